@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <color_spinor_field.h>
+#include <vector_io_native.h>
+
+/**
+   @file async_io.h
+
+   @brief Engine for writing sets of vector fields in the background.
+   Fields are snapshotted to host staging fields on the calling
+   thread, after which the local file writes are done by a dedicated
+   I/O thread, overlapping with continued computation.  The collective
+   parts of a write (creating the file, and reducing the checksums on
+   completion) are always done on the calling thread, so no
+   thread-safe communication is required.
+
+   The host memory held by pending writes is bounded by a staging
+   budget: when a new write would exceed it, the oldest pending
+   writes are completed first.  Since every rank holds the same
+   volume, all ranks make the same decision, so the collective
+   completions stay matched.
+ */
+
+namespace quda
+{
+
+  namespace async_io
+  {
+
+    /**
+       @return Whether asynchronous writing is enabled, which is set
+       with QUDA_ENABLE_ASYNC_IO=1
+     */
+    bool enabled();
+
+    /**
+       @return The host staging budget in bytes, which is set in MiB
+       with QUDA_ASYNC_IO_BUDGET (default 4096)
+     */
+    size_t budget();
+
+    /**
+       @brief Make room in the staging budget for a new write by
+       completing the oldest pending writes.  This is collective.
+       @param[in] bytes The staging bytes of the new write
+     */
+    void reserve(size_t bytes);
+
+    /**
+       @brief Submit a write of staged fields to the I/O thread.  The
+       writer must have been created on the calling thread, and the
+       staging budget reserved.
+       @param[in] writer The writer for the file
+       @param[in] staging The staged fields, which are owned by the
+       engine until the write completes
+     */
+    void submit(std::unique_ptr<native_io::Writer> &&writer, std::vector<ColorSpinorField> &&staging);
+
+    /**
+       @brief Complete pending writes, waiting for the I/O thread if
+       needed.  This is collective.
+       @param[in] filename If set, only complete the writes up to and
+       including the last one to this file
+     */
+    void flush(const std::string &filename = "");
+
+    /**
+       @return The number of pending writes
+     */
+    size_t pending();
+
+    /**
+       @brief Complete all pending writes and stop the I/O thread
+     */
+    void destroy();
+
+  } // namespace async_io
+
+} // namespace quda
@@ -795,6 +795,15 @@ namespace quda
      */
     static FieldTmp<ColorSpinorField> create_comms_batch(cvector_ref<const ColorSpinorField> &v);
 
+    /**
+      @brief Create a temporary field that holds a batch of fields,
+      one per slice of an extra outermost dimension, for operators
+      that apply to the whole batch in one call
+      @param[in] v Vector of fields we wish to batch together
+      @return Uninitialized (nDim+1)-dimensional field
+     */
+    static FieldTmp<ColorSpinorField> create_batch(cvector_ref<const ColorSpinorField> &v);
+
     /**
        @brief Create a field that aliases this field's storage.  The
        alias field can use a different precision than this field,
@@ -991,6 +1000,20 @@ namespace quda
   */
   void copyFieldOffset(ColorSpinorField &out, const ColorSpinorField &in, CommKey offset, QudaPCType pc_type);
 
+  /**
+    @brief Copy a set of fields into the slices of a batched field
+    @param[out] batch The batched field, see ColorSpinorField::create_batch
+    @param[in] v The fields we are copying, one per slice
+  */
+  void copyToBatch(ColorSpinorField &batch, cvector_ref<const ColorSpinorField> &v);
+
+  /**
+    @brief Copy the slices of a batched field out to a set of fields
+    @param[out] v The fields we are copying to, one per slice
+    @param[in] batch The batched field, see ColorSpinorField::create_batch
+  */
+  void copyFromBatch(cvector_ref<ColorSpinorField> &v, const ColorSpinorField &batch);
+
   /**
      @brief Print the value of the field at the requested coordinates
      @param[in] a The field we are printing from
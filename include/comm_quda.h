@@ -188,6 +188,12 @@ namespace quda
   */
   int comm_rank_global(void);
 
+  /**
+     @return The largest message tag supported by the communications
+     layer, which is at least 32767
+  */
+  int comm_tag_ub(void);
+
   /**
      @return Number of processes
   */
@@ -398,6 +404,21 @@ namespace quda
   void comm_allreduce_int(int &data);
   void comm_allreduce_xor(uint64_t &data);
 
+  /**
+     @brief Start a non-blocking global sum of an array, in place,
+     which may be overlapped with computation.  Only one such
+     reduction may be outstanding at a time.
+     @param[in,out] data The array to be summed, which must not be
+     accessed until comm_allreduce_wait returns
+     @param[in] size The length of the array
+  */
+  void comm_allreduce_sum_array_start(double *data, size_t size);
+
+  /**
+     @brief Complete the reduction started by comm_allreduce_sum_array_start
+  */
+  void comm_allreduce_wait();
+
   /**
      @brief Broadcast from the root rank
      @param[in,out] data The data to be read from on the root rank, and
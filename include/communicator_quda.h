@@ -649,6 +649,7 @@ namespace quda
 
 #if defined(QMP_COMMS) || defined(MPI_COMMS)
   MPI_Comm MPI_COMM_HANDLE;
+  MPI_Request allreduce_request = MPI_REQUEST_NULL; /** Request of the outstanding non-blocking reduction */
 #endif
 
 #if defined(QMP_COMMS)
@@ -741,6 +742,21 @@ namespace quda
 
   void comm_allreduce_sum_array(double *data, size_t size);
 
+  /**
+     @brief Start a non-blocking global sum of an array, in place.
+     Only one such reduction may be outstanding at a time.  With
+     deterministic reductions enabled this is a blocking reduction.
+     @param[in,out] data The array to be summed, which must not be
+     accessed until comm_allreduce_wait returns
+     @param[in] size The length of the array
+  */
+  void comm_allreduce_sum_array_start(double *data, size_t size);
+
+  /**
+     @brief Complete the outstanding non-blocking reduction
+  */
+  void comm_allreduce_wait();
+
   void comm_allreduce_max_array(double *data, size_t size);
 
   void comm_allreduce_max_array(deviation_t<double> *data, size_t size);
@@ -765,6 +781,8 @@ namespace quda
   static void comm_abort_(int status);
 
   static int comm_rank_global();
+
+  static int comm_tag_ub();
 };
 
 constexpr CommKey default_comm_key = {1, 1, 1, 1};
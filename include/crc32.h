@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+   @file crc32.h
+
+   @brief Host CRC-32 (the IEEE 802.3 polynomial, as used by zlib)
+   and the SciDAC checksum built from it.  The SciDAC checksum of a
+   field is independent of how the field is partitioned over ranks,
+   since each site contributes according to its global lexicographic
+   index, and the per-rank contributions are combined with an XOR.
+ */
+
+namespace quda
+{
+
+  namespace crc
+  {
+
+    /**
+       @return The table for byte-wise CRC-32 computation
+     */
+    inline const std::array<uint32_t, 256> &crc32_table()
+    {
+      static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> table;
+        for (uint32_t i = 0; i < 256; i++) {
+          uint32_t c = i;
+          for (int k = 0; k < 8; k++) c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+          table[i] = c;
+        }
+        return table;
+      }();
+      return table;
+    }
+
+    /**
+       @brief Update a CRC-32 with a buffer, with the same semantics as zlib's crc32()
+       @param[in] crc The running CRC (0 to start)
+       @param[in] buf The buffer
+       @param[in] len The number of bytes in the buffer
+       @return The updated CRC
+     */
+    inline uint32_t crc32(uint32_t crc, const void *buf, size_t len)
+    {
+      auto &table = crc32_table();
+      auto p = static_cast<const unsigned char *>(buf);
+      crc = ~crc;
+      for (size_t i = 0; i < len; i++) crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+      return ~crc;
+    }
+
+    /**
+       @brief Accumulator for the SciDAC checksum
+     */
+    struct ScidacChecksum {
+      uint32_t suma = 0;
+      uint32_t sumb = 0;
+
+      /**
+         @brief Add a site to the checksum
+         @param[in] rank The global lexicographic index of the site
+         @param[in] buf The site data
+         @param[in] len The number of bytes per site
+       */
+      void add(uint64_t rank, const void *buf, size_t len) { add(rank, crc32(0, buf, len)); }
+
+      /**
+         @brief Add a site to the checksum given the CRC-32 of its
+         data, e.g., when the data are streamed in pieces
+         @param[in] rank The global lexicographic index of the site
+         @param[in] work The CRC-32 of the site data
+       */
+      void add(uint64_t rank, uint32_t work)
+      {
+        int rank29 = rank % 29;
+        int rank31 = rank % 31;
+        suma ^= rank29 ? (work << rank29) | (work >> (32 - rank29)) : work;
+        sumb ^= rank31 ? (work << rank31) | (work >> (32 - rank31)) : work;
+      }
+
+      /** @return The checksum packed into a single word, e.g., for a global XOR reduction */
+      uint64_t pack() const { return (static_cast<uint64_t>(suma) << 32) | sumb; }
+
+      /** @brief Unpack a checksum packed with pack() */
+      void unpack(uint64_t packed)
+      {
+        suma = packed >> 32;
+        sumb = packed & 0xffffffffu;
+      }
+    };
+
+  } // namespace crc
+
+} // namespace quda
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <typeinfo>
 #include <quda_internal.h>
 #include <timer.h>
@@ -8,6 +9,7 @@
 #include <clover_field.h>
 #include <blas_quda.h>
 #include <field_cache.h>
+#include <solver_telemetry.h>
 
 // temporary addition until multi-RHS for all Dirac operator functions
 #ifdef __CUDACC__
@@ -570,6 +572,22 @@ namespace quda {
     void M(ColorSpinorField &out, const ColorSpinorField &in) const;
     void MdagM(ColorSpinorField &out, const ColorSpinorField &in) const;
 
+    /**
+       @brief Apply M to a set of fields.  The fields are copied into
+       a batched field, so that each dslash applies to the whole set
+       in one kernel that reads each gauge link once for all fields.
+       @param[out] out The vector of output fields
+       @param[in] in The vector of input fields
+    */
+    void M(cvector_ref<ColorSpinorField> &out, cvector_ref<const ColorSpinorField> &in) const;
+
+    /**
+       @brief Apply MdagM to a set of fields, batched as for M
+       @param[out] out The vector of output fields
+       @param[in] in The vector of input fields
+    */
+    void MdagM(cvector_ref<ColorSpinorField> &out, cvector_ref<const ColorSpinorField> &in) const;
+
     void prepare(ColorSpinorField* &src, ColorSpinorField* &sol,
 		 ColorSpinorField &x, ColorSpinorField &b,
 		 const QudaSolutionType) const;
@@ -1841,6 +1859,19 @@ public:
      */
     DiracCoarse(const DiracParam &param, bool gpu_setup=true, bool mapped=false);
 
+    /**
+       @brief Construct the operator from previously computed coarse
+       links, e.g., restored from a checkpoint, rather than by
+       coarsening the fine operator
+       @param[in] param Parameters defining this operator
+       @param[in] gpu_setup Whether the operator is set up on GPU or CPU
+       @param[in] mapped Set to true to put Y and X fields in mapped memory
+       @param[in] restore Function that fills in the host fields Y, X,
+       Xinv and Yhat passed to it
+     */
+    DiracCoarse(const DiracParam &param, bool gpu_setup, bool mapped,
+                const std::function<void(const std::vector<GaugeField *> &)> &restore);
+
     /**
        @param[in] param Parameters defining this operator
        @param[in] Y_h CPU coarse link field
@@ -1865,6 +1896,19 @@ public:
 
     virtual bool isCoarse() const { return true; }
 
+    /**
+       @brief Return the coarse link fields, creating them in the
+       requested location if needed
+       @param[in] location The location of the fields
+       @return The fields Y, X, Xinv and Yhat
+     */
+    std::vector<GaugeField *> CoarseLinks(QudaFieldLocation location) const
+    {
+      initializeLazy(location);
+      if (location == QUDA_CUDA_FIELD_LOCATION) return {Y_d, X_d, Xinv_d, Yhat_d};
+      return {Y_h, X_h, Xinv_h, Yhat_h};
+    }
+
     /**
        @brief Apply the coarse clover operator
        @param[out] out Output field
@@ -2296,6 +2340,7 @@ public:
     */
     void operator()(ColorSpinorField &out, const ColorSpinorField &in) const
     {
+      SolverTelemetry::Region region(SolverTelemetry::OPERATOR);
       dirac->M(out, in);
       if (shift != 0.0) blas::axpy(shift, in, out);
     }
@@ -2307,6 +2352,7 @@ public:
      */
     void operator()(cvector_ref<ColorSpinorField> &out, cvector_ref<const ColorSpinorField> &in) const
     {
+      SolverTelemetry::Region region(SolverTelemetry::OPERATOR);
       dirac->M(out, in);
       for (auto i = 0u; i < in.size(); i++)
         if (shift != 0.0) blas::axpy(shift, in[i], out[i]);
@@ -2327,6 +2373,7 @@ public:
 
     void operator()(ColorSpinorField &out, const ColorSpinorField &in) const
     {
+      SolverTelemetry::Region region(SolverTelemetry::OPERATOR);
       dirac->MdagM(out, in);
       if (shift != 0.0) blas::axpy(shift, in, out);
     }
@@ -2338,6 +2385,7 @@ public:
      */
     void operator()(cvector_ref<ColorSpinorField> &out, cvector_ref<const ColorSpinorField> &in) const
     {
+      SolverTelemetry::Region region(SolverTelemetry::OPERATOR);
       dirac->MdagM(out, in);
       for (auto i = 0u; i < in.size(); i++)
         if (shift != 0.0) blas::axpy(shift, in[i], out[i]);
@@ -2359,7 +2407,11 @@ public:
     DiracMdagMLocal(const Dirac &d) : DiracMatrix(d) { }
     DiracMdagMLocal(const Dirac *d) : DiracMatrix(d) { }
 
-    void operator()(ColorSpinorField &out, const ColorSpinorField &in) const { dirac->MdagMLocal(out, in); }
+    void operator()(ColorSpinorField &out, const ColorSpinorField &in) const
+    {
+      SolverTelemetry::Region region(SolverTelemetry::OPERATOR);
+      dirac->MdagMLocal(out, in);
+    }
 
     /**
        @brief Multi-RHS operator application.
@@ -2368,6 +2420,7 @@ public:
      */
     void operator()(cvector_ref<ColorSpinorField> &out, cvector_ref<const ColorSpinorField> &in) const
     {
+      SolverTelemetry::Region region(SolverTelemetry::OPERATOR);
       dirac->MdagMLocal(out, in);
     }
 
@@ -2387,6 +2440,7 @@ public:
 
     void operator()(ColorSpinorField &out, const ColorSpinorField &in) const
     {
+      SolverTelemetry::Region region(SolverTelemetry::OPERATOR);
       dirac->MMdag(out, in);
       if (shift != 0.0) blas::axpy(shift, in, out);
     }
@@ -2398,6 +2452,7 @@ public:
      */
     void operator()(cvector_ref<ColorSpinorField> &out, cvector_ref<const ColorSpinorField> &in) const
     {
+      SolverTelemetry::Region region(SolverTelemetry::OPERATOR);
       dirac->MMdag(out, in);
       for (auto i = 0u; i < in.size(); i++)
         if (shift != 0.0) blas::axpy(shift, in[i], out[i]);
@@ -2420,6 +2475,7 @@ public:
 
     void operator()(ColorSpinorField &out, const ColorSpinorField &in) const
     {
+      SolverTelemetry::Region region(SolverTelemetry::OPERATOR);
       dirac->Mdag(out, in);
       if (shift != 0.0) blas::axpy(shift, in, out);
     }
@@ -2431,6 +2487,7 @@ public:
      */
     void operator()(cvector_ref<ColorSpinorField> &out, cvector_ref<const ColorSpinorField> &in) const
     {
+      SolverTelemetry::Region region(SolverTelemetry::OPERATOR);
       dirac->Mdag(out, in);
       for (auto i = 0u; i < in.size(); i++)
         if (shift != 0.0) blas::axpy(shift, in[i], out[i]);
@@ -2564,6 +2621,7 @@ public:
 
     void operator()(ColorSpinorField &out, const ColorSpinorField &in) const
     {
+      SolverTelemetry::Region region(SolverTelemetry::OPERATOR);
       dirac->M(out, in);
       if (shift != 0.0) blas::axpy(shift, in, out);
       applyGamma5(out);
@@ -2576,6 +2634,7 @@ public:
      */
     void operator()(cvector_ref<ColorSpinorField> &out, cvector_ref<const ColorSpinorField> &in) const
     {
+      SolverTelemetry::Region region(SolverTelemetry::OPERATOR);
       dirac->M(out, in);
       for (auto i = 0u; i < in.size(); i++) {
         if (shift != 0.0) blas::axpy(shift, in[i], out[i]);
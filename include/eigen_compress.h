@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <color_spinor_field.h>
+#include <reference_wrapper_helper.h>
+
+/**
+   @file eigen_compress.h
+
+   @brief Compressed storage of eigenvectors using local coherence.
+   The lowest n_basis eigenvectors are block orthonormalized with the
+   multigrid Transfer machinery, and every eigenvector is stored as its
+   restriction onto this block basis, i.e., as a single-precision
+   coarse field of n_basis colors per block and chirality.  On loading,
+   the eigenvectors are reconstructed by prolongation.  With 4^4
+   blocks and 24 basis vectors, the coefficients are about 30x smaller
+   than double-precision Wilson eigenvectors.
+
+   A compressed eigenspace consists of three files:
+
+   - filename: a JSON manifest with the blocking, the number of basis
+     vectors and the relative reconstruction error of each vector;
+   - filename.basis: the basis vectors in the native format;
+   - filename.coeff: the coefficients in the native format.
+
+   Compression is enabled by setting the number of basis vectors with
+   QUDA_EIGEN_COMPRESS_NBASIS, which must be one of the multigrid
+   Nvec values QUDA was built with, and the block size with
+   QUDA_EIGEN_COMPRESS_BLOCK (default "4,4,4,4").  Only eigenvectors
+   of fine-grid operators are compressed: singular vectors (which are
+   not ordered with the lowest modes first) and the eigenvectors of
+   coarse-grid operators are always saved uncompressed.
+ */
+
+namespace quda
+{
+
+  namespace eigen_compress
+  {
+
+    /**
+       @return Whether saving eigenvectors in compressed form is enabled
+     */
+    bool enabled();
+
+    /**
+       @brief Return whether a file is the manifest of a compressed
+       eigenspace.  This is collective over all ranks.
+       @param[in] filename The file to query
+     */
+    bool is_compressed_file(const std::string &filename);
+
+    /**
+       @brief Save eigenvectors in compressed form.  This is collective
+       over all ranks.
+       @param[in] filename The manifest file to write
+       @param[in] evecs The eigenvectors to save, with the lowest modes first
+       @param[in] prec The precision to save the basis vectors in
+       @return Whether the vectors were saved.  If false, the
+       eigenvectors are not compatible with compression (e.g., not
+       four dimensional, or fewer than the number of basis vectors),
+       and should be saved uncompressed.
+     */
+    bool save(const std::string &filename, cvector_ref<const ColorSpinorField> &evecs, QudaPrecision prec);
+
+    /**
+       @brief Load and reconstruct eigenvectors from a compressed
+       eigenspace.  This is collective over all ranks.
+       @param[in] filename The manifest file to read
+       @param[in] evecs The eigenvectors to load
+     */
+    void load(const std::string &filename, cvector_ref<ColorSpinorField> &evecs);
+
+  } // namespace eigen_compress
+
+} // namespace quda
@@ -126,6 +126,11 @@ typedef enum QudaInverterType_s {
   QUDA_CA_CGNE_INVERTER,
   QUDA_CA_CGNR_INVERTER,
   QUDA_CA_GCR_INVERTER,
+  QUDA_PIPELINED_CG_INVERTER,
+  QUDA_IDR_INVERTER,
+  QUDA_CA_BICGSTAB_INVERTER,
+  QUDA_GCRODR_INVERTER,
+  QUDA_BLOCK_CG_INVERTER,
   QUDA_INVALID_INVERTER = QUDA_INVALID_ENUM
 } QudaInverterType;
 
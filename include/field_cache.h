@@ -1,16 +1,31 @@
 #pragma once
 
 #include <string>
-#include <map>
-#include <stack>
+#include <functional>
+#include <memory>
+#include <utility>
 #include <vector>
 #include <reference_wrapper_helper.h>
 
 namespace quda {
 
+  class GaugeField;
+  class CloverField;
+
+  /**
+     @brief Return the auxiliary string used to key a field in the
+     field cache.  By default this is the field's tuning aux string,
+     which is specialized for field types whose aux string does not
+     uniquely describe their layout.
+     @param[in] a Field whose aux key string we wish to generate
+   */
+  template <typename T> std::string field_cache_aux(const T &a) { return a.AuxString(); }
+  std::string field_cache_aux(const GaugeField &a);
+  std::string field_cache_aux(const CloverField &a);
+
   /**
-     FieldKey is a container for a key for a std::map to cache
-     allocated field instances.
+     FieldKey is a container for a key for a std::unordered_map to
+     cache allocated field instances.
      @tparam T The field type
    */
   template <typename T>
@@ -24,37 +39,63 @@ namespace quda {
        @brief Constructor for FieldKey
        @param[in] a Field whose key we wish to generate
     */
-    FieldKey(const T &a) : volume(a.VolString()), aux(a.AuxString()) { }
+    FieldKey(const T &a) : volume(a.VolString()), aux(field_cache_aux(a)) { }
 
     /**
-       @brief Less than operator used for ordering in the container
+       @brief Equality operator used for lookup in the container
      */
-    bool operator<(const FieldKey<T> &other) const
-    {
-      if (volume < other.volume) {
-        return true;
-      } else if (volume == other.volume) {
-        return aux < other.aux ? true : false;
+    bool operator==(const FieldKey<T> &other) const { return volume == other.volume && aux == other.aux; }
+
+    /**
+       @brief Hash function used for lookup in the container
+     */
+    struct hash {
+      size_t operator()(const FieldKey<T> &key) const
+      {
+        size_t h = std::hash<std::string>()(key.volume);
+        return h ^ (std::hash<std::string>()(key.aux) + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2));
       }
-      return false;
-    }
+    };
   };
 
   /**
-     FieldTmp is a wrapper for a cached field.
+     @brief Default budget (in MiB) of each field cache, used when
+     QUDA_FIELD_CACHE_BUDGET is not set
+   */
+  constexpr size_t default_field_cache_budget = 1024;
+
+  /**
+     @brief Statistics of a field cache
+   */
+  struct FieldCacheStats {
+    size_t hits = 0;          /** Temporaries served from the cache */
+    size_t misses = 0;        /** Temporaries that had to be allocated */
+    size_t evictions = 0;     /** Cached temporaries freed to stay within the budget */
+    size_t cached_fields = 0; /** Number of temporaries currently cached */
+    size_t cached_bytes = 0;  /** Bytes of the temporaries currently cached */
+    size_t budget = 0;        /** Maximum bytes of cached temporaries (0 = unlimited) */
+  };
+
+  /**
+     FieldTmp is a wrapper for a cached field.  Released temporaries
+     are kept in a per-type cache, from which the least recently
+     released ones are evicted once the cached bytes exceed the budget.
+     The budget (in MiB) is set with QUDA_FIELD_CACHE_BUDGET, or with
+     set_budget(), and applies to each field type separately.  It
+     defaults to default_field_cache_budget (1 GiB); a budget of 0
+     leaves the cache unbounded.
      @tparam T The field type
    */
   template <typename T>
   class FieldTmp {
-    static std::map<FieldKey<T>, std::stack<T>> cache; /** Field Cache */
-    T tmp;                                             /** The temporary field instance */
-    FieldKey<T> key;                                   /** Key associated with this instance */
+    std::unique_ptr<T> tmp; /** The temporary field instance */
+    FieldKey<T> key;        /** Key associated with this instance */
 
   public:
     /**
        @brief Allow FieldTmp<T> to be used in lieu of T
     */
-    operator T&() { return tmp; }
+    operator T&() { return *tmp; }
 
     /**
        @brief Create a field temporary that is identical to the field
@@ -97,6 +138,22 @@ namespace quda {
 
     /** @brief Flush the cache and frees all temporary allocations */
     static void destroy();
+
+    /**
+       @brief Set the maximum number of bytes of cached temporaries,
+       evicting the least recently released ones if needed
+       @param[in] bytes The budget in bytes (0 = unlimited)
+     */
+    static void set_budget(size_t bytes);
+
+    /** @return The statistics of the cache */
+    static FieldCacheStats get_stats();
+
+    /**
+       @brief Print the statistics of the cache
+       @param[in] name Name of the field type to print
+     */
+    static void print_stats(const char *name);
   };
 
   /**
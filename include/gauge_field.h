@@ -830,6 +830,47 @@ namespace quda {
   */
   uint64_t Checksum(const GaugeField &u, bool mini=false);
 
+  /**
+     Checksums of a gauge field
+  */
+  struct GaugeChecksum {
+    uint64_t xor_sum = 0; /** The XOR checksum, as returned by Checksum() */
+    uint32_t suma = 0;    /** The SciDAC checksum a */
+    uint32_t sumb = 0;    /** The SciDAC checksum b */
+  };
+
+  /**
+     @return Whether the checksums of a field can be computed in place,
+     i.e., it is a single or double precision host field in an order
+     with a direct accessor.  Other fields must first be reordered to
+     a host field.
+     @param[in] u The gauge field
+  */
+  bool ChecksumInPlace(const GaugeField &u);
+
+  /**
+     Compute the XOR checksum and the SciDAC checksum of a gauge field
+     in a single threaded pass over the field, reduced over all ranks.
+     The SciDAC checksum is that written to SciDAC and ILDG files by
+     QIO, MILC and Chroma: the CRC-32 of the links of each site,
+     serialized as in the file, rotated by the global site index.  The
+     number of host threads can be set with QUDA_CHECKSUM_THREADS,
+     and defaults to the cores in the affinity mask of the process.
+     Fields that support ChecksumInPlace() are read directly; device
+     fields and fields in other orders are first copied to a host
+     QDP-ordered field, so their checksums only match the file if the
+     field holds the links exactly (e.g., no half precision or
+     compressed reconstruction).  Extended fields are not supported.
+     @param[in] u The gauge field
+     @param[in] file_precision The precision of the links in the file
+     (default is the precision of the field)
+     @param[in] big_endian Whether the file is big endian, as for
+     ILDG and SciDAC files
+     @return The checksums
+  */
+  GaugeChecksum Checksums(const GaugeField &u, QudaPrecision file_precision = QUDA_INVALID_PRECISION,
+                          bool big_endian = true);
+
   /**
      @brief Helper function for determining if the reconstruct of the fields is the same.
      @param[in] a Input field
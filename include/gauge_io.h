@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <gauge_field.h>
+
+/**
+   @file gauge_io.h
+
+   @brief Native parallel readers for gauge configurations in the
+   NERSC (3x2 and 3x3, either byte order) and ILDG/LIME formats.
+   Each rank reads its own sub-volume directly from the file with
+   positional reads, and converts it into the host field, so there is
+   no serialization through a single rank and no full-lattice
+   intermediate copy.  The checksum in the file (the NERSC word sum or
+   the SciDAC checksum of an ILDG file) is verified on the fly.
+ */
+
+namespace quda
+{
+
+  namespace gauge_io
+  {
+
+    /**
+       @brief Read a gauge configuration, detecting its format.  This
+       is collective over all ranks.
+       @param[in] filename The configuration to read
+       @param[out] u Host gauge field in QDP or MILC order to read
+       into, in double or single precision, whose local dimensions and
+       rank partitioning define the sub-volume read by each rank
+     */
+    void read(const std::string &filename, GaugeField &u);
+
+    /**
+       @brief Read a NERSC gauge configuration.  This is collective
+       over all ranks.
+       @param[in] filename The configuration to read
+       @param[out] u Host gauge field to read into
+     */
+    void read_nersc(const std::string &filename, GaugeField &u);
+
+    /**
+       @brief Read an ILDG (LIME) gauge configuration.  This is
+       collective over all ranks.
+       @param[in] filename The configuration to read
+       @param[out] u Host gauge field to read into
+     */
+    void read_ildg(const std::string &filename, GaugeField &u);
+
+  } // namespace gauge_io
+
+} // namespace quda
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <memory>
+#include <functional>
 #include <quda.h>
 #include <quda_internal.h>
 #include <timer.h>
@@ -10,6 +11,7 @@
 #include <qio_field.h>
 #include <eigensolve_quda.h>
 #include <invert_x_update.h>
+#include <solver_telemetry.h>
 #include <madwf_param.h>
 
 namespace quda {
@@ -245,10 +247,25 @@ namespace quda {
     double  inc_tol;
     double  eigenval_tol;
 
+    bool preserve_recycle = false;          //! whether to preserve the GCRO-DR recycled subspace after the solve
+    void *preserve_recycle_space = nullptr; //! the preserved recycle_space, if any
+
+    bool precision_ladder = false;       //! whether to promote the sloppy precision adaptively during the solve
+    int precision_ladder_check = 0;      //! minimum iterations over which the rate is measured on the precision ladder
+    int precision_ladder_promotions = 0; //! number of promotions on the precision ladder in the last solve
+
+    /** Called by the CG, PCG, pipelined CG, GCR and BiCGstab solvers
+        at each reliable update with the iteration count and the true
+        residual norm squared; the solve ends there if it returns true.
+        This is not copied with the parameters. */
+    std::function<bool(int, double)> reliable_update_hook;
+
     QudaVerbosity verbosity_precondition; //! verbosity to use for preconditioner
 
     bool is_preconditioner; //! whether the solver acting as a preconditioner for another solver
 
+    bool record_telemetry = false; //! whether to record the solver telemetry, set for top-level solves only
+
     bool global_reduction; //! whether to use a global or local (node) reduction for this solver
 
     /** Whether the MG preconditioner (if any) is an instance of MG
@@ -344,6 +361,10 @@ namespace quda {
       max_restart_num(param.max_restart_num),
       inc_tol(param.inc_tol),
       eigenval_tol(param.eigenval_tol),
+      preserve_recycle(param.preserve_recycle == QUDA_BOOLEAN_TRUE),
+      preserve_recycle_space(param.preserve_recycle_space),
+      precision_ladder(param.precision_ladder == QUDA_BOOLEAN_TRUE),
+      precision_ladder_check(param.precision_ladder_check),
       verbosity_precondition(param.verbosity_precondition),
       is_preconditioner(false),
       global_reduction(true),
@@ -433,6 +454,10 @@ namespace quda {
       max_restart_num(param.max_restart_num),
       inc_tol(param.inc_tol),
       eigenval_tol(param.eigenval_tol),
+      preserve_recycle(param.preserve_recycle),
+      preserve_recycle_space(param.preserve_recycle_space),
+      precision_ladder(param.precision_ladder),
+      precision_ladder_check(param.precision_ladder_check),
       verbosity_precondition(param.verbosity_precondition),
       is_preconditioner(param.is_preconditioner),
       global_reduction(param.global_reduction),
@@ -483,6 +508,10 @@ namespace quda {
       //for incremental eigCG:
       param.rhs_idx = rhs_idx;
 
+      param.preserve_recycle_space = preserve_recycle_space;
+
+      param.precision_ladder_promotions = precision_ladder_promotions;
+
       param.ca_lambda_min = ca_lambda_min;
       param.ca_lambda_max = ca_lambda_max;
 
@@ -516,6 +545,7 @@ namespace quda {
     bool recompute_evals;   /** If true, instruct the solver to recompute evals from an existing deflation space. */
     std::vector<ColorSpinorField> evecs; /** Holds the eigenvectors. */
     std::vector<Complex> evals;          /** Holds the eigenvalues. */
+    SolverTelemetry telemetry;           /** Telemetry record of the current solve, if enabled */
 
     bool mixed() { return param.precision != param.precision_sloppy; }
 
@@ -933,6 +963,54 @@ namespace quda {
     virtual bool hermitian() { return false; } /** CG3NR is for any system */
   };
 
+  /**
+     @brief Pipelined Conjugate-Gradient solver (Ghysels and Vanroose,
+     https://doi.org/10.1016/j.parco.2013.06.001).  The two inner
+     products of each iteration are fused into a single local
+     reduction whose global sum is non-blocking and overlapped with
+     the application of the operator, so each iteration has one
+     global synchronization that is hidden behind the stencil.  The
+     extra recurrences for A p and A^2 p are reset by residual
+     replacement, triggered with the same criteria as the reliable
+     updates of CG.
+   */
+  class PipelinedCG : public Solver
+  {
+
+  private:
+    ColorSpinorField r;        /** High-precision residual */
+    ColorSpinorField y;        /** High-precision solution accumulator */
+    ColorSpinorField r_sloppy; /** Residual r */
+    ColorSpinorField x_sloppy; /** Solution accumulated since the last residual replacement */
+    ColorSpinorField p;        /** Search direction p */
+    ColorSpinorField s;        /** s = A p */
+    ColorSpinorField w;        /** w = A r */
+    ColorSpinorField z;        /** z = A s */
+    ColorSpinorField q;        /** q = A w */
+    bool init = false;
+
+    /**
+       @brief Initiate the fields needed by the solver
+       @param[in] x Solution vector
+       @param[in] b Source vector
+    */
+    void create(ColorSpinorField &x, const ColorSpinorField &b);
+
+  public:
+    PipelinedCG(const DiracMatrix &mat, const DiracMatrix &matSloppy, const DiracMatrix &matPrecon,
+                const DiracMatrix &matEig, SolverParam &param, TimeProfile &profile);
+    virtual ~PipelinedCG();
+
+    void operator()(ColorSpinorField &out, ColorSpinorField &in);
+
+    /**
+       @return Return the residual vector from the prior solve
+    */
+    ColorSpinorField &get_residual();
+
+    virtual bool hermitian() { return true; } /** CG is only for Hermitian systems */
+  };
+
   class PreconCG : public Solver {
     private:
     std::shared_ptr<Solver> K;
@@ -1108,6 +1186,68 @@ namespace quda {
     virtual bool hermitian() { return false; } /** BiCGStab is for any linear system */
   };
 
+  /**
+     @brief IDR(s) with biorthogonalization, as described in van
+     Gijzen and Sonneveld, https://doi.org/10.1145/2049662.2049667.
+     The residuals are forced into a sequence of nested subspaces of
+     shrinking dimension, defined by an s-dimensional shadow space P.
+     Each cycle of s+1 operator applications enters the next subspace,
+     and all projections onto P are done with multi-reduce kernels.
+     IDR(1) is mathematically equivalent to BiCGstab.  The shadow space
+     dimension s is given by Nkrylov.
+   */
+  class IDR : public Solver
+  {
+
+  private:
+    int n_shadow; /** The dimension s of the shadow space */
+
+    std::vector<Complex> M; /** M = P^H G, lower triangular, stored row major */
+    std::vector<Complex> f; /** f = P^H r */
+
+    ColorSpinorField r_full; /** Full precision residual */
+    ColorSpinorField y;      /** Full precision solution accumulator */
+
+    // sloppy precision fields
+    ColorSpinorField r;        /** Sloppy residual */
+    ColorSpinorField x_sloppy; /** Sloppy solution accumulator */
+    ColorSpinorField v;        /** Temporary */
+    ColorSpinorField t;        /** t = A r in the dimension reduction step */
+    std::vector<ColorSpinorField> P; /** Orthonormal shadow space */
+    std::vector<ColorSpinorField> G; /** Directions in the current subspace */
+    std::vector<ColorSpinorField> U; /** U with G = A U */
+
+    bool init = false;
+
+    std::string solver_name; /** IDR(s) with the value of s */
+
+    /**
+       @brief Allocate persistent fields and parameter checking
+       @param[in] x Solution vector
+       @param[in] b Source vector
+     */
+    void create(ColorSpinorField &x, const ColorSpinorField &b);
+
+    /**
+       @brief Fill the shadow space with orthonormalized random vectors
+    */
+    void createShadowSpace();
+
+  public:
+    IDR(const DiracMatrix &mat, const DiracMatrix &matSloppy, const DiracMatrix &matPrecon, const DiracMatrix &matEig,
+        SolverParam &param, TimeProfile &profile);
+    virtual ~IDR();
+
+    void operator()(ColorSpinorField &out, ColorSpinorField &in);
+
+    /**
+       @return Return the residual vector from the prior solve
+    */
+    ColorSpinorField &get_residual();
+
+    virtual bool hermitian() { return false; } /** IDR is for any linear system */
+  };
+
   class GCR : public Solver {
 
   private:
@@ -1384,6 +1524,71 @@ namespace quda {
     virtual bool hermitian() { return false; } /** GCR is for any linear system */
   };
 
+  /**
+     @brief Communication-avoiding BiCGstab, as described in Carson,
+     Knight and Demmel, https://doi.org/10.1137/120881191.  Every s
+     iterations, a basis of dimension 2s+1 for the search direction
+     and one of dimension 2s for the residual are built with the same
+     power or Chebyshev polynomials as CA-CG, and a single block
+     reduction computes their Gram matrix together with their
+     projection onto the shadow residual.  The s iterations are then
+     carried out on coordinate vectors of length 4s+1 on the host
+     without any global reduction.  The number of steps s is given by
+     Nkrylov.
+   */
+  class CABiCGstab : public Solver
+  {
+
+  private:
+    bool init = false;
+
+    bool lambda_init;  // whether or not lambda_max has been initialized
+    QudaCABasis basis; // CA basis
+
+    ColorSpinorField r;       // full precision residual
+    ColorSpinorField r_tilde; // shadow residual
+    ColorSpinorField tmp;     // sloppy temporary
+
+    std::vector<ColorSpinorField> Y;  // basis [P, R]
+    std::vector<ColorSpinorField> P;  // search direction basis, aliases the first 2s+1 vectors of Y
+    std::vector<ColorSpinorField> R;  // residual basis, aliases the last 2s vectors of Y
+    std::vector<ColorSpinorField> AP; // mat * P, aliases P[1..2s] for the power basis
+    std::vector<ColorSpinorField> AR; // mat * R, aliases R[1..2s-1] for the power basis, else AP
+
+    /**
+       @brief Initiate the fields needed by the solver
+       @param[in] x Solution vector
+       @param[in] b Source vector
+    */
+    void create(ColorSpinorField &x, const ColorSpinorField &b);
+
+    /**
+       @brief Compute the basis vector v[n] from the recurrence of the
+       CA basis, given v[0..n-1] and Av[n-1]
+       @param[in,out] v Basis vectors
+       @param[in] Av mat * basis vectors
+       @param[in] n The index of the vector to compute
+       @param[in] m_map Slope mapping for Chebyshev basis; ignored for power basis
+       @param[in] b_map Intercept mapping for Chebyshev basis; ignored for power basis
+    */
+    void extendBasis(std::vector<ColorSpinorField> &v, std::vector<ColorSpinorField> &Av, int n, double m_map,
+                     double b_map);
+
+  public:
+    CABiCGstab(const DiracMatrix &mat, const DiracMatrix &matSloppy, const DiracMatrix &matPrecon,
+               const DiracMatrix &matEig, SolverParam &param, TimeProfile &profile);
+    virtual ~CABiCGstab();
+
+    void operator()(ColorSpinorField &out, ColorSpinorField &in);
+
+    /**
+       @return Return the residual vector from the prior solve
+    */
+    ColorSpinorField &get_residual();
+
+    virtual bool hermitian() { return false; } /** BiCGstab is for any linear system */
+  };
+
   // Steepest descent solver used as a preconditioner
   class SD : public Solver {
     private:
@@ -1450,6 +1655,52 @@ public:
     virtual bool hermitian() { return solver->hermitian(); } /** Use the inner solver */
   };
 
+  /**
+     @brief Adaptive precision ladder for mixed-precision solvers.  The
+     rungs are the distinct precisions of the preconditioner, sloppy and
+     outer operators, in increasing order, and the solve starts on the
+     lowest rung, with its precision and operator as the sloppy ones.
+     Promotion is decided at the reliable updates of the solver, where
+     the true residual is known: the reduction of the true residual
+     per iteration is measured over at least precision_ladder_check
+     iterations, and the solve is promoted to the next rung once this
+     has fallen below half the best rate seen on the current rung.  It
+     is also promoted when the solver has exited unconverged before
+     the iteration limit, i.e., the rung has reached its noise floor.
+     The solver is only restarted on promotion, from the current
+     solution, with the residual converted to the new sloppy
+     precision.  Only the solvers that report their reliable updates
+     through SolverParam::reliable_update_hook are supported: CG,
+     CGNE, CGNR, PCG, pipelined CG, GCR and BiCGstab.
+  */
+  class PrecisionLadder : public Solver
+  {
+
+  private:
+    std::vector<std::pair<QudaPrecision, const DiracMatrix *>> rungs; //! precision and operator of each rung
+    int rung = 0;                                                     //! the current rung
+    SolverParam rung_param;                                           //! parameters of the solver on the current rung
+    std::unique_ptr<Solver> solver;                                   //! the solver on the current rung
+
+    /**
+       @brief Create the solver on the current rung
+    */
+    void createRung();
+
+  public:
+    PrecisionLadder(const DiracMatrix &mat, const DiracMatrix &matSloppy, const DiracMatrix &matPrecon,
+                    const DiracMatrix &matEig, SolverParam &param, TimeProfile &profile);
+
+    /**
+       @brief Run the solver, climbing the precision ladder as needed
+       @param out Solution vector
+       @param in Right-hand side
+    */
+    void operator()(ColorSpinorField &out, ColorSpinorField &in);
+
+    virtual bool hermitian() { return solver->hermitian(); } /** Use the inner solver */
+  };
+
   class MultiShiftSolver {
 
   protected:
@@ -1457,6 +1708,7 @@ public:
     const DiracMatrix &matSloppy;
     SolverParam &param;
     TimeProfile &profile;
+    SolverTelemetry telemetry; /** Telemetry record of the current solve, if enabled */
 
     /**
        @brief Generic solver setup and parameter checking
@@ -1498,7 +1750,9 @@ public:
     /**
      * @brief Run multi-shift and return Krylov-space at the end of the solve in p and r2_old_arry.
      *
-     * @param out std::vector of pointer to solutions for all the shifts.
+     * @param out std::vector of pointer to solutions for all the shifts, which hold the initial guesses on input
+     * if use_init_guess is set.  Since the shifted systems must share a residual, all shifts are corrected with the
+     * residual of the guess of the first shift, and the remainder of the other shifts is left to the refinement.
      * @param in right-hand side.
      * @param p std::vector of pointers to hold search directions. Note this will be resized as necessary.
      * @param r2_old_array pointer to last values of r2_old for old shifts. Needs to be large enough to hold r2_old for all shifts.
@@ -1521,6 +1775,127 @@ public:
     }
   };
 
+  /**
+     @brief Batched multi-source Conjugate-Gradient solver.  All
+     sources are iterated together, with the operator applied to the
+     active sources in one call of the multi-RHS DiracMatrix
+     interface, and the inner products of all sources computed in one
+     multi-reduction.  The even-odd Wilson operator applies the whole
+     set in one batched dslash, so that the gauge field is read once
+     per application rather than once per source, while other
+     operators apply the sources one at a time.  Each source
+     keeps its own recurrence, and is dropped from the batch once
+     converged.
+   */
+  class MultiSrcCG
+  {
+
+  protected:
+    const DiracMatrix &mat;
+    const DiracMatrix &matSloppy;
+    SolverParam &param;
+    TimeProfile &profile;
+
+    std::vector<ColorSpinorField> r;        /** High-precision residuals */
+    std::vector<ColorSpinorField> r_sloppy; /** Sloppy residuals */
+    std::vector<ColorSpinorField> x_sloppy; /** Solutions accumulated since the last reliable update */
+    std::vector<ColorSpinorField> p;        /** Search directions */
+    std::vector<ColorSpinorField> s;        /** s = A r */
+    std::vector<ColorSpinorField> q;        /** q = A p */
+
+    /**
+       @brief Check the parameters and allocate the fields needed by the solver
+       @param[in] x Solution vectors
+       @param[in] b Source vectors
+     */
+    void create(const std::vector<ColorSpinorField> &x, const std::vector<ColorSpinorField> &b);
+
+    /**
+       @brief Compute the initial residuals and stopping conditions,
+       and start the compute profile
+       @param[in,out] x Solution vectors, zeroed unless used as initial guesses
+       @param[in] b Source vectors
+       @param[out] b2 Source norms squared
+       @param[out] r2 Initial residual norms squared
+       @param[out] stop Stopping conditions
+       @return The indices of the sources that need solving
+     */
+    std::vector<int> initialize(std::vector<ColorSpinorField> &x, std::vector<ColorSpinorField> &b,
+                                std::vector<double> &b2, std::vector<double> &r2, std::vector<double> &stop);
+
+    /**
+       @brief Accumulate the solutions, compute the true residuals if
+       requested, and record the solver statistics
+       @param[in,out] x Solution vectors
+       @param[in] b Source vectors
+       @param[in] b2 Source norms squared
+       @param[in] r2 Iterated residual norms squared
+       @param[in] iter Iterations taken by each source
+       @param[in] k Iterations taken by the batch
+     */
+    void finalize(std::vector<ColorSpinorField> &x, std::vector<ColorSpinorField> &b, const std::vector<double> &b2,
+                  const std::vector<double> &r2, const std::vector<int> &iter, int k);
+
+    /**
+       @brief Return the set of fields selected by idx
+       @param[in] v Fields to select from
+       @param[in] idx Indices of the selected fields
+       @return Set of references to the selected fields
+     */
+    static vector_ref<ColorSpinorField> subset(std::vector<ColorSpinorField> &v, const std::vector<int> &idx)
+    {
+      vector_ref<ColorSpinorField> set;
+      set.reserve(idx.size());
+      for (auto i : idx) set.push_back(v[i]);
+      return set;
+    }
+
+  public:
+    MultiSrcCG(const DiracMatrix &mat, const DiracMatrix &matSloppy, SolverParam &param, TimeProfile &profile);
+    virtual ~MultiSrcCG() = default;
+
+    /**
+       @brief Solve A x_i = b_i for all sources.  On return
+       param.iter is the number of batched iterations, and param.true_res
+       the largest true residual over the sources if requested.
+       @param[in,out] x Solution vectors, initial guesses on input if requested
+       @param[in] b Source vectors
+     */
+    virtual void operator()(std::vector<ColorSpinorField> &x, std::vector<ColorSpinorField> &b);
+  };
+
+  /**
+     @brief Breakdown-free block Conjugate-Gradient solver.  Unlike
+     MultiSrcCG, the search space is shared between the sources, so
+     that correlated sources converge faster.  The search directions
+     are orthonormalized with a rank-revealing factorization of their
+     Gram matrix, such that directions that have become linearly
+     dependent are dropped rather than breaking down the solver, and
+     the block width shrinks as sources converge.
+   */
+  class BlockCG : public MultiSrcCG
+  {
+
+    /**
+       @brief Replace the search directions with an orthonormal basis
+       for the first m fields in s (the new directions), dropping
+       numerically dependent ones
+       @param[in] m Number of new directions
+       @return The block width, the number of search directions retained
+     */
+    int orthonormalize(int m);
+
+  public:
+    BlockCG(const DiracMatrix &mat, const DiracMatrix &matSloppy, SolverParam &param, TimeProfile &profile);
+
+    /**
+       @brief Solve A X = B for the block of sources
+       @param[in,out] x Solution vectors, initial guesses on input if requested
+       @param[in] b Source vectors
+     */
+    virtual void operator()(std::vector<ColorSpinorField> &x, std::vector<ColorSpinorField> &b);
+  };
+
 
   /**
      @brief This computes the optimum guess for the system Ax=b in the L2
@@ -1555,6 +1930,16 @@ public:
     void solve(std::vector<Complex> &psi_, std::vector<ColorSpinorField> &p, std::vector<ColorSpinorField> &q,
                const ColorSpinorField &b, bool hermitian);
 
+    /**
+       @brief Orthonormalize the basis p if requested, and compute q = A p
+       if requested, otherwise apply the same transformation to q.  The
+       orthonormalization is a Cholesky QR built from a single block
+       reduction, with a fallback to Gram-Schmidt if p is rank deficient
+       @param[in,out] p Search direction vectors
+       @param[in,out] q Search direction vectors with the operator applied
+    */
+    void orthonormalize(std::vector<ColorSpinorField> &p, std::vector<ColorSpinorField> &q);
+
   public:
     /**
        @param mat The operator for the linear system we wish to solve
@@ -1572,6 +1957,22 @@ public:
     */
     void operator()(ColorSpinorField &x, const ColorSpinorField &b, std::vector<ColorSpinorField> &p,
                     std::vector<ColorSpinorField> &q);
+
+    /**
+       @brief Compute guesses for the shifted systems (A + shift_i) x_i
+       = b for use in a multi-shift solve, with a single reduction for
+       all the shifts.  The guess of the first shift is the optimum for
+       b, while the others are the optimum for A x_0, so that the
+       residuals of the shifted systems are as close as possible to
+       that of the first.
+       @param x The guesses for the shifted systems
+       @param b The source vector in the equation to be solved
+       @param p The basis vectors in which we are building the guess
+       @param q The basis vectors multiplied by A
+       @param shift The shifts, relative to the first system, so shift[0] = 0
+    */
+    void operator()(std::vector<ColorSpinorField> &x, const ColorSpinorField &b, std::vector<ColorSpinorField> &p,
+                    std::vector<ColorSpinorField> &q, const std::vector<double> &shift);
   };
 
   using ColorSpinorFieldSet = ColorSpinorField;
@@ -1673,6 +2074,74 @@ public:
     bool hermitian() { return false; } // GMRESDR for any linear system
  };
 
+ /**
+    @brief GCRO-DR solver with Krylov subspace recycling, see Parks et
+    al, https://doi.org/10.1137/040607277.  Each cycle runs m - k
+    Arnoldi steps with the operator projected orthogonally to C = A U,
+    where U spans a recycled subspace of dimension k, and minimizes the
+    residual over U and the Arnoldi basis.  At the end of each cycle U
+    is replaced by the k harmonic Ritz vectors of smallest magnitude.
+    If SolverParam::preserve_recycle is set, U is kept resident in a
+    recycle_space between solves, e.g., for a sequence of sources or
+    a slowly evolving operator, and C is recomputed with the operator
+    of the next solve.  Here k is given by n_ev and m by
+    max_search_dim.
+ */
+ class GCRODR : public Solver
+ {
+
+ private:
+   bool init = false;
+
+   int n_recycle = 0; // current dimension of the recycled subspace, either 0 or k
+
+   ColorSpinorField r; // full precision residual
+
+   std::vector<ColorSpinorField> V;     // Arnoldi basis
+   std::vector<ColorSpinorField> U;     // recycled subspace
+   std::vector<ColorSpinorField> C;     // mat * U, orthonormal
+   std::vector<ColorSpinorField> U_new; // temporary for the update of U
+   std::vector<ColorSpinorField> C_new; // temporary for the update of C
+
+   int n_solve = 0;       // number of solves with a recycled subspace
+   int iter_initial = 0;  // iterations of the solve that created the recycled subspace
+   int iter_recycled = 0; // total iterations of the solves with a recycled subspace
+
+   /**
+      @brief Initiate the fields needed by the solver
+      @param[in] x Solution vector
+      @param[in] b Source vector
+   */
+   void create(ColorSpinorField &x, const ColorSpinorField &b);
+
+   /**
+      @brief Restore the recycled subspace from the preserved
+      recycle_space, and compute C = A U for the current operator
+      @return The number of matrix-vector products done
+   */
+   int restoreRecycleSpace();
+
+   /**
+      @brief Move the recycled subspace into a new recycle_space if
+      preservation is requested
+   */
+   void preserveRecycleSpace();
+
+ public:
+   GCRODR(const DiracMatrix &mat, const DiracMatrix &matSloppy, const DiracMatrix &matPrecon,
+          const DiracMatrix &matEig, SolverParam &param, TimeProfile &profile);
+   virtual ~GCRODR();
+
+   void operator()(ColorSpinorField &out, ColorSpinorField &in);
+
+   /**
+      @return Return the residual vector from the prior solve
+   */
+   ColorSpinorField &get_residual();
+
+   bool hermitian() { return false; } // GCRO-DR for any linear system
+ };
+
  /**
     @brief This is an object that captures the state required for a
     deflated solver.
@@ -1683,6 +2152,18 @@ public:
    std::vector<Complex> evals;          /** The eigenvalues */
  };
 
+ /**
+    @brief This is an object that captures the recycled subspace of
+    GCRO-DR between solves, together with the statistics of the
+    iterations it saved.
+ */
+ struct recycle_space : public Object {
+   std::vector<ColorSpinorField> U; /** The recycled subspace */
+   int n_solve = 0;                 /** The number of solves that used the recycled subspace */
+   int iter_initial = 0;            /** The iterations of the solve that created the recycled subspace */
+   int iter_recycled = 0;           /** The total iterations of the solves that used the recycled subspace */
+ };
+
  /**
    @brief Returns if a solver is CA or not
    @return true if CA, false otherwise
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <color_spinor_field_order.h>
+#include <color_spinor.h>
+#include <kernel.h>
+
+namespace quda
+{
+
+  /**
+     @brief Parameter structure for copying a field to or from a
+     slice of a batched field
+   */
+  template <typename Float, int nSpin_, int nColor_> struct CopyBatchArg : kernel_param<> {
+    using real = typename mapper<Float>::type;
+    static constexpr int nSpin = nSpin_;
+    static constexpr int nColor = nColor_;
+    using F = typename colorspinor_mapper<Float, nSpin, nColor>::type;
+
+    F out;                // output field
+    const F in;           // input field
+    const int out_offset; // checkerboard site offset of the slice in the output field
+    const int in_offset;  // checkerboard site offset of the slice in the input field
+
+    CopyBatchArg(ColorSpinorField &out, const ColorSpinorField &in, int volume_cb, int out_offset, int in_offset) :
+      kernel_param(dim3(volume_cb, in.SiteSubset(), 1)), out(out), in(in), out_offset(out_offset), in_offset(in_offset)
+    {
+    }
+  };
+
+  /**
+     @brief Copy a slice of the input field to a slice of the output field
+   */
+  template <typename Arg> struct CopyBatch {
+    const Arg &arg;
+    constexpr CopyBatch(const Arg &arg) : arg(arg) { }
+    static constexpr const char *filename() { return KERNEL_FILE; }
+
+    __device__ __host__ void operator()(int x_cb, int parity)
+    {
+      ColorSpinor<typename Arg::real, Arg::nColor, Arg::nSpin> v = arg.in(x_cb + arg.in_offset, parity);
+      arg.out(x_cb + arg.out_offset, parity) = v;
+    }
+  };
+
+} // namespace quda
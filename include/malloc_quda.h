@@ -49,6 +49,41 @@ namespace quda {
    */
   size_t host_allocated_peak();
 
+  /**
+     @brief Statistics of a caching memory pool.  The slack is the
+     difference between the bytes handed out by the pool (rounded up
+     to their size class) and the bytes that were requested.
+   */
+  struct PoolStats {
+    size_t cap = 0;               /** Maximum bytes the pool will hold in its cache (0 = unlimited) */
+    size_t cached_bytes = 0;      /** Bytes currently held in the cache */
+    size_t cached_blocks = 0;     /** Number of blocks currently held in the cache */
+    size_t cached_bytes_peak = 0; /** Peak bytes held in the cache */
+    size_t active_bytes = 0;      /** Bytes currently handed out by the pool */
+    size_t requested_bytes = 0;   /** Bytes requested by the active allocations */
+    size_t slack_bytes = 0;       /** Current slack: active_bytes - requested_bytes */
+    size_t slack_bytes_peak = 0;  /** Peak slack */
+    size_t hits = 0;              /** Allocations served from the cache */
+    size_t misses = 0;            /** Allocations that required a new block */
+    size_t trims = 0;             /** Number of cached blocks released because of the cap */
+    size_t trimmed_bytes = 0;     /** Bytes released because of the cap */
+  };
+
+  /**
+     @return statistics of the device memory pool
+   */
+  PoolStats device_pool_stats();
+
+  /**
+     @return statistics of the pinned memory pool
+   */
+  PoolStats pinned_pool_stats();
+
+  /**
+     @return statistics of the host memory pool used by safe_malloc
+   */
+  PoolStats host_pool_stats();
+
   /**
      @return are we using managed memory for device allocations
   */
@@ -161,6 +196,39 @@ namespace quda {
     */
     void flush_pinned();
 
+    /**
+       @brief Free all outstanding host-memory allocations held by the
+       host memory pool that backs large safe_malloc() allocations.
+    */
+    void flush_host();
+
+    /**
+       @brief Release cached host-memory allocations until at most
+       bytes remain in the cache.
+       @param bytes Number of cached bytes to retain
+    */
+    void trim_host(size_t bytes);
+
+    /**
+       @brief Release cached device-memory allocations until at most
+       bytes remain in the cache.
+       @param bytes Number of cached bytes to retain
+    */
+    void trim_device(size_t bytes);
+
+    /**
+       @brief Release cached pinned-memory allocations until at most
+       bytes remain in the cache.
+       @param bytes Number of cached bytes to retain
+    */
+    void trim_pinned(size_t bytes);
+
+    /**
+       @brief Print the per size-class statistics of the device,
+       pinned and host memory pools.
+    */
+    void print_stats();
+
   } // namespace pool
 
 }
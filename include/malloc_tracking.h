@@ -0,0 +1,197 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+/**
+   @file malloc_tracking.h
+
+   @brief Thread-safe helpers used by the target allocators to track
+   the live memory allocations.  These are shared between the
+   different targets.
+ */
+
+namespace quda
+{
+
+  /**
+     @brief Registry that interns allocation call sites, so that each
+     tracked allocation only needs to store an integer id rather than
+     its own copy of the function and file names.  Lookups of already
+     registered sites only take a shared lock.  Sites are keyed on the
+     addresses of the function and file names, which are string
+     literals when coming from the allocation macros in malloc_quda.h.
+   */
+  class CallSiteRegistry
+  {
+  public:
+    struct CallSite {
+      std::string func;
+      std::string file;
+      int line;
+    };
+
+  private:
+    using key_t = std::tuple<const char *, const char *, int>;
+
+    struct key_hash {
+      size_t operator()(const key_t &key) const
+      {
+        auto h = std::hash<const void *>()(std::get<0>(key));
+        h ^= std::hash<const void *>()(std::get<1>(key)) + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2);
+        h ^= std::hash<int>()(std::get<2>(key)) + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2);
+        return h;
+      }
+    };
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<key_t, int, key_hash> ids;
+    std::vector<CallSite> sites;
+
+  public:
+    /**
+       @return The id of a given call site, registering it if needed
+       @param[in] func The calling function
+       @param[in] file The calling file
+       @param[in] line The calling line
+     */
+    int id(const char *func, const char *file, int line)
+    {
+      key_t key {func, file, line};
+      {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = ids.find(key);
+        if (it != ids.end()) return it->second;
+      }
+
+      std::unique_lock<std::shared_mutex> lock(mutex);
+      auto it = ids.find(key);
+      if (it != ids.end()) return it->second;
+      int id = sites.size();
+      sites.push_back({func ? func : "", file ? file : "", line});
+      ids[key] = id;
+      return id;
+    }
+
+    /**
+       @return The call site corresponding to a given id
+       @param[in] id The call-site id
+     */
+    CallSite get(int id) const
+    {
+      std::shared_lock<std::shared_mutex> lock(mutex);
+      return (id >= 0 && id < static_cast<int>(sites.size())) ? sites[id] : CallSite {"", "", -1};
+    }
+  };
+
+  /**
+     @brief Table of live allocations of a given type, mapping each
+     pointer to its tracking entry.  The table is striped over n_shard
+     independently locked shards, selected by a hash of the pointer,
+     so that allocations from different host threads rarely contend.
+     @tparam Entry The tracking entry stored for each allocation
+   */
+  template <typename Entry> class AllocTable
+  {
+    static constexpr int n_shard = 16;
+
+    struct Shard {
+      mutable std::mutex mutex;
+      std::unordered_map<void *, Entry> map;
+    };
+
+    std::array<Shard, n_shard> shard;
+
+    Shard &get_shard(const void *ptr)
+    {
+      auto p = reinterpret_cast<std::uintptr_t>(ptr);
+      return shard[((p >> 6) ^ (p >> 12) ^ (p >> 21)) % n_shard];
+    }
+
+  public:
+    /**
+       @brief Insert a new allocation into the table
+       @param[in] ptr The allocation
+       @param[in] entry Its tracking entry
+     */
+    void insert(void *ptr, const Entry &entry)
+    {
+      auto &s = get_shard(ptr);
+      std::lock_guard<std::mutex> lock(s.mutex);
+      s.map[ptr] = entry;
+    }
+
+    /**
+       @brief Remove an allocation from the table
+       @param[in] ptr The allocation
+       @param[out] entry The tracking entry of the removed allocation
+       @return Whether ptr was found in the table
+     */
+    bool erase(void *ptr, Entry &entry)
+    {
+      auto &s = get_shard(ptr);
+      std::lock_guard<std::mutex> lock(s.mutex);
+      auto it = s.map.find(ptr);
+      if (it == s.map.end()) return false;
+      entry = std::move(it->second);
+      s.map.erase(it);
+      return true;
+    }
+
+    /**
+       @return Whether ptr is a live allocation in this table
+       @param[in] ptr The allocation
+     */
+    bool count(void *ptr)
+    {
+      auto &s = get_shard(ptr);
+      std::lock_guard<std::mutex> lock(s.mutex);
+      return s.map.count(ptr) > 0;
+    }
+
+    /**
+       @return Whether the table has no live allocations
+     */
+    bool empty() const
+    {
+      for (auto &s : shard) {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.map.empty()) return false;
+      }
+      return true;
+    }
+
+    /**
+       @brief Apply a function to every live allocation.  Each shard
+       is locked while it is being traversed, so f must not allocate
+       or free memory of this type.
+       @param[in] f Function taking the pointer and its tracking entry
+     */
+    template <typename F> void for_each(F &&f) const
+    {
+      for (auto &s : shard) {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (auto &entry : s.map) f(entry.first, entry.second);
+      }
+    }
+  };
+
+  /**
+     @brief Atomically raise max to value if value is larger
+     @param[in,out] max The running maximum
+     @param[in] value The candidate value
+   */
+  inline void atomic_fetch_max(std::atomic<size_t> &max, size_t value)
+  {
+    size_t old = max.load(std::memory_order_relaxed);
+    while (value > old && !max.compare_exchange_weak(old, value, std::memory_order_relaxed)) { }
+  }
+
+} // namespace quda
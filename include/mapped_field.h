@@ -0,0 +1,95 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <color_spinor_field.h>
+#include <gauge_field.h>
+
+/**
+   @file mapped_field.h
+
+   @brief Host fields backed by a read-only memory mapping of a file
+   region, so that large inputs (gauge configurations, sources) can be
+   streamed from the page cache to the device without first being
+   copied into anonymous host memory.  The file region must hold the
+   rank-local field in the host order given by the field parameters,
+   e.g., as written by a rank-local dump of a host field.  Since the
+   mapping is read only, the fields can only be used as the source of
+   copies; writing to them is a segmentation fault.  These fields back
+   loadGaugeMappedQuda and invertMappedQuda.
+ */
+
+namespace quda
+{
+
+  /**
+     A read-only memory mapping of a region of a file
+   */
+  class MappedRegion
+  {
+    void *base;                  /** Start of the mapping, which is page aligned */
+    size_t length;               /** Length of the mapping */
+    char *ptr;                   /** Start of the region */
+    size_t bytes;                /** Length of the region */
+    std::vector<void *> chunks_; /** Storage for the chunk pointers returned by chunks() */
+
+  public:
+    /**
+       @param[in] filename The file to map
+       @param[in] offset The offset of the region in the file, which
+       need not be page aligned
+       @param[in] bytes The length of the region
+     */
+    MappedRegion(const std::string &filename, size_t offset, size_t bytes);
+
+    MappedRegion(const MappedRegion &) = delete;
+    MappedRegion &operator=(const MappedRegion &) = delete;
+
+    virtual ~MappedRegion();
+
+    /** @return The start of the region */
+    void *data() const { return ptr; }
+
+    /** @return The length of the region */
+    size_t size() const { return bytes; }
+
+    /**
+       @brief Split the region into equal consecutive chunks
+       @param[in] n The number of chunks
+       @return Array of pointers to the chunks, valid for the lifetime of the region
+     */
+    void **chunks(int n);
+  };
+
+  /**
+     A host gauge field in QDP or MILC order whose links are a read-only
+     mapping of a file region.  For QDP order, the file holds the
+     directions one after another.
+   */
+  class MappedGaugeField : private MappedRegion, public cpuGaugeField
+  {
+  public:
+    /**
+       @param[in] filename The file to map
+       @param[in] offset The offset of the field in the file
+       @param[in] param Parameters of the host field; create is ignored
+     */
+    MappedGaugeField(const std::string &filename, size_t offset, const GaugeFieldParam &param);
+  };
+
+  /**
+     A host vector field in space-spin-color order whose data are a
+     read-only mapping of a file region.
+   */
+  class MappedColorSpinorField : private MappedRegion, public ColorSpinorField
+  {
+  public:
+    /**
+       @param[in] filename The file to map
+       @param[in] offset The offset of the field in the file
+       @param[in] param Parameters of the host field; create is ignored
+     */
+    MappedColorSpinorField(const std::string &filename, size_t offset, const ColorSpinorParam &param);
+  };
+
+} // namespace quda
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include <malloc_quda.h>
+#include <util_quda.h>
+
+/**
+   @file memory_pool.h
+
+   @brief Size-class memory pool used to cache device and pinned
+   allocations.  This is shared between the different targets, with
+   each target providing the underlying allocation and free
+   functions.
+ */
+
+namespace quda
+{
+
+  namespace pool
+  {
+
+    /**
+       @brief Caching allocator that bins allocations into size
+       classes.  Each power-of-two octave is split into n_fine_bin
+       equally spaced classes, so the slack of an allocation (the
+       difference between the class size and the requested size) is at
+       most 1/n_fine_bin of the request.  A request is only served from
+       a cached block of its own size class.
+
+       The bytes held in the cache are bounded by an optional cap: when
+       a free pushes the cached bytes above the cap, blocks are released
+       (largest classes first) until the cached bytes have dropped to
+       the low-water mark of trim_fraction * cap.  Since a new block
+       joins the cache once it is released, a miss first trims the
+       cache so that the cached bytes plus the new block fit within the
+       cap, rather than leaving blocks of other classes resident.
+
+       Since blocks cached in other size classes may be what is keeping
+       a new allocation from fitting, a pool may be given a second
+       allocator that returns nullptr rather than failing: a miss first
+       tries this, and should it fail the cache is flushed and the
+       allocation retried with the failing allocator.
+
+       The pool is thread safe, with the underlying allocation and free
+       functions always called without the pool lock held.
+     */
+    class SizeClassPool
+    {
+    public:
+      using malloc_t = void *(*)(const char *, const char *, int, size_t);
+      using free_t = void (*)(const char *, const char *, int, void *);
+
+    private:
+      static constexpr int n_fine_bin = 8;            /** Number of size classes per power-of-two octave */
+      static constexpr size_t min_class_bytes = 512;  /** Smallest size class */
+      static constexpr double trim_fraction = 0.75;   /** Low-water mark, as a fraction of the cap, to trim down to */
+
+      const char *name;  /** Name used for reporting */
+      malloc_t malloc_;      /** Underlying allocator */
+      free_t free_;          /** Underlying free */
+      malloc_t try_malloc_;  /** Optional underlying allocator that returns nullptr on failure */
+      size_t cap = 0;    /** Maximum number of bytes held in the cache (0 = unlimited) */
+
+      /** Statistics for each size class */
+      struct class_stats_t {
+        std::vector<void *> cache; /** Inactive blocks of this class */
+        size_t active = 0;         /** Number of active blocks of this class */
+        size_t requested = 0;      /** Bytes requested by the active blocks */
+        size_t hits = 0;           /** Allocations served from the cache */
+        size_t misses = 0;         /** Allocations that required a new block */
+        size_t trimmed = 0;        /** Number of blocks released by trimming */
+      };
+
+      mutable std::mutex mutex;                             /** Lock protecting the members below */
+      std::map<size_t, class_stats_t> classes;             /** Map from class size to its statistics */
+      std::map<void *, std::pair<size_t, size_t>> active;  /** Active blocks, mapped to (class, requested) bytes */
+      PoolStats stats;                                      /** Pool-wide statistics */
+
+      /**
+         @brief Remove cached blocks, largest classes first, until the
+         cached bytes are no larger than target.  Must be called with
+         the lock held, and the caller is responsible for freeing the
+         removed blocks once the lock has been released.
+         @param[in] target The number of cached bytes to trim down to
+         @param[out] trimmed The blocks that were removed from the cache
+       */
+      void trim_to(size_t target, std::vector<void *> &trimmed)
+      {
+        for (auto it = classes.rbegin(); it != classes.rend() && stats.cached_bytes > target; it++) {
+          auto &c = it->second;
+          while (!c.cache.empty() && stats.cached_bytes > target) {
+            trimmed.push_back(c.cache.back());
+            c.cache.pop_back();
+            c.trimmed++;
+            stats.cached_bytes -= it->first;
+            stats.cached_blocks--;
+            stats.trimmed_bytes += it->first;
+            stats.trims++;
+          }
+        }
+      }
+
+      /**
+         @brief Free blocks that have been removed from the cache
+         @param[in] blocks The blocks to free
+       */
+      void free_blocks(const std::vector<void *> &blocks)
+      {
+        for (auto ptr : blocks) free_(__func__, __FILE__, __LINE__, ptr);
+      }
+
+    public:
+      /**
+         @brief Constructor for the pool
+         @param[in] name Name used for reporting
+         @param[in] malloc_ Underlying allocator, which fails with an error
+         @param[in] free_ Underlying free
+         @param[in] try_malloc_ Optional underlying allocator that
+         returns nullptr on failure, after which the cache is flushed
+         and malloc_ called instead
+       */
+      SizeClassPool(const char *name, malloc_t malloc_, free_t free_, malloc_t try_malloc_ = nullptr) :
+        name(name), malloc_(malloc_), free_(free_), try_malloc_(try_malloc_)
+      {
+      }
+
+      /**
+         @brief Set the maximum number of bytes the pool may hold in its cache
+         @param[in] cap_ The cap in bytes (0 = unlimited)
+       */
+      void set_cap(size_t cap_)
+      {
+        std::vector<void *> trimmed;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          cap = cap_;
+          stats.cap = cap;
+          if (cap > 0 && stats.cached_bytes > cap) trim_to(cap, trimmed);
+        }
+        free_blocks(trimmed);
+      }
+
+      /**
+         @return The size class of a given request: the request is
+         rounded up to the next multiple of 1/n_fine_bin of its
+         power-of-two octave
+         @param[in] bytes The requested bytes
+       */
+      static size_t size_class(size_t bytes)
+      {
+        if (bytes <= min_class_bytes) return min_class_bytes;
+        size_t octave = 1;
+        while (octave * 2 < bytes) octave *= 2;
+        size_t step = octave / n_fine_bin;
+        return octave + ((bytes - octave + step - 1) / step) * step;
+      }
+
+      void *allocate(const char *func, const char *file, int line, size_t bytes)
+      {
+        size_t class_bytes = size_class(bytes);
+        void *ptr = nullptr;
+        std::vector<void *> trimmed;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          auto &c = classes[class_bytes];
+          if (!c.cache.empty()) {
+            ptr = c.cache.back();
+            c.cache.pop_back();
+            c.hits++;
+            stats.hits++;
+            stats.cached_bytes -= class_bytes;
+            stats.cached_blocks--;
+          } else {
+            c.misses++;
+            stats.misses++;
+            if (cap > 0 && stats.cached_bytes + class_bytes > cap)
+              trim_to(cap > class_bytes ? cap - class_bytes : 0, trimmed);
+          }
+        }
+        free_blocks(trimmed);
+
+        if (!ptr && try_malloc_) {
+          ptr = try_malloc_(func, file, line, class_bytes);
+          if (!ptr) {
+            logQuda(QUDA_VERBOSE, "%s pool allocation of %zu bytes failed, flushing %zu cached bytes and retrying\n",
+                    name, class_bytes, get_stats().cached_bytes);
+            flush();
+          }
+        }
+        if (!ptr) ptr = malloc_(func, file, line, class_bytes);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &c = classes[class_bytes];
+        active[ptr] = std::make_pair(class_bytes, bytes);
+        c.active++;
+        c.requested += bytes;
+        stats.active_bytes += class_bytes;
+        stats.requested_bytes += bytes;
+        stats.slack_bytes = stats.active_bytes - stats.requested_bytes;
+        if (stats.slack_bytes > stats.slack_bytes_peak) stats.slack_bytes_peak = stats.slack_bytes;
+        return ptr;
+      }
+
+      void release(void *ptr)
+      {
+        std::vector<void *> trimmed;
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = active.find(ptr);
+        if (it == active.end()) { errorQuda("Attempt to free invalid pointer %p to %s pool", ptr, name); }
+        size_t class_bytes = it->second.first;
+        size_t bytes = it->second.second;
+        active.erase(it);
+
+        auto &c = classes[class_bytes];
+        c.active--;
+        c.requested -= bytes;
+        c.cache.push_back(ptr);
+        stats.active_bytes -= class_bytes;
+        stats.requested_bytes -= bytes;
+        stats.slack_bytes = stats.active_bytes - stats.requested_bytes;
+        stats.cached_bytes += class_bytes;
+        stats.cached_blocks++;
+        if (stats.cached_bytes > stats.cached_bytes_peak) stats.cached_bytes_peak = stats.cached_bytes;
+
+        if (cap > 0 && stats.cached_bytes > cap) trim_to(static_cast<size_t>(trim_fraction * cap), trimmed);
+        lock.unlock();
+
+        free_blocks(trimmed);
+      }
+
+      /**
+         @return Whether ptr is an active allocation of this pool
+         @param[in] ptr The pointer to query
+       */
+      bool owns(void *ptr) const
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        return active.count(ptr) > 0;
+      }
+
+      /**
+         @brief Release cached blocks until at most target bytes remain cached
+         @param[in] target The number of cached bytes to retain
+       */
+      void trim(size_t target)
+      {
+        std::vector<void *> trimmed;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          trim_to(target, trimmed);
+        }
+        free_blocks(trimmed);
+      }
+
+      /**
+         @brief Release all cached blocks
+       */
+      void flush()
+      {
+        std::vector<void *> flushed;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          for (auto &c : classes) {
+            flushed.insert(flushed.end(), c.second.cache.begin(), c.second.cache.end());
+            c.second.cache.clear();
+          }
+          stats.cached_bytes = 0;
+          stats.cached_blocks = 0;
+        }
+        free_blocks(flushed);
+      }
+
+      /**
+         @return The pool-wide statistics
+       */
+      PoolStats get_stats() const
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+      }
+
+      /**
+         @brief Print the statistics for every size class that has been used
+       */
+      void print_stats() const
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        printfQuda("%s pool: %.1f MiB cached in %zu blocks (peak %.1f MiB, cap %.1f MiB), %zu hits, %zu misses, %.1f "
+                   "MiB trimmed in %zu blocks, %.1f MiB slack (peak %.1f MiB)\n",
+                   name, stats.cached_bytes / (double)(1 << 20), stats.cached_blocks,
+                   stats.cached_bytes_peak / (double)(1 << 20), stats.cap / (double)(1 << 20), stats.hits,
+                   stats.misses, stats.trimmed_bytes / (double)(1 << 20), stats.trims,
+                   stats.slack_bytes / (double)(1 << 20), stats.slack_bytes_peak / (double)(1 << 20));
+        if (classes.empty()) return;
+        printfQuda("%16s %8s %8s %14s %14s %10s %10s %8s\n", "Class bytes", "Cached", "Active", "Requested",
+                   "Slack", "Hits", "Misses", "Trimmed");
+        for (auto &c : classes) {
+          auto &s = c.second;
+          printfQuda("%16zu %8zu %8zu %14zu %14zu %10zu %10zu %8zu\n", c.first, s.cache.size(), s.active, s.requested,
+                     s.active * c.first - s.requested, s.hits, s.misses, s.trimmed);
+        }
+      }
+    };
+
+  } // namespace pool
+
+} // namespace quda
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+
+/**
+   @file memory_timeline.h
+
+   @brief Optional timeline of the memory allocations, used to find
+   which phase of an algorithm reached the memory high-water mark.
+   Every tracked allocation and free is recorded as an event (time,
+   type, signed size, phase) in a ring buffer, where the phase is the
+   innermost active TimeProfile timer or MemoryPhase scope.  For every
+   phase the peak device, pinned, mapped and host memory allocated
+   while that phase was active is also recorded.
+
+   The timeline is enabled by setting QUDA_ENABLE_MEMORY_TIMELINE=1,
+   with QUDA_MEMORY_TIMELINE_SIZE setting the number of events held in
+   the ring buffer (default 65536).
+ */
+
+namespace quda
+{
+
+  namespace memory_timeline
+  {
+
+    /**
+       @return Whether the memory timeline is enabled
+     */
+    bool enabled();
+
+    /**
+       @brief Push a phase onto the stack of active phases
+       @param[in] name The name of the phase
+     */
+    void push_phase(const std::string &name);
+
+    /**
+       @brief Remove the most recent instance of a phase from the stack
+       of active phases.  Phases need not be popped in the reverse
+       order they were pushed.
+       @param[in] name The name of the phase
+     */
+    void pop_phase(const std::string &name);
+
+    /**
+       @brief Record an allocation or free event.  This is called by
+       the target allocators after their allocation totals have been
+       updated.
+       @param[in] type The name of the memory type
+       @param[in] delta The signed number of bytes (positive for an
+       allocation, negative for a free)
+     */
+    void record(const char *type, long delta);
+
+    /**
+       @brief Print the per-phase memory high-water marks
+     */
+    void print_phase_peaks();
+
+    /**
+       @brief Serialize the recorded events in the format of the
+       tunecache trace, with the phase in the name column and the
+       memory type and size in the aux column.
+       @param[out] out The stream to write to
+     */
+    void serialize(std::ostream &out);
+
+    /**
+       @return The number of events held in the ring buffer
+     */
+    size_t size();
+
+  } // namespace memory_timeline
+
+  /**
+     @brief Scoped memory timeline phase, used to attribute the
+     allocations in a region that is not covered by its own TimeProfile
+     timer.  This is a no-op if the timeline is disabled.
+   */
+  class MemoryPhase
+  {
+    std::string name;
+    bool active;
+
+  public:
+    MemoryPhase(const std::string &name) : name(name), active(memory_timeline::enabled())
+    {
+      if (active) memory_timeline::push_phase(name);
+    }
+
+    MemoryPhase(const MemoryPhase &) = delete;
+    MemoryPhase &operator=(const MemoryPhase &) = delete;
+
+    ~MemoryPhase()
+    {
+      if (active) memory_timeline::pop_phase(name);
+    }
+  };
+
+} // namespace quda
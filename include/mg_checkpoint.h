@@ -0,0 +1,157 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <color_spinor_field.h>
+#include <gauge_field.h>
+
+/**
+   @file mg_checkpoint.h
+
+   @brief Checkpointing of a multigrid hierarchy.  A checkpoint holds,
+   for every level that has a coarser level, the null-space vectors
+   B, the block-orthogonalized basis V that defines the transfer
+   operator, and the coarse link fields Y, X, Xinv and Yhat, so that a
+   hierarchy can be restored without generating the null space,
+   block orthogonalizing or coarsening.  A checkpoint consists of
+
+   - filename: a JSON manifest with the rank partitioning, the local
+     lattice dimensions, the parameters that define the hierarchy, the
+     XOR checksum of the gauge field it was built from, and the size,
+     offset, number of checksummed chunks and SciDAC checksum of
+     every field;
+   - filename.data: the fields, each with one contiguous block per
+     rank in the QUDA host order of the field.
+
+   A checkpoint is only restored if the gauge field checksum, the
+   rank partitioning and the parameters, including the geometric
+   block sizes, all match, since otherwise the restored hierarchy
+   would not be a valid preconditioner.  A checkpoint that is
+   missing, does not match, is missing fields or fails its checksums
+   is not restored, and the hierarchy is set up afresh.
+ */
+
+namespace quda
+{
+
+  namespace mg_checkpoint
+  {
+
+    /** Names of the coarse link fields in a checkpoint, in the order of DiracCoarse::CoarseLinks() */
+    inline const std::vector<std::string> coarse_link_names = {"Y", "X", "Xinv", "Yhat"};
+
+    /**
+       Writer of a checkpoint.  The constructor and close() are
+       collective over all ranks.
+     */
+    class Writer
+    {
+      std::string filename;
+      std::string manifest; /** Serialized manifest, with the field entries added on close */
+      std::vector<std::string> entries;
+      int fd;
+      uint64_t offset; /** Offset of the next field in the data file */
+
+      /** @brief Write a field given as a list of contiguous chunks of its rank-local data */
+      void write(int level, const std::string &name, const std::vector<std::pair<const void *, size_t>> &chunks);
+
+    public:
+      /**
+         @brief Create a checkpoint
+         @param[in] filename The manifest to write
+         @param[in] param The multigrid parameters of the hierarchy
+         @param[in] gauge The gauge field the hierarchy was built from
+       */
+      Writer(const std::string &filename, const QudaMultigridParam &param, const GaugeField &gauge);
+
+      ~Writer();
+
+      /**
+         @brief Write a set of vector fields
+         @param[in] level The multigrid level
+         @param[in] name The name of the fields
+         @param[in] v The fields to write, in any location
+       */
+      void write(int level, const std::string &name, const std::vector<const ColorSpinorField *> &v);
+
+      /**
+         @brief Write a host gauge field
+         @param[in] level The multigrid level
+         @param[in] name The name of the field
+         @param[in] u The field to write
+       */
+      void write(int level, const std::string &name, const GaugeField &u);
+
+      /**
+         @brief Finalize the checkpoint, writing the manifest
+       */
+      void close();
+    };
+
+    /**
+       Reader of a checkpoint.  The constructor is collective over all
+       ranks, since it checks the manifest and verifies the checksums
+       of all fields.
+     */
+    class Reader
+    {
+      struct Entry {
+        uint64_t offset;
+        uint64_t bytes;
+        uint64_t chunks; /** Number of equal chunks the rank-local data are checksummed in */
+        uint32_t suma;
+        uint32_t sumb;
+      };
+
+      std::string filename;
+      std::map<std::string, Entry> entries;
+      int fd;
+
+      /** @brief Read a field given as a list of contiguous chunks of its rank-local data */
+      void read(int level, const std::string &name, const std::vector<std::pair<void *, size_t>> &chunks);
+
+    public:
+      /**
+         @brief Open a checkpoint, checking that it matches the
+         hierarchy to be built, that every field the restore reads is
+         present, and that the checksums of all fields match, which
+         reads the data file once.  A checkpoint that fails these
+         checks is reported with a warning and is not valid, so the
+         hierarchy is set up afresh rather than failing part way
+         through the restore.
+         @param[in] filename The manifest to read
+         @param[in] param The multigrid parameters of the hierarchy
+         @param[in] gauge The gauge field the hierarchy is built from
+       */
+      Reader(const std::string &filename, const QudaMultigridParam &param, const GaugeField &gauge);
+
+      ~Reader();
+
+      /**
+         @return Whether the checkpoint matches the hierarchy and can
+         be restored
+       */
+      bool valid() const { return fd >= 0; }
+
+      /**
+         @brief Read a set of vector fields
+         @param[in] level The multigrid level
+         @param[in] name The name of the fields
+         @param[out] v The fields to read into, in any location
+       */
+      void read(int level, const std::string &name, const std::vector<ColorSpinorField *> &v);
+
+      /**
+         @brief Read a host gauge field
+         @param[in] level The multigrid level
+         @param[in] name The name of the field
+         @param[out] u The field to read into
+       */
+      void read(int level, const std::string &name, GaugeField &u);
+    };
+
+  } // namespace mg_checkpoint
+
+} // namespace quda
@@ -71,6 +71,11 @@ namespace quda {
   // forward declarations
   class MG;
   class DiracCoarse;
+  namespace mg_checkpoint
+  {
+    class Reader;
+    class Writer;
+  } // namespace mg_checkpoint
 
   /**
      This struct contains all the metadata required to define the
@@ -163,6 +168,10 @@ namespace quda {
     /** Whether to use tensor cores (if available) */
     bool use_mma;
 
+    /** Checkpoint to restore the hierarchy from, if set, which is
+        released once the hierarchy has been built */
+    std::shared_ptr<mg_checkpoint::Reader> checkpoint;
+
     /**
        This is top level instantiation done when we start creating the multigrid operator.
      */
@@ -227,7 +236,8 @@ namespace quda {
       location(param.mg_global.location[level]),
       setup_location(param.mg_global.setup_location[level]),
       transfer_type(param.mg_global.transfer_type[level]),
-      use_mma(param.use_mma)
+      use_mma(param.use_mma),
+      checkpoint(param.checkpoint)
     {
       // set the block size
       for (int i = 0; i < QUDA_MAX_DIM; i++) geoBlockSize[i] = param.mg_global.geo_block_size[level][i];
@@ -391,6 +401,13 @@ namespace quda {
     */
     void dumpNullVectors() const;
 
+    /**
+       @brief Write the hierarchy (null space, transfer operator and
+       coarse operator) to a checkpoint.  Will recurse over all levels.
+       @param[in] writer The checkpoint to write to
+    */
+    void saveCheckpoint(mg_checkpoint::Writer &writer) const;
+
     /**
        @brief Create the smoothers
     */
@@ -704,7 +721,14 @@ namespace quda {
     MG *mg;
     TimeProfile &profile;
 
-    multigrid_solver(QudaMultigridParam &mg_param, TimeProfile &profile);
+    /**
+       @param[in] mg_param The multigrid parameters
+       @param[in] profile The profile to use for the setup
+       @param[in] checkpoint Optional checkpoint to restore the
+       hierarchy from; if it does not match the parameters or gauge
+       field, the hierarchy is set up afresh
+     */
+    multigrid_solver(QudaMultigridParam &mg_param, TimeProfile &profile, const std::string &checkpoint = "");
 
     virtual ~multigrid_solver()
     {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 
 /**
  * sets the cpu affinity of the calling process to the affinity mask reported by nvidia-smi topo
@@ -8,3 +9,32 @@
  * @return          0 if numa affinity was set
  */
 int setNumaAffinityNVML(int deviceid);
+
+/**
+ * Sets the NUMA placement of the calling process from the sysfs
+ * topology of the device (falling back to NVML for the cpu affinity
+ * if available).  The calling thread, and thus any host worker
+ * threads it subsequently spawns, is bound to the cpus of the NUMA
+ * node the device is attached to, and large host allocations are
+ * subsequently placed according to QUDA_NUMA_HOST_MEMORY:
+ * "local" (prefer the device's node, the default), "interleave"
+ * (interleave over all nodes) or "none".  This is a no-op unless
+ * QUDA_ENABLE_NUMA_AFFINITY=1 is set.
+ * @param  deviceid gpu to determine affinity for
+ * @param  pci_bus_id PCI bus id of the gpu, in the form [domain]:[bus]:[device].[function]
+ * @return          0 if numa affinity was set
+ */
+int setNumaAffinity(int deviceid, const char *pci_bus_id);
+
+/**
+ * Apply the NUMA memory policy chosen by setNumaAffinity to a host
+ * allocation.  This is applied by safe_malloc, pinned_malloc,
+ * mapped_malloc and the host memory pool.  Only the whole pages of
+ * the allocation are bound, and only pages not yet touched are
+ * placed by the policy, so it must be called before the memory is
+ * first written.  This is a no-op if no policy has been set or if
+ * the allocation is smaller than 1 MiB.
+ * @param  ptr start of the allocation
+ * @param  bytes size of the allocation
+ */
+void setNumaMemoryPolicy(void *ptr, size_t bytes);
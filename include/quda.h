@@ -90,6 +90,10 @@ extern "C" {
     size_t gauge_offset; /**< Offset into MILC site struct to the gauge field (only if gauge_order=MILC_SITE_GAUGE_ORDER) */
     size_t mom_offset; /**< Offset into MILC site struct to the momentum field (only if gauge_order=MILC_SITE_GAUGE_ORDER) */
     size_t site_size; /**< Size of MILC site struct (only if gauge_order=MILC_SITE_GAUGE_ORDER) */
+
+    QudaPrecision checksum_precision; /**< Precision of the links in the configuration file the field was read from.  If set, loadGaugeQuda validates the field against the SciDAC checksum (checksum_a, checksum_b) of the file, which is computed in this precision (default QUDA_INVALID_PRECISION, no validation).  Host fields in the QDP, QDPJIT, MILC, CPS, BQCD and TIFR orders are checksummed in place; device fields and other orders are first copied to a host field, so must hold the links exactly (no half precision or compressed reconstruction) */
+    unsigned int checksum_a; /**< SciDAC checksum a of the configuration file (only if checksum_precision is set) */
+    unsigned int checksum_b; /**< SciDAC checksum b of the configuration file (only if checksum_precision is set) */
   } QudaGaugeParam;
 
 
@@ -435,7 +439,10 @@ extern "C" {
     /** The index to indicate which chrono history we are augmenting */
     int chrono_index;
 
-    /** Precision to store the chronological basis in */
+    /** Precision to store the chronological basis in: either the outer or
+        sloppy precision, or a lower precision, e.g., half or quarter, in
+        which case the basis is promoted to the sloppy precision for the
+        forecast */
     QudaPrecision chrono_precision;
 
     /** Which external library to use in the linear solvers (Eigen) */
@@ -447,6 +454,42 @@ extern "C" {
     /** Whether to use fused kernels for mobius */
     QudaBoolean use_mobius_fused_kernel;
 
+    /** Whether to preserve the GCRO-DR recycled subspace between
+        solves.  If true, the space will be stored in an instance of
+        the recycle_space struct, pointed to by preserve_recycle_space */
+    QudaBoolean preserve_recycle;
+
+    /** This is where we store the recycled subspace.  This will point
+        to an instance of recycle_space.  When GCRO-DR is used, the
+        recycled subspace will be obtained from this. */
+    void *preserve_recycle_space;
+
+    /** Whether invertMultiSrcQuda iterates all sources together with
+        the batched multi-source CG solver, rather than solving them one
+        after another.  The even-odd Wilson operator is applied to all
+        sources in one batched dslash, other operators one source at a
+        time.
+        Requires the CG inverter, or the block CG inverter to share the
+        Krylov space between the sources, and no split grid. */
+    QudaBoolean batched_multi_src;
+
+    /** Whether to adapt the sloppy precision during the solve: the
+        solve starts with the preconditioner precision as its sloppy
+        precision, and is promoted to the sloppy and then the outer
+        precision when progress at the current precision stalls.
+        Supported with the CG, CGNE, CGNR, PCG, pipelined CG, GCR and
+        BiCGstab inverters */
+    QudaBoolean precision_ladder;
+
+    /** Minimum number of iterations over which the convergence rate
+        is measured, between the reliable updates at which promotion on
+        the precision ladder is decided */
+    int precision_ladder_check;
+
+    /** The number of promotions on the precision ladder in the last
+        solve (output) */
+    int precision_ladder_promotions;
+
   } QudaInvertParam;
 
   // Parameter set for solving eigenvalue problems.
@@ -802,6 +845,10 @@ extern "C" {
 
     /** Whether to do a full (false) or thin (true) update in the context of updateMultigridQuda */
     QudaBoolean thin_update_only;
+
+    /** Output: whether restoreMultigridQuda restored the hierarchy from the checkpoint (true) or set it up afresh
+        (false) */
+    QudaBoolean checkpoint_restored;
   } QudaMultigridParam;
 
   typedef struct QudaGaugeObservableParam_s {
@@ -1102,6 +1149,18 @@ extern "C" {
    */
   void loadGaugeQuda(void *h_gauge, QudaGaugeParam *param);
 
+  /**
+   * Load the gauge field from a region of a file, which is memory
+   * mapped and copied to the device directly from the page cache
+   * without an intermediate host copy.
+   * @param filename The file holding the rank-local gauge field, in
+   *                 the host order and precision given by param
+   *                 (QDP order holds the directions one after another)
+   * @param offset   Offset of the gauge field in the file
+   * @param param    Contains all metadata regarding host and device storage
+   */
+  void loadGaugeMappedQuda(const char *filename, size_t offset, QudaGaugeParam *param);
+
   /**
    * Free QUDA's internal copy of the gauge field.
    */
@@ -1125,6 +1184,29 @@ extern "C" {
    */
   void saveGaugeQuda(void *h_gauge, QudaGaugeParam *param);
 
+  /**
+   * Read a gauge configuration in the NERSC or ILDG format into a
+   * host gauge field.  Each rank reads its own sub-volume in parallel,
+   * and the checksum in the file is verified.
+   * @param h_gauge Base pointer to host gauge field, in QDP or MILC order
+   * @param filename The configuration to read
+   * @param param   Contains all metadata regarding host storage
+   */
+  void readGaugeFileQuda(void *h_gauge, const char *filename, QudaGaugeParam *param);
+
+  /**
+   * Read a gauge configuration in the NERSC or ILDG format and load
+   * it to the device, as loadGaugeQuda.  Each rank reads its own
+   * sub-volume into an internal pinned host field, from which it is
+   * copied directly to the device, so unlike readGaugeFileQuda
+   * followed by loadGaugeQuda no host array of the caller is filled
+   * and then staged again.  The checksum in the file is verified.
+   * @param filename The configuration to read
+   * @param param   Contains all metadata regarding host and device
+   * storage, where the host gauge order and location are ignored
+   */
+  void loadGaugeFileQuda(const char *filename, QudaGaugeParam *param);
+
   /**
    * Load the clover term and/or the clover inverse from the host.
    * Either h_clover or h_clovinv may be set to NULL.
@@ -1173,6 +1255,21 @@ extern "C" {
    */
   void invertQuda(void *h_x, void *h_b, QudaInvertParam *param);
 
+  /**
+   * Perform the solve as invertQuda, with the source read from a
+   * region of a file, which is memory mapped and copied to the device
+   * directly from the page cache without an intermediate host copy.
+   * @param h_x      Solution spinor field
+   * @param filename The file holding the rank-local source, in the
+   *                 host order and precision given by param (the
+   *                 dirac_order must be QUDA_DIRAC_ORDER,
+   *                 QUDA_QDP_DIRAC_ORDER or QUDA_CPS_WILSON_DIRAC_ORDER)
+   * @param offset   Offset of the source in the file
+   * @param param    Contains all metadata regarding host and device
+   *                 storage and solver parameters
+   */
+  void invertMappedQuda(void *h_x, const char *filename, size_t offset, QudaInvertParam *param);
+
   /**
    * @brief Perform the solve like @invertQuda but for multiple rhs by spliting the comm grid into
    * sub-partitions: each sub-partition invert one or more rhs'.
@@ -1261,6 +1358,31 @@ extern "C" {
    */
   void dumpMultigridQuda(void *mg_instance, QudaMultigridParam *param);
 
+  /**
+   * @brief Write the full multigrid hierarchy (null space, transfer
+   * operators and coarse operators on every level) to a checkpoint,
+   * which can be restored with restoreMultigridQuda() to skip the
+   * setup.  This is supported when aggregation is used on all levels.
+   * @param[in] mg_instance Pointer to the instance of multigrid_solver
+   * @param[in] param Contains all metadata regarding host and device
+   * storage and solver parameters
+   * @param[in] filename The checkpoint to write
+   */
+  void checkpointMultigridQuda(void *mg_instance, QudaMultigridParam *param, const char *filename);
+
+  /**
+   * @brief Setup the multigrid solver from a checkpoint written by
+   * checkpointMultigridQuda().  The checkpoint is only restored if
+   * the gauge field, the rank partitioning and the parameters match
+   * those it was written with; otherwise the multigrid solver is set
+   * up afresh as with newMultigridQuda().
+   * @param param  Contains all metadata regarding host and device
+   *               storage and solver parameters
+   * @param filename The checkpoint to restore
+   * @return Pointer to the instance of multigrid_solver
+   */
+  void *restoreMultigridQuda(QudaMultigridParam *param, const char *filename);
+
   /**
    * Apply the Dslash operator (D_{eo} or D_{oe}).
    * @param h_out  Result spinor field
@@ -1724,6 +1846,15 @@ extern "C" {
    */
   void flushChronoQuda(int index);
 
+  /**
+   * @brief Wait for all background writes of eigenvectors and
+   * multigrid null-space vectors to complete.  This is only needed if
+   * the files are to be used outside of QUDA before endQuda is
+   * called, since QUDA completes any pending write to a file before
+   * reading or overwriting it.
+   */
+  void flushAsyncIOQuda();
+
 
   /**
   * Create deflation solver resources.
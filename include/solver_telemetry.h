@@ -0,0 +1,150 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+   @file solver_telemetry.h
+
+   @brief Optional per-solve telemetry of the linear solvers, for
+   collecting convergence histories across many production solves.
+   For every top-level solve one JSON object is appended to the
+   telemetry file, holding the solver, precisions, tolerance,
+   iteration count, reliable updates, true residual, wall-clock time,
+   the device time spent in the operator, the blas and the reductions,
+   and the operator and blas shares of the flops, together with the
+   iterated residual, time and reliable-update flag of the most recent
+   iterations, which are held in a fixed-size ring buffer.  Only
+   host-side values that the solver has already computed are
+   recorded, and the device time is measured with events that are
+   read back once they have completed, so no synchronization is added
+   to the solver.
+
+   Telemetry is enabled by setting QUDA_SOLVER_TELEMETRY to the path
+   of the file to append to, which is written by rank 0 only, with
+   QUDA_SOLVER_TELEMETRY_SIZE setting the number of iterations held in
+   the ring buffer (default 256).
+ */
+
+namespace quda
+{
+
+  struct SolverParam;
+
+  class SolverTelemetry
+  {
+  public:
+    /**
+       @brief The categories of device work that are timed
+     */
+    enum Category { OPERATOR, BLAS, REDUCTION, CATEGORY_COUNT };
+
+    /**
+       @brief Scoped timer of the device work issued on the default
+       stream while a solve is recorded, used at the entry points of
+       the operator, blas and reduction kernels.  The time of a region
+       nested in another is attributed to the outermost region, and a
+       region is a no-op when no solve is recorded.
+     */
+    class Region
+    {
+      bool entered = false; // whether a solve was recorded when the region was entered
+      int slot = -1;        // event pair of an outermost region
+    public:
+      Region(Category category);
+      ~Region();
+      Region(const Region &) = delete;
+      Region &operator=(const Region &) = delete;
+    };
+
+  private:
+    struct Iteration {
+      int k;         /** Iteration count */
+      double r2;     /** Iterated residual norm squared */
+      double hq;     /** Heavy-quark residual */
+      double time;   /** Seconds since the start of the solve */
+      bool reliable; /** Whether a reliable update preceded this iteration */
+    };
+
+    bool active = false;
+    std::string name;
+    int precision = 0;
+    int precision_sloppy = 0;
+    double tol = 0.0;
+    double b2 = 0.0;
+    double operator_gflops = 0.0;
+    double blas_gflops = 0.0;
+    int reliable_updates = 0;
+    bool reliable = false; // whether a reliable update is pending for the next iteration
+    std::vector<Iteration> ring;
+    size_t n_iter = 0; // total number of iterations recorded
+    std::chrono::steady_clock::time_point start;
+    double secs[CATEGORY_COUNT] = {}; // device time of each category
+
+    /**
+       @brief Add the time of the completed regions to this record
+       @param[in] wait Whether to wait for all regions to complete
+     */
+    void harvest(bool wait);
+
+  public:
+    SolverTelemetry() = default;
+
+    /**
+       @brief Stop timing the regions if this solve is being recorded
+     */
+    ~SolverTelemetry();
+
+    /**
+       @return Whether solver telemetry is enabled
+     */
+    static bool enabled();
+
+    /**
+       @brief Start recording a solve.  This is a no-op if telemetry is
+       disabled, on ranks other than 0, or unless
+       param.record_telemetry is set, which is only the case for the
+       top-level solver of invertQuda and invertMultiShiftQuda.
+       @param[in] name The name of the solver
+       @param[in] param The solver parameters
+       @param[in] b2 The source norm squared
+     */
+    void begin(const char *name, const SolverParam &param, double b2);
+
+    /**
+       @brief Record an iteration of the solve
+       @param[in] k The iteration count
+       @param[in] r2 The iterated residual norm squared
+       @param[in] hq The heavy-quark residual
+     */
+    void iteration(int k, double r2, double hq);
+
+    /**
+       @brief Record a reliable update, which is flagged on the next
+       iteration recorded
+     */
+    void reliable_update();
+
+    /**
+       @brief Record the flops of the solve, split between the operator
+       and the blas
+       @param[in] operator_gflops Gflops of the operator applications
+       @param[in] blas_gflops Gflops of the blas
+     */
+    void set_flops(double operator_gflops, double blas_gflops);
+
+    /**
+       @brief Finish recording a solve and append the record to the
+       telemetry file
+       @param[in] iter The number of iterations of the solve
+       @param[in] converged Whether the solve converged
+       @param[in] true_res The true relative residual, or NaN if not
+       computed
+       @param[in] true_res_hq The true heavy-quark residual, or NaN if
+       not computed
+     */
+    void end(int iter, bool converged, double true_res, double true_res_hq);
+  };
+
+} // namespace quda
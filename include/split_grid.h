@@ -1,8 +1,12 @@
 #pragma once
 
+#include <vector>
+#include <algorithm>
+
 #include <quda.h>
 #include <comm_quda.h>
 #include <communicator_quda.h>
+#include <timer.h>
 
 #include <gauge_field.h>
 #include <color_spinor_field.h>
@@ -13,194 +17,343 @@ namespace quda
 
   int comm_rank_from_coords(const int *coords);
 
-  template <class Field>
-  void inline split_field(Field &collect_field, std::vector<Field *> &v_base_field, const CommKey &comm_key,
-                          QudaPCType pc_type = QUDA_4D_PC)
-  {
-    CommKey comm_grid_dim = {comm_dim(0), comm_dim(1), comm_dim(2), comm_dim(3)};
-    CommKey comm_grid_idx = {comm_coord(0), comm_coord(1), comm_coord(2), comm_coord(3)};
-
-    int rank = comm_rank();
-    int total_rank = product(comm_grid_dim);
+  /**
+     @brief Cumulative statistics of the split-grid field
+     redistribution.  The total time is measured from the start of a
+     transfer until its completion, while the exposed time is only the
+     part of it that was spent inside the redistribution calls
+     themselves, i.e., that was not overlapped with other work.
+  */
+  struct SplitGridStats {
+    size_t bytes = 0;     /** Bytes received by this rank */
+    double total = 0.0;   /** Time from the start of the transfers until their completion */
+    double exposed = 0.0; /** Time spent inside the start and wait calls */
+    int count = 0;        /** Number of completed redistributions */
 
     /**
-      The term partition in the variable names and comments can mean two things:
-      - The processor grid (with dimension comm_grid_dim) is divided into (sub)partitions.
-      - For the collecting field, on each processor it contains several partitions, each partition is a copy of
-        the base field.
-      The term partition_dim means the number of partitions in each direction, and (unsurprisingly) partition_dim
-      is the same for the above two meanings, i.e. if I divide the overall processor grid by 3 in one direction,
-      the collect field will be 3 times fatter compared to the base field, in that direction.
-
-      In this file the term *_dim and *_idx are all arrays of 4 int's - one can simplify them as 1d-int to understand
-      things and the extension to 4d is trivial.
-    */
-
-    auto processor_dim = comm_grid_dim / comm_key; // How many processors are there in a processor grid sub-parititon?
-    auto partition_dim
-      = comm_grid_dim / processor_dim; // How many such sub-partitions are there? partition_dim == comm_key
-
-    int n_replicates = product(comm_key);
-    std::vector<void *> v_send_buffer_h(n_replicates, nullptr);
-    std::vector<MsgHandle *> v_mh_send(n_replicates, nullptr);
-
-    int n_fields = v_base_field.size();
-    if (n_fields == 0) { errorQuda("split_field: input field vec has zero size."); }
-
-    const auto meta = v_base_field[0];
-
-    // Send cycles
-    for (int i = 0; i < n_replicates; i++) {
-      auto partition_idx = coordinate_from_index(i, comm_key); // Which partition to send to?
-      auto processor_idx = comm_grid_idx / partition_dim;      // Which processor in that partition to send to?
-
-      auto dst_idx = partition_idx * processor_dim + processor_idx;
-
-      int dst_rank = ::quda::comm_rank_from_coords(dst_idx.data());
-      int tag = rank * total_rank + dst_rank; // tag = src_rank * total_rank + dst_rank
-
-      size_t bytes = meta->TotalBytes();
-
-      v_send_buffer_h[i] = pinned_malloc(bytes);
+       @brief Print the accumulated statistics and reset
+       @param[in] name Which redistribution the statistics refers to
+     */
+    void print_and_reset(const char *name)
+    {
+      if (count > 0 && getVerbosity() >= QUDA_VERBOSE) {
+        printfQuda("Split grid %s: %d redistributions of %.1f MiB in %.3f s (%.3f s exposed), %.3f GiB/s\n", name,
+                   count, bytes / (double)(1 << 20), total, exposed,
+                   total > 0.0 ? bytes / (total * (double)(1 << 30)) : 0.0);
+      }
+      *this = SplitGridStats();
+    }
+  };
 
-      v_base_field[i % n_fields]->copy_to_buffer(v_send_buffer_h[i]);
+  /**
+     @return The statistics accumulated by all split-grid field redistributions
+   */
+  inline SplitGridStats &split_grid_stats()
+  {
+    static SplitGridStats stats;
+    return stats;
+  }
 
-      v_mh_send[i] = comm_declare_send_rank(v_send_buffer_h[i], dst_rank, tag, bytes);
-      comm_start(v_mh_send[i]);
+  /**
+     @return The maximum size of a single message used for the
+     split-grid redistribution.  Larger fields are sent in chunks of at
+     most this size, which keeps each message within the int-sized
+     count limit of MPI and allows the network to pipeline the chunks.
+     This can be set (in MiB) with QUDA_SPLIT_GRID_CHUNK_SIZE.
+   */
+  inline size_t split_grid_chunk_bytes()
+  {
+    static size_t chunk_bytes = 0;
+    if (chunk_bytes == 0) {
+      char *chunk_env = getenv("QUDA_SPLIT_GRID_CHUNK_SIZE");
+      chunk_bytes = static_cast<size_t>(chunk_env ? atoi(chunk_env) : 256) << 20;
+      if (chunk_bytes == 0 || chunk_bytes >= (1ul << 31))
+        errorQuda("Invalid QUDA_SPLIT_GRID_CHUNK_SIZE = %s MiB", chunk_env);
     }
+    return chunk_bytes;
+  }
 
+  /**
+     @brief Non-blocking redistribution of fields between the full
+     processor grid and its sub-partitions.  When splitting, each set
+     of base fields (one per sub-partition) is gathered into a collect
+     field that is fatter by comm_key; when joining, a collect field
+     is scattered back into its base fields.
+
+     All messages are declared as persistent requests at construction,
+     so the object must be created while the default communicator is
+     active.  The transfers themselves may then be started and
+     completed while a split communicator is active, which allows them
+     to be overlapped with computation on the sub-partitions.  To allow
+     field k+1 to be in flight while field k is being worked on, the
+     object owns n_slot independent sets of host buffers and messages.
+     Messages in flight between the same pair of ranks share a tag,
+     and are matched in the order they were started, which MPI
+     guarantees to be consistent since every rank starts the slots in
+     the same order.
+
+     @tparam Field The field type (ColorSpinorField, GaugeField or CloverField)
+   */
+  template <class Field> class FieldRedistribution
+  {
     using param_type = typename Field::param_type;
 
-    param_type param(*meta);
-    Field *buffer_field = Field::Create(param);
-
-    CommKey field_dim = {meta->full_dim(0), meta->full_dim(1), meta->full_dim(2), meta->full_dim(3)};
-
-    // Receive cycles
-    for (int i = 0; i < n_replicates; i++) {
-      auto partition_idx
-        = coordinate_from_index(i, comm_key); // Here this means which partition of the field we are working on.
-      auto src_idx
-        = (comm_grid_idx % processor_dim) * partition_dim + partition_idx; // And where does this partition comes from?
-
-      int src_rank = comm_rank_from_coords(src_idx.data());
-      int tag = src_rank * total_rank + rank;
-
-      size_t bytes = buffer_field->TotalBytes();
-
-      void *recv_buffer_h = pinned_malloc(bytes);
-
-      auto mh_recv = comm_declare_recv_rank(recv_buffer_h, src_rank, tag, bytes);
-
-      comm_start(mh_recv);
-      comm_wait(mh_recv);
-
-      buffer_field->copy_from_buffer(recv_buffer_h);
-
-      comm_free(mh_recv);
-      host_free(recv_buffer_h);
-
-      auto offset = partition_idx * field_dim;
+    /**
+       The term partition in the variable names and comments can mean two things:
+       - The processor grid (with dimension comm_grid_dim) is divided into (sub)partitions.
+       - For the collecting field, on each processor it contains several partitions, each partition is a copy of
+         the base field.
+       The term partition_dim means the number of partitions in each direction, and (unsurprisingly) partition_dim
+       is the same for the above two meanings, i.e. if I divide the overall processor grid by 3 in one direction,
+       the collect field will be 3 times fatter compared to the base field, in that direction.
+
+       In this file the term *_dim and *_idx are all arrays of 4 int's - one can simplify them as 1d-int to understand
+       things and the extension to 4d is trivial.
+    */
+    const CommKey comm_key;
+    const bool split;          /** Whether we are splitting (base -> collect) or joining (collect -> base) */
+    const QudaPCType pc_type;  /** The type of even-odd preconditioning used by the field */
+    const int n_slot;          /** Number of independent transfers that can be in flight */
+    const int n_replicates;    /** Number of partitions, and thus messages sent and received per transfer */
+    const size_t bytes;        /** Bytes per message, i.e., the size of one base field */
+    const size_t chunk_bytes;  /** Maximum size of a single message */
+    const int n_chunk;         /** Number of chunks each message is sent in */
+    CommKey field_dim;         /** Local dimensions of the base field */
+    Field *buffer_field;       /** Base-sized temporary used to insert/extract a partition */
+
+    std::vector<void *> send_buffer; /** Send buffers, indexed by slot * n_replicates + replicate */
+    std::vector<void *> recv_buffer; /** Receive buffers, indexed by slot * n_replicates + replicate */
+    std::vector<MsgHandle *> mh_send; /** Send messages, indexed by (slot * n_replicates + replicate) * n_chunk + chunk */
+    std::vector<MsgHandle *> mh_recv; /** Receive messages, indexed as mh_send */
+    std::vector<bool> active;          /** Whether a given slot is currently in flight */
+    std::vector<host_timer_t> timer;   /** Per-slot timer measuring start to completion */
+
+    size_t chunk_size(int chunk) const { return std::min(chunk_bytes, bytes - chunk * chunk_bytes); }
+
+    void check_slot(int slot, bool expected, const char *func) const
+    {
+      if (slot < 0 || slot >= n_slot) errorQuda("%s: invalid slot %d (n_slot = %d)", func, slot, n_slot);
+      if (active[slot] != expected)
+        errorQuda("%s: slot %d is %s in flight", func, slot, active[slot] ? "already" : "not");
+    }
 
-      quda::copyFieldOffset(collect_field, *buffer_field, offset, pc_type);
+  public:
+    /**
+       @brief Constructor for the field redistribution, allocates the
+       host buffers and declares all messages.  Must be called while
+       the default communicator is active.
+       @param[in] meta A base field that defines the geometry of the transfer
+       @param[in] comm_key The split-grid key
+       @param[in] split Whether we are splitting or joining fields
+       @param[in] n_slot How many transfers can be in flight concurrently
+       @param[in] pc_type The type of even-odd preconditioning of the fields
+     */
+    FieldRedistribution(const Field &meta, const CommKey &comm_key, bool split, int n_slot = 1,
+                        QudaPCType pc_type = QUDA_4D_PC) :
+      comm_key(comm_key),
+      split(split),
+      pc_type(pc_type),
+      n_slot(n_slot),
+      n_replicates(product(comm_key)),
+      bytes(meta.TotalBytes()),
+      chunk_bytes(split_grid_chunk_bytes()),
+      n_chunk((bytes + chunk_bytes - 1) / chunk_bytes),
+      field_dim {meta.full_dim(0), meta.full_dim(1), meta.full_dim(2), meta.full_dim(3)},
+      send_buffer(n_slot * n_replicates, nullptr),
+      recv_buffer(n_slot * n_replicates, nullptr),
+      mh_send(n_slot * n_replicates * n_chunk, nullptr),
+      mh_recv(n_slot * n_replicates * n_chunk, nullptr),
+      active(n_slot, false),
+      timer(n_slot)
+    {
+      CommKey comm_grid_dim = {comm_dim(0), comm_dim(1), comm_dim(2), comm_dim(3)};
+      CommKey comm_grid_idx = {comm_coord(0), comm_coord(1), comm_coord(2), comm_coord(3)};
+
+      int rank = comm_rank();
+      int total_rank = product(comm_grid_dim);
+      const long n_pair_tag = (static_cast<long>(comm_tag_ub()) + 1) / 2; // number of distinct tags per direction
+
+      auto processor_dim = comm_grid_dim / comm_key; // How many processors are there in a processor grid sub-parititon?
+      auto partition_dim
+        = comm_grid_dim / processor_dim; // How many such sub-partitions are there? partition_dim == comm_key
+
+      param_type param(meta);
+      buffer_field = Field::Create(param);
+
+      for (int i = 0; i < n_replicates; i++) {
+        auto partition_idx = coordinate_from_index(i, comm_key);
+
+        // when splitting we send partition i of the base field to the processor that holds it in the collect
+        // field, and receive partition i of our collect field from where it resides on the full grid; joining
+        // is the exact inverse
+        auto processor_idx = comm_grid_idx / partition_dim;
+        auto full_idx = partition_idx * processor_dim + processor_idx;
+        auto collect_idx = (comm_grid_idx % processor_dim) * partition_dim + partition_idx;
+
+        int dst_rank = comm_rank_from_coords(split ? full_idx.data() : collect_idx.data());
+        int src_rank = comm_rank_from_coords(split ? collect_idx.data() : full_idx.data());
+
+        // tag = (src_rank * total_rank + dst_rank) * 2 + direction, so that concurrent splits and joins never match;
+        // the pair index is wrapped to keep the tag within the bound of the communications layer, which is safe
+        // since messages are matched on the source rank as well as the tag, so only the direction must be kept
+        auto tag = [&](int src, int dst) {
+          return static_cast<int>(((static_cast<long>(src) * total_rank + dst) % n_pair_tag) * 2 + (split ? 0 : 1));
+        };
+        int send_tag = tag(rank, dst_rank);
+        int recv_tag = tag(src_rank, rank);
+
+        for (int s = 0; s < n_slot; s++) {
+          int idx = s * n_replicates + i;
+          send_buffer[idx] = pool_pinned_malloc(bytes);
+          recv_buffer[idx] = pool_pinned_malloc(bytes);
+          for (int c = 0; c < n_chunk; c++) {
+            mh_send[idx * n_chunk + c] = comm_declare_send_rank(static_cast<char *>(send_buffer[idx]) + c * chunk_bytes,
+                                                                dst_rank, send_tag, chunk_size(c));
+            mh_recv[idx * n_chunk + c] = comm_declare_recv_rank(static_cast<char *>(recv_buffer[idx]) + c * chunk_bytes,
+                                                                src_rank, recv_tag, chunk_size(c));
+          }
+        }
+      }
     }
 
-    delete buffer_field;
+    FieldRedistribution(const FieldRedistribution &) = delete;
+    FieldRedistribution(FieldRedistribution &&) = delete;
+    FieldRedistribution &operator=(const FieldRedistribution &) = delete;
+    FieldRedistribution &operator=(FieldRedistribution &&) = delete;
+
+    ~FieldRedistribution()
+    {
+      for (int s = 0; s < n_slot; s++) {
+        if (active[s]) errorQuda("Destroying FieldRedistribution with slot %d still in flight", s);
+      }
+      for (auto &mh : mh_send) {
+        if (mh) comm_free(mh);
+      }
+      for (auto &mh : mh_recv) {
+        if (mh) comm_free(mh);
+      }
+      for (auto &p : send_buffer) pool_pinned_free(p);
+      for (auto &p : recv_buffer) pool_pinned_free(p);
+      delete buffer_field;
+    }
 
-    comm_barrier();
+    /**
+       @brief Pack the send buffers of a slot and start its transfers.
+       @param[in] slot Which slot to use
+       @param[in,out] collect_field The collect field (source when joining)
+       @param[in,out] v_base_field The base fields (source when splitting)
+     */
+    void start(int slot, Field &collect_field, std::vector<Field *> &v_base_field)
+    {
+      check_slot(slot, false, __func__);
+      int n_fields = v_base_field.size();
+      if (n_fields == 0) { errorQuda("%s: base field vec has zero size.", split ? "split_field" : "join_field"); }
+
+      host_timer_t exposed;
+      exposed.start();
+      timer[slot].start();
+
+      // post the receives first to avoid unexpected messages
+      for (int i = 0; i < n_replicates; i++) {
+        int idx = slot * n_replicates + i;
+        for (int c = 0; c < n_chunk; c++) comm_start(mh_recv[idx * n_chunk + c]);
+      }
+
+      for (int i = 0; i < n_replicates; i++) {
+        int idx = slot * n_replicates + i;
+        if (split) {
+          v_base_field[i % n_fields]->copy_to_buffer(send_buffer[idx]);
+        } else {
+          auto offset = coordinate_from_index(i, comm_key) * field_dim;
+          quda::copyFieldOffset(*buffer_field, collect_field, offset, pc_type);
+          buffer_field->copy_to_buffer(send_buffer[idx]);
+        }
+        for (int c = 0; c < n_chunk; c++) comm_start(mh_send[idx * n_chunk + c]);
+      }
+
+      active[slot] = true;
+      exposed.stop();
+      split_grid_stats().exposed += exposed.last();
+    }
 
-    for (auto &p : v_send_buffer_h) {
-      if (p) { host_free(p); }
-    };
-    for (auto &p : v_mh_send) {
-      if (p) { comm_free(p); }
-    };
+    /**
+       @brief Wait for the transfers of a slot to complete and unpack
+       the received data.  The fields passed must be the same ones that
+       were passed to the matching start call.
+       @param[in] slot Which slot to complete
+       @param[in,out] collect_field The collect field (destination when splitting)
+       @param[in,out] v_base_field The base fields (destination when joining)
+     */
+    void wait(int slot, Field &collect_field, std::vector<Field *> &v_base_field)
+    {
+      check_slot(slot, true, __func__);
+      int n_fields = v_base_field.size();
+
+      host_timer_t exposed;
+      exposed.start();
+
+      for (int i = 0; i < n_replicates; i++) {
+        int idx = slot * n_replicates + i;
+        for (int c = 0; c < n_chunk; c++) comm_wait(mh_recv[idx * n_chunk + c]);
+
+        if (split) {
+          buffer_field->copy_from_buffer(recv_buffer[idx]);
+          auto offset = coordinate_from_index(i, comm_key) * field_dim;
+          quda::copyFieldOffset(collect_field, *buffer_field, offset, pc_type);
+        } else {
+          v_base_field[i % n_fields]->copy_from_buffer(recv_buffer[idx]);
+        }
+      }
+
+      for (int i = 0; i < n_replicates; i++) {
+        int idx = slot * n_replicates + i;
+        for (int c = 0; c < n_chunk; c++) comm_wait(mh_send[idx * n_chunk + c]);
+      }
+
+      active[slot] = false;
+      timer[slot].stop();
+      exposed.stop();
+
+      auto &stats = split_grid_stats();
+      stats.bytes += n_replicates * bytes;
+      stats.total += timer[slot].last();
+      stats.exposed += exposed.last();
+      stats.count++;
+    }
+  };
+
+  /**
+     @brief Blocking split of the base fields into the collect field
+     @param[out] collect_field The collect field
+     @param[in] v_base_field The base fields
+     @param[in] comm_key The split-grid key
+     @param[in] pc_type The type of even-odd preconditioning of the fields
+   */
+  template <class Field>
+  void inline split_field(Field &collect_field, std::vector<Field *> &v_base_field, const CommKey &comm_key,
+                          QudaPCType pc_type = QUDA_4D_PC)
+  {
+    if (v_base_field.size() == 0) { errorQuda("split_field: input field vec has zero size."); }
+    FieldRedistribution<Field> redistribution(*v_base_field[0], comm_key, true, 1, pc_type);
+    redistribution.start(0, collect_field, v_base_field);
+    redistribution.wait(0, collect_field, v_base_field);
   }
 
+  /**
+     @brief Blocking join of the collect field into the base fields
+     @param[out] v_base_field The base fields
+     @param[in] collect_field The collect field
+     @param[in] comm_key The split-grid key
+     @param[in] pc_type The type of even-odd preconditioning of the fields
+   */
   template <class Field>
   void inline join_field(std::vector<Field *> &v_base_field, const Field &collect_field, const CommKey &comm_key,
                          QudaPCType pc_type = QUDA_4D_PC)
   {
-    CommKey comm_grid_dim = {comm_dim(0), comm_dim(1), comm_dim(2), comm_dim(3)};
-    CommKey comm_grid_idx = {comm_coord(0), comm_coord(1), comm_coord(2), comm_coord(3)};
-
-    int rank = comm_rank();
-    int total_rank = product(comm_grid_dim);
-
-    auto processor_dim = comm_grid_dim / comm_key; // Communicator grid.
-    auto partition_dim
-      = comm_grid_dim / processor_dim; // The full field needs to be partitioned according to the communicator grid.
-
-    int n_replicates = product(comm_key);
-    std::vector<void *> v_send_buffer_h(n_replicates, nullptr);
-    std::vector<MsgHandle *> v_mh_send(n_replicates, nullptr);
-
-    int n_fields = v_base_field.size();
-    if (n_fields == 0) { errorQuda("join_field: output field vec has zero size."); }
-
-    const auto &meta = *(v_base_field[0]);
-
-    using param_type = typename Field::param_type;
-
-    param_type param(meta);
-    Field *buffer_field = Field::Create(param);
-
-    CommKey field_dim = {meta.full_dim(0), meta.full_dim(1), meta.full_dim(2), meta.full_dim(3)};
-
-    // Send cycles
-    for (int i = 0; i < n_replicates; i++) {
-
-      auto partition_idx = coordinate_from_index(i, comm_key);
-      auto dst_idx = (comm_grid_idx % processor_dim) * partition_dim + partition_idx;
-
-      int dst_rank = comm_rank_from_coords(dst_idx.data());
-      int tag = rank * total_rank + dst_rank;
-
-      size_t bytes = meta.TotalBytes();
-
-      auto offset = partition_idx * field_dim;
-      quda::copyFieldOffset(*buffer_field, collect_field, offset, pc_type);
-
-      v_send_buffer_h[i] = pinned_malloc(bytes);
-      buffer_field->copy_to_buffer(v_send_buffer_h[i]);
-
-      v_mh_send[i] = comm_declare_send_rank(v_send_buffer_h[i], dst_rank, tag, bytes);
-
-      comm_start(v_mh_send[i]);
-    }
-
-    // Receive cycles
-    for (int i = 0; i < n_replicates; i++) {
-
-      auto partition_idx = coordinate_from_index(i, comm_key);
-      auto processor_idx = comm_grid_idx / partition_dim;
-
-      auto src_idx = partition_idx * processor_dim + processor_idx;
-
-      int src_rank = comm_rank_from_coords(src_idx.data());
-      int tag = src_rank * total_rank + rank;
-
-      size_t bytes = buffer_field->TotalBytes();
-
-      void *recv_buffer_h = pinned_malloc(bytes);
-
-      auto mh_recv = comm_declare_recv_rank(recv_buffer_h, src_rank, tag, bytes);
-
-      comm_start(mh_recv);
-      comm_wait(mh_recv);
-
-      v_base_field[i % n_fields]->copy_from_buffer(recv_buffer_h);
-
-      comm_free(mh_recv);
-      host_free(recv_buffer_h);
-    }
-
-    delete buffer_field;
-
-    comm_barrier();
-
-    for (auto &p : v_send_buffer_h) { host_free(p); };
-    for (auto &p : v_mh_send) { comm_free(p); };
+    if (v_base_field.size() == 0) { errorQuda("join_field: output field vec has zero size."); }
+    FieldRedistribution<Field> redistribution(*v_base_field[0], comm_key, false, 1, pc_type);
+    redistribution.start(0, const_cast<Field &>(collect_field), v_base_field);
+    redistribution.wait(0, const_cast<Field &>(collect_field), v_base_field);
   }
 
 } // namespace quda
@@ -9,6 +9,7 @@
 #include <quda_internal.h>
 #include <util_quda.h>
 #include <device.h>
+#include <memory_timeline.h>
 
 namespace quda {
 
@@ -237,6 +238,18 @@ namespace quda {
       }
     }
 
+    /**
+       @return Whether a given timer is tracked as a memory timeline
+       phase: the lower level timers are too fine grained to be useful
+     */
+    static bool isMemoryPhase(QudaProfileType idx)
+    {
+      return (idx < QUDA_PROFILE_LOWER_LEVEL || idx == QUDA_PROFILE_TOTAL) && memory_timeline::enabled();
+    }
+
+    /** @return The name of a given timer as a memory timeline phase */
+    std::string memoryPhase(QudaProfileType idx) const { return fname + ":" + pname[idx]; }
+
     static void StartGlobal(const char *func, const char *file, int line, QudaProfileType idx) {
       // if total timer isn't running, then start it running
       if (!global_profile[idx].running) {
@@ -266,12 +279,14 @@ namespace quda {
       }
 
       profile[idx].start(func, file, line);
+      if (isMemoryPhase(idx)) memory_timeline::push_phase(memoryPhase(idx));
       PUSH_RANGE(fname.c_str(),idx)
 	if (use_global) StartGlobal(func,file,line,idx);
     }
 
     void Stop_(const char *func, const char *file, int line, QudaProfileType idx) {
       profile[idx].stop(func, file, line);
+      if (isMemoryPhase(idx)) memory_timeline::pop_phase(memoryPhase(idx));
       POP_RANGE
 
       // switch off total timer if we need to
@@ -11,6 +11,7 @@
  */
 
 #include <color_spinor_field.h>
+#include <functional>
 #include <vector>
 
 namespace quda {
@@ -171,9 +172,13 @@ namespace quda {
      * @param parity For single-parity fields are these QUDA_EVEN_PARITY or QUDA_ODD_PARITY
      * @param null_precision The precision to store the null-space basis vectors in
      * @param enable_gpu Whether to enable this to run on GPU (as well as CPU)
+     * @param restore If set, the block-orthogonal basis V is not
+     * computed from B, but is instead passed to this function to fill
+     * in, e.g., from a checkpoint
      */
     Transfer(const std::vector<ColorSpinorField *> &B, int Nvec, int NblockOrtho, bool blockOrthoTwoPass, int *geo_bs,
-             int spin_bs, QudaPrecision null_precision, const QudaTransferType transfer_type, TimeProfile &profile);
+             int spin_bs, QudaPrecision null_precision, const QudaTransferType transfer_type, TimeProfile &profile,
+             const std::function<void(ColorSpinorField &)> &restore = nullptr);
 
     /** The destructor for Transfer */
     virtual ~Transfer();
@@ -9,13 +9,33 @@ namespace quda
 
   /**
      @brief VectorIO is a simple wrapper class for loading and saving
-     sets of vector fields using QIO.
+     sets of vector fields using QIO or QUDA's native format.
    */
   class VectorIO
   {
     const std::string filename;
     bool parity_inflate;
 
+    /**
+       @brief Load vectors from a file in the native format.  Vectors
+       that need conversion are streamed through two host staging
+       batches, so that reading one batch overlaps with copying the
+       previous one to its destination.
+       @param[in] vecs The set of vectors to load
+       @param[in] load_prec The precision of the host staging fields
+    */
+    void load_native(cvector_ref<ColorSpinorField> &vecs, QudaPrecision load_prec);
+
+    /**
+       @brief Save vectors to a file in the native format.  Vectors
+       that need conversion are streamed through two host staging
+       batches, so that writing one batch overlaps with filling the
+       next one.
+       @param[in] vecs The set of vectors to save
+       @param[in] save_prec The precision to save in
+    */
+    void save_native(cvector_ref<const ColorSpinorField> &vecs, QudaPrecision save_prec);
+
   public:
     /**
        Constructor for VectorIO class
@@ -26,19 +46,43 @@ namespace quda
     VectorIO(const std::string &filename, bool parity_inflate = false);
 
     /**
-       @brief Load vectors from filename
+       @brief Load vectors from filename.  Only the native format is
+       streamed through bounded staging (QUDA_VECTOR_IO_BATCH_SIZE):
+       QIO reads the whole set in a single call, so with QIO every
+       vector that needs conversion is staged on the host at once.
        @param[in] vecs The set of vectors to load
     */
     void load(cvector_ref<ColorSpinorField> &vecs);
 
     /**
-       @brief Save vectors to filename
+       @brief Save vectors to filename.  As with load(), only the
+       native format is streamed through bounded staging, and QIO
+       stages every vector that needs conversion at once.
        @param[in] vecs The set of vectors to save
        @param[in] prec Optional change of precision when saving
        @param[in] size Optional cap to number of vectors saved
     */
     void save(cvector_ref<const ColorSpinorField> &vecs, QudaPrecision prec = QUDA_INVALID_PRECISION, uint32_t size = 0);
 
+    /**
+       @brief Save vectors to filename in the background.  The vectors
+       are snapshotted to host staging fields before returning, so may
+       be modified immediately, and the file is written by the
+       asynchronous I/O thread (see async_io.h).  This falls back to
+       save() if asynchronous writing is disabled, if the format is
+       not native, or if the vectors exceed the staging budget.
+       @param[in] vecs The set of vectors to save
+       @param[in] prec Optional change of precision when saving
+       @param[in] size Optional cap to number of vectors saved
+    */
+    void save_async(cvector_ref<const ColorSpinorField> &vecs, QudaPrecision prec = QUDA_INVALID_PRECISION,
+                    uint32_t size = 0);
+
+    /**
+       @brief Wait for all asynchronous saves to complete
+    */
+    static void flush();
+
   };
 
 } // namespace quda
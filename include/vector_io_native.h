@@ -0,0 +1,252 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <crc32.h>
+#include <color_spinor_field.h>
+#include <reference_wrapper_helper.h>
+
+/**
+   @file vector_io_native.h
+
+   @brief QUDA's native container format for sets of vector fields,
+   which does not depend on QIO.  A file consists of
+
+   - an 8-byte magic string ("QUDAFLD1") and a little-endian 64-bit
+     length of the header;
+   - a JSON header describing the global geometry, the precision,
+     site order, site subset, the rank partitioning of the writer and
+     a SciDAC checksum for each vector;
+   - the payload, starting at a page-aligned offset: for each vector,
+     one contiguous block per writer rank (ordered lexicographically
+     in the rank grid) holding that rank's sub-lattice in QUDA's host
+     space-spin-color checkerboarded order.
+
+   Each rank writes and reads its own block with positional I/O, so
+   there is no serialization through a single rank.  A file can be
+   read back with a different rank partitioning, in which case each
+   rank gathers its sites from the overlapping writer blocks, and the
+   checksum is verified independently of the partitioning.
+ */
+
+namespace quda
+{
+
+  namespace native_io
+  {
+
+    /**
+       @brief Return whether a file is in the native format.  This is
+       collective over all ranks.
+       @param[in] filename The file to query
+     */
+    bool is_native_file(const std::string &filename);
+
+    /**
+       Geometry of the rank-local block of sites of a field, stored in
+       QUDA's host checkerboarded order: sites are ordered by parity
+       (if both are present), then by lexicographic index divided by
+       two.
+     */
+    struct Geometry {
+      int nDim;
+      lat_dim_t L;       /** Full local dimensions */
+      lat_dim_t offset;  /** Global coordinates of the local origin */
+      lat_dim_t G;       /** Global dimensions */
+      bool full;         /** Whether both parities are present */
+      QudaParity parity; /** The parity present if single parity */
+      bool pc_5d;        /** Whether the parity includes the fifth dimension */
+
+      Geometry(const ColorSpinorField &v, QudaParity parity);
+
+      /** @return The number of sites (of both parities) in the local block */
+      size_t volume() const;
+
+      /** @return The number of sites stored in the local block */
+      size_t sites() const { return full ? volume() : volume() / 2; }
+
+      /** @return The parities present */
+      std::vector<int> parities() const;
+
+      /** @return The offset of a parity in the local block, in sites */
+      size_t parity_offset(int p) const { return full ? p * (volume() / 2) : 0; }
+
+      /**
+         @brief Apply a function to each half line of a given parity,
+         i.e., the sites of that parity along the x dimension for
+         fixed other coordinates, which are contiguous in memory
+         @param[in] p The parity
+         @param[in] f Function taking the local coordinates of the
+         first site, its checkerboard index and the number of sites
+       */
+      template <typename F> void for_each_half_line(int p, F &&f) const
+      {
+        lat_dim_t x = {};
+        size_t n_line = volume() / L[0];
+        for (size_t line = 0; line < n_line; line++) {
+          size_t r = line;
+          int sum = offset[0];
+          for (int d = 1; d < nDim; d++) {
+            x[d] = r % L[d];
+            r /= L[d];
+            if (d < 4 || pc_5d) sum += offset[d] + x[d];
+          }
+          x[0] = ((p - sum) % 2 + 2) % 2;
+          f(x, (line * L[0] + x[0]) / 2, static_cast<size_t>(L[0] / 2));
+        }
+      }
+
+      /**
+         @brief Compute the local contribution to the SciDAC checksum
+         @param[in] buf The local block
+         @param[in] site_bytes The bytes per site
+       */
+      crc::ScidacChecksum checksum(const char *buf, size_t site_bytes) const;
+    };
+
+    /**
+       Writer for a native file.  The constructor and close() are
+       collective over all ranks, while write() only does local file
+       I/O, so may be called from a helper thread to overlap the
+       writing with other work.
+     */
+    class Writer
+    {
+      const std::string filename;
+      const Geometry g;
+      const int nColor;
+      const int nSpin;
+      const QudaPrecision precision;
+      const size_t nvec;
+      size_t site_bytes;
+      size_t block_bytes;
+      size_t vec_bytes;
+      size_t block;
+      size_t payload;
+      int fd = -1;
+      std::vector<uint64_t> checksums; /** Local checksums of each vector */
+      size_t written = 0;              /** Vectors written */
+      size_t bytes = 0;                /** Bytes written */
+      double time = 0.0;               /** Time spent writing */
+
+      /** @return The serialized header, with the checksums if final */
+      std::string header(bool final) const;
+
+    public:
+      /**
+         @brief Create a native file for a set of vectors
+         @param[in] filename The file to write
+         @param[in] meta Field with the geometry and precision to write,
+         which must be a host field in space-spin-color order
+         @param[in] parity The parity of the fields if they are single parity
+         @param[in] nvec The number of vectors in the file
+       */
+      Writer(const std::string &filename, const ColorSpinorField &meta, QudaParity parity, size_t nvec);
+
+      Writer(const Writer &) = delete;
+      Writer &operator=(const Writer &) = delete;
+      ~Writer();
+
+      /** @return The file being written */
+      const std::string &Filename() const { return filename; }
+
+      /**
+         @brief Write vectors to the file.  This is a local operation.
+         @param[in] vecs The vectors to write, which must match the meta field
+         @param[in] first The index in the file of the first vector
+       */
+      void write(cvector_ref<const ColorSpinorField> &vecs, size_t first);
+
+      /**
+         @brief Finalize the file, writing the checksums to the header
+       */
+      void close();
+    };
+
+    /**
+       Reader for a native file.  The constructor and close() are
+       collective over all ranks, while read() only does local file
+       I/O, so may be called from a helper thread to overlap the
+       reading with other work.
+     */
+    class Reader
+    {
+      const std::string filename;
+      const Geometry g;
+      const int nColor;
+      const int nSpin;
+      size_t nvec_;
+      bool file_full;
+      QudaPrecision file_prec;
+      lat_dim_t W;  /** Partitioning of the writer */
+      lat_dim_t Lw; /** Local dimensions of the writer */
+      size_t Vw;
+      size_t block_bytes;
+      size_t vec_bytes;
+      size_t payload;
+      int fd = -1;
+      std::vector<uint64_t> expected;                     /** Checksum of each vector in the file */
+      std::vector<std::pair<size_t, uint64_t>> checksums; /** Local checksums of the vectors read */
+      std::vector<char> staging;                          /** Staging buffer in the file precision */
+      size_t bytes = 0;                                   /** Bytes read */
+      double time = 0.0;                                  /** Time spent reading */
+
+    public:
+      /**
+         @brief Open a native file
+         @param[in] filename The file to read
+         @param[in] meta Field with the geometry to read, which must be
+         a host field in space-spin-color order
+         @param[in] parity The parity of the fields if they are single parity
+       */
+      Reader(const std::string &filename, const ColorSpinorField &meta, QudaParity parity);
+
+      Reader(const Reader &) = delete;
+      Reader &operator=(const Reader &) = delete;
+      ~Reader();
+
+      /** @return The number of vectors in the file */
+      size_t nvec() const { return nvec_; }
+
+      /**
+         @brief Read vectors from the file, converting to their
+         precision.  This is a local operation.
+         @param[in] vecs The vectors to read into, which must match the meta field
+         @param[in] first The index in the file of the first vector
+       */
+      void read(cvector_ref<ColorSpinorField> &vecs, size_t first);
+
+      /**
+         @brief Close the file, verifying the checksums of the vectors
+         read.  The checksums can only be verified if the field subset
+         matches that in the file.
+       */
+      void close();
+    };
+
+    /**
+       @brief Write a set of vector fields to a file in the native
+       format.  This is collective over all ranks.  The fields must be
+       host fields in space-spin-color order, and are written in their
+       own precision.
+       @param[in] filename The file to write
+       @param[in] vecs The fields to write
+       @param[in] parity The parity of the fields if they are single parity
+     */
+    void write(const std::string &filename, cvector_ref<const ColorSpinorField> &vecs, QudaParity parity);
+
+    /**
+       @brief Read a set of vector fields from a file in the native
+       format.  This is collective over all ranks.  The fields must be
+       host fields in space-spin-color order, and the file data are
+       converted to their precision.  A single-parity field may be read
+       from a file holding full fields.
+       @param[in] filename The file to read
+       @param[in] vecs The fields to read into
+       @param[in] parity The parity of the fields if they are single parity
+     */
+    void read(const std::string &filename, cvector_ref<ColorSpinorField> &vecs, QudaParity parity);
+
+  } // namespace native_io
+
+} // namespace quda
@@ -0,0 +1,149 @@
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <async_io.h>
+#include <util_quda.h>
+
+namespace quda
+{
+
+  namespace async_io
+  {
+
+    namespace
+    {
+
+      struct Job {
+        std::unique_ptr<native_io::Writer> writer;
+        std::vector<ColorSpinorField> staging;
+        size_t bytes = 0;
+        bool done = false; /** Set by the I/O thread once the local writes are complete */
+      };
+
+      std::mutex mutex;
+      std::condition_variable cv;
+      std::deque<std::unique_ptr<Job>> jobs; // pending jobs in submission order
+      std::deque<Job *> queue;               // jobs not yet started by the I/O thread
+      std::thread thread;
+      bool stop = false;
+      size_t staged = 0; // staging bytes held by pending jobs
+
+      void io_thread()
+      {
+        while (true) {
+          Job *job;
+          {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [] { return stop || !queue.empty(); });
+            if (queue.empty()) return;
+            job = queue.front();
+            queue.pop_front();
+          }
+
+          job->writer->write({job->staging.begin(), job->staging.end()}, 0);
+
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            job->done = true;
+          }
+          cv.notify_all();
+        }
+      }
+
+      /**
+         @brief Wait for the oldest job to be written, then complete it
+       */
+      void retire()
+      {
+        auto &job = jobs.front();
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          cv.wait(lock, [&] { return job->done; });
+        }
+        job->writer->close();
+        staged -= job->bytes;
+        jobs.pop_front();
+      }
+
+    } // namespace
+
+    bool enabled()
+    {
+      static const bool enable = [] {
+        char *enable_str = getenv("QUDA_ENABLE_ASYNC_IO");
+        return enable_str && strcmp(enable_str, "1") == 0;
+      }();
+      return enable;
+    }
+
+    size_t budget()
+    {
+      static const size_t budget = [] {
+        char *budget_str = getenv("QUDA_ASYNC_IO_BUDGET");
+        long budget = 4096;
+        if (budget_str) {
+          budget = atol(budget_str);
+          if (budget < 0) errorQuda("Invalid QUDA_ASYNC_IO_BUDGET=%s", budget_str);
+        }
+        return static_cast<size_t>(budget) << 20;
+      }();
+      return budget;
+    }
+
+    void reserve(size_t bytes)
+    {
+      while (!jobs.empty() && staged + bytes > budget()) retire();
+    }
+
+    void submit(std::unique_ptr<native_io::Writer> &&writer, std::vector<ColorSpinorField> &&staging)
+    {
+      auto job = std::make_unique<Job>();
+      job->writer = std::move(writer);
+      job->staging = std::move(staging);
+      for (auto &s : job->staging) job->bytes += s.Bytes();
+      staged += job->bytes;
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!thread.joinable()) {
+          stop = false;
+          thread = std::thread(io_thread);
+        }
+        queue.push_back(job.get());
+      }
+      cv.notify_all();
+
+      logQuda(QUDA_VERBOSE, "Queued asynchronous write of %s (%.1f MiB staged, %lu pending)\n",
+              job->writer->Filename().c_str(), staged / (double)(1 << 20), jobs.size() + 1);
+      jobs.push_back(std::move(job));
+    }
+
+    void flush(const std::string &filename)
+    {
+      size_t n = jobs.size();
+      if (!filename.empty()) {
+        n = 0;
+        for (auto i = 0u; i < jobs.size(); i++)
+          if (jobs[i]->writer->Filename() == filename) n = i + 1;
+      }
+      for (auto i = 0u; i < n; i++) retire();
+    }
+
+    size_t pending() { return jobs.size(); }
+
+    void destroy()
+    {
+      flush();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+      }
+      cv.notify_all();
+      if (thread.joinable()) thread.join();
+    }
+
+  } // namespace async_io
+
+} // namespace quda
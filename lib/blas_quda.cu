@@ -1,4 +1,5 @@
 #include <blas_quda.h>
+#include <solver_telemetry.h>
 #include <color_spinor_field.h>
 #include <tunable_nd.h>
 #include <kernels/blas_core.cuh>
@@ -55,7 +56,10 @@ namespace quda {
           strcat(aux, y.AuxString().c_str());
         }
 
-        apply(device::get_default_stream());
+        {
+          SolverTelemetry::Region region(SolverTelemetry::BLAS);
+          apply(device::get_default_stream());
+        }
 
         blas::bytes += bytes();
         blas::flops += flops();
@@ -129,6 +129,9 @@ void printQudaGaugeParam(QudaGaugeParam *param) {
   P(gauge_offset, 0);
   P(mom_offset, 0);
   P(site_size, 0);
+  P(checksum_precision, QUDA_INVALID_PRECISION);
+  P(checksum_a, 0u);
+  P(checksum_b, 0u);
 #else
   P(overwrite_mom, INVALID_INT);
   P(use_resident_gauge, INVALID_INT);
@@ -536,7 +539,7 @@ void printQudaInvertParam(QudaInvertParam *param) {
   P(gcrNkrylov, INVALID_INT);
 #else
   if (param->inv_type == QUDA_GCR_INVERTER || param->inv_type == QUDA_BICGSTABL_INVERTER
-      || quda::is_ca_solver(param->inv_type)) {
+      || param->inv_type == QUDA_IDR_INVERTER || quda::is_ca_solver(param->inv_type)) {
     P(gcrNkrylov, INVALID_INT);
   }
 #endif
@@ -673,6 +676,33 @@ void printQudaInvertParam(QudaInvertParam *param) {
   P(eigenval_tol, INVALID_DOUBLE);
 #endif
 
+#if defined INIT_PARAM
+  P(preserve_recycle, QUDA_BOOLEAN_FALSE);
+  P(preserve_recycle_space, 0);
+#else
+  P(preserve_recycle, QUDA_BOOLEAN_INVALID);
+#endif
+
+#if defined INIT_PARAM
+  P(batched_multi_src, QUDA_BOOLEAN_FALSE);
+#else
+  P(batched_multi_src, QUDA_BOOLEAN_INVALID);
+#endif
+
+#if defined INIT_PARAM
+  P(precision_ladder, QUDA_BOOLEAN_FALSE);
+  P(precision_ladder_check, 100);
+#else
+  P(precision_ladder, QUDA_BOOLEAN_INVALID);
+  P(precision_ladder_check, INVALID_INT);
+#endif
+
+#ifdef INIT_PARAM
+  P(precision_ladder_promotions, 0);
+#elif defined(PRINT_PARAM)
+  P(precision_ladder_promotions, INVALID_INT);
+#endif
+
 #if defined INIT_PARAM
   P(use_resident_solution, 0);
   P(make_resident_solution, 0);
@@ -1002,6 +1032,12 @@ void printQudaMultigridParam(QudaMultigridParam *param) {
   P(thin_update_only, QUDA_BOOLEAN_INVALID);
 #endif
 
+#ifdef INIT_PARAM
+  P(checkpoint_restored, QUDA_BOOLEAN_FALSE);
+#else
+  P(checkpoint_restored, QUDA_BOOLEAN_INVALID);
+#endif
+
 #ifdef INIT_PARAM
   return ret;
 #endif
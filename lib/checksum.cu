@@ -1,4 +1,11 @@
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <sched.h>
 #include <gauge_field_order.h>
+#include <index_helper.cuh>
+#include <crc32.h>
 
 namespace quda {
 
@@ -9,78 +16,246 @@ namespace quda {
     typedef typename gauge_order_mapper<T,order,Nc>::type G;
     const G U;
     const int volumeCB;
-    ChecksumArg(const GaugeField &U, bool mini) : U(U), volumeCB(mini ? 1 : U.VolumeCB()) { }
+    lat_dim_t X;         // local dimensions
+    lat_dim_t offset;    // global coordinates of the local origin
+    lat_dim_t G_dim;     // global dimensions
+    const bool scidac;   // whether to compute the SciDAC checksum
+    const QudaPrecision file_precision;
+    const bool big_endian;
+    ChecksumArg(const GaugeField &U, bool mini, QudaPrecision file_precision, bool big_endian) :
+      U(U),
+      volumeCB(mini ? 1 : U.VolumeCB()),
+      scidac(!mini && file_precision != QUDA_INVALID_PRECISION),
+      file_precision(file_precision),
+      big_endian(big_endian)
+    {
+      for (int d = 0; d < 4; d++) {
+        X[d] = U.X()[d];
+        offset[d] = comm_coord(d) * X[d];
+        G_dim[d] = comm_dim(d) * X[d];
+      }
+    }
   };
 
   template <typename Arg>
   __device__ __host__ inline uint64_t siteChecksum(const Arg &arg, int d, int parity, int x_cb) {
     const Matrix<complex<typename Arg::real>,Arg::nColor> u = arg.U(d, x_cb, parity);
-    return u.checksum(); 
+    return u.checksum();
+  }
+
+  /**
+     @brief Store a value in the file representation for the SciDAC checksum
+   */
+  template <typename F> inline char *store(char *buf, double value, bool swap)
+  {
+    F f = value;
+    char *b = reinterpret_cast<char *>(&f);
+    if (swap) std::reverse(b, b + sizeof(F));
+    memcpy(buf, b, sizeof(F));
+    return buf + sizeof(F);
+  }
+
+  /**
+     @brief Add a site to the SciDAC checksum, with the links
+     serialized as in ILDG and SciDAC files: for each direction the
+     row-major color matrix, in the file precision and byte order
+   */
+  template <typename Arg>
+  inline void siteScidac(const Arg &arg, crc::ScidacChecksum &sum, std::vector<char> &buf, int parity, int x_cb)
+  {
+    const uint16_t one = 1;
+    const bool swap = arg.big_endian == (*reinterpret_cast<const char *>(&one) == 1);
+
+    char *p = buf.data();
+    for (int d = 0; d < arg.U.geometry; d++) {
+      const Matrix<complex<typename Arg::real>, Arg::nColor> u = arg.U(d, x_cb, parity);
+      for (int i = 0; i < Arg::nColor; i++) {
+        for (int j = 0; j < Arg::nColor; j++) {
+          if (arg.file_precision == QUDA_DOUBLE_PRECISION) {
+            p = store<double>(p, u(i, j).real(), swap);
+            p = store<double>(p, u(i, j).imag(), swap);
+          } else {
+            p = store<float>(p, u(i, j).real(), swap);
+            p = store<float>(p, u(i, j).imag(), swap);
+          }
+        }
+      }
+    }
+
+    int x[4];
+    getCoords(x, x_cb, arg.X, parity);
+    uint64_t rank = 0;
+    for (int d = 3; d >= 0; d--) rank = rank * arg.G_dim[d] + arg.offset[d] + x[d];
+    sum.add(rank, buf.data(), buf.size());
+  }
+
+  /**
+     @return The number of host threads used for checksums, set with
+     QUDA_CHECKSUM_THREADS (default is the number of cores in the
+     affinity mask of the process, so that ranks sharing a node do not
+     oversubscribe it)
+   */
+  static int checksum_threads()
+  {
+    static const int n = [] {
+      char *n_str = getenv("QUDA_CHECKSUM_THREADS");
+      if (n_str) {
+        int n = atoi(n_str);
+        if (n <= 0) errorQuda("Invalid QUDA_CHECKSUM_THREADS=%s", n_str);
+        return n;
+      }
+      cpu_set_t mask;
+      if (sched_getaffinity(0, sizeof(mask), &mask) == 0) return std::max(CPU_COUNT(&mask), 1);
+      return std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    }();
+    return n;
   }
 
   template <typename Arg>
-  uint64_t ChecksumCPU(const Arg &arg)
+  GaugeChecksum ChecksumCPU(const Arg &arg)
+  {
+    const size_t sites = 2 * static_cast<size_t>(arg.volumeCB);
+    const int n_thread = std::min(static_cast<size_t>(checksum_threads()), std::max(sites / 1024, size_t(1)));
+    std::vector<GaugeChecksum> partial(n_thread);
+    const size_t site_bytes = arg.scidac ? arg.U.geometry * Arg::nColor * Arg::nColor * 2 * arg.file_precision : 0;
+
+    // each thread handles a contiguous range of sites, and the partial checksums are combined with XOR
+    auto work = [&](int t) {
+      uint64_t checksum_ = 0;
+      crc::ScidacChecksum sum;
+      std::vector<char> buf(site_bytes);
+      for (size_t s = (sites * t) / n_thread; s < (sites * (t + 1)) / n_thread; s++) {
+        int parity = s / arg.volumeCB;
+        int x_cb = s % arg.volumeCB;
+        for (int d = 0; d < arg.U.geometry; d++) checksum_ ^= siteChecksum(arg, d, parity, x_cb);
+        if (arg.scidac) siteScidac(arg, sum, buf, parity, x_cb);
+      }
+      partial[t] = {checksum_, sum.suma, sum.sumb};
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < n_thread; t++) threads.emplace_back(work, t);
+    work(0);
+    for (auto &t : threads) t.join();
+
+    GaugeChecksum checksum;
+    for (auto &p : partial) {
+      checksum.xor_sum ^= p.xor_sum;
+      checksum.suma ^= p.suma;
+      checksum.sumb ^= p.sumb;
+    }
+    return checksum;
+  }
+
+  template <typename T, QudaGaugeFieldOrder order, int Nc>
+  GaugeChecksum Checksum(const GaugeField &u, bool mini, QudaPrecision file_precision, bool big_endian)
   {
-    uint64_t checksum_ = 0;
-    for (int parity=0; parity<2; parity++)
-      for (int x_cb=0; x_cb<arg.volumeCB; x_cb++)
-	for (int d=0; d<arg.U.geometry; d++)
-	  checksum_ ^= siteChecksum(arg, d, parity, x_cb);
-    return checksum_;
+    ChecksumArg<T, order, Nc> arg(u, mini, file_precision, big_endian);
+    return ChecksumCPU(arg);
   }
 
   template <typename T, int Nc>
-  uint64_t Checksum(const GaugeField &u, bool mini)
+  GaugeChecksum Checksum(const GaugeField &u, bool mini, QudaPrecision file_precision, bool big_endian)
   {
-    uint64_t checksum = 0;
+    GaugeChecksum checksum;
     if (u.Order() == QUDA_QDP_GAUGE_ORDER) {
-      ChecksumArg<T,QUDA_QDP_GAUGE_ORDER,Nc> arg(u,mini);
-      checksum = ChecksumCPU(arg);
+      checksum = Checksum<T, QUDA_QDP_GAUGE_ORDER, Nc>(u, mini, file_precision, big_endian);
     } else if (u.Order() == QUDA_QDPJIT_GAUGE_ORDER) {
-      ChecksumArg<T,QUDA_QDPJIT_GAUGE_ORDER,Nc> arg(u,mini);
-      checksum = ChecksumCPU(arg);
+      checksum = Checksum<T, QUDA_QDPJIT_GAUGE_ORDER, Nc>(u, mini, file_precision, big_endian);
     } else if (u.Order() == QUDA_MILC_GAUGE_ORDER) {
-      ChecksumArg<T,QUDA_MILC_GAUGE_ORDER,Nc> arg(u,mini);
-      checksum = ChecksumCPU(arg);
+      checksum = Checksum<T, QUDA_MILC_GAUGE_ORDER, Nc>(u, mini, file_precision, big_endian);
+    } else if (u.Order() == QUDA_CPS_WILSON_GAUGE_ORDER) {
+      checksum = Checksum<T, QUDA_CPS_WILSON_GAUGE_ORDER, Nc>(u, mini, file_precision, big_endian);
     } else if (u.Order() == QUDA_BQCD_GAUGE_ORDER) {
-      ChecksumArg<T,QUDA_BQCD_GAUGE_ORDER,Nc> arg(u,mini);
-      checksum = ChecksumCPU(arg);
+      checksum = Checksum<T, QUDA_BQCD_GAUGE_ORDER, Nc>(u, mini, file_precision, big_endian);
     } else if (u.Order() == QUDA_TIFR_GAUGE_ORDER) {
-      ChecksumArg<T,QUDA_TIFR_GAUGE_ORDER,Nc> arg(u,mini);
-      checksum = ChecksumCPU(arg);
+      checksum = Checksum<T, QUDA_TIFR_GAUGE_ORDER, Nc>(u, mini, file_precision, big_endian);
     } else if (u.Order() == QUDA_TIFR_PADDED_GAUGE_ORDER) {
-      ChecksumArg<T,QUDA_TIFR_PADDED_GAUGE_ORDER,Nc> arg(u,mini);
-      checksum = ChecksumCPU(arg);
+      checksum = Checksum<T, QUDA_TIFR_PADDED_GAUGE_ORDER, Nc>(u, mini, file_precision, big_endian);
     } else {
-      errorQuda("Checksum not implemented");
-    }    
+      errorQuda("Checksum not implemented for order %d", u.Order());
+    }
 
     return checksum;
   }
 
   template <typename T>
-  uint64_t Checksum(const GaugeField &u, bool mini)
+  GaugeChecksum Checksum(const GaugeField &u, bool mini, QudaPrecision file_precision, bool big_endian)
   {
-    uint64_t checksum = 0;
+    GaugeChecksum checksum;
     switch (u.Ncolor()) {
-    case 3: checksum = Checksum<T,3>(u,mini); break;
+    case 3: checksum = Checksum<T, 3>(u, mini, file_precision, big_endian); break;
     default: errorQuda("Unsupported nColor = %d", u.Ncolor());
     }
     return checksum;
   }
 
-  uint64_t Checksum(const GaugeField &u, bool mini)
+  bool ChecksumInPlace(const GaugeField &u)
+  {
+    if (u.Location() != QUDA_CPU_FIELD_LOCATION) return false;
+    if (u.Precision() != QUDA_DOUBLE_PRECISION && u.Precision() != QUDA_SINGLE_PRECISION) return false;
+    switch (u.Order()) {
+    case QUDA_QDP_GAUGE_ORDER:
+    case QUDA_QDPJIT_GAUGE_ORDER:
+    case QUDA_MILC_GAUGE_ORDER:
+    case QUDA_CPS_WILSON_GAUGE_ORDER:
+    case QUDA_BQCD_GAUGE_ORDER:
+    case QUDA_TIFR_GAUGE_ORDER:
+    case QUDA_TIFR_PADDED_GAUGE_ORDER: return true;
+    default: return false;
+    }
+  }
+
+  /**
+     @brief Compute the checksums of a field, reduced over all ranks
+     @param[in] file_precision The precision of the SciDAC checksum,
+     or QUDA_INVALID_PRECISION to only compute the XOR checksum
+   */
+  static GaugeChecksum checksum(const GaugeField &u, bool mini, QudaPrecision file_precision, bool big_endian)
   {
-    uint64_t checksum = 0;
-    switch (u.Precision()) {
-    case QUDA_DOUBLE_PRECISION: checksum = Checksum<double>(u,mini); break;
-    case QUDA_SINGLE_PRECISION: checksum = Checksum<float>(u,mini); break;
-    default: errorQuda("Unsupported precision = %d", u.Precision());
+    // device and other orders are reordered to a host QDP-ordered copy
+    std::unique_ptr<GaugeField> tmp;
+    if (!ChecksumInPlace(u)) {
+      if (u.GhostExchange() == QUDA_GHOST_EXCHANGE_EXTENDED) errorQuda("Checksum of extended fields not supported");
+      GaugeFieldParam param(u);
+      param.location = QUDA_CPU_FIELD_LOCATION;
+      param.order = QUDA_QDP_GAUGE_ORDER;
+      param.reconstruct = QUDA_RECONSTRUCT_NO;
+      param.ghostExchange = QUDA_GHOST_EXCHANGE_NO;
+      param.create = QUDA_NULL_FIELD_CREATE;
+      param.setPrecision(std::max(u.Precision(), QUDA_SINGLE_PRECISION));
+      tmp.reset(GaugeField::Create(param));
+      tmp->copy(u);
+    }
+    const GaugeField &v = tmp ? *tmp : u;
+
+    GaugeChecksum checksum;
+    switch (v.Precision()) {
+    case QUDA_DOUBLE_PRECISION: checksum = Checksum<double>(v, mini, file_precision, big_endian); break;
+    case QUDA_SINGLE_PRECISION: checksum = Checksum<float>(v, mini, file_precision, big_endian); break;
+    default: errorQuda("Unsupported precision = %d", v.Precision());
     }
 
-    comm_allreduce_xor(checksum);
+    uint64_t scidac = crc::ScidacChecksum {checksum.suma, checksum.sumb}.pack();
+    comm_allreduce_xor(checksum.xor_sum);
+    comm_allreduce_xor(scidac);
+    checksum.suma = scidac >> 32;
+    checksum.sumb = scidac & 0xffffffffu;
 
     return checksum;
   }
 
+  GaugeChecksum Checksums(const GaugeField &u, QudaPrecision file_precision, bool big_endian)
+  {
+    if (file_precision == QUDA_INVALID_PRECISION) file_precision = std::max(u.Precision(), QUDA_SINGLE_PRECISION);
+    if (file_precision != QUDA_DOUBLE_PRECISION && file_precision != QUDA_SINGLE_PRECISION)
+      errorQuda("Unsupported file precision = %d", file_precision);
+    return checksum(u, false, file_precision, big_endian);
+  }
+
+  uint64_t Checksum(const GaugeField &u, bool mini)
+  {
+    return checksum(u, mini, QUDA_INVALID_PRECISION, true).xor_sum;
+  }
+
 }
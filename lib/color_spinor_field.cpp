@@ -857,6 +857,27 @@ namespace quda
     return FieldTmp<ColorSpinorField>(key, param);
   }
 
+  FieldTmp<ColorSpinorField> ColorSpinorField::create_batch(cvector_ref<const ColorSpinorField> &v)
+  {
+    if (v[0].Ndim() == 5) errorQuda("Cannot batch together 5-d fields");
+    ColorSpinorParam param(v[0]);
+    param.nDim++;
+    param.x[param.nDim - 1] = v.size();
+    param.pc_type = QUDA_4D_PC;
+    param.create = QUDA_NULL_FIELD_CREATE;
+
+    // we use a custom cache key to distinguish batches from 5-d fields
+    FieldKey<ColorSpinorField> key;
+    key.volume = v[0].VolString();
+    key.aux = v[0].AuxString();
+    char aux[32];
+    strcpy(aux, ",batch=");
+    u32toa(aux + 7, v.size());
+    key.aux += aux;
+
+    return FieldTmp<ColorSpinorField>(key, param);
+  }
+
   ColorSpinorField ColorSpinorField::create_alias(const ColorSpinorParam &param_)
   {
     if (param_.init && param_.Precision() > precision)
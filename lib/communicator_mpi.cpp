@@ -291,6 +291,18 @@ namespace quda
     }
   }
 
+  void Communicator::comm_allreduce_sum_array_start(double *data, size_t size)
+  {
+    if (allreduce_request != MPI_REQUEST_NULL) errorQuda("Non-blocking reduction already in flight");
+    if (!comm_deterministic_reduce()) {
+      MPI_CHECK(MPI_Iallreduce(MPI_IN_PLACE, data, size, MPI_DOUBLE, MPI_SUM, MPI_COMM_HANDLE, &allreduce_request));
+    } else {
+      comm_allreduce_sum_array(data, size);
+    }
+  }
+
+  void Communicator::comm_allreduce_wait() { MPI_CHECK(MPI_Wait(&allreduce_request, MPI_STATUS_IGNORE)); }
+
   void Communicator::comm_allreduce_max_array(deviation_t<double> *data, size_t size)
   {
     size_t n = comm_size();
@@ -354,4 +366,12 @@ namespace quda
     return rank;
   }
 
+  int Communicator::comm_tag_ub()
+  {
+    int *tag_ub;
+    int flag;
+    MPI_CHECK(MPI_Comm_get_attr(MPI_COMM_WORLD, MPI_TAG_UB, &tag_ub, &flag));
+    return flag ? *tag_ub : 32767;
+  }
+
 } // namespace quda
@@ -318,6 +318,19 @@ void Communicator::comm_allreduce_sum_array(double *data, size_t size)
   }
 }
 
+// QMP has no non-blocking reductions, so we call MPI directly
+void Communicator::comm_allreduce_sum_array_start(double *data, size_t size)
+{
+  if (allreduce_request != MPI_REQUEST_NULL) errorQuda("Non-blocking reduction already in flight");
+  if (!comm_deterministic_reduce()) {
+    MPI_CHECK(MPI_Iallreduce(MPI_IN_PLACE, data, size, MPI_DOUBLE, MPI_SUM, MPI_COMM_HANDLE, &allreduce_request));
+  } else {
+    comm_allreduce_sum_array(data, size);
+  }
+}
+
+void Communicator::comm_allreduce_wait() { MPI_CHECK(MPI_Wait(&allreduce_request, MPI_STATUS_IGNORE)); }
+
 void Communicator::comm_allreduce_max_array(deviation_t<double> *data, size_t size)
 {
   size_t n = comm_size();
@@ -366,4 +379,7 @@ void Communicator::comm_abort_(int status) { QMP_abort(status); }
 
 int Communicator::comm_rank_global() { return QMP_get_node_number(); }
 
+// QMP does not use message tags, so report the minimum bound required by MPI
+int Communicator::comm_tag_ub() { return 32767; }
+
 } // namespace quda
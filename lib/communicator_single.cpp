@@ -83,6 +83,10 @@ namespace quda
 
   void Communicator::comm_allreduce_sum_array(double *, size_t) { }
 
+  void Communicator::comm_allreduce_sum_array_start(double *, size_t) { }
+
+  void Communicator::comm_allreduce_wait() { }
+
   void Communicator::comm_allreduce_max_array(deviation_t<double> *, size_t) { }
 
   void Communicator::comm_allreduce_max_array(double *, size_t) { }
@@ -101,4 +105,6 @@ namespace quda
 
   int Communicator::comm_rank_global() { return 0; }
 
+  int Communicator::comm_tag_ub() { return 32767; }
+
 } // namespace quda
@@ -95,6 +95,8 @@ namespace quda
 
   int comm_rank_global(void) { return Communicator::comm_rank_global(); }
 
+  int comm_tag_ub(void) { return Communicator::comm_tag_ub(); }
+
   size_t comm_size(void) { return get_current_communicator().comm_size(); }
 
   // XXX:
@@ -184,6 +186,13 @@ namespace quda
     get_current_communicator().comm_allreduce_sum_array(data, size);
   }
 
+  void comm_allreduce_sum_array_start(double *data, size_t size)
+  {
+    get_current_communicator().comm_allreduce_sum_array_start(data, size);
+  }
+
+  void comm_allreduce_wait() { get_current_communicator().comm_allreduce_wait(); }
+
   template <> void comm_allreduce_sum<std::vector<double>>(std::vector<double> &a)
   {
     comm_allreduce_sum_array(a.data(), a.size());
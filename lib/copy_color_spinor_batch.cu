@@ -0,0 +1,74 @@
+#include <color_spinor_field.h>
+#include <tunable_nd.h>
+#include <instantiate.h>
+#include <kernels/copy_color_spinor_batch.cuh>
+
+namespace quda
+{
+
+  template <typename Float, int nColor> class CopyColorSpinorBatch : public TunableKernel2D
+  {
+    ColorSpinorField &out;
+    const ColorSpinorField &in;
+    const ColorSpinorField &slice; // the unbatched field
+    const int out_offset;
+    const int in_offset;
+    unsigned int minThreads() const { return slice.VolumeCB(); }
+
+  public:
+    CopyColorSpinorBatch(ColorSpinorField &out, const ColorSpinorField &in, const ColorSpinorField &slice,
+                         int out_offset, int in_offset) :
+      TunableKernel2D(slice, slice.SiteSubset()),
+      out(out),
+      in(in),
+      slice(slice),
+      out_offset(out_offset),
+      in_offset(in_offset)
+    {
+      strcat(aux, out.Ndim() > in.Ndim() ? ",to_batch" : ",from_batch");
+      apply(device::get_default_stream());
+    }
+
+    void apply(const qudaStream_t &stream)
+    {
+      TuneParam tp = tuneLaunch(*this, getTuning(), getVerbosity());
+      if (in.Nspin() == 4) {
+        launch<CopyBatch>(tp, stream, CopyBatchArg<Float, 4, nColor>(out, in, slice.VolumeCB(), out_offset, in_offset));
+      } else {
+        errorQuda("Unsupported spin = %d", in.Nspin());
+      }
+    }
+
+    long long flops() const { return 0; }
+    long long bytes() const { return 2 * slice.Bytes(); }
+  };
+
+  /**
+     @brief Check that batch holds v as slices of its outermost dimension
+   */
+  template <typename T> static void checkBatch(const ColorSpinorField &batch, cvector_ref<T> &v)
+  {
+    if (v.size() == 0) errorQuda("Empty batch");
+    if (batch.Ndim() != v[0].Ndim() + 1 || batch.X(batch.Ndim() - 1) != static_cast<int>(v.size()))
+      errorQuda("Batched field does not hold %lu fields", v.size());
+    for (auto i = 0u; i < v.size(); i++) {
+      checkPrecision(batch, v[i]);
+      checkLocation(batch, v[i]);
+      if (v[i].VolumeCB() * static_cast<int>(v.size()) != batch.VolumeCB() || v[i].SiteSubset() != batch.SiteSubset())
+        errorQuda("Field %u does not match a slice of the batched field", i);
+    }
+  }
+
+  void copyToBatch(ColorSpinorField &batch, cvector_ref<const ColorSpinorField> &v)
+  {
+    checkBatch(batch, v);
+    for (auto i = 0u; i < v.size(); i++) instantiate<CopyColorSpinorBatch>(batch, v[i], v[i], i * v[i].VolumeCB(), 0);
+  }
+
+  void copyFromBatch(cvector_ref<ColorSpinorField> &v, const ColorSpinorField &batch)
+  {
+    checkBatch(batch, v);
+    for (auto i = 0u; i < v.size(); i++) instantiate<CopyColorSpinorBatch>(v[i], batch, v[i], 0, i * v[i].VolumeCB());
+  }
+
+} // namespace quda
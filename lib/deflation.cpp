@@ -21,6 +21,7 @@ namespace quda
     r_sloppy(nullptr),
     Av_sloppy(nullptr)
   {
+    MemoryPhase memory_phase("deflation");
     // for reporting level 1 is the fine level but internally use level 0 for indexing
     printfQuda("Creating deflation space of %d vectors.\n", param.tot_dim);
 
@@ -167,6 +168,7 @@ if( param.eig_global.extlib_type == QUDA_EIGEN_EXTLIB ) {
       errorQuda("Method is not implemented for %d inverter type", param.eig_global.invert_param->inv_type);
 
     if (n_ev == 0) return; // nothing to do
+    MemoryPhase memory_phase("deflation");
 
     const int first_idx = param.cur_dim;
 
@@ -33,6 +33,48 @@ namespace quda {
     initializeCoarse();
   }
 
+  DiracCoarse::DiracCoarse(const DiracParam &param, bool gpu_setup, bool mapped,
+                           const std::function<void(const std::vector<GaugeField *> &)> &restore) :
+    Dirac(param),
+    mass(param.mass),
+    mu(param.mu),
+    mu_factor(param.mu_factor),
+    transfer(param.transfer),
+    dirac(param.dirac),
+    need_bidirectional(param.need_bidirectional),
+    allow_truncation(param.allow_truncation),
+    use_mma(param.use_mma),
+    Y_h(nullptr),
+    X_h(nullptr),
+    Xinv_h(nullptr),
+    Yhat_h(nullptr),
+    Y_d(nullptr),
+    X_d(nullptr),
+    Xinv_d(nullptr),
+    Yhat_d(nullptr),
+    enable_gpu(false),
+    enable_cpu(false),
+    gpu_setup(gpu_setup),
+    init_gpu(false),
+    init_cpu(false),
+    mapped(mapped)
+  {
+    // the fields are restored on the host, with the halos then exchanged as when computing them
+    createY(false);
+    createYhat(false);
+    restore({Y_h, X_h, Xinv_h, Yhat_h});
+    Y_h->exchangeGhost(QUDA_LINK_BIDIRECTIONAL);
+    Yhat_h->exchangeGhost(QUDA_LINK_FORWARDS);
+    enable_cpu = true;
+    init_cpu = true;
+
+    if (gpu_setup) {
+      initializeLazy(QUDA_CUDA_FIELD_LOCATION);
+      Y_d->exchangeGhost(QUDA_LINK_BIDIRECTIONAL);
+      Yhat_d->exchangeGhost(QUDA_LINK_FORWARDS);
+    }
+  }
+
   DiracCoarse::DiracCoarse(const DiracParam &param, cpuGaugeField *Y_h, cpuGaugeField *X_h, cpuGaugeField *Xinv_h,
                            cpuGaugeField *Yhat_h, // cpu link fields
                            cudaGaugeField *Y_d, cudaGaugeField *X_d, cudaGaugeField *Xinv_d,
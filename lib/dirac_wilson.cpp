@@ -128,6 +128,35 @@ namespace quda {
     Mdag(out, tmp);
   }
 
+  void DiracWilsonPC::M(cvector_ref<ColorSpinorField> &out, cvector_ref<const ColorSpinorField> &in) const
+  {
+    if (in.size() == 1) {
+      M(out[0], in[0]);
+      return;
+    }
+
+    // the Wilson dslash applies to a batched field with the batch index as the fifth dimension
+    auto in_batch = ColorSpinorField::create_batch(in);
+    auto out_batch = ColorSpinorField::create_batch(in);
+    copyToBatch(in_batch, in);
+    M(static_cast<ColorSpinorField &>(out_batch), static_cast<ColorSpinorField &>(in_batch));
+    copyFromBatch(out, out_batch);
+  }
+
+  void DiracWilsonPC::MdagM(cvector_ref<ColorSpinorField> &out, cvector_ref<const ColorSpinorField> &in) const
+  {
+    if (in.size() == 1) {
+      MdagM(out[0], in[0]);
+      return;
+    }
+
+    auto in_batch = ColorSpinorField::create_batch(in);
+    auto out_batch = ColorSpinorField::create_batch(in);
+    copyToBatch(in_batch, in);
+    MdagM(static_cast<ColorSpinorField &>(out_batch), static_cast<ColorSpinorField &>(in_batch));
+    copyFromBatch(out, out_batch);
+  }
+
   void DiracWilsonPC::prepare(ColorSpinorField *&src, ColorSpinorField *&sol, ColorSpinorField &x, ColorSpinorField &b,
                               const QudaSolutionType solType) const
   {
@@ -44,7 +44,11 @@ namespace quda
       WilsonArg<Float, nColor, nDim, recon> arg(out, in, U, a, x, parity, dagger, comm_override);
       Wilson<decltype(arg)> wilson(arg, out, in);
 
-      dslash::DslashPolicyTune<decltype(wilson)> policy(wilson, in, in.VolumeCB(), in.GhostFaceCB(), profile);
+      // a batch of fields along a fifth dimension shares the gauge field, with the batch index on the y thread
+      // dimension, so the thread counts are those of a single field
+      const auto &dc = in.getDslashConstant();
+      dslash::DslashPolicyTune<decltype(wilson)> policy(wilson, in, dc.volume_4d_cb,
+                                                        in.Ndim() == 5 ? dc.ghostFaceCB : in.GhostFaceCB(), profile);
     }
   };
 
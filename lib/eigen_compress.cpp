@@ -0,0 +1,347 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include <externals/json.hpp>
+#include <blas_quda.h>
+#include <eigen_compress.h>
+#include <timer.h>
+#include <transfer.h>
+#include <vector_io_native.h>
+
+namespace quda
+{
+
+  namespace eigen_compress
+  {
+
+    using json = nlohmann::json;
+
+    namespace
+    {
+
+      constexpr int format_version = 1;
+      constexpr size_t max_manifest_bytes = 1 << 24;
+
+      /** @return The number of basis vectors set with QUDA_EIGEN_COMPRESS_NBASIS (0 if disabled) */
+      int n_basis()
+      {
+        static const int n = [] {
+          char *n_str = getenv("QUDA_EIGEN_COMPRESS_NBASIS");
+          int n = n_str ? atoi(n_str) : 0;
+          if (n < 0) errorQuda("Invalid QUDA_EIGEN_COMPRESS_NBASIS=%s", n_str);
+          return n;
+        }();
+        return n;
+      }
+
+      /** @return The block size set with QUDA_EIGEN_COMPRESS_BLOCK */
+      std::vector<int> block_size()
+      {
+        static const std::vector<int> block = [] {
+          std::vector<int> block;
+          char *block_str = getenv("QUDA_EIGEN_COMPRESS_BLOCK");
+          std::stringstream ss(block_str ? block_str : "4,4,4,4");
+          for (std::string b; std::getline(ss, b, ',');) block.push_back(std::stoi(b));
+          if (block.size() != 4 || *std::min_element(block.begin(), block.end()) <= 0)
+            errorQuda("Invalid QUDA_EIGEN_COMPRESS_BLOCK=%s", block_str);
+          return block;
+        }();
+        return block;
+      }
+
+      /** @return Parameters of a host field for file I/O of a given field */
+      ColorSpinorParam host_param(const ColorSpinorField &v, QudaPrecision prec)
+      {
+        ColorSpinorParam param(v);
+        param.location = QUDA_CPU_FIELD_LOCATION;
+        param.mem_type = QUDA_MEMORY_PINNED;
+        param.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
+        param.setPrecision(prec);
+        param.create = QUDA_NULL_FIELD_CREATE;
+        return param;
+      }
+
+      std::string basis_file(const std::string &filename) { return filename + ".basis"; }
+      std::string coeff_file(const std::string &filename) { return filename + ".coeff"; }
+
+      /**
+         @brief Read the manifest on rank 0 and broadcast it
+         @param[in] filename The manifest file
+         @param[in] require Whether failing to parse the manifest is an error
+         @return The manifest, or a discarded value if not a valid manifest
+       */
+      json read_manifest(const std::string &filename, bool require)
+      {
+        std::string manifest;
+        uint64_t length = 0;
+        if (comm_rank() == 0) {
+          int fd = open(filename.c_str(), O_RDONLY);
+          if (fd >= 0) {
+            char first;
+            // cheap rejection of binary files before reading the whole file
+            if (pread(fd, &first, 1, 0) == 1 && first == '{') {
+              off_t size = lseek(fd, 0, SEEK_END);
+              if (size > 0 && static_cast<size_t>(size) <= max_manifest_bytes) {
+                manifest.resize(size);
+                if (pread(fd, &manifest[0], size, 0) == size) length = size;
+              }
+            }
+            close(fd);
+          } else if (require) {
+            errorQuda("Failed to open %s (%s)", filename.c_str(), strerror(errno));
+          }
+        }
+        comm_broadcast(&length, sizeof(length));
+        manifest.resize(length);
+        if (length > 0) comm_broadcast(&manifest[0], length);
+
+        auto j = json::parse(manifest, nullptr, false);
+        if (!j.is_discarded() && (!j.is_object() || j.value("format", "") != "quda-compressed-eigenspace"))
+          j = json::value_t::discarded;
+        if (require && j.is_discarded()) errorQuda("%s is not a compressed eigenspace", filename.c_str());
+        return j;
+      }
+
+      /**
+         Work space for compression: full-parity device fields for the
+         basis vectors and the transfer operator built from them.
+       */
+      struct Codec {
+        QudaParity parity;
+        ColorSpinorParam param; /** Parameters of the full-parity work fields */
+        std::vector<ColorSpinorField> basis;
+        std::vector<ColorSpinorField *> B;
+        TimeProfile profile;
+        std::unique_ptr<Transfer> transfer;
+        ColorSpinorField fine;
+        std::unique_ptr<ColorSpinorField> coarse;
+
+        /**
+           @param[in] v Field with the geometry of the eigenvectors
+           @param[in] nbasis The number of basis vectors
+         */
+        Codec(const ColorSpinorField &v, int nbasis) :
+          parity(v.SuggestedParity()), param(v), basis(nbasis), profile("eigen_compress", false)
+        {
+          if (v.SiteSubset() == QUDA_PARITY_SITE_SUBSET) {
+            if (parity != QUDA_EVEN_PARITY && parity != QUDA_ODD_PARITY)
+              errorQuda("Single parity eigenvectors must have their suggested parity set");
+            param.x[0] *= 2;
+            param.siteSubset = QUDA_FULL_SITE_SUBSET;
+          }
+          param.create = QUDA_ZERO_FIELD_CREATE;
+          param.location = QUDA_CUDA_FIELD_LOCATION;
+          param.mem_type = QUDA_MEMORY_DEVICE;
+          param.setPrecision(QUDA_SINGLE_PRECISION, QUDA_SINGLE_PRECISION, true);
+          for (auto &b : basis) b = ColorSpinorField(param);
+          fine = ColorSpinorField(param);
+        }
+
+        /** @brief Copy an eigenvector into a full-parity field, leaving the other parity zero */
+        void embed(ColorSpinorField &full, const ColorSpinorField &v) const
+        {
+          if (v.SiteSubset() == QUDA_FULL_SITE_SUBSET) {
+            full = v;
+          } else {
+            blas::copy(parity == QUDA_EVEN_PARITY ? full.Even() : full.Odd(), v);
+          }
+        }
+
+        /** @brief Copy an eigenvector from a full-parity field */
+        void extract(ColorSpinorField &v, const ColorSpinorField &full) const
+        {
+          if (v.SiteSubset() == QUDA_FULL_SITE_SUBSET) {
+            v = full;
+          } else {
+            v = parity == QUDA_EVEN_PARITY ? full.Even() : full.Odd();
+          }
+        }
+
+        /**
+           @brief Block orthonormalize the basis vectors, which must have been set
+           @param[in] geo_bs The block size, which may be reduced to be compatible with the lattice
+         */
+        void create_transfer(std::vector<int> &geo_bs)
+        {
+          for (auto &b : basis) B.push_back(&b);
+          int spin_bs = param.nSpin == 1 ? 0 : param.nSpin / 2;
+          transfer = std::make_unique<Transfer>(B, B.size(), 2, false, geo_bs.data(), spin_bs, QUDA_SINGLE_PRECISION,
+                                                QUDA_TRANSFER_AGGREGATE, profile);
+          geo_bs.assign(transfer->Geo_bs(), transfer->Geo_bs() + 4);
+          coarse.reset(B[0]->CreateCoarse(geo_bs.data(), spin_bs, B.size(), QUDA_SINGLE_PRECISION));
+        }
+
+        /** @return Parameters of host coarse fields holding the coefficients */
+        ColorSpinorParam coeff_param() const
+        {
+          std::unique_ptr<ColorSpinorField> h(B[0]->CreateCoarse(transfer->Geo_bs(), transfer->Spin_bs(), B.size(),
+                                                                 QUDA_SINGLE_PRECISION, QUDA_CPU_FIELD_LOCATION));
+          ColorSpinorParam p(*h);
+          p.create = QUDA_NULL_FIELD_CREATE;
+          return p;
+        }
+      };
+
+    } // namespace
+
+    bool enabled() { return n_basis() > 0; }
+
+    bool is_compressed_file(const std::string &filename) { return !read_manifest(filename, false).is_discarded(); }
+
+    bool save(const std::string &filename, cvector_ref<const ColorSpinorField> &evecs, QudaPrecision prec)
+    {
+      const ColorSpinorField &v0 = evecs[0];
+      const int nbasis = n_basis();
+      if (v0.Ndim() != 4) {
+        warningQuda("Cannot compress %d-dimensional eigenvectors, saving uncompressed", v0.Ndim());
+        return false;
+      }
+      if (evecs.size() < static_cast<size_t>(nbasis)) {
+        warningQuda("Cannot compress %lu eigenvectors with %d basis vectors, saving uncompressed", evecs.size(), nbasis);
+        return false;
+      }
+
+      host_timer_t timer;
+      timer.start();
+      const QudaPrecision basis_prec = prec == QUDA_INVALID_PRECISION ? std::max(v0.Precision(), QUDA_SINGLE_PRECISION) :
+                                                                        prec;
+
+      // the lowest modes define the block basis, and are stored as is
+      Codec codec(v0, nbasis);
+      ColorSpinorField basis_h(host_param(v0, basis_prec));
+      {
+        native_io::Writer writer(basis_file(filename), basis_h, codec.parity, nbasis);
+        for (int i = 0; i < nbasis; i++) {
+          codec.embed(codec.basis[i], evecs[i]);
+          basis_h = evecs[i];
+          writer.write(basis_h, i);
+        }
+        writer.close();
+      }
+
+      std::vector<int> geo_bs = block_size();
+      codec.create_transfer(geo_bs);
+
+      // restrict each eigenvector onto the block basis, and measure the reconstruction error
+      ColorSpinorField coarse_h(codec.coeff_param());
+      ColorSpinorField recon(codec.param);
+      std::vector<double> error(evecs.size());
+      {
+        native_io::Writer writer(coeff_file(filename), coarse_h, QUDA_INVALID_PARITY, evecs.size());
+        for (auto i = 0u; i < evecs.size(); i++) {
+          codec.embed(codec.fine, evecs[i]);
+          double norm = blas::norm2(codec.fine);
+          codec.transfer->R(*codec.coarse, codec.fine);
+          coarse_h = *codec.coarse;
+          writer.write(coarse_h, i);
+
+          codec.transfer->P(recon, *codec.coarse);
+          error[i] = norm > 0.0 ? sqrt(blas::xmyNorm(codec.fine, recon) / norm) : 0.0;
+        }
+        writer.close();
+      }
+
+      const size_t uncompressed = evecs.size() * v0.Volume() * v0.Nspin() * v0.Ncolor() * 2 * basis_prec * comm_size();
+      const size_t compressed = (nbasis * v0.Volume() * v0.Nspin() * v0.Ncolor() * 2 * basis_prec
+                                 + evecs.size() * coarse_h.Volume() * coarse_h.Nspin() * coarse_h.Ncolor() * 2
+                                   * coarse_h.Precision())
+        * comm_size();
+
+      json manifest;
+      manifest["format"] = "quda-compressed-eigenspace";
+      manifest["version"] = format_version;
+      manifest["nvec"] = evecs.size();
+      manifest["nbasis"] = nbasis;
+      manifest["block"] = geo_bs;
+      manifest["spin_block"] = codec.transfer->Spin_bs();
+      manifest["subset"] = v0.SiteSubset() == QUDA_FULL_SITE_SUBSET ? "full" : "parity";
+      manifest["basis_file"] = basis_file(filename);
+      manifest["coeff_file"] = coeff_file(filename);
+      manifest["uncompressed_bytes"] = uncompressed;
+      manifest["compressed_bytes"] = compressed;
+      manifest["reconstruction_error"] = error;
+
+      if (comm_rank() == 0) {
+        const std::string str = manifest.dump(2);
+        int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) errorQuda("Failed to open %s (%s)", filename.c_str(), strerror(errno));
+        if (::write(fd, str.data(), str.size()) != static_cast<ssize_t>(str.size()))
+          errorQuda("Failed to write %s (%s)", filename.c_str(), strerror(errno));
+        close(fd);
+      }
+      comm_barrier();
+
+      timer.stop();
+      if (getVerbosity() >= QUDA_SUMMARIZE)
+        printfQuda("Compressed %lu eigenvectors to %s with %d basis vectors in %.3f s: %.1f MiB -> %.1f MiB (%.1fx), max "
+                   "relative reconstruction error %e\n",
+                   evecs.size(), filename.c_str(), nbasis, timer.last(), uncompressed / (double)(1 << 20),
+                   compressed / (double)(1 << 20), (double)uncompressed / compressed,
+                   *std::max_element(error.begin(), error.end()));
+      return true;
+    }
+
+    void load(const std::string &filename, cvector_ref<ColorSpinorField> &evecs)
+    {
+      host_timer_t timer;
+      timer.start();
+
+      auto manifest = read_manifest(filename, true);
+      if (manifest.at("version") > format_version) errorQuda("Unsupported version of %s", filename.c_str());
+      const size_t nvec = manifest.at("nvec").get<size_t>();
+      const int nbasis = manifest.at("nbasis").get<int>();
+      if (evecs.size() > nvec) errorQuda("%s contains %lu vectors, but %lu requested", filename.c_str(), nvec, evecs.size());
+      const ColorSpinorField &v0 = evecs[0];
+      if ((manifest.at("subset") == "full") != (v0.SiteSubset() == QUDA_FULL_SITE_SUBSET))
+        errorQuda("Site subset of %s does not match", filename.c_str());
+
+      // reconstruct the block basis, converting from the stored precision
+      Codec codec(v0, nbasis);
+      {
+        ColorSpinorField basis_h(host_param(v0, QUDA_DOUBLE_PRECISION));
+        native_io::Reader reader(manifest.at("basis_file").get<std::string>(), basis_h, codec.parity);
+        for (int i = 0; i < nbasis; i++) {
+          reader.read(basis_h, i);
+          codec.embed(codec.basis[i], basis_h);
+        }
+        reader.close();
+      }
+
+      auto geo_bs = manifest.at("block").get<std::vector<int>>();
+      auto requested_bs = geo_bs;
+      codec.create_transfer(geo_bs);
+      if (geo_bs != requested_bs) errorQuda("Block size of %s is not compatible with the lattice", filename.c_str());
+      if (codec.transfer->Spin_bs() != manifest.at("spin_block").get<int>())
+        errorQuda("Spin block size of %s does not match", filename.c_str());
+
+      // reconstruct each eigenvector by prolongation of its coefficients
+      ColorSpinorField coarse_h(codec.coeff_param());
+      native_io::Reader reader(manifest.at("coeff_file").get<std::string>(), coarse_h, QUDA_INVALID_PARITY);
+      for (auto i = 0u; i < evecs.size(); i++) {
+        reader.read(coarse_h, i);
+        *codec.coarse = coarse_h;
+        codec.transfer->P(codec.fine, *codec.coarse);
+        codec.extract(evecs[i], codec.fine);
+      }
+      reader.close();
+
+      timer.stop();
+      auto error = manifest.at("reconstruction_error").get<std::vector<double>>();
+      error.resize(evecs.size());
+      if (getVerbosity() >= QUDA_SUMMARIZE)
+        printfQuda("Reconstructed %lu eigenvectors from %s with %d basis vectors in %.3f s, max relative "
+                   "reconstruction error %e\n",
+                   evecs.size(), filename.c_str(), nbasis, timer.last(), *std::max_element(error.begin(), error.end()));
+      if (getVerbosity() >= QUDA_VERBOSE)
+        for (auto i = 0u; i < error.size(); i++) printfQuda("Eigenvector %u reconstruction error %e\n", i, error[i]);
+    }
+
+  } // namespace eigen_compress
+
+} // namespace quda
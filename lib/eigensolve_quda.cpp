@@ -15,6 +15,7 @@
 #include <util_quda.h>
 #include <tune_quda.h>
 #include <vector_io.h>
+#include <eigen_compress.h>
 #include <eigen_helper.h>
 
 namespace quda
@@ -254,9 +255,16 @@ namespace quda
       const QudaParity mat_parity = impliedParityFromMatPC(mat.getMatPCType());
       for (auto &k : kSpace) k.setSuggestedParity(mat_parity);
 
-      // save the vectors
-      VectorIO io(eig_param->vec_outfile, eig_param->io_parity_inflate == QUDA_BOOLEAN_TRUE);
-      io.save(kSpace, save_prec, n_eig);
+      // save the vectors, either compressed or in the background if asynchronous I/O is enabled; compression
+      // needs fine-grid vectors with the lowest modes first, so singular vectors and the eigenvectors of
+      // coarse-grid operators (e.g., within multigrid) are always saved as is
+      bool compress = eigen_compress::enabled() && !compute_svd && !mat.isCoarse();
+      if (eigen_compress::enabled() && !compress)
+        logQuda(QUDA_VERBOSE, "Saving %s uncompressed\n", compute_svd ? "singular vectors" : "coarse eigenvectors");
+      if (!compress || !eigen_compress::save(eig_param->vec_outfile, kSpace, save_prec)) {
+        VectorIO io(eig_param->vec_outfile, eig_param->io_parity_inflate == QUDA_BOOLEAN_TRUE);
+        io.save_async(kSpace, save_prec, n_eig);
+      }
     }
 
     mat.flops();
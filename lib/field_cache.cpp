@@ -1,47 +1,185 @@
+#include <list>
+#include <unordered_map>
+#include <sstream>
 #include <field_cache.h>
 #include <color_spinor_field.h>
+#include <gauge_field.h>
+#include <clover_field.h>
 
 namespace quda {
 
-  template <typename T> std::map<FieldKey<T>, std::stack<T>> FieldTmp<T>::cache;
+  std::string field_cache_aux(const GaugeField &a)
+  {
+    // the gauge tuning string does not distinguish between layouts
+    std::stringstream aux_ss;
+    aux_ss << a.AuxString() << ",location=" << a.Location() << ",order=" << a.Order()
+           << ",reconstruct=" << a.Reconstruct() << ",link_type=" << a.LinkType() << ",ghost=" << a.GhostExchange()
+           << ",nFace=" << a.Nface();
+    return aux_ss.str();
+  }
+
+  std::string field_cache_aux(const CloverField &a)
+  {
+    // the clover tuning string does not distinguish between layouts,
+    // and total bytes distinguishes whether the inverse is allocated
+    std::stringstream aux_ss;
+    aux_ss << a.AuxString() << ",location=" << a.Location() << ",order=" << a.Order()
+           << ",reconstruct=" << a.Reconstruct() << ",twist=" << a.TwistFlavor() << ",bytes=" << a.TotalBytes();
+    return aux_ss.str();
+  }
+
+  namespace
+  {
+
+    /**
+       The cache of released temporaries of a given field type.
+       Temporaries are held in a list ordered by release, with the most
+       recently released at the front, together with an index mapping
+       each key to the list entries with that key (oldest first).
+     */
+    template <typename T> struct FieldCache {
+      struct Entry {
+        FieldKey<T> key;
+        std::unique_ptr<T> field;
+        size_t bytes;
+      };
+      using list_t = std::list<Entry>;
+
+      list_t lru;
+      std::unordered_map<FieldKey<T>, std::vector<typename list_t::iterator>, typename FieldKey<T>::hash> index;
+      FieldCacheStats stats;
+
+      FieldCache()
+      {
+        stats.budget = static_cast<size_t>(default_field_cache_budget) * 1024 * 1024;
+        char *budget_str = getenv("QUDA_FIELD_CACHE_BUDGET");
+        if (budget_str) {
+          long budget = atol(budget_str);
+          if (budget < 0) errorQuda("Invalid QUDA_FIELD_CACHE_BUDGET=%s", budget_str);
+          stats.budget = static_cast<size_t>(budget) * 1024 * 1024;
+        }
+      }
+
+      /**
+         @brief Pop the most recently released temporary matching key
+         @return The cached temporary, or nullptr if there is none
+       */
+      std::unique_ptr<T> pop(const FieldKey<T> &key)
+      {
+        auto it = index.find(key);
+        if (it == index.end() || it->second.empty()) {
+          stats.misses++;
+          return nullptr;
+        }
+
+        auto entry = it->second.back();
+        it->second.pop_back();
+        if (it->second.empty()) index.erase(it);
+
+        auto field = std::move(entry->field);
+        stats.hits++;
+        stats.cached_fields--;
+        stats.cached_bytes -= entry->bytes;
+        lru.erase(entry);
+        return field;
+      }
+
+      /**
+         @brief Push a released temporary onto the cache, evicting the
+         least recently released temporaries if over budget
+       */
+      void push(const FieldKey<T> &key, std::unique_ptr<T> &&field)
+      {
+        size_t bytes = field->TotalBytes();
+        lru.push_front({key, std::move(field), bytes});
+        index[key].push_back(lru.begin());
+        stats.cached_fields++;
+        stats.cached_bytes += bytes;
+        if (stats.budget > 0) evict(stats.budget);
+      }
+
+      /**
+         @brief Evict the least recently released temporaries until at
+         most target bytes remain cached
+       */
+      void evict(size_t target)
+      {
+        while (stats.cached_bytes > target && !lru.empty()) {
+          auto &entry = lru.back();
+          // the oldest entry overall is also the oldest with its key
+          auto it = index.find(entry.key);
+          it->second.erase(it->second.begin());
+          if (it->second.empty()) index.erase(it);
+
+          stats.evictions++;
+          stats.cached_fields--;
+          stats.cached_bytes -= entry.bytes;
+          lru.pop_back();
+        }
+      }
+
+      void clear()
+      {
+        index.clear();
+        lru.clear();
+        stats.cached_fields = 0;
+        stats.cached_bytes = 0;
+      }
+    };
+
+    template <typename T> FieldCache<T> &get_cache()
+    {
+      static FieldCache<T> cache;
+      return cache;
+    }
+
+  } // namespace
 
   template <typename T> FieldTmp<T>::FieldTmp(const T &a) : key(FieldKey(a))
   {
-    auto it = cache.find(key);
+    tmp = get_cache<T>().pop(key);
 
-    if (it != cache.end() && it->second.size()) { // found an entry
-      tmp = std::move(it->second.top());
-      it->second.pop(); // pop the defunct object
-    } else { // no entry found, we must allocate a new field
+    if (!tmp) { // no entry found, we must allocate a new field
       typename T::param_type param(a);
       param.create = QUDA_ZERO_FIELD_CREATE;
-      tmp = T(param);
+      tmp.reset(T::Create(param));
     }
   }
 
   template <typename T> FieldTmp<T>::FieldTmp(const FieldKey<T> &key, const typename T::param_type &param) : key(key)
   {
-    auto it = cache.find(key);
+    tmp = get_cache<T>().pop(key);
 
-    if (it != cache.end() && it->second.size()) { // found an entry
-      tmp = std::move(it->second.top());
-      it->second.pop(); // pop the defunct object
-    } else {            // no entry found, we must allocate a new field
-      tmp = T(param);
-    }
+    if (!tmp) tmp.reset(T::Create(param)); // no entry found, we must allocate a new field
   }
 
   template <typename T> FieldTmp<T>::~FieldTmp()
   {
     // don't cache the field if it's empty (e.g., has been moved)
-    if (tmp.Bytes() == 0) return;
-    cache[key].push(std::move(tmp));
+    if (!tmp || tmp->Bytes() == 0) return;
+    get_cache<T>().push(key, std::move(tmp));
+  }
+
+  template <typename T> void FieldTmp<T>::destroy() { get_cache<T>().clear(); }
+
+  template <typename T> void FieldTmp<T>::set_budget(size_t bytes)
+  {
+    auto &cache = get_cache<T>();
+    cache.stats.budget = bytes;
+    if (bytes > 0) cache.evict(bytes);
   }
 
-  template <typename T> void FieldTmp<T>::destroy()
+  template <typename T> FieldCacheStats FieldTmp<T>::get_stats() { return get_cache<T>().stats; }
+
+  template <typename T> void FieldTmp<T>::print_stats(const char *name)
   {
-    cache.clear();
+    auto &stats = get_cache<T>().stats;
+    printfQuda("%s cache: %.1f MiB cached in %zu fields (budget %.1f MiB), %zu hits, %zu misses, %zu evictions\n", name,
+               stats.cached_bytes / (double)(1 << 20), stats.cached_fields, stats.budget / (double)(1 << 20),
+               stats.hits, stats.misses, stats.evictions);
   }
 
   template class FieldTmp<ColorSpinorField>;
+  template class FieldTmp<GaugeField>;
+  template class FieldTmp<CloverField>;
 }
@@ -0,0 +1,439 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <vector>
+#include <crc32.h>
+#include <gauge_io.h>
+#include <timer.h>
+
+namespace quda
+{
+
+  namespace gauge_io
+  {
+
+    namespace
+    {
+
+      constexpr uint32_t lime_magic = 0x456789ab;
+      constexpr size_t lime_header_bytes = 144;
+
+      /**
+         @brief Read a buffer from a given file offset, retrying on
+         partial reads
+       */
+      void pread_all(int fd, void *buf, size_t bytes, off_t offset, const std::string &filename)
+      {
+        auto p = static_cast<char *>(buf);
+        while (bytes > 0) {
+          ssize_t n = pread(fd, p, bytes, offset);
+          if (n < 0 && errno == EINTR) continue;
+          if (n <= 0)
+            errorQuda("Failed to read %s at offset %lld (%s)", filename.c_str(), (long long)offset, strerror(errno));
+          p += n;
+          bytes -= n;
+          offset += n;
+        }
+      }
+
+      bool little_endian()
+      {
+        const uint16_t one = 1;
+        return *reinterpret_cast<const char *>(&one) == 1;
+      }
+
+      uint64_t big_endian_64(const unsigned char *p)
+      {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; i++) v = (v << 8) | p[i];
+        return v;
+      }
+
+      uint32_t big_endian_32(const unsigned char *p)
+      {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++) v = (v << 8) | p[i];
+        return v;
+      }
+
+      /**
+         Description of the binary link data in a file, which is
+         ordered lexicographically over the global lattice (x fastest),
+         with the four links of each site stored consecutively as
+         row-major color matrices
+       */
+      struct Layout {
+        uint64_t offset;      /** File offset of the link data */
+        int precision;        /** Bytes per real number */
+        int rows;             /** The number of rows stored per matrix, 2 or 3 */
+        int big_endian;       /** Whether the data are big endian */
+        int dims[4];          /** Global dimensions */
+        int nersc;            /** Whether to compute the NERSC checksum */
+        uint32_t nersc_sum;   /** Expected NERSC checksum */
+        int scidac;           /** Whether to verify the SciDAC checksum */
+        uint32_t suma;        /** Expected SciDAC checksum a */
+        uint32_t sumb;        /** Expected SciDAC checksum b */
+
+        size_t site_bytes() const { return 4 * rows * 3 * 2 * precision; }
+      };
+
+      /**
+         @brief Swap the byte order of an array in place
+       */
+      template <typename word_t> void byte_swap(char *buf, size_t bytes)
+      {
+        auto w = reinterpret_cast<word_t *>(buf);
+        size_t n = bytes / sizeof(word_t);
+        for (size_t i = 0; i < n; i++) {
+          if constexpr (sizeof(word_t) == 8)
+            w[i] = __builtin_bswap64(w[i]);
+          else
+            w[i] = __builtin_bswap32(w[i]);
+        }
+      }
+
+      /**
+         @brief Convert the links of a contiguous run of sites from the
+         file representation (in host byte order) into the field,
+         reconstructing the third row if only two are stored
+         @param[in] buf The file data of the sites
+         @param[in] n The number of sites
+         @param[in] rows The number of rows stored per matrix
+         @param[in] dst Function returning the destination of the
+         links of a site in the run and a direction
+       */
+      template <typename file_t, typename field_t, typename Dst>
+      void convert(const char *buf, size_t n, int rows, Dst &&dst)
+      {
+        auto src = reinterpret_cast<const file_t *>(buf);
+        const int site_reals = 4 * rows * 6;
+        for (size_t s = 0; s < n; s++) {
+          for (int d = 0; d < 4; d++) {
+            const file_t *m = src + s * site_reals + d * rows * 6;
+            field_t *u = dst(s, d);
+            for (int i = 0; i < rows * 6; i++) u[i] = m[i];
+            if (rows == 2) {
+              // third row is the complex conjugate of the cross product of the first two
+              double a[6], b[6];
+              for (int i = 0; i < 6; i++) {
+                a[i] = m[i];
+                b[i] = m[6 + i];
+              }
+              for (int k = 0; k < 3; k++) {
+                int k1 = (k + 1) % 3, k2 = (k + 2) % 3;
+                double re = a[2 * k1] * b[2 * k2] - a[2 * k1 + 1] * b[2 * k2 + 1] - a[2 * k2] * b[2 * k1]
+                  + a[2 * k2 + 1] * b[2 * k1 + 1];
+                double im = a[2 * k1] * b[2 * k2 + 1] + a[2 * k1 + 1] * b[2 * k2] - a[2 * k2] * b[2 * k1 + 1]
+                  - a[2 * k2 + 1] * b[2 * k1];
+                u[12 + 2 * k] = re;
+                u[12 + 2 * k + 1] = -im;
+              }
+            }
+          }
+        }
+      }
+
+      void check_field(const GaugeField &u)
+      {
+        if (u.Location() != QUDA_CPU_FIELD_LOCATION) errorQuda("Gauge readers require a host field");
+        if (u.Order() != QUDA_QDP_GAUGE_ORDER && u.Order() != QUDA_MILC_GAUGE_ORDER)
+          errorQuda("Gauge readers require QDP or MILC order, not %d", u.Order());
+        if (u.Precision() != QUDA_DOUBLE_PRECISION && u.Precision() != QUDA_SINGLE_PRECISION)
+          errorQuda("Unsupported precision %d", u.Precision());
+        if (u.Ncolor() != 3 || u.Geometry() != QUDA_VECTOR_GEOMETRY) errorQuda("Gauge readers require SU(3) links");
+      }
+
+      template <typename file_t, typename field_t>
+      void convert(const char *buf, size_t n, int rows, GaugeField &u, const int *x0, const lat_dim_t &L)
+      {
+        const size_t volume_cb = u.VolumeCB();
+        const bool qdp = u.Order() == QUDA_QDP_GAUGE_ORDER;
+        auto gauge = u.Gauge_p();
+        convert<file_t, field_t>(buf, n, rows, [&](size_t s, int d) {
+          int x = x0[0] + s % L[0];
+          int y = x0[1] + s / L[0];
+          int parity = (x + y + x0[2] + x0[3]) & 1;
+          size_t cb = ((((size_t)x0[3] * L[2] + x0[2]) * L[1] + y) * L[0] + x) / 2;
+          size_t site = parity * volume_cb + cb;
+          return qdp ? static_cast<field_t *>(static_cast<void **>(gauge)[d]) + site * 18 :
+                       static_cast<field_t *>(gauge) + (site * 4 + d) * 18;
+        });
+      }
+
+      /**
+         @brief Read the rank-local sub-volume of the link data into
+         the field, verifying the checksums
+       */
+      void read_links(const std::string &filename, const Layout &layout, GaugeField &u)
+      {
+        check_field(u);
+        host_timer_t timer;
+        timer.start();
+
+        lat_dim_t L, offset;
+        for (int d = 0; d < 4; d++) {
+          L[d] = u.X()[d];
+          offset[d] = comm_coord(d) * L[d];
+          if (comm_dim(d) * L[d] != layout.dims[d])
+            errorQuda("Dimension %d of %s is %d, expected %d", d, filename.c_str(), layout.dims[d], comm_dim(d) * L[d]);
+        }
+
+        // when a rank spans the x dimension, its lines in y are contiguous in the file
+        const size_t site_bytes = layout.site_bytes();
+        const int lines = L[0] == layout.dims[0] ? L[1] : 1;
+        std::vector<char> buf(lines * L[0] * site_bytes);
+        const bool swap = layout.big_endian == little_endian();
+
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) errorQuda("Failed to open %s (%s)", filename.c_str(), strerror(errno));
+
+        uint32_t nersc_sum = 0;
+        crc::ScidacChecksum scidac;
+        for (int t = 0; t < L[3]; t++) {
+          for (int z = 0; z < L[2]; z++) {
+            for (int y = 0; y < L[1]; y += lines) {
+              uint64_t global = (((uint64_t)(offset[3] + t) * layout.dims[2] + offset[2] + z) * layout.dims[1]
+                                 + offset[1] + y) * layout.dims[0] + offset[0];
+              const size_t n = lines * L[0];
+              pread_all(fd, buf.data(), n * site_bytes, layout.offset + global * site_bytes, filename);
+
+              // the SciDAC checksum is of the data as stored
+              if (layout.scidac) {
+                for (size_t s = 0; s < n; s++) {
+                  uint64_t rank = global + (s / L[0]) * layout.dims[0] + s % L[0];
+                  scidac.add(rank, buf.data() + s * site_bytes, site_bytes);
+                }
+              }
+
+              if (swap) {
+                if (layout.precision == 8)
+                  byte_swap<uint64_t>(buf.data(), n * site_bytes);
+                else
+                  byte_swap<uint32_t>(buf.data(), n * site_bytes);
+              }
+
+              // the NERSC checksum is the sum of the 32-bit words of the data in host byte order
+              if (layout.nersc) {
+                auto w = reinterpret_cast<const uint32_t *>(buf.data());
+                for (size_t i = 0; i < n * site_bytes / 4; i++) nersc_sum += w[i];
+              }
+
+              const int x0[4] = {0, y, z, t};
+              if (layout.precision == 8) {
+                if (u.Precision() == QUDA_DOUBLE_PRECISION)
+                  convert<double, double>(buf.data(), n, layout.rows, u, x0, L);
+                else
+                  convert<double, float>(buf.data(), n, layout.rows, u, x0, L);
+              } else {
+                if (u.Precision() == QUDA_DOUBLE_PRECISION)
+                  convert<float, double>(buf.data(), n, layout.rows, u, x0, L);
+                else
+                  convert<float, float>(buf.data(), n, layout.rows, u, x0, L);
+              }
+            }
+          }
+        }
+        close(fd);
+        timer.stop();
+
+        if (layout.nersc) {
+          // each partial sum is less than 2^32, so the sum over ranks is exact in double precision
+          double sum = nersc_sum;
+          comm_allreduce_sum(sum);
+          uint32_t total = static_cast<uint64_t>(sum) & 0xffffffffu;
+          if (total != layout.nersc_sum)
+            errorQuda("NERSC checksum mismatch for %s: computed %x, expected %x", filename.c_str(), total,
+                      layout.nersc_sum);
+        }
+
+        if (layout.scidac) {
+          uint64_t packed = scidac.pack();
+          comm_allreduce_xor(packed);
+          scidac.unpack(packed);
+          if (scidac.suma != layout.suma || scidac.sumb != layout.sumb)
+            errorQuda("SciDAC checksum mismatch for %s: computed %x %x, expected %x %x", filename.c_str(), scidac.suma,
+                      scidac.sumb, layout.suma, layout.sumb);
+        }
+
+        double time = timer.last();
+        comm_allreduce_max(time);
+        const double bytes = (double)layout.dims[0] * layout.dims[1] * layout.dims[2] * layout.dims[3] * site_bytes;
+        if (getVerbosity() >= QUDA_SUMMARIZE)
+          printfQuda("Read %s (%.1f MiB) in %.3f s (%.2f GB/s)%s\n", filename.c_str(), bytes / (1 << 20), time,
+                     bytes / (1e9 * time), layout.nersc || layout.scidac ? ", checksum verified" : "");
+      }
+
+      /**
+         @brief Read the start of a file on rank 0 and broadcast it
+       */
+      std::string read_start(const std::string &filename, size_t max_bytes)
+      {
+        std::string start;
+        uint64_t length = 0;
+        if (comm_rank() == 0) {
+          int fd = open(filename.c_str(), O_RDONLY);
+          if (fd < 0) errorQuda("Failed to open %s (%s)", filename.c_str(), strerror(errno));
+          start.resize(max_bytes);
+          ssize_t n = pread(fd, &start[0], max_bytes, 0);
+          length = n > 0 ? n : 0;
+          close(fd);
+        }
+        comm_broadcast(&length, sizeof(length));
+        start.resize(length);
+        if (length > 0) comm_broadcast(&start[0], length);
+        return start;
+      }
+
+      /** @return The contents of an XML element, or an empty string if not present */
+      std::string xml_value(const std::string &xml, const std::string &tag)
+      {
+        auto begin = xml.find("<" + tag + ">");
+        if (begin == std::string::npos) return "";
+        begin += tag.size() + 2;
+        auto end = xml.find("</" + tag + ">", begin);
+        if (end == std::string::npos) return "";
+        auto value = xml.substr(begin, end - begin);
+        value.erase(0, value.find_first_not_of(" \t\n"));
+        value.erase(value.find_last_not_of(" \t\n") + 1);
+        return value;
+      }
+
+    } // namespace
+
+    void read_nersc(const std::string &filename, GaugeField &u)
+    {
+      auto header = read_start(filename, 65536);
+      if (header.compare(0, 12, "BEGIN_HEADER") != 0) errorQuda("%s is not a NERSC configuration", filename.c_str());
+      auto end = header.find("END_HEADER");
+      if (end == std::string::npos) errorQuda("Header of %s not terminated", filename.c_str());
+      end = header.find('\n', end);
+      if (end == std::string::npos) errorQuda("Header of %s not terminated", filename.c_str());
+
+      std::map<std::string, std::string> keys;
+      std::istringstream lines(header.substr(0, end));
+      for (std::string line; std::getline(lines, line);) {
+        auto eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        auto key = line.substr(0, eq);
+        auto value = line.substr(eq + 1);
+        key.erase(key.find_last_not_of(" \t\r") + 1);
+        key.erase(0, key.find_first_not_of(" \t"));
+        value.erase(0, value.find_first_not_of(" \t"));
+        value.erase(value.find_last_not_of(" \t\r") + 1);
+        keys[key] = value;
+      }
+      auto get = [&](const std::string &key) {
+        auto it = keys.find(key);
+        if (it == keys.end()) errorQuda("%s missing from the header of %s", key.c_str(), filename.c_str());
+        return it->second;
+      };
+
+      Layout layout = {};
+      layout.offset = end + 1;
+      auto datatype = get("DATATYPE");
+      if (datatype == "4D_SU3_GAUGE") {
+        layout.rows = 2;
+      } else if (datatype == "4D_SU3_GAUGE_3x3") {
+        layout.rows = 3;
+      } else {
+        errorQuda("Unsupported NERSC datatype %s", datatype.c_str());
+      }
+      auto floating_point = get("FLOATING_POINT");
+      if (floating_point == "IEEE32" || floating_point == "IEEE32BIG") {
+        layout.precision = 4;
+        layout.big_endian = true;
+      } else if (floating_point == "IEEE64BIG") {
+        layout.precision = 8;
+        layout.big_endian = true;
+      } else if (floating_point == "IEEE32LITTLE") {
+        layout.precision = 4;
+        layout.big_endian = false;
+      } else if (floating_point == "IEEE64LITTLE") {
+        layout.precision = 8;
+        layout.big_endian = false;
+      } else {
+        errorQuda("Unsupported NERSC floating point type %s", floating_point.c_str());
+      }
+      for (int d = 0; d < 4; d++) layout.dims[d] = std::stoi(get("DIMENSION_" + std::to_string(d + 1)));
+      layout.nersc = true;
+      layout.nersc_sum = std::stoul(get("CHECKSUM"), nullptr, 16);
+
+      if (getVerbosity() >= QUDA_VERBOSE)
+        printfQuda("NERSC configuration %s: %s %s, plaquette %s, link trace %s\n", filename.c_str(), datatype.c_str(),
+                   floating_point.c_str(), keys["PLAQUETTE"].c_str(), keys["LINK_TRACE"].c_str());
+
+      read_links(filename, layout, u);
+    }
+
+    void read_ildg(const std::string &filename, GaugeField &u)
+    {
+      Layout layout = {};
+      bool found_format = false, found_data = false;
+
+      if (comm_rank() == 0) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) errorQuda("Failed to open %s (%s)", filename.c_str(), strerror(errno));
+        off_t size = lseek(fd, 0, SEEK_END);
+
+        // walk the LIME records, picking out the format, binary data and checksum
+        for (off_t pos = 0; pos + (off_t)lime_header_bytes <= size;) {
+          unsigned char header[lime_header_bytes];
+          pread_all(fd, header, lime_header_bytes, pos, filename);
+          if (big_endian_32(header) != lime_magic) errorQuda("Invalid LIME record in %s at %lld", filename.c_str(), (long long)pos);
+          uint64_t length = big_endian_64(header + 8);
+          std::string type(reinterpret_cast<char *>(header + 16), strnlen(reinterpret_cast<char *>(header + 16), 128));
+          off_t data = pos + lime_header_bytes;
+
+          if (type == "ildg-format" || type == "scidac-checksum") {
+            std::string xml(length, '\0');
+            pread_all(fd, &xml[0], length, data, filename);
+            if (type == "ildg-format") {
+              if (xml_value(xml, "field") != "su3gauge") errorQuda("%s does not hold an SU(3) gauge field", filename.c_str());
+              layout.precision = std::stoi(xml_value(xml, "precision")) / 8;
+              const char *dims[] = {"lx", "ly", "lz", "lt"};
+              for (int d = 0; d < 4; d++) layout.dims[d] = std::stoi(xml_value(xml, dims[d]));
+              found_format = true;
+            } else {
+              layout.scidac = true;
+              layout.suma = std::stoul(xml_value(xml, "suma"), nullptr, 16);
+              layout.sumb = std::stoul(xml_value(xml, "sumb"), nullptr, 16);
+            }
+          } else if (type == "ildg-binary-data") {
+            layout.offset = data;
+            found_data = true;
+          }
+          pos = data + ((length + 7) / 8) * 8;
+        }
+        close(fd);
+
+        if (!found_format || !found_data) errorQuda("%s is missing ILDG format or binary data records", filename.c_str());
+        if (layout.precision != 4 && layout.precision != 8) errorQuda("Unsupported ILDG precision %d", 8 * layout.precision);
+      }
+      comm_broadcast(&layout, sizeof(layout));
+      layout.rows = 3;
+      layout.big_endian = true;
+      layout.nersc = false;
+
+      if (!layout.scidac) warningQuda("%s has no SciDAC checksum record", filename.c_str());
+      read_links(filename, layout, u);
+    }
+
+    void read(const std::string &filename, GaugeField &u)
+    {
+      auto start = read_start(filename, 16);
+      if (start.size() >= 4 && big_endian_32(reinterpret_cast<const unsigned char *>(start.data())) == lime_magic) {
+        read_ildg(filename, u);
+      } else if (start.compare(0, 12, "BEGIN_HEADER") == 0) {
+        read_nersc(filename, u);
+      } else {
+        errorQuda("Unknown gauge configuration format of %s", filename.c_str());
+      }
+    }
+
+  } // namespace gauge_io
+
+} // namespace quda
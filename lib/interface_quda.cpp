@@ -31,6 +31,11 @@
 
 #include <multigrid.h>
 #include <deflation.h>
+#include <vector_io.h>
+#include <async_io.h>
+#include <gauge_io.h>
+#include <mg_checkpoint.h>
+#include <mapped_field.h>
 
 #include <split_grid.h>
 
@@ -574,6 +579,22 @@ void loadGaugeQuda(void *h_gauge, QudaGaugeParam *param)
     static_cast<GaugeField*>(new cpuGaugeField(gauge_param)) :
     static_cast<GaugeField*>(new cudaGaugeField(gauge_param));
 
+  // validate the input field against the SciDAC checksum of the configuration file if this has been set, and
+  // optionally print the checksums (in the precision of the field unless the file precision is set)
+  static const bool print_checksum = getenv("QUDA_GAUGE_CHECKSUM") && strcmp(getenv("QUDA_GAUGE_CHECKSUM"), "1") == 0;
+  const bool validate_checksum = param->checksum_precision != QUDA_INVALID_PRECISION;
+  if (validate_checksum || print_checksum) {
+    auto checksum = Checksums(*in, param->checksum_precision);
+    QudaPrecision prec
+      = validate_checksum ? param->checksum_precision : std::max(in->Precision(), QUDA_SINGLE_PRECISION);
+    if (print_checksum)
+      printfQuda("Loaded gauge field checksums: SciDAC %08x %08x (%s precision), XOR %016lx\n", checksum.suma,
+                 checksum.sumb, prec == QUDA_DOUBLE_PRECISION ? "double" : "single", checksum.xor_sum);
+    if (validate_checksum && (checksum.suma != param->checksum_a || checksum.sumb != param->checksum_b))
+      errorQuda("Gauge field checksum %08x %08x does not match the expected %08x %08x", checksum.suma, checksum.sumb,
+                param->checksum_a, param->checksum_b);
+  }
+
   if (in->Order() == QUDA_BQCD_GAUGE_ORDER) {
     static size_t checksum = SIZE_MAX;
     size_t in_checksum = in->checksum(true);
@@ -769,6 +790,16 @@ void loadGaugeQuda(void *h_gauge, QudaGaugeParam *param)
   profileGauge.TPSTOP(QUDA_PROFILE_TOTAL);
 }
 
+void loadGaugeMappedQuda(const char *filename, size_t offset, QudaGaugeParam *param)
+{
+  if (param->location != QUDA_CPU_FIELD_LOCATION) errorQuda("Mapped gauge fields must be host fields");
+
+  // the mapped field provides the host pointers, so loadGaugeQuda references the mapping directly
+  GaugeFieldParam gauge_param(*param);
+  MappedGaugeField mapped(filename, offset, gauge_param);
+  loadGaugeQuda(mapped.Gauge_p(), param);
+}
+
 void saveGaugeQuda(void *h_gauge, QudaGaugeParam *param)
 {
   profileGauge.TPSTART(QUDA_PROFILE_TOTAL);
@@ -807,6 +838,54 @@ void saveGaugeQuda(void *h_gauge, QudaGaugeParam *param)
   profileGauge.TPSTOP(QUDA_PROFILE_TOTAL);
 }
 
+void readGaugeFileQuda(void *h_gauge, const char *filename, QudaGaugeParam *param)
+{
+  profileGauge.TPSTART(QUDA_PROFILE_TOTAL);
+
+  if (!initialized) errorQuda("QUDA not initialized");
+  checkGaugeParam(param);
+
+  // wrap the host field, into which each rank reads its sub-volume directly
+  GaugeFieldParam gauge_param(*param, h_gauge);
+  cpuGaugeField cpuGauge(gauge_param);
+
+  profileGauge.TPSTART(QUDA_PROFILE_IO);
+  gauge_io::read(filename, cpuGauge);
+  profileGauge.TPSTOP(QUDA_PROFILE_IO);
+
+  profileGauge.TPSTOP(QUDA_PROFILE_TOTAL);
+}
+
+void loadGaugeFileQuda(const char *filename, QudaGaugeParam *param)
+{
+  if (!initialized) errorQuda("QUDA not initialized");
+
+  // read into a pinned host field in MILC order, from which the device field is loaded without further staging;
+  // the file checksum is verified by the reader
+  QudaGaugeParam file_param = *param;
+  file_param.location = QUDA_CPU_FIELD_LOCATION;
+  file_param.gauge_order = QUDA_MILC_GAUGE_ORDER;
+  file_param.checksum_precision = QUDA_INVALID_PRECISION;
+  checkGaugeParam(&file_param);
+
+  size_t bytes = 4 * 18 * file_param.cpu_prec; // four SU(3) links per site
+  for (int d = 0; d < 4; d++) bytes *= file_param.X[d];
+  void *h_gauge = pool_pinned_malloc(bytes);
+  {
+    profileGauge.TPSTART(QUDA_PROFILE_TOTAL);
+    GaugeFieldParam gauge_param(file_param, h_gauge);
+    cpuGaugeField cpuGauge(gauge_param);
+
+    profileGauge.TPSTART(QUDA_PROFILE_IO);
+    gauge_io::read(filename, cpuGauge);
+    profileGauge.TPSTOP(QUDA_PROFILE_IO);
+    profileGauge.TPSTOP(QUDA_PROFILE_TOTAL);
+  }
+
+  loadGaugeQuda(h_gauge, &file_param);
+  pool_pinned_free(h_gauge);
+}
+
 void loadSloppyCloverQuda(const QudaPrecision prec[]);
 void freeSloppyCloverQuda();
 
@@ -1366,12 +1445,21 @@ void flushChronoQuda(int i)
   chronoResident[i].clear();
 }
 
+void flushAsyncIOQuda()
+{
+  if (!initialized) errorQuda("QUDA not initialized");
+  VectorIO::flush();
+}
+
 void endQuda(void)
 {
   profileEnd.TPSTART(QUDA_PROFILE_TOTAL);
 
   if (!initialized) return;
 
+  // complete any background writes while the communicator is still available
+  async_io::destroy();
+
   freeGaugeQuda();
   freeCloverQuda();
 
@@ -1383,14 +1471,23 @@ void endQuda(void)
 
   LatticeField::freeGhostBuffer();
   ColorSpinorField::freeGhostBuffer();
+  if (getVerbosity() >= QUDA_VERBOSE) {
+    FieldTmp<ColorSpinorField>::print_stats("ColorSpinorField");
+    FieldTmp<GaugeField>::print_stats("GaugeField");
+    FieldTmp<CloverField>::print_stats("CloverField");
+  }
   FieldTmp<ColorSpinorField>::destroy();
+  FieldTmp<GaugeField>::destroy();
+  FieldTmp<CloverField>::destroy();
 
   blas_lapack::generic::destroy();
   blas_lapack::native::destroy();
   reducer::destroy();
 
+  if (getVerbosity() >= QUDA_VERBOSE) pool::print_stats();
   pool::flush_pinned();
   pool::flush_device();
+  pool::flush_host();
 
   host_free(num_failures_h);
   num_failures_h = nullptr;
@@ -1451,6 +1548,10 @@ void endQuda(void)
     printfQuda("\n");
     printPeakMemUsage();
     printfQuda("\n");
+    if (memory_timeline::enabled()) {
+      memory_timeline::print_phase_peaks();
+      printfQuda("\n");
+    }
   }
 
   assertAllMemFree();
@@ -2378,7 +2479,7 @@ void eigensolveQuda(void **host_evecs, double _Complex *host_evals, QudaEigParam
   profileEigensolve.TPSTOP(QUDA_PROFILE_TOTAL);
 }
 
-multigrid_solver::multigrid_solver(QudaMultigridParam &mg_param, TimeProfile &profile)
+multigrid_solver::multigrid_solver(QudaMultigridParam &mg_param, TimeProfile &profile, const std::string &checkpoint)
   : profile(profile) {
   profile.TPSTART(QUDA_PROFILE_INIT);
   QudaInvertParam *param = mg_param.invert_param;
@@ -2454,6 +2555,23 @@ multigrid_solver::multigrid_solver(QudaMultigridParam &mg_param, TimeProfile &pr
   // fill out the MG parameters for the fine level
   mgParam = new MGParam(mg_param, B, m, mSmooth, mSmoothSloppy);
 
+  if (!checkpoint.empty()) {
+    bool aggregate = true;
+    for (int i = 0; i < mg_param.n_level - 1; i++)
+      if (mg_param.transfer_type[i] != QUDA_TRANSFER_AGGREGATE) aggregate = false;
+    if (aggregate) {
+      profile.TPSTOP(QUDA_PROFILE_INIT);
+      profile.TPSTART(QUDA_PROFILE_IO);
+      auto reader = std::make_shared<mg_checkpoint::Reader>(checkpoint, mg_param, *cudaGauge);
+      if (reader->valid()) mgParam->checkpoint = reader;
+      profile.TPSTOP(QUDA_PROFILE_IO);
+      profile.TPSTART(QUDA_PROFILE_INIT);
+    } else {
+      warningQuda("Not restoring multigrid checkpoint %s since it requires aggregation on all levels", checkpoint.c_str());
+    }
+  }
+  mg_param.checkpoint_restored = mgParam->checkpoint ? QUDA_BOOLEAN_TRUE : QUDA_BOOLEAN_FALSE;
+
   mg = new MG(*mgParam, profile);
   mgParam->updateInvertParam(*param);
 
@@ -2479,6 +2597,24 @@ void* newMultigridQuda(QudaMultigridParam *mg_param) {
   return static_cast<void*>(mg);
 }
 
+void *restoreMultigridQuda(QudaMultigridParam *mg_param, const char *filename)
+{
+  profilerStart(__func__);
+
+  pushVerbosity(mg_param->invert_param->verbosity);
+
+  profileInvert.TPSTART(QUDA_PROFILE_TOTAL);
+  auto *mg = new multigrid_solver(*mg_param, profileInvert, filename);
+  profileInvert.TPSTOP(QUDA_PROFILE_TOTAL);
+
+  saveTuneCache();
+
+  popVerbosity();
+
+  profilerStop(__func__);
+  return static_cast<void *>(mg);
+}
+
 void destroyMultigridQuda(void *mg) {
   delete static_cast<multigrid_solver*>(mg);
 }
@@ -2615,6 +2751,27 @@ void dumpMultigridQuda(void *mg_, QudaMultigridParam *mg_param)
   profilerStop(__func__);
 }
 
+void checkpointMultigridQuda(void *mg_, QudaMultigridParam *mg_param, const char *filename)
+{
+  profilerStart(__func__);
+  pushVerbosity(mg_param->invert_param->verbosity);
+  profileInvert.TPSTART(QUDA_PROFILE_TOTAL);
+
+  auto *mg = static_cast<multigrid_solver *>(mg_);
+  checkMultigridParam(mg_param);
+  cudaGaugeField *cudaGauge = checkGauge(mg_param->invert_param);
+
+  profileInvert.TPSTART(QUDA_PROFILE_IO);
+  mg_checkpoint::Writer writer(filename, *mg_param, *cudaGauge);
+  mg->mg->saveCheckpoint(writer);
+  writer.close();
+  profileInvert.TPSTOP(QUDA_PROFILE_IO);
+
+  profileInvert.TPSTOP(QUDA_PROFILE_TOTAL);
+  popVerbosity();
+  profilerStop(__func__);
+}
+
 deflated_solver::deflated_solver(QudaEigParam &eig_param, TimeProfile &profile)
   : d(nullptr), m(nullptr), RV(nullptr), deflParam(nullptr), defl(nullptr),  profile(profile) {
 
@@ -2696,6 +2853,134 @@ void destroyDeflationQuda(void *df) {
   delete static_cast<deflated_solver*>(df);
 }
 
+/**
+   @brief Add a solution to the chronological basis selected by
+   param->chrono_index, rotating out the oldest entry once the basis
+   has reached param->chrono_max_dim.
+   @param[in] x The solution to make resident
+   @param[in] param The invert parameters specifying the basis
+ */
+static void makeChronoResident(const ColorSpinorField &x, const QudaInvertParam &param)
+{
+  if (param.chrono_max_dim < 1) errorQuda("Cannot chrono_make_resident with chrono_max_dim %i", param.chrono_max_dim);
+
+  const int i = param.chrono_index;
+  if (i >= QUDA_MAX_CHRONO) errorQuda("Requested chrono index %d is outside of max %d\n", i, QUDA_MAX_CHRONO);
+
+  auto &basis = chronoResident[i];
+
+  if (param.chrono_max_dim < (int)basis.size()) {
+    errorQuda("Requested chrono_max_dim %i is smaller than already existing chronology %lu", param.chrono_max_dim,
+              basis.size());
+  }
+
+  if (not param.chrono_replace_last) {
+    // if we have not filled the space yet just augment
+    if ((int)basis.size() < param.chrono_max_dim) {
+      ColorSpinorParam cs_param(x);
+      cs_param.setPrecision(param.chrono_precision);
+      basis.emplace_back(cs_param);
+    }
+
+    // shuffle every entry down one and bring the last to the front
+    std::rotate(basis.begin(), basis.end() - 1, basis.end());
+  }
+  basis[0] = x; // set first entry to new solution
+}
+
+/**
+   @brief Prepare the resident chronological basis for forecasting,
+   returning the basis p and its image q = A p.  A basis stored at
+   the outer or sloppy precision is aliased, while one stored at a
+   lower precision than the sloppy precision (e.g., half or quarter
+   to save memory) is promoted to the sloppy precision, so that the
+   projection is carried out at the sloppy precision.
+   @param[out] p The basis at the precision of the returned operator
+   @param[out] q The image of the basis under the returned operator
+   @param[in] m The outer operator
+   @param[in] mSloppy The sloppy operator
+   @param[in] param The invert parameters specifying the basis
+   @return The operator used to form q
+ */
+static const DiracMatrix &chronoBasis(std::vector<ColorSpinorField> &p, std::vector<ColorSpinorField> &q,
+                                      const DiracMatrix &m, const DiracMatrix &mSloppy, const QudaInvertParam &param)
+{
+  auto &basis = chronoResident[param.chrono_index];
+
+  QudaPrecision prec = param.chrono_precision;
+  if (prec != param.cuda_prec && prec != param.cuda_prec_sloppy) {
+    if (prec > param.cuda_prec_sloppy)
+      errorQuda("Unexpected precision %d for chrono vectors (doesn't match outer %d and exceeds sloppy precision %d)",
+                prec, param.cuda_prec, param.cuda_prec_sloppy);
+    prec = param.cuda_prec_sloppy;
+  }
+  const DiracMatrix &mat = prec == param.cuda_prec ? m : mSloppy;
+
+  ColorSpinorParam cs_param(basis[0]);
+  cs_param.setPrecision(prec, prec, true);
+  cs_param.create = QUDA_NULL_FIELD_CREATE;
+  p.clear();
+  for (auto &v : basis) {
+    if (v.Precision() == prec) {
+      p.push_back(v.create_alias());
+    } else {
+      p.emplace_back(cs_param);
+      blas::copy(p.back(), v);
+    }
+  }
+  q.resize(basis.size(), cs_param);
+  for (unsigned int j = 0; j < basis.size(); j++) mat(q[j], p[j]);
+
+  return mat;
+}
+
+/**
+   @brief Prepare the system to be solved for a source: rescale the
+   source and initial guess if source normalization is requested,
+   apply the mass rescaling and prepare the (preconditioned) source
+   and solution.
+   @param[out] in The prepared source
+   @param[out] out The prepared solution
+   @param[in,out] x The full solution, holding the initial guess
+   @param[in,out] b The full source
+   @param[in] nb The norm squared of the source
+   @param[in] dirac The operator
+   @param[in] param The invert parameters
+ */
+static void prepareSolve(ColorSpinorField *&in, ColorSpinorField *&out, ColorSpinorField &x, ColorSpinorField &b,
+                         double nb, Dirac &dirac, QudaInvertParam &param)
+{
+  // rescale the source and solution vectors to help prevent the onset of underflow
+  if (param.solver_normalization == QUDA_SOURCE_NORMALIZATION) {
+    blas::ax(1.0 / sqrt(nb), b);
+    blas::ax(1.0 / sqrt(nb), x);
+  }
+
+  massRescale(b, param, false);
+
+  dirac.prepare(in, out, x, b, param.solution_type);
+}
+
+/**
+   @brief Reconstruct the full solution from the solution of the
+   prepared system, undoing the source normalization
+   @param[in,out] x The full solution
+   @param[in] b The full source, as prepared by prepareSolve
+   @param[in] nb The norm squared of the source
+   @param[in] dirac The operator
+   @param[in] param The invert parameters
+ */
+static void reconstructSolve(ColorSpinorField &x, ColorSpinorField &b, double nb, Dirac &dirac,
+                             const QudaInvertParam &param)
+{
+  dirac.reconstruct(x, b, param.solution_type);
+
+  if (param.solver_normalization == QUDA_SOURCE_NORMALIZATION) {
+    // rescale the solution
+    blas::ax(sqrt(nb), x);
+  }
+}
+
 void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
 {
   profilerStart(__func__);
@@ -2823,15 +3108,7 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
     if (param->use_init_guess == QUDA_USE_INIT_GUESS_YES) { printfQuda("Initial guess: %g\n", blas::norm2(x)); }
   }
 
-  // rescale the source and solution vectors to help prevent the onset of underflow
-  if (param->solver_normalization == QUDA_SOURCE_NORMALIZATION) {
-    blas::ax(1.0 / sqrt(nb), b);
-    blas::ax(1.0 / sqrt(nb), x);
-  }
-
-  massRescale(b, *param, false);
-
-  dirac.prepare(in, out, x, b, param->solution_type);
+  prepareSolve(in, out, x, b, nb, dirac, *param);
 
   if (getVerbosity() >= QUDA_VERBOSE) {
     double nin = blas::norm2(*in);
@@ -2894,6 +3171,7 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
   } else if (!mat_solution && direct_solve) { // perform the first of two solves: A^dag y = b
     DiracMdag m(dirac), mSloppy(diracSloppy), mPre(diracPre), mEig(diracEig);
     SolverParam solverParam(*param);
+    solverParam.record_telemetry = true;
     Solver *solve = Solver::create(solverParam, m, mSloppy, mPre, mEig, profileInvert);
     (*solve)(*out, *in);
     blas::copy(*in, *out);
@@ -2904,23 +3182,13 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
   if (direct_solve) {
     DiracM m(dirac), mSloppy(diracSloppy), mPre(diracPre), mEig(diracEig);
     SolverParam solverParam(*param);
+    solverParam.record_telemetry = true;
     // chronological forecasting
     if (param->chrono_use_resident && chronoResident[param->chrono_index].size() > 0) {
       profileInvert.TPSTART(QUDA_PROFILE_CHRONO);
 
-      auto &basis = chronoResident[param->chrono_index];
-
-      ColorSpinorParam cs_param(basis[0]);
-      std::vector<ColorSpinorField> Ap(basis.size(), cs_param);
-
-      if (param->chrono_precision == param->cuda_prec) {
-        for (unsigned int j = 0; j < basis.size(); j++) m(Ap[j], basis[j]);
-      } else if (param->chrono_precision == param->cuda_prec_sloppy) {
-        for (unsigned int j = 0; j < basis.size(); j++) mSloppy(Ap[j], basis[j]);
-      } else {
-        errorQuda("Unexpected precision %d for chrono vectors (doesn't match outer %d or sloppy precision %d)",
-                  param->chrono_precision, param->cuda_prec, param->cuda_prec_sloppy);
-      }
+      std::vector<ColorSpinorField> basis, Ap;
+      chronoBasis(basis, Ap, m, mSloppy, *param);
 
       bool orthogonal = true;
       bool apply_mat = false;
@@ -2938,24 +3206,14 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
   } else if (!norm_error_solve) {
     DiracMdagM m(dirac), mSloppy(diracSloppy), mPre(diracPre), mEig(diracEig);
     SolverParam solverParam(*param);
+    solverParam.record_telemetry = true;
 
     // chronological forecasting
     if (param->chrono_use_resident && chronoResident[param->chrono_index].size() > 0) {
       profileInvert.TPSTART(QUDA_PROFILE_CHRONO);
 
-      auto &basis = chronoResident[param->chrono_index];
-
-      ColorSpinorParam cs_param(basis[0]);
-      std::vector<ColorSpinorField> Ap(basis.size(), cs_param);
-
-      if (param->chrono_precision == param->cuda_prec) {
-        for (unsigned int j = 0; j < basis.size(); j++) m(Ap[j], basis[j]);
-      } else if (param->chrono_precision == param->cuda_prec_sloppy) {
-        for (unsigned int j = 0; j < basis.size(); j++) mSloppy(Ap[j], basis[j]);
-      } else {
-        errorQuda("Unexpected precision %d for chrono vectors (doesn't match outer %d or sloppy precision %d)",
-                  param->chrono_precision, param->cuda_prec, param->cuda_prec_sloppy);
-      }
+      std::vector<ColorSpinorField> basis, Ap;
+      chronoBasis(basis, Ap, m, mSloppy, *param);
 
       bool orthogonal = true;
       bool apply_mat = false;
@@ -2983,6 +3241,7 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
     DiracMMdag m(dirac), mSloppy(diracSloppy), mPre(diracPre), mEig(diracEig);
     ColorSpinorField tmp(*out);
     SolverParam solverParam(*param);
+    solverParam.record_telemetry = true;
     Solver *solve = Solver::create(solverParam, m, mSloppy, mPre, mEig, profileInvert);
     (*solve)(tmp, *in); // y = (M M^\dag) b
     dirac.Mdag(*out, tmp);  // x = M^dag y
@@ -2993,40 +3252,8 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
   if (getVerbosity() >= QUDA_VERBOSE) { printfQuda("Solution = %g\n", blas::norm2(x)); }
 
   profileInvert.TPSTART(QUDA_PROFILE_EPILOGUE);
-  if (param->chrono_make_resident) {
-    if(param->chrono_max_dim < 1){
-      errorQuda("Cannot chrono_make_resident with chrono_max_dim %i", param->chrono_max_dim);
-    }
-
-    const int i = param->chrono_index;
-    if (i >= QUDA_MAX_CHRONO)
-      errorQuda("Requested chrono index %d is outside of max %d\n", i, QUDA_MAX_CHRONO);
-
-    auto &basis = chronoResident[i];
-
-    if (param->chrono_max_dim < (int)basis.size()) {
-      errorQuda("Requested chrono_max_dim %i is smaller than already existing chronology %lu", param->chrono_max_dim, basis.size());
-    }
-
-    if(not param->chrono_replace_last){
-      // if we have not filled the space yet just augment
-      if ((int)basis.size() < param->chrono_max_dim) {
-        ColorSpinorParam cs_param(*out);
-        cs_param.setPrecision(param->chrono_precision);
-        basis.emplace_back(cs_param);
-      }
-
-      // shuffle every entry down one and bring the last to the front
-      std::rotate(basis.begin(), basis.end() - 1, basis.end());
-    }
-    basis[0] = *out; // set first entry to new solution
-  }
-  dirac.reconstruct(x, b, param->solution_type);
-
-  if (param->solver_normalization == QUDA_SOURCE_NORMALIZATION) {
-    // rescale the solution
-    blas::ax(sqrt(nb), x);
-  }
+  if (param->chrono_make_resident) makeChronoResident(*out, *param);
+  reconstructSolve(x, b, nb, dirac, *param);
   profileInvert.TPSTOP(QUDA_PROFILE_EPILOGUE);
 
   if (!param->make_resident_solution) {
@@ -3071,6 +3298,20 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
   profilerStop(__func__);
 }
 
+void invertMappedQuda(void *hp_x, const char *filename, size_t offset, QudaInvertParam *param)
+{
+  if (!initialized) errorQuda("QUDA not initialized");
+  if (!gaugePrecise) errorQuda("Gauge field not allocated");
+  if (param->input_location != QUDA_CPU_FIELD_LOCATION) errorQuda("Mapped sources must be host fields");
+
+  // the mapped field provides the source pointer, so invertQuda copies the source from the mapping directly
+  bool pc_solution
+    = (param->solution_type == QUDA_MATPC_SOLUTION) || (param->solution_type == QUDA_MATPCDAG_MATPC_SOLUTION);
+  ColorSpinorParam cpu_param(nullptr, *param, gaugePrecise->X(), pc_solution, QUDA_CPU_FIELD_LOCATION);
+  MappedColorSpinorField mapped(filename, offset, cpu_param);
+  invertQuda(hp_x, mapped.V(), param);
+}
+
 void loadFatLongGaugeQuda(QudaInvertParam *inv_param, QudaGaugeParam *gauge_param, void *milc_fatlinks,
                           void *milc_longlinks)
 {
@@ -3123,6 +3364,174 @@ void loadFatLongGaugeQuda(QudaInvertParam *inv_param, QudaGaugeParam *gauge_para
   }
 }
 
+/**
+   @brief Solve all the sources of invertMultiSrcQuda together with
+   the batched multi-source CG or block CG solver, which share the
+   iteration and reliable updates of all sources.  The preparation of
+   the sources and reconstruction of the solutions are those of
+   invertQuda.
+   @param[out] hp_x Host solution pointers
+   @param[in] hp_b Host source pointers
+   @param[in,out] param Invert parameters
+ */
+static void invertMultiSrcBatchedQuda(void **hp_x, void **hp_b, QudaInvertParam *param)
+{
+  profilerStart(__func__);
+
+  profileInvert.TPSTART(QUDA_PROFILE_TOTAL);
+
+  if (!initialized) errorQuda("QUDA not initialized");
+
+  pushVerbosity(param->verbosity);
+  if (getVerbosity() >= QUDA_DEBUG_VERBOSE) printQudaInvertParam(param);
+
+  checkInvertParam(param, hp_x[0], hp_b[0]);
+
+  // check the gauge fields have been created
+  cudaGaugeField *cudaGauge = checkGauge(param);
+
+  CommKey split_key = {param->split_grid[0], param->split_grid[1], param->split_grid[2], param->split_grid[3]};
+  if (quda::product(split_key) != 1) errorQuda("Batched multi-source solves do not support split grid");
+  if (param->inv_type != QUDA_CG_INVERTER && param->inv_type != QUDA_BLOCK_CG_INVERTER)
+    errorQuda("Batched multi-source solves require the CG or block CG inverter (inv_type = %d)", param->inv_type);
+  if (param->chrono_use_resident || param->chrono_make_resident)
+    errorQuda("Chronological forecasting is not supported by batched multi-source solves");
+  if (param->use_resident_solution || param->make_resident_solution)
+    errorQuda("Resident solutions are not supported by batched multi-source solves");
+
+  bool pc_solution = (param->solution_type == QUDA_MATPC_SOLUTION) ||
+    (param->solution_type == QUDA_MATPCDAG_MATPC_SOLUTION);
+  bool pc_solve = (param->solve_type == QUDA_DIRECT_PC_SOLVE) ||
+    (param->solve_type == QUDA_NORMOP_PC_SOLVE) || (param->solve_type == QUDA_NORMERR_PC_SOLVE);
+  bool mat_solution = (param->solution_type == QUDA_MAT_SOLUTION) ||
+    (param->solution_type ==  QUDA_MATPC_SOLUTION);
+  bool direct_solve = (param->solve_type == QUDA_DIRECT_SOLVE) ||
+    (param->solve_type == QUDA_DIRECT_PC_SOLVE);
+  bool norm_error_solve = (param->solve_type == QUDA_NORMERR_SOLVE) ||
+    (param->solve_type == QUDA_NORMERR_PC_SOLVE);
+
+  if (norm_error_solve) errorQuda("Normal error solves are not supported by batched multi-source solves");
+  if (!mat_solution && direct_solve) errorQuda("Two-pass solves are not supported by batched multi-source solves");
+
+  param->secs = 0;
+  param->gflops = 0;
+  param->iter = 0;
+
+  Dirac *d = nullptr;
+  Dirac *dSloppy = nullptr;
+  Dirac *dPre = nullptr;
+
+  createDirac(d, dSloppy, dPre, *param, pc_solve);
+
+  Dirac &dirac = *d;
+  Dirac &diracSloppy = *dSloppy;
+
+  profileInvert.TPSTART(QUDA_PROFILE_H2D);
+
+  const int n = param->num_src;
+  const auto X = cudaGauge->X();
+
+  ColorSpinorParam cpuParam(hp_b[0], *param, X, pc_solution, param->input_location);
+  ColorSpinorParam cudaParam(cpuParam, *param, QUDA_CUDA_FIELD_LOCATION);
+  cudaParam.create = QUDA_NULL_FIELD_CREATE;
+  std::vector<ColorSpinorField> b(n, cudaParam);
+  std::vector<ColorSpinorField> x(n, cudaParam);
+
+  for (int i = 0; i < n; i++) {
+    // download source
+    cpuParam.v = hp_b[i];
+    cpuParam.location = param->input_location;
+    ColorSpinorField h_b(cpuParam);
+    b[i] = h_b;
+
+    if (param->use_init_guess == QUDA_USE_INIT_GUESS_YES) { // download initial guess
+      cpuParam.v = hp_x[i];
+      cpuParam.location = param->output_location;
+      ColorSpinorField h_x(cpuParam);
+      x[i] = h_x;
+    } else { // zero initial guess
+      blas::zero(x[i]);
+    }
+  }
+
+  profileInvert.TPSTOP(QUDA_PROFILE_H2D);
+  profileInvert.TPSTART(QUDA_PROFILE_PREAMBLE);
+
+  std::vector<double> nb(n);
+  std::vector<ColorSpinorField> in, out;
+  for (int i = 0; i < n; i++) {
+    nb[i] = blas::norm2(b[i]);
+    if (nb[i] == 0.0) errorQuda("Source %d has zero norm", i);
+    logQuda(QUDA_VERBOSE, "Source %d: %g\n", i, nb[i]);
+
+    ColorSpinorField *in_i = nullptr;
+    ColorSpinorField *out_i = nullptr;
+    prepareSolve(in_i, out_i, x[i], b[i], nb[i], dirac, *param);
+
+    if (mat_solution && !direct_solve) { // prepare source: b' = A^dag b
+      ColorSpinorField tmp(*in_i);
+      dirac.Mdag(*in_i, tmp);
+    }
+
+    in.push_back(in_i->create_alias());
+    out.push_back(out_i->create_alias());
+  }
+
+  profileInvert.TPSTOP(QUDA_PROFILE_PREAMBLE);
+
+  DiracMatrix *m, *mSloppy;
+  if (direct_solve) {
+    m = new DiracM(dirac);
+    mSloppy = new DiracM(diracSloppy);
+  } else {
+    m = new DiracMdagM(dirac);
+    mSloppy = new DiracMdagM(diracSloppy);
+  }
+
+  SolverParam solverParam(*param);
+  {
+    std::unique_ptr<MultiSrcCG> cg;
+    if (param->inv_type == QUDA_BLOCK_CG_INVERTER)
+      cg = std::make_unique<BlockCG>(*m, *mSloppy, solverParam, profileInvert);
+    else
+      cg = std::make_unique<MultiSrcCG>(*m, *mSloppy, solverParam, profileInvert);
+    (*cg)(out, in);
+  }
+  solverParam.updateInvertParam(*param);
+
+  delete m;
+  delete mSloppy;
+
+  profileInvert.TPSTART(QUDA_PROFILE_EPILOGUE);
+  for (int i = 0; i < n; i++) reconstructSolve(x[i], b[i], nb[i], dirac, *param);
+  profileInvert.TPSTOP(QUDA_PROFILE_EPILOGUE);
+
+  profileInvert.TPSTART(QUDA_PROFILE_D2H);
+  for (int i = 0; i < n; i++) {
+    cpuParam.v = hp_x[i];
+    cpuParam.location = param->output_location;
+    ColorSpinorField h_x(cpuParam);
+    h_x = x[i];
+    logQuda(QUDA_VERBOSE, "Reconstructed solution %d: %g\n", i, blas::norm2(x[i]));
+  }
+  profileInvert.TPSTOP(QUDA_PROFILE_D2H);
+
+  profileInvert.TPSTART(QUDA_PROFILE_FREE);
+  delete d;
+  delete dSloppy;
+  delete dPre;
+  profileInvert.TPSTOP(QUDA_PROFILE_FREE);
+
+  popVerbosity();
+
+  // cache is written out even if a long benchmarking job gets interrupted
+  saveTuneCache();
+
+  profileInvert.TPSTOP(QUDA_PROFILE_TOTAL);
+
+  profilerStop(__func__);
+}
+
 template <class Interface, class... Args>
 void callMultiSrcQuda(void **_hp_x, void **_hp_b, QudaInvertParam *param, // color spinor field pointers, and inv_param
                       void *h_gauge, void *milc_fatlinks, void *milc_longlinks,
@@ -3307,6 +3716,7 @@ void callMultiSrcQuda(void **_hp_x, void **_hp_b, QudaInvertParam *param, // col
       v_g[0] = milc_longlink_field;
       quda::split_field(*collected_milc_longlink_field, v_g, split_key);
     }
+    split_grid_stats().print_and_reset("gauge/clover redistribution");
 
     profileInvertMultiSrc.TPSTOP(QUDA_PROFILE_INIT);
     profileInvertMultiSrc.TPSTART(QUDA_PROFILE_PREAMBLE);
@@ -3317,16 +3727,29 @@ void callMultiSrcQuda(void **_hp_x, void **_hp_b, QudaInvertParam *param, // col
     quda::ColorSpinorParam cpu_cs_param_split(*_h_x[0]);
     cpu_cs_param_split.location = QUDA_CPU_FIELD_LOCATION;
     for (int d = 0; d < CommKey::n_dim; d++) { cpu_cs_param_split.x[d] *= split_key[d]; }
-    std::vector<quda::ColorSpinorField *> _collect_b(param->num_src_per_sub_partition, nullptr);
-    std::vector<quda::ColorSpinorField *> _collect_x(param->num_src_per_sub_partition, nullptr);
-    for (int n = 0; n < param->num_src_per_sub_partition; n++) {
+    const int num_src_per_sub_partition = param->num_src_per_sub_partition;
+    std::vector<quda::ColorSpinorField *> _collect_b(num_src_per_sub_partition, nullptr);
+    std::vector<quda::ColorSpinorField *> _collect_x(num_src_per_sub_partition, nullptr);
+    std::vector<std::vector<ColorSpinorField *>> _v_b(num_src_per_sub_partition);
+    std::vector<std::vector<ColorSpinorField *>> _v_x(num_src_per_sub_partition);
+    for (int n = 0; n < num_src_per_sub_partition; n++) {
       _collect_b[n] = new quda::ColorSpinorField(cpu_cs_param_split);
       _collect_x[n] = new quda::ColorSpinorField(cpu_cs_param_split);
-      auto first = _h_b.begin() + n * num_sub_partition;
-      auto last = _h_b.begin() + (n + 1) * num_sub_partition;
-      std::vector<ColorSpinorField *> _v_b(first, last);
-      split_field(*_collect_b[n], _v_b, split_key, pc_type);
+      _v_b[n] = std::vector<ColorSpinorField *>(_h_b.begin() + n * num_sub_partition,
+                                                _h_b.begin() + (n + 1) * num_sub_partition);
+      _v_x[n] = std::vector<ColorSpinorField *>(_h_x.begin() + n * num_sub_partition,
+                                                _h_x.begin() + (n + 1) * num_sub_partition);
     }
+
+    // The sources and solutions are redistributed in a pipeline: source n + 1 is split and solution n - 1 is
+    // joined while source n is being solved on the sub-partitions.  Each transfer completes before the next one
+    // in the same direction is started, so a single slot is needed for each.  The messages are declared here
+    // while the default communicator is active, so they can be progressed under the split one.
+    FieldRedistribution<ColorSpinorField> split_b(*_h_b[0], split_key, true, 1, pc_type);
+    FieldRedistribution<ColorSpinorField> join_x(*_h_x[0], split_key, false, 1, pc_type);
+
+    split_b.start(0, *_collect_b[0], _v_b[0]);
+    split_b.wait(0, *_collect_b[0], _v_b[0]);
     comm_barrier();
 
     push_communicator(split_key);
@@ -3359,8 +3782,14 @@ void callMultiSrcQuda(void **_hp_x, void **_hp_b, QudaInvertParam *param, // col
       if (getVerbosity() >= QUDA_DEBUG_VERBOSE) { printfQuda("Split grid loaded clover field...\n"); }
     }
 
-    for (int n = 0; n < param->num_src_per_sub_partition; n++) {
+    for (int n = 0; n < num_src_per_sub_partition; n++) {
+      if (n + 1 < num_src_per_sub_partition) split_b.start(0, *_collect_b[n + 1], _v_b[n + 1]);
+
       op(_collect_x[n]->V(), _collect_b[n]->V(), param, args...);
+
+      if (n + 1 < num_src_per_sub_partition) split_b.wait(0, *_collect_b[n + 1], _v_b[n + 1]);
+      if (n > 0) join_x.wait(0, *_collect_x[n - 1], _v_x[n - 1]);
+      join_x.start(0, *_collect_x[n], _v_x[n]);
     }
 
     profileInvertMultiSrc.TPSTART(QUDA_PROFILE_TOTAL);
@@ -3374,12 +3803,8 @@ void callMultiSrcQuda(void **_hp_x, void **_hp_b, QudaInvertParam *param, // col
       gauge_param->ga_pad /= split_key[d];
     }
 
-    for (int n = 0; n < param->num_src_per_sub_partition; n++) {
-      auto first = _h_x.begin() + n * num_sub_partition;
-      auto last = _h_x.begin() + (n + 1) * num_sub_partition;
-      std::vector<ColorSpinorField *> _v_x(first, last);
-      join_field(_v_x, *_collect_x[n], split_key, pc_type);
-    }
+    join_x.wait(0, *_collect_x[num_src_per_sub_partition - 1], _v_x[num_src_per_sub_partition - 1]);
+    split_grid_stats().print_and_reset("source/solution redistribution");
 
     for (auto p : _collect_b) { delete p; }
     for (auto p : _collect_x) { delete p; }
@@ -3421,6 +3846,10 @@ void callMultiSrcQuda(void **_hp_x, void **_hp_b, QudaInvertParam *param, // col
 
 void invertMultiSrcQuda(void **_hp_x, void **_hp_b, QudaInvertParam *param, void *h_gauge, QudaGaugeParam *gauge_param)
 {
+  if (param->batched_multi_src == QUDA_BOOLEAN_TRUE) {
+    invertMultiSrcBatchedQuda(_hp_x, _hp_b, param);
+    return;
+  }
   auto op = [](void *_x, void *_b, QudaInvertParam *param) { invertQuda(_x, _b, param); };
   callMultiSrcQuda(_hp_x, _hp_b, param, h_gauge, nullptr, nullptr, gauge_param, nullptr, nullptr, op);
 }
@@ -3428,6 +3857,10 @@ void invertMultiSrcQuda(void **_hp_x, void **_hp_b, QudaInvertParam *param, void
 void invertMultiSrcStaggeredQuda(void **_hp_x, void **_hp_b, QudaInvertParam *param, void *milc_fatlinks,
                                  void *milc_longlinks, QudaGaugeParam *gauge_param)
 {
+  if (param->batched_multi_src == QUDA_BOOLEAN_TRUE) {
+    invertMultiSrcBatchedQuda(_hp_x, _hp_b, param);
+    return;
+  }
   auto op = [](void *_x, void *_b, QudaInvertParam *param) { invertQuda(_x, _b, param); };
   callMultiSrcQuda(_hp_x, _hp_b, param, nullptr, milc_fatlinks, milc_longlinks, gauge_param, nullptr, nullptr, op);
 }
@@ -3435,6 +3868,10 @@ void invertMultiSrcStaggeredQuda(void **_hp_x, void **_hp_b, QudaInvertParam *pa
 void invertMultiSrcCloverQuda(void **_hp_x, void **_hp_b, QudaInvertParam *param, void *h_gauge,
                               QudaGaugeParam *gauge_param, void *h_clover, void *h_clovinv)
 {
+  if (param->batched_multi_src == QUDA_BOOLEAN_TRUE) {
+    invertMultiSrcBatchedQuda(_hp_x, _hp_b, param);
+    return;
+  }
   auto op = [](void *_x, void *_b, QudaInvertParam *param) { invertQuda(_x, _b, param); };
   callMultiSrcQuda(_hp_x, _hp_b, param, h_gauge, nullptr, nullptr, gauge_param, h_clover, h_clovinv, op);
 }
@@ -3651,6 +4088,41 @@ void invertMultiShiftQuda(void **hp_x, void *hp_b, QudaInvertParam *param)
   }
 
   SolverParam solverParam(*param);
+  solverParam.record_telemetry = true;
+
+  // chronological forecasting: the basis holds previous solutions of
+  // the smallest shift, from which all shifts are forecast together
+  if (param->chrono_use_resident && chronoResident[param->chrono_index].size() > 0) {
+    if (!param->compute_true_res)
+      errorQuda("Chronological forecasting of multi-shift solves requires compute_true_res to refine the shifts");
+
+    profileMulti.TPSTART(QUDA_PROFILE_CHRONO);
+
+    // for staggered the first shift is already the mass term
+    const bool staggered = param->dslash_type == QUDA_ASQTAD_DSLASH || param->dslash_type == QUDA_STAGGERED_DSLASH;
+    const double shift0 = staggered ? 0.0 : param->offset[0];
+    m->shift = shift0;
+    mSloppy->shift = shift0;
+
+    std::vector<ColorSpinorField> basis, Ap;
+    const DiracMatrix &mChrono = chronoBasis(basis, Ap, *m, *mSloppy, *param);
+
+    std::vector<double> shift(param->num_offset);
+    for (int i = 0; i < param->num_offset; i++) shift[i] = param->offset[i] - param->offset[0];
+
+    bool orthogonal = true;
+    bool apply_mat = false;
+    bool hermitian = true;
+    MinResExt mre(mChrono, orthogonal, apply_mat, hermitian, profileMulti);
+    mre(x, b, basis, Ap, shift);
+    m->shift = 0.0;
+    mSloppy->shift = 0.0;
+
+    solverParam.use_init_guess = QUDA_USE_INIT_GUESS_YES;
+
+    profileMulti.TPSTOP(QUDA_PROFILE_CHRONO);
+  }
+
   {
     MultiShiftCG cg_m(*m, *mSloppy, solverParam, profileMulti);
     cg_m(x, b, p, r2_old);
@@ -3792,6 +4264,12 @@ void invertMultiShiftQuda(void **hp_x, void *hp_b, QudaInvertParam *param)
     param->action[1] = action.imag();
   }
 
+  if (param->chrono_make_resident) {
+    profileMulti.TPSTART(QUDA_PROFILE_CHRONO);
+    makeChronoResident(x[0], *param);
+    profileMulti.TPSTOP(QUDA_PROFILE_CHRONO);
+  }
+
   for(int i=0; i < param->num_offset; i++) {
     if (param->solver_normalization == QUDA_SOURCE_NORMALIZATION) { // rescale the solution
       blas::ax(sqrt(nb), x[i]);
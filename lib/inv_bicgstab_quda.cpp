@@ -218,12 +218,14 @@ namespace quda {
     double maxrr = rNorm;
     double maxrx = rNorm;
 
-    PrintStats("BiCGstab", k, r2, b2, heavy_quark_res);
-
     if (!param.is_preconditioner) { // do not do the below if we this is an inner solver
       blas::flops = 0;
+      telemetry.begin("BiCGstab", param, b2);
     }
 
+    PrintStats("BiCGstab", k, r2, b2, heavy_quark_res);
+    telemetry.iteration(k, r2, heavy_quark_res);
+
     profile.TPSTOP(QUDA_PROFILE_PREAMBLE);
     profile.TPSTART(QUDA_PROFILE_COMPUTE);
 
@@ -325,11 +327,19 @@ namespace quda {
 	maxrx = rNorm;
 	//r0Norm = rNorm;
 	rUpdate++;
+        telemetry.reliable_update();
+
+        // the caller may end the solve at a reliable update, where the solution is up to date
+        if (param.reliable_update_hook && param.reliable_update_hook(k + 1, r2)) {
+          k++;
+          break;
+        }
       }
 
       k++;
 
       PrintStats("BiCGstab", k, r2, b2, heavy_quark_res);
+      telemetry.iteration(k, r2, heavy_quark_res);
       if (getVerbosity() >= QUDA_DEBUG_VERBOSE)
 	printfQuda("BiCGstab debug: x2=%e, r2=%e, v2=%e, p2=%e, tmp2=%e r0=%e t2=%e\n",
 		   blas::norm2(x), blas::norm2(rSloppy), blas::norm2(v), blas::norm2(p),
@@ -351,7 +361,9 @@ namespace quda {
     profile.TPSTART(QUDA_PROFILE_EPILOGUE);
 
     param.secs += profile.Last(QUDA_PROFILE_COMPUTE);
-    double gflops = (blas::flops + mat.flops() + matSloppy.flops() + matPrecon.flops())*1e-9;
+    double blas_gflops = blas::flops * 1e-9;
+    double gflops = blas_gflops + (mat.flops() + matSloppy.flops() + matPrecon.flops()) * 1e-9;
+    telemetry.set_flops(gflops - blas_gflops, blas_gflops);
 
     param.gflops += gflops;
     param.iter += k;
@@ -367,6 +379,8 @@ namespace quda {
       param.true_res_hq = use_heavy_quark_res ? sqrt(blas::HeavyQuarkResidualNorm(x,r).z) : 0.0;
 
       PrintSummary("BiCGstab", k, r2, b2, stop, param.tol_hq);
+      telemetry.end(k, convergence(r2, heavy_quark_res, stop, param.tol_hq), param.true_res,
+                    use_heavy_quark_res ? param.true_res_hq : NAN);
     }
 
     // reset the flops counters
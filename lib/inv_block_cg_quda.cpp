@@ -0,0 +1,288 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include <quda_internal.h>
+#include <color_spinor_field.h>
+#include <blas_quda.h>
+#include <invert_quda.h>
+#include <util_quda.h>
+#include <eigen_helper.h>
+
+/*
+  Breakdown-free block CG:
+  H. Ji and Y. Li, "A breakdown-free block conjugate gradient method",
+  BIT Numer. Math. 57 (2017) p. 379-403
+*/
+
+namespace quda
+{
+
+  using matrix = Matrix<Complex, Dynamic, Dynamic>;
+
+  BlockCG::BlockCG(const DiracMatrix &mat, const DiracMatrix &matSloppy, SolverParam &param, TimeProfile &profile) :
+    MultiSrcCG(mat, matSloppy, param, profile)
+  {
+  }
+
+  /**
+     @brief Extract the block of rows [row0, row0 + rows) and columns
+     [col0, col0 + cols) from a row-major result of a block reduction
+     with ld columns
+   */
+  static matrix block(const std::vector<Complex> &G, int ld, int row0, int rows, int col0, int cols)
+  {
+    matrix B(rows, cols);
+    for (int i = 0; i < rows; i++)
+      for (int j = 0; j < cols; j++) B(i, j) = G[(row0 + i) * ld + col0 + j];
+    return B;
+  }
+
+  /**
+     @brief Flatten a matrix to the row-major coefficients of the multi-blas
+   */
+  static std::vector<Complex> coefficients(const matrix &B)
+  {
+    std::vector<Complex> a(B.rows() * B.cols());
+    for (int i = 0; i < B.rows(); i++)
+      for (int j = 0; j < B.cols(); j++) a[i * B.cols() + j] = B(i, j);
+    return a;
+  }
+
+  /*
+    Rank-revealing orthonormalization from the Gram matrix G = W* W.
+    The Cholesky factorization of G with diagonal pivoting is the
+    triangular factor R of the column-pivoted QR factorization
+    W Pi = Q R, and is stopped once the remaining columns, scaled to
+    unit norm, are within tol of the span of the selected ones.  The
+    returned n x k coefficients C give the orthonormal basis Q = W C.
+  */
+  static matrix orthonormalBasis(const matrix &G, double tol)
+  {
+    const int n = G.rows();
+
+    std::vector<double> d(n);
+    for (int i = 0; i < n; i++) d[i] = G(i, i).real() > 0.0 ? 1.0 / sqrt(G(i, i).real()) : 0.0;
+    matrix A(n, n);
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < n; j++) A(i, j) = d[i] * G(i, j) * d[j];
+
+    std::vector<int> perm(n);
+    std::iota(perm.begin(), perm.end(), 0);
+    matrix L = matrix::Zero(n, n);
+
+    int k = 0;
+    for (; k < n; k++) {
+      int piv = k;
+      for (int i = k + 1; i < n; i++)
+        if (A(i, i).real() > A(piv, piv).real()) piv = i;
+      if (A(piv, piv).real() <= tol * tol) break; // the remaining columns are dependent
+
+      if (piv != k) {
+        A.row(k).swap(A.row(piv));
+        A.col(k).swap(A.col(piv));
+        L.row(k).swap(L.row(piv));
+        std::swap(perm[k], perm[piv]);
+      }
+
+      L(k, k) = sqrt(A(k, k).real());
+      for (int i = k + 1; i < n; i++) L(i, k) = A(i, k) / L(k, k);
+      for (int i = k + 1; i < n; i++)
+        for (int j = k + 1; j < n; j++) A(i, j) -= L(i, k) * std::conj(L(j, k));
+    }
+
+    matrix R_inv = L.topLeftCorner(k, k).adjoint().triangularView<Upper>().solve(matrix::Identity(k, k));
+    matrix C = matrix::Zero(n, k);
+    for (int i = 0; i < k; i++) C.row(perm[i]) = d[perm[i]] * R_inv.row(i);
+    return C;
+  }
+
+  /**
+     @brief Relative tolerance below which a search direction is
+     treated as dependent: the square root of the unit roundoff of the
+     precision the directions are stored in
+   */
+  static double dependenceTolerance(QudaPrecision prec)
+  {
+    switch (prec) {
+    case QUDA_DOUBLE_PRECISION: return sqrt(std::numeric_limits<double>::epsilon() / 2.);
+    case QUDA_SINGLE_PRECISION: return sqrt(std::numeric_limits<float>::epsilon() / 2.);
+    case QUDA_HALF_PRECISION: return pow(2., -6.5);
+    case QUDA_QUARTER_PRECISION: return pow(2., -3);
+    default: errorQuda("Invalid precision %d", prec);
+    }
+    return 0.0;
+  }
+
+  int BlockCG::orthonormalize(int m)
+  {
+    vector_ref<ColorSpinorField> w = {s.begin(), s.begin() + m};
+
+    std::vector<Complex> G_(m * m);
+    blas::hDotProduct(G_, w, w);
+
+    profile.TPSTOP(QUDA_PROFILE_COMPUTE);
+    profile.TPSTART(QUDA_PROFILE_EIGEN);
+
+    matrix C = orthonormalBasis(block(G_, m, 0, m, 0, m), dependenceTolerance(param.precision_sloppy));
+    const int k = C.cols();
+
+    profile.TPSTOP(QUDA_PROFILE_EIGEN);
+    profile.TPSTART(QUDA_PROFILE_COMPUTE);
+
+    if (k < m) logQuda(QUDA_VERBOSE, "Dropped %d dependent search directions\n", m - k);
+    if (k == 0) return 0;
+
+    vector_ref<ColorSpinorField> p_k = {p.begin(), p.begin() + k};
+    blas::zero(p_k);
+    blas::caxpy(coefficients(C), w, p_k);
+
+    return k;
+  }
+
+  /*
+    Each iteration applies the operator to the k orthonormal search
+    directions P, and takes
+
+      X += P alpha,  R -= Q alpha,  alpha = (P* Q)^{-1} P* R,  Q = A P
+
+    with P* [Q, R] from one block reduction.  The next directions are
+    W = R + P beta, beta = -(P* Q)^{-1} Q* R, with [Q, R]* R from a
+    second block reduction, which also gives the residual norms.  W
+    is orthonormalized with a rank-revealing factorization of W* W,
+    the third block reduction, so that dependent directions are
+    dropped rather than making P* Q singular.  Converged sources are
+    removed from R, so the block width k never exceeds the number of
+    unconverged sources.
+  */
+  void BlockCG::operator()(std::vector<ColorSpinorField> &x, std::vector<ColorSpinorField> &b)
+  {
+    const int n = b.size();
+    if (n == 0) return;
+
+    pushOutputPrefix("BlockCG: ");
+
+    create(x, b);
+
+    std::vector<double> b2(n), r2(n), stop(n);
+    std::vector<int> active = initialize(x, b, b2, r2, stop);
+
+    std::vector<double> r_max(n); // largest residual norm since the last reliable update
+    std::vector<int> iter(n, 0);
+    for (int i = 0; i < n; i++) r_max[i] = sqrt(r2[i]);
+
+    // the initial search directions span the residuals
+    for (auto a = 0u; a < active.size(); a++) blas::copy(s[a], r_sloppy[active[a]]);
+    int width = active.empty() ? 0 : orthonormalize(active.size());
+
+    int k = 0;
+    int rUpdate = 0;
+
+    while (!active.empty() && width > 0 && k < param.maxiter) {
+      const int m = active.size();
+      vector_ref<ColorSpinorField> p_k = {p.begin(), p.begin() + width};
+      vector_ref<ColorSpinorField> q_k = {q.begin(), q.begin() + width};
+      auto r_a = subset(r_sloppy, active);
+      auto x_a = subset(x_sloppy, active);
+
+      matSloppy(q_k, p_k);
+
+      // P* [Q, R] in a single reduction
+      std::vector<Complex> G1(width * (width + m));
+      blas::cDotProduct(G1, p_k, {q_k, r_a});
+      matrix PQ = block(G1, width + m, 0, width, 0, width);
+      PQ = 0.5 * (PQ + PQ.adjoint()).eval();
+      LDLT<matrix> PQ_ldlt(PQ);
+      matrix alpha = PQ_ldlt.solve(block(G1, width + m, 0, width, width, m));
+
+      blas::caxpy(coefficients(alpha), p_k, x_a);
+      blas::caxpy(coefficients(-alpha), q_k, r_a);
+      for (auto i : active) iter[i]++;
+      k++;
+
+      // [Q, R]* R in a single reduction, for the next directions and the residual norms
+      std::vector<Complex> G2((width + m) * m);
+      blas::cDotProduct(G2, {q_k, r_a}, r_a);
+
+      // the columns of X and R are updated independently, so a reliable update is only done for the sources that
+      // trigger one, forced on convergence should this have been accumulated in sloppy precision
+      std::vector<int> update, update_cols;
+      for (int a = 0; a < m; a++) {
+        const int i = active[a];
+        r2[i] = G2[(width + a) * m + a].real();
+        r_max[i] = std::max(r_max[i], sqrt(r2[i]));
+        if (sqrt(r2[i]) < param.delta * r_max[i] || (r2[i] < stop[i] && param.delta >= param.tol)) {
+          update.push_back(i);
+          update_cols.push_back(a);
+        }
+      }
+
+      if (!update.empty()) {
+        for (auto i : update) {
+          blas::xpy(x_sloppy[i], x[i]);
+          blas::zero(x_sloppy[i]);
+        }
+        auto x_u = subset(x, update);
+        mat(subset(r, update), x_u);
+        for (auto i : update) {
+          r2[i] = blas::xmyNorm(b[i], r[i]);
+          blas::copy(r_sloppy[i], r[i]);
+          r_max[i] = sqrt(r2[i]);
+        }
+
+        // refresh the columns of [Q, R]* R of the updated residuals
+        const int u = update.size();
+        std::vector<Complex> G2_u((width + m) * u);
+        auto r_u = subset(r_sloppy, update);
+        blas::cDotProduct(G2_u, {q_k, r_a}, r_u);
+        for (int i = 0; i < width + m; i++)
+          for (int c = 0; c < u; c++) G2[i * m + update_cols[c]] = G2_u[i * u + c];
+        rUpdate += u;
+      }
+
+      // drop the converged sources from the block
+      std::vector<int> next, cols;
+      for (int a = 0; a < m; a++) {
+        const int i = active[a];
+        if (r2[i] < stop[i]) {
+          logQuda(QUDA_VERBOSE, "Source %d converged after %d iterations\n", i, iter[i]);
+        } else {
+          next.push_back(i);
+          cols.push_back(a);
+        }
+      }
+      active = next;
+      if (active.empty()) break;
+
+      // W = R + P beta, with beta = -(P* Q)^{-1} Q* R
+      matrix QR(width, active.size());
+      for (int i = 0; i < width; i++)
+        for (auto c = 0u; c < cols.size(); c++) QR(i, c) = G2[i * m + cols[c]];
+      matrix beta = -PQ_ldlt.solve(QR);
+
+      vector_ref<ColorSpinorField> w = {s.begin(), s.begin() + active.size()};
+      for (auto c = 0u; c < active.size(); c++) blas::copy(w[c], r_sloppy[active[c]]);
+      blas::caxpy(coefficients(beta), p_k, w);
+
+      width = orthonormalize(active.size());
+
+      if (getVerbosity() >= QUDA_VERBOSE) {
+        double r_rel = 0.0;
+        for (auto i : active) r_rel = std::max(r_rel, sqrt(r2[i] / b2[i]));
+        printfQuda("%d iterations, block width %d, %d active sources, max |r| / |b| = %e\n", k, width,
+                   (int)active.size(), r_rel);
+      }
+    }
+
+    if (!active.empty() && width == 0) warningQuda("Search space exhausted with %lu active sources", active.size());
+    if (k == param.maxiter) warningQuda("Exceeded maximum iterations %d with %lu active sources", k, active.size());
+
+    logQuda(QUDA_VERBOSE, "Reliable updates = %d\n", rUpdate);
+
+    finalize(x, b, b2, r2, iter, k);
+
+    popOutputPrefix();
+  }
+
+} // namespace quda
@@ -0,0 +1,404 @@
+#include <invert_quda.h>
+#include <blas_quda.h>
+#include <eigen_helper.h>
+#include <solver.hpp>
+
+namespace quda
+{
+
+  CABiCGstab::CABiCGstab(const DiracMatrix &mat, const DiracMatrix &matSloppy, const DiracMatrix &matPrecon,
+                         const DiracMatrix &matEig, SolverParam &param, TimeProfile &profile) :
+    Solver(mat, matSloppy, matPrecon, matEig, param, profile), init(false), lambda_init(false), basis(param.ca_basis)
+  {
+  }
+
+  CABiCGstab::~CABiCGstab()
+  {
+    if (!param.is_preconditioner) profile.TPSTART(QUDA_PROFILE_FREE);
+    destroyDeflationSpace();
+    if (!param.is_preconditioner) profile.TPSTOP(QUDA_PROFILE_FREE);
+  }
+
+  void CABiCGstab::create(ColorSpinorField &x, const ColorSpinorField &b)
+  {
+    Solver::create(x, b);
+
+    if (!init) {
+      if (!param.is_preconditioner) {
+        blas::flops = 0;
+        profile.TPSTART(QUDA_PROFILE_INIT);
+      }
+
+      const int s = param.Nkrylov;
+
+      ColorSpinorParam csParam(b);
+      csParam.create = QUDA_NULL_FIELD_CREATE;
+      csParam.setPrecision(param.precision_sloppy);
+
+      // P and R live in a single array so that the Gram matrix is one reduction
+      Y.resize(4 * s + 1);
+      P.resize(2 * s + 1);
+      R.resize(2 * s);
+      for (auto &y : Y) y = ColorSpinorField(csParam);
+      for (int i = 0; i < 2 * s + 1; i++) P[i] = Y[i].create_alias(csParam);
+      for (int i = 0; i < 2 * s; i++) R[i] = Y[2 * s + 1 + i].create_alias(csParam);
+
+      AP.resize(2 * s);
+      AR.resize(2 * s - 1);
+      if (basis == QUDA_POWER_BASIS) {
+        // in power basis A p[k] = p[k+1], so we don't need separate A P and A R arrays
+        for (int i = 0; i < 2 * s; i++) AP[i] = P[i + 1].create_alias(csParam);
+        for (int i = 0; i < 2 * s - 1; i++) AR[i] = R[i + 1].create_alias(csParam);
+      } else {
+        // A P is no longer needed once P is complete, so A R can reuse it
+        for (int i = 0; i < 2 * s; i++) AP[i] = ColorSpinorField(csParam);
+        for (int i = 0; i < 2 * s - 1; i++) AR[i] = AP[i].create_alias(csParam);
+      }
+
+      tmp = ColorSpinorField(csParam);
+      r_tilde = ColorSpinorField(csParam);
+
+      csParam.setPrecision(param.precision);
+      r = ColorSpinorField(csParam);
+
+      if (!param.is_preconditioner) profile.TPSTOP(QUDA_PROFILE_INIT);
+      init = true;
+    } // init
+  }
+
+  void CABiCGstab::extendBasis(std::vector<ColorSpinorField> &v, std::vector<ColorSpinorField> &Av, int n,
+                               double m_map, double b_map)
+  {
+    if (basis == QUDA_POWER_BASIS) {
+      blas::copy(v[n], Av[n - 1]); // no-op since aliased
+    } else if (n == 1) {
+      // v[1] = m_map A v[0] + b_map v[0]
+      blas::axpbyz(m_map, Av[0], b_map, v[0], v[1]);
+    } else {
+      // v[n] = 2 m_map A v[n-1] + 2 b_map v[n-1] - v[n-2]
+      blas::axpbypczw(2. * m_map, Av[n - 1], 2. * b_map, v[n - 1], -1., v[n - 2], v[n]);
+    }
+  }
+
+  ColorSpinorField &CABiCGstab::get_residual()
+  {
+    if (!init) errorQuda("No residual vector present");
+    if (!param.return_residual) errorQuda("SolverParam::return_residual not enabled");
+    return r;
+  }
+
+  /**
+     @brief Fill in the matrix T such that A Y' = Y T, where Y' is Y
+     with the last vector of both the P and R blocks dropped
+     @param[out] T The change of basis matrix
+     @param[in] offset The offset of the block
+     @param[in] n The number of columns of the block
+     @param[in] basis The CA basis
+     @param[in] m_map Slope mapping for Chebyshev basis
+     @param[in] b_map Intercept mapping for Chebyshev basis
+   */
+  template <typename matrix>
+  static void changeOfBasis(matrix &T, int offset, int n, QudaCABasis basis, double m_map, double b_map)
+  {
+    for (int k = 0; k < n; k++) {
+      auto i = offset + k;
+      if (basis == QUDA_POWER_BASIS) {
+        T(i + 1, i) = 1.0;
+      } else if (k == 0) {
+        // A v_0 = (v_1 - b_map v_0) / m_map
+        T(i, i) = -b_map / m_map;
+        T(i + 1, i) = 1.0 / m_map;
+      } else {
+        // A v_k = (v_{k+1} + v_{k-1} - 2 b_map v_k) / (2 m_map)
+        T(i - 1, i) = 0.5 / m_map;
+        T(i, i) = -b_map / m_map;
+        T(i + 1, i) = 0.5 / m_map;
+      }
+    }
+  }
+
+  /*
+    The main CA-BiCGstab algorithm, which consists of three main steps:
+    1. Build bases P and R of size 2s+1 and 2s from p and r
+    2. Compute the Gram matrix of [P, R] and its projection onto the shadow residual
+    3. Perform s BiCGstab iterations on the coordinate vectors and update x, r and p
+  */
+  void CABiCGstab::operator()(ColorSpinorField &x, ColorSpinorField &b)
+  {
+    typedef Matrix<Complex, Dynamic, Dynamic> matrix;
+    typedef Matrix<Complex, Dynamic, 1> vector;
+
+    const int s = param.Nkrylov;
+
+    if (param.maxiter == 0 || s == 0) {
+      if (param.use_init_guess == QUDA_USE_INIT_GUESS_NO) blas::zero(x);
+      return;
+    }
+
+    create(x, b);
+
+    if (!param.is_preconditioner) profile.TPSTART(QUDA_PROFILE_PREAMBLE);
+
+    double b2 = blas::norm2(b);
+    double r2 = 0.0; // if zero source then we will exit immediately doing no work
+
+    // compute intitial residual depending on whether we have an initial guess or not
+    if (param.use_init_guess == QUDA_USE_INIT_GUESS_YES) {
+      mat(r, x);
+      r2 = blas::xmyNorm(b, r);
+    } else {
+      r2 = b2;
+      blas::copy(r, b);
+      blas::zero(x);
+    }
+
+    // Use power iterations to approx lambda_max
+    auto &lambda_min = param.ca_lambda_min;
+    auto &lambda_max = param.ca_lambda_max;
+
+    if (basis == QUDA_CHEBYSHEV_BASIS && lambda_max < lambda_min && !lambda_init) {
+      if (!param.is_preconditioner) {
+        profile.TPSTOP(QUDA_PROFILE_PREAMBLE);
+        profile.TPSTART(QUDA_PROFILE_INIT);
+      }
+
+      // Perform 100 power iterations, normalizing every 10 mat-vecs, using r as an initial seed
+      // and AP[0]/AP[1] as temporaries for the power iterations
+      lambda_max = 1.1 * Solver::performPowerIterations(matSloppy, r, AP[0], AP[1], 100, 10);
+      logQuda(QUDA_SUMMARIZE, "CA-BiCGstab Approximate lambda max = 1.1 x %e\n", lambda_max / 1.1);
+
+      lambda_init = true;
+
+      if (!param.is_preconditioner) {
+        profile.TPSTOP(QUDA_PROFILE_INIT);
+        profile.TPSTART(QUDA_PROFILE_PREAMBLE);
+      }
+    }
+
+    // Factors which map linear operator onto [-1,1]
+    double m_map = 2. / (lambda_max - lambda_min);
+    double b_map = -(lambda_max + lambda_min) / (lambda_max - lambda_min);
+
+    // Check to see that we're not trying to invert on a zero-field source
+    if (b2 == 0) {
+      if (param.compute_null_vector == QUDA_COMPUTE_NULL_VECTOR_NO) {
+        warningQuda("inverting on zero-field source\n");
+        x = b;
+        param.true_res = 0.0;
+        param.true_res_hq = 0.0;
+        return;
+      } else {
+        b2 = r2;
+      }
+    }
+
+    double stop = stopping(param.tol, b2, param.residual_type); // stopping condition of solver
+
+    const bool use_heavy_quark_res = (param.residual_type & QUDA_HEAVY_QUARK_RESIDUAL) ? true : false;
+
+    // this parameter determines how many consective reliable update
+    // reisudal increases we tolerate before terminating the solver,
+    // i.e., how long do we want to keep trying to converge
+    const int maxResIncrease = param.max_res_increase; // check if we reached the limit of our tolerance
+    const int maxResIncreaseTotal = param.max_res_increase_total;
+
+    double heavy_quark_res = 0.0; // heavy quark residual
+    if (use_heavy_quark_res) heavy_quark_res = sqrt(blas::HeavyQuarkResidualNorm(x, r).z);
+
+    int resIncrease = 0;
+    int resIncreaseTotal = 0;
+
+    if (!param.is_preconditioner) {
+      blas::flops = 0;
+      profile.TPSTOP(QUDA_PROFILE_PREAMBLE);
+      profile.TPSTART(QUDA_PROFILE_COMPUTE);
+    }
+
+    // the coordinates of the basis vectors are fixed, so T is only computed once
+    const int N = 4 * s + 1;
+    matrix T = matrix::Zero(N, N);
+    changeOfBasis(T, 0, 2 * s, basis, m_map, b_map);
+    changeOfBasis(T, 2 * s + 1, 2 * s - 1, basis, m_map, b_map);
+
+    matrix G(N, N);
+    vector g(N), a(N), c(N), e(N);
+    std::vector<Complex> Gg(N * (N + 1));
+    std::vector<Complex> coeff(N);
+
+    int total_iter = 0;
+    double r2_old = r2;
+    bool breakdown = false;
+
+    blas::copy(r_tilde, r);
+    blas::copy(P[0], r);
+    blas::copy(R[0], r);
+
+    PrintStats("CA-BiCGstab", total_iter, r2, b2, heavy_quark_res);
+    while (!convergence(r2, heavy_quark_res, stop, param.tol_hq) && total_iter < param.maxiter && !breakdown) {
+
+      // build up the bases P = [p, A p, ..., A^2s p] and R = [r, A r, ..., A^(2s-1) r]
+      computeCAKrylovSpace(matSloppy, AP, P, 2 * s, basis, m_map, b_map);
+      extendBasis(P, AP, 2 * s, m_map, b_map);
+      computeCAKrylovSpace(matSloppy, AR, R, 2 * s - 1, basis, m_map, b_map);
+      extendBasis(R, AR, 2 * s - 1, m_map, b_map);
+
+      // the only reduction for s iterations: G = Y^* Y and g = Y^* r_tilde
+      blas::cDotProduct(Gg, Y, {Y, r_tilde});
+      for (int i = 0; i < N; i++) {
+        g(i) = Gg[i * (N + 1) + N];
+        for (int j = 0; j < N; j++) G(i, j) = Gg[i * (N + 1) + j];
+      }
+
+      if (!param.is_preconditioner) {
+        profile.TPSTOP(QUDA_PROFILE_COMPUTE);
+        param.secs += profile.Last(QUDA_PROFILE_COMPUTE);
+        profile.TPSTART(QUDA_PROFILE_EIGEN);
+      }
+
+      // coordinates of p, r and the update to x in the basis Y
+      a.setZero();
+      a(0) = 1.0;
+      c.setZero();
+      c(2 * s + 1) = 1.0;
+      e.setZero();
+
+      Complex delta = g.dot(c); // (r_tilde, r)
+      double r2_est = r2;
+      int j = 0;
+      for (; j < s; j++) {
+        vector Ta = T * a;
+        Complex gTa = g.dot(Ta);
+        if (gTa == 0.0) {
+          warningQuda("CA-BiCGstab: breakdown (r_tilde, A p) = 0 at iteration %d", total_iter + j);
+          breakdown = true;
+          break;
+        }
+        Complex alpha = delta / gTa;
+
+        vector d = c - alpha * Ta;
+        vector Td = T * d;
+        Complex tt = Td.dot(G * Td);
+        Complex omega = tt != 0.0 ? Td.dot(G * d) / tt : 0.0;
+
+        e += alpha * a + omega * d;
+        c = d - omega * Td;
+
+        r2_est = std::abs(c.dot(G * c));
+        if (omega == 0.0 || r2_est < stop) {
+          if (omega == 0.0) {
+            warningQuda("CA-BiCGstab: breakdown omega = 0 at iteration %d", total_iter + j);
+            breakdown = true;
+          }
+          j++;
+          break;
+        }
+
+        Complex delta_new = g.dot(c);
+        Complex beta = (delta_new / delta) * (alpha / omega);
+        a = c + beta * (a - omega * Ta);
+        delta = delta_new;
+      }
+
+      if (!param.is_preconditioner) {
+        profile.TPSTOP(QUDA_PROFILE_EIGEN);
+        param.secs += profile.Last(QUDA_PROFILE_EIGEN);
+        profile.TPSTART(QUDA_PROFILE_COMPUTE);
+      }
+
+      // x += Y e
+      for (int i = 0; i < N; i++) coeff[i] = e(i);
+      blas::caxpy(coeff, Y, x);
+
+      // r = Y c
+      for (int i = 0; i < N; i++) coeff[i] = c(i);
+      blas::zero(r);
+      blas::caxpy(coeff, Y, r);
+
+      // p = Y a, via tmp since p aliases Y[0]
+      for (int i = 0; i < N; i++) coeff[i] = a(i);
+      blas::zero(tmp);
+      blas::caxpy(coeff, Y, tmp);
+      blas::copy(P[0], tmp);
+
+      total_iter += j;
+      r2 = blas::norm2(r);
+      if (use_heavy_quark_res) heavy_quark_res = sqrt(blas::HeavyQuarkResidualNorm(x, r).z);
+
+      logQuda(QUDA_DEBUG_VERBOSE, "CA-BiCGstab: estimated |r|^2 = %e, computed |r|^2 = %e\n", r2_est, r2);
+      PrintStats("CA-BiCGstab", total_iter, r2, b2, heavy_quark_res);
+
+      // reliable update if converged, maxiter reached or the residual has dropped by delta
+      if (total_iter >= param.maxiter || r2 < stop || breakdown || sqrt(r2 / r2_old) < param.delta) {
+
+        if ((r2 < stop || total_iter >= param.maxiter) && param.sloppy_converge) break;
+        mat(r, x);
+        r2 = blas::xmyNorm(b, r);
+
+        if (use_heavy_quark_res) heavy_quark_res = sqrt(blas::HeavyQuarkResidualNorm(x, r).z);
+
+        // break-out check if we have reached the limit of the precision
+        if (r2 > r2_old) {
+          resIncrease++;
+          resIncreaseTotal++;
+          warningQuda("CA-BiCGstab: new reliable residual norm %e is greater than previous reliable residual norm %e "
+                      "(total #inc %i)",
+                      sqrt(r2), sqrt(r2_old), resIncreaseTotal);
+          if (resIncrease > maxResIncrease or resIncreaseTotal > maxResIncreaseTotal) {
+            warningQuda("CA-BiCGstab: solver exiting due to too many true residual norm increases");
+            break;
+          }
+        } else {
+          resIncrease = 0;
+        }
+
+        // on breakdown restart with the true residual as both the search direction and shadow residual
+        if (breakdown && !convergence(r2, heavy_quark_res, stop, param.tol_hq)) {
+          PrintStats("CA-BiCGstab (restart)", total_iter, r2, b2, heavy_quark_res);
+          blas::copy(r_tilde, r);
+          blas::copy(P[0], r);
+          breakdown = false;
+        }
+
+        r2_old = r2;
+      }
+
+      blas::copy(R[0], r);
+    }
+
+    if (total_iter > param.maxiter && getVerbosity() >= QUDA_SUMMARIZE)
+      warningQuda("Exceeded maximum iterations %d", param.maxiter);
+
+    if (param.compute_true_res) {
+      // Calculate the true residual
+      mat(r, x);
+      double true_res = blas::xmyNorm(b, r);
+      param.true_res = sqrt(true_res / b2);
+      param.true_res_hq
+        = (param.residual_type & QUDA_HEAVY_QUARK_RESIDUAL) ? sqrt(blas::HeavyQuarkResidualNorm(x, r).z) : 0.0;
+    }
+
+    if (!param.is_preconditioner) {
+      qudaDeviceSynchronize(); // ensure solver is complete before ending timing
+      profile.TPSTOP(QUDA_PROFILE_COMPUTE);
+      profile.TPSTART(QUDA_PROFILE_EPILOGUE);
+      param.secs += profile.Last(QUDA_PROFILE_COMPUTE);
+
+      // store flops and reset counters
+      double gflops = (blas::flops + mat.flops() + matSloppy.flops() + matPrecon.flops()) * 1e-9;
+
+      param.gflops += gflops;
+      param.iter += total_iter;
+
+      // reset the flops counters
+      blas::flops = 0;
+      mat.flops();
+      matSloppy.flops();
+      matPrecon.flops();
+
+      profile.TPSTOP(QUDA_PROFILE_EPILOGUE);
+    }
+
+    PrintSummary("CA-BiCGstab", total_iter, r2, b2, stop, param.tol_hq);
+  }
+
+} // namespace quda
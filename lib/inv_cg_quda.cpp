@@ -388,11 +388,13 @@ namespace quda {
       profile.TPSTOP(QUDA_PROFILE_PREAMBLE);
       profile.TPSTART(QUDA_PROFILE_COMPUTE);
       blas::flops = 0;
+      telemetry.begin("CG", param, b2);
     }
 
     int k = 0;
 
     PrintStats("CG", k, r2, b2, heavy_quark_res);
+    telemetry.iteration(k, r2, heavy_quark_res);
 
     bool converged = convergence(r2, heavy_quark_res, stop, param.tol_hq);
 
@@ -545,6 +547,12 @@ namespace quda {
           if (ru.reliable_break(r2, stop, L2breakdown, L2breakdown_eps)) { break; }
         }
 
+        // the caller may end the solve at a reliable update, where the solution is up to date
+        if (param.reliable_update_hook && param.reliable_update_hook(k + 1, r2)) {
+          k++;
+          break;
+        }
+
         // if L2 broke down already we turn off reliable updates and restart the CG
         if (use_heavy_quark_res && ru.reliable_heavy_quark_break(L2breakdown, heavy_quark_res, heavy_quark_res_old, heavy_quark_restart)) {
           break;
@@ -565,6 +573,7 @@ namespace quda {
         }
 
         ru.reset(r2);
+        telemetry.reliable_update();
 
         heavy_quark_res_old = heavy_quark_res;
       }
@@ -573,6 +582,7 @@ namespace quda {
       k++;
 
       PrintStats("CG", k, r2, b2, heavy_quark_res);
+      telemetry.iteration(k, r2, heavy_quark_res);
       // check convergence, if convergence is satisfied we only need to check that we had a reliable update for the heavy quarks recently
       converged = convergence(r2, heavy_quark_res, stop, param.tol_hq);
 
@@ -606,9 +616,11 @@ namespace quda {
       profile.TPSTART(QUDA_PROFILE_EPILOGUE);
 
       param.secs = profile.Last(QUDA_PROFILE_COMPUTE);
-      double gflops = (blas::flops + mat.flops() + matSloppy.flops() + matPrecon.flops() + matEig.flops()) * 1e-9;
+      double blas_gflops = blas::flops * 1e-9;
+      double gflops = blas_gflops + (mat.flops() + matSloppy.flops() + matPrecon.flops() + matEig.flops()) * 1e-9;
       param.gflops = gflops;
       param.iter += k;
+      telemetry.set_flops(gflops - blas_gflops, blas_gflops);
 
       if (k == param.maxiter) warningQuda("Exceeded maximum iterations %d", param.maxiter);
     }
@@ -623,6 +635,10 @@ namespace quda {
     }
 
     PrintSummary("CG", k, r2, b2, stop, param.tol_hq);
+    if (advanced_feature && param.compute_true_res)
+      telemetry.end(k, converged, param.true_res, use_heavy_quark_res ? param.true_res_hq : NAN);
+    else
+      telemetry.end(k, converged, NAN, NAN);
 
     if (!param.is_preconditioner) {
       // reset the flops counters
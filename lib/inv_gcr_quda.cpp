@@ -336,11 +336,13 @@ namespace quda {
 
     profile.TPSTOP(QUDA_PROFILE_PREAMBLE);
     profile.TPSTART(QUDA_PROFILE_COMPUTE);
+    telemetry.begin("GCR", param, b2);
 
     int k = 0;
     int k_break = 0;
 
     PrintStats("GCR", total_iter+k, r2, b2, heavy_quark_res);
+    telemetry.iteration(total_iter, r2, heavy_quark_res);
     while ( !convergence(r2, heavy_quark_res, stop, param.tol_hq) && total_iter < param.maxiter) {
 
       if (K) {
@@ -368,6 +370,7 @@ namespace quda {
       total_iter++;
 
       PrintStats("GCR", total_iter, r2, b2, heavy_quark_res);
+      telemetry.iteration(total_iter, r2, heavy_quark_res);
 
       // update since n_krylov or maxiter reached, converged or reliable update required
       // note that the heavy quark residual will by definition only be checked every n_krylov steps
@@ -379,6 +382,7 @@ namespace quda {
         if ( (r2 < stop || total_iter==param.maxiter) && param.sloppy_converge) break;
         mat(r, x);
         r2 = blas::xmyNorm(b, r);
+        telemetry.reliable_update();
 
         if (param.deflate && sqrt(r2) < maxr_deflate * param.tol_restart) {
           // Deflate: Hardcoded to SVD.
@@ -407,6 +411,9 @@ namespace quda {
           resIncrease = 0;
         }
 
+        // the caller may end the solve at a reliable update, where the solution is up to date
+        if (param.reliable_update_hook && param.reliable_update_hook(total_iter, r2)) break;
+
         k_break = k;
         k = 0;
 
@@ -431,8 +438,10 @@ namespace quda {
 
     param.secs += profile.Last(QUDA_PROFILE_COMPUTE);
 
-    double gflops = (blas::flops + mat.flops() + matSloppy.flops() + matPrecon.flops() + matMdagM.flops()) * 1e-9;
+    double blas_gflops = blas::flops * 1e-9;
+    double gflops = blas_gflops + (mat.flops() + matSloppy.flops() + matPrecon.flops() + matMdagM.flops()) * 1e-9;
     if (K) gflops += K->flops()*1e-9;
+    telemetry.set_flops(gflops - blas_gflops, blas_gflops);
 
     if (k >= param.maxiter) warningQuda("Exceeded maximum iterations %d", param.maxiter);
 
@@ -467,6 +476,8 @@ namespace quda {
     profile.TPSTART(QUDA_PROFILE_FREE);
 
     PrintSummary("GCR", total_iter, r2, b2, stop, param.tol_hq);
+    telemetry.end(total_iter, convergence(r2, heavy_quark_res, stop, param.tol_hq),
+                  param.compute_true_res ? param.true_res : NAN, use_heavy_quark_res ? param.true_res_hq : NAN);
 
     profile.TPSTOP(QUDA_PROFILE_FREE);
   }
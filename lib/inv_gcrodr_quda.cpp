@@ -0,0 +1,444 @@
+#include <algorithm>
+#include <numeric>
+
+#include <invert_quda.h>
+#include <blas_quda.h>
+#include <eigen_helper.h>
+
+/*
+  GCRO-DR algorithm:
+  M. L. Parks et al, "Recycling Krylov subspaces for sequences of linear systems",
+  SIAM J. Sci. Comput. 28 (2006) p. 1651-1674
+*/
+
+namespace quda
+{
+
+  using matrix = Matrix<Complex, Dynamic, Dynamic>;
+  using vector = Matrix<Complex, Dynamic, 1>;
+
+  GCRODR::GCRODR(const DiracMatrix &mat, const DiracMatrix &matSloppy, const DiracMatrix &matPrecon,
+                 const DiracMatrix &matEig, SolverParam &param, TimeProfile &profile) :
+    Solver(mat, matSloppy, matPrecon, matEig, param, profile)
+  {
+    if (param.n_ev < 1 || param.n_ev >= param.m)
+      errorQuda("GCRO-DR requires 0 < n_ev (%d) < max_search_dim (%d)", param.n_ev, param.m);
+  }
+
+  GCRODR::~GCRODR()
+  {
+    if (!param.is_preconditioner) profile.TPSTART(QUDA_PROFILE_FREE);
+    preserveRecycleSpace();
+    if (!param.is_preconditioner) profile.TPSTOP(QUDA_PROFILE_FREE);
+  }
+
+  void GCRODR::create(ColorSpinorField &x, const ColorSpinorField &b)
+  {
+    Solver::create(x, b);
+
+    if (!init) {
+      if (!param.is_preconditioner) {
+        blas::flops = 0;
+        profile.TPSTART(QUDA_PROFILE_INIT);
+      }
+
+      ColorSpinorParam csParam(b);
+      csParam.create = QUDA_NULL_FIELD_CREATE;
+      csParam.setPrecision(param.precision_sloppy);
+
+      resize(V, param.m + 1, csParam);
+      resize(U, param.n_ev, csParam);
+      resize(C, param.n_ev, csParam);
+      resize(U_new, param.n_ev, csParam);
+      resize(C_new, param.n_ev, csParam);
+
+      csParam.setPrecision(param.precision);
+      r = ColorSpinorField(csParam);
+
+      if (!param.is_preconditioner) profile.TPSTOP(QUDA_PROFILE_INIT);
+      init = true;
+    } // init
+  }
+
+  ColorSpinorField &GCRODR::get_residual()
+  {
+    if (!init) errorQuda("No residual vector present");
+    if (!param.return_residual) errorQuda("SolverParam::return_residual not enabled");
+    return r;
+  }
+
+  /**
+     @brief Concatenate the first n1 fields of v1 with the first n2 fields of v2
+   */
+  static vector_ref<const ColorSpinorField> join(const std::vector<ColorSpinorField> &v1, int n1,
+                                                 const std::vector<ColorSpinorField> &v2, int n2)
+  {
+    vector_ref<const ColorSpinorField> v;
+    v.reserve(n1 + n2);
+    for (int i = 0; i < n1; i++) v.push_back(v1[i]);
+    for (int i = 0; i < n2; i++) v.push_back(v2[i]);
+    return v;
+  }
+
+  int GCRODR::restoreRecycleSpace()
+  {
+    auto space = reinterpret_cast<recycle_space *>(param.preserve_recycle_space);
+    if (!space) return 0;
+    param.preserve_recycle_space = nullptr;
+
+    const int k = param.n_ev;
+    if (static_cast<int>(space->U.size()) != k)
+      errorQuda("Preserved recycle space size %lu does not match expected %d", space->U.size(), k);
+    logQuda(QUDA_VERBOSE, "Restoring recycle space of size %lu\n", space->U.size());
+
+    for (int i = 0; i < k; i++) blas::copy(U[i], space->U[i]);
+    n_solve = space->n_solve;
+    iter_initial = space->iter_initial;
+    iter_recycled = space->iter_recycled;
+    delete space;
+
+    // the operator may have changed since U was computed, so recompute C = A U and orthonormalize it
+    for (int i = 0; i < k; i++) matSloppy(C[i], U[i]);
+
+    std::vector<Complex> G_(k * k);
+    blas::cDotProduct(G_, C, C);
+    matrix G(k, k);
+    for (int i = 0; i < k; i++)
+      for (int j = 0; j < k; j++) G(i, j) = G_[i * k + j];
+
+    LLT<matrix> cholesky(G);
+    if (cholesky.info() != Success) {
+      warningQuda("GCRO-DR: recycled subspace is rank deficient, discarding it");
+      return k;
+    }
+
+    // C = C R^{-1} and U = U R^{-1} where R^* R = C^* C
+    matrix R_inv = cholesky.matrixU().solve(matrix::Identity(k, k));
+    std::vector<Complex> coeff(k * k);
+    for (int i = 0; i < k; i++)
+      for (int j = 0; j < k; j++) coeff[i * k + j] = R_inv(i, j);
+
+    blas::zero(C_new);
+    blas::caxpy(coeff, C, C_new);
+    blas::zero(U_new);
+    blas::caxpy(coeff, U, U_new);
+    std::swap(C, C_new);
+    std::swap(U, U_new);
+
+    n_recycle = k;
+    return k;
+  }
+
+  void GCRODR::preserveRecycleSpace()
+  {
+    if (!param.preserve_recycle || n_recycle == 0) return;
+    logQuda(QUDA_VERBOSE, "Preserving recycle space of size %lu\n", U.size());
+
+    if (param.preserve_recycle_space) delete reinterpret_cast<recycle_space *>(param.preserve_recycle_space);
+
+    auto space = new recycle_space;
+    space->U = std::move(U);
+    space->n_solve = n_solve;
+    space->iter_initial = iter_initial;
+    space->iter_recycled = iter_recycled;
+    param.preserve_recycle_space = space;
+
+    n_recycle = 0;
+  }
+
+  /*
+    The main GCRO-DR algorithm, which consists of four main steps per cycle:
+    1. Project the residual orthogonally to C and update x accordingly
+    2. Run m - k Arnoldi steps of (I - C C^*) A
+    3. Minimize the residual over [U, V] and update x and r
+    4. Replace U and C with the k harmonic Ritz vectors of smallest magnitude
+  */
+  void GCRODR::operator()(ColorSpinorField &x, ColorSpinorField &b)
+  {
+    const int m = param.m;
+    const int k = param.n_ev;
+
+    if (param.maxiter == 0) {
+      if (param.use_init_guess == QUDA_USE_INIT_GUESS_NO) blas::zero(x);
+      return;
+    }
+
+    create(x, b);
+
+    if (!param.is_preconditioner) profile.TPSTART(QUDA_PROFILE_PREAMBLE);
+
+    double b2 = blas::norm2(b);
+    double r2 = 0.0; // if zero source then we will exit immediately doing no work
+
+    // compute intitial residual depending on whether we have an initial guess or not
+    if (param.use_init_guess == QUDA_USE_INIT_GUESS_YES) {
+      mat(r, x);
+      r2 = blas::xmyNorm(b, r);
+    } else {
+      r2 = b2;
+      blas::copy(r, b);
+      blas::zero(x);
+    }
+
+    // Check to see that we're not trying to invert on a zero-field source
+    if (b2 == 0) {
+      if (param.compute_null_vector == QUDA_COMPUTE_NULL_VECTOR_NO) {
+        warningQuda("inverting on zero-field source\n");
+        x = b;
+        param.true_res = 0.0;
+        param.true_res_hq = 0.0;
+        return;
+      } else {
+        b2 = r2;
+      }
+    }
+
+    double stop = stopping(param.tol, b2, param.residual_type); // stopping condition of solver
+
+    const bool use_heavy_quark_res = (param.residual_type & QUDA_HEAVY_QUARK_RESIDUAL) ? true : false;
+
+    // this parameter determines how many consective reliable update
+    // reisudal increases we tolerate before terminating the solver,
+    // i.e., how long do we want to keep trying to converge
+    const int maxResIncrease = param.max_res_increase; // check if we reached the limit of our tolerance
+    const int maxResIncreaseTotal = param.max_res_increase_total;
+
+    double heavy_quark_res = 0.0; // heavy quark residual
+    if (use_heavy_quark_res) heavy_quark_res = sqrt(blas::HeavyQuarkResidualNorm(x, r).z);
+
+    int resIncrease = 0;
+    int resIncreaseTotal = 0;
+
+    if (!param.is_preconditioner) {
+      blas::flops = 0;
+      profile.TPSTOP(QUDA_PROFILE_PREAMBLE);
+      profile.TPSTART(QUDA_PROFILE_COMPUTE);
+    }
+
+    // a recycled subspace left by a prior solve with this instance is
+    // used as is, while a preserved one needs C recomputing
+    int recycle_iter = n_recycle == 0 ? restoreRecycleSpace() : 0;
+    const bool recycled = n_recycle > 0;
+
+    int total_iter = 0;
+    int restart = 0;
+    double r2_old = r2;
+
+    matrix G = matrix::Zero(m + 1, m); // A [U, V_0..V_{s-1}] = [C, V_0..V_s] G
+    vector rhs(m + 1);
+    vector y;
+
+    PrintStats("GCRO-DR", total_iter, r2, b2, heavy_quark_res);
+    while (!convergence(r2, heavy_quark_res, stop, param.tol_hq) && total_iter < param.maxiter) {
+      const int kk = n_recycle;
+
+      if (kk > 0) {
+        // x += U C^* r and r -= C C^* r, since A U = C
+        blas::copy(V[0], r);
+        std::vector<Complex> z(kk);
+        blas::cDotProduct(z, C, V[0]);
+        blas::caxpy(z, U, x);
+        for (auto &zi : z) zi = -zi;
+        blas::caxpy(z, C, r);
+        r2 = blas::norm2(r);
+      }
+
+      blas::copy(V[0], r);
+      blas::ax(1.0 / sqrt(r2), V[0]);
+
+      G.setZero();
+      for (int i = 0; i < kk; i++) G(i, i) = 1.0;
+      rhs.setZero();
+      rhs(kk) = sqrt(r2);
+
+      int s = 0;
+      while (s < m - kk && total_iter < param.maxiter) {
+        matSloppy(V[s + 1], V[s]);
+
+        // orthogonalize against [C, V_0..V_s] with two passes of classical Gram-Schmidt
+        auto W = join(C, kk, V, s + 1);
+        std::vector<Complex> h(kk + s + 1);
+        for (int pass = 0; pass < 2; pass++) {
+          blas::cDotProduct(h, W, V[s + 1]);
+          for (int i = 0; i < kk + s + 1; i++) {
+            G(i, kk + s) += h[i];
+            h[i] = -h[i];
+          }
+          blas::caxpy(h, W, V[s + 1]);
+        }
+        double h_norm = sqrt(blas::norm2(V[s + 1]));
+        G(kk + s + 1, kk + s) = h_norm;
+        if (h_norm > 0.0) blas::ax(1.0 / h_norm, V[s + 1]);
+
+        total_iter++;
+        s++;
+
+        // solve the small least-squares problem to monitor the residual
+        const int n = kk + s;
+        y = G.topLeftCorner(n + 1, n).colPivHouseholderQr().solve(rhs.head(n + 1));
+        double rho2 = (rhs.head(n + 1) - G.topLeftCorner(n + 1, n) * y).squaredNorm();
+
+        PrintStats("GCRO-DR", total_iter, rho2, b2, heavy_quark_res);
+        if (h_norm == 0.0 || rho2 < stop) break;
+      }
+
+      // x += [U, V] y and r -= [C, V] G y
+      const int n = kk + s;
+      auto V_hat = join(U, kk, V, s);
+      auto W_hat = join(C, kk, V, s + 1);
+
+      std::vector<Complex> coeff(y.data(), y.data() + n);
+      blas::caxpy(coeff, V_hat, x);
+      vector Gy = G.topLeftCorner(n + 1, n) * y;
+      coeff.resize(n + 1);
+      for (int i = 0; i < n + 1; i++) coeff[i] = -Gy(i);
+      blas::caxpy(coeff, W_hat, r);
+      r2 = blas::norm2(r);
+
+      if (n > k) {
+        // the harmonic Ritz vectors solve G^* G z = theta G^* W_hat^* V_hat z
+        matrix WV = matrix::Zero(n + 1, n);
+        if (kk > 0) {
+          std::vector<Complex> WU((n + 1) * kk);
+          blas::cDotProduct(WU, W_hat, U);
+          for (int i = 0; i < n + 1; i++)
+            for (int j = 0; j < kk; j++) WV(i, j) = WU[i * kk + j];
+        }
+        for (int i = 0; i < s; i++) WV(kk + i, kk + i) = 1.0;
+
+        if (!param.is_preconditioner) {
+          profile.TPSTOP(QUDA_PROFILE_COMPUTE);
+          param.secs += profile.Last(QUDA_PROFILE_COMPUTE);
+          profile.TPSTART(QUDA_PROFILE_EIGEN);
+        }
+
+        matrix G_n = G.topLeftCorner(n + 1, n);
+        matrix B = G_n.adjoint() * WV;
+        ComplexEigenSolver<matrix> es(B.fullPivLu().solve(G_n.adjoint() * G_n));
+
+        // keep the k harmonic Ritz vectors of smallest magnitude
+        std::vector<int> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int i, int j) {
+          return std::abs(es.eigenvalues()(i)) < std::abs(es.eigenvalues()(j));
+        });
+        matrix P(n, k);
+        for (int j = 0; j < k; j++) P.col(j) = es.eigenvectors().col(order[j]);
+
+        // G P = Q R, so that C = W_hat Q is orthonormal and U = V_hat P R^{-1} satisfies A U = C
+        HouseholderQR<matrix> qr(G_n * P);
+        matrix Q = qr.householderQ() * matrix::Identity(n + 1, k);
+        matrix R = qr.matrixQR().topLeftCorner(k, k).triangularView<Upper>();
+        matrix PR = P * R.triangularView<Upper>().solve(matrix::Identity(k, k));
+
+        if (!param.is_preconditioner) {
+          profile.TPSTOP(QUDA_PROFILE_EIGEN);
+          param.secs += profile.Last(QUDA_PROFILE_EIGEN);
+          profile.TPSTART(QUDA_PROFILE_COMPUTE);
+        }
+
+        std::vector<Complex> u_coeff(n * k);
+        for (int i = 0; i < n; i++)
+          for (int j = 0; j < k; j++) u_coeff[i * k + j] = PR(i, j);
+        std::vector<Complex> c_coeff((n + 1) * k);
+        for (int i = 0; i < n + 1; i++)
+          for (int j = 0; j < k; j++) c_coeff[i * k + j] = Q(i, j);
+
+        blas::zero(U_new);
+        blas::caxpy(u_coeff, V_hat, U_new);
+        blas::zero(C_new);
+        blas::caxpy(c_coeff, W_hat, C_new);
+        std::swap(U, U_new);
+        std::swap(C, C_new);
+        n_recycle = k;
+      }
+
+      // update since maxiter reached, converged or reliable update required
+      if (total_iter >= param.maxiter || r2 < stop || sqrt(r2 / r2_old) < param.delta) {
+
+        if ((r2 < stop || total_iter >= param.maxiter) && param.sloppy_converge) break;
+        mat(r, x);
+        r2 = blas::xmyNorm(b, r);
+
+        if (use_heavy_quark_res) heavy_quark_res = sqrt(blas::HeavyQuarkResidualNorm(x, r).z);
+
+        // break-out check if we have reached the limit of the precision
+        if (r2 > r2_old) {
+          resIncrease++;
+          resIncreaseTotal++;
+          warningQuda(
+            "GCRO-DR: new reliable residual norm %e is greater than previous reliable residual norm %e (total #inc %i)",
+            sqrt(r2), sqrt(r2_old), resIncreaseTotal);
+          if (resIncrease > maxResIncrease or resIncreaseTotal > maxResIncreaseTotal) {
+            warningQuda("GCRO-DR: solver exiting due to too many true residual norm increases");
+            break;
+          }
+        } else {
+          resIncrease = 0;
+        }
+
+        r2_old = r2;
+      }
+
+      if (!convergence(r2, heavy_quark_res, stop, param.tol_hq)) {
+        restart++;
+        PrintStats("GCRO-DR (restart)", restart, r2, b2, heavy_quark_res);
+        r2_old = r2;
+      }
+    }
+
+    if (total_iter > param.maxiter && getVerbosity() >= QUDA_SUMMARIZE)
+      warningQuda("Exceeded maximum iterations %d", param.maxiter);
+
+    logQuda(QUDA_VERBOSE, "GCRO-DR: number of restarts = %d\n", restart);
+
+    // the matrix-vector products to recompute C count against the savings
+    if (recycled) {
+      n_solve++;
+      iter_recycled += total_iter + recycle_iter;
+      if (iter_initial > 0)
+        logQuda(QUDA_SUMMARIZE,
+                "GCRO-DR: %d iterations (+ %d to recompute C) with a recycled subspace of dimension %d, versus %d "
+                "without; average saving over %d solves = %.1f%%\n",
+                total_iter, recycle_iter, k, iter_initial, n_solve,
+                100.0 * (1.0 - static_cast<double>(iter_recycled) / (n_solve * iter_initial)));
+    } else if (n_recycle > 0) {
+      iter_initial = total_iter;
+      n_solve = 0;
+      iter_recycled = 0;
+    }
+
+    if (param.compute_true_res) {
+      // Calculate the true residual
+      mat(r, x);
+      double true_res = blas::xmyNorm(b, r);
+      param.true_res = sqrt(true_res / b2);
+      param.true_res_hq
+        = (param.residual_type & QUDA_HEAVY_QUARK_RESIDUAL) ? sqrt(blas::HeavyQuarkResidualNorm(x, r).z) : 0.0;
+    }
+
+    if (!param.is_preconditioner) {
+      qudaDeviceSynchronize(); // ensure solver is complete before ending timing
+      profile.TPSTOP(QUDA_PROFILE_COMPUTE);
+      profile.TPSTART(QUDA_PROFILE_EPILOGUE);
+      param.secs += profile.Last(QUDA_PROFILE_COMPUTE);
+
+      // store flops and reset counters
+      double gflops = (blas::flops + mat.flops() + matSloppy.flops() + matPrecon.flops()) * 1e-9;
+
+      param.gflops += gflops;
+      param.iter += total_iter;
+
+      // reset the flops counters
+      blas::flops = 0;
+      mat.flops();
+      matSloppy.flops();
+      matPrecon.flops();
+
+      profile.TPSTOP(QUDA_PROFILE_EPILOGUE);
+    }
+
+    PrintSummary("GCRO-DR", total_iter, r2, b2, stop, param.tol_hq);
+  }
+
+} // namespace quda
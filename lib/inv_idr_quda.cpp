@@ -0,0 +1,324 @@
+#include <cmath>
+#include <sstream>
+
+#include <quda_internal.h>
+#include <color_spinor_field.h>
+#include <blas_quda.h>
+#include <invert_quda.h>
+#include <util_quda.h>
+
+namespace quda
+{
+
+  IDR::IDR(const DiracMatrix &mat, const DiracMatrix &matSloppy, const DiracMatrix &matPrecon,
+           const DiracMatrix &matEig, SolverParam &param, TimeProfile &profile) :
+    Solver(mat, matSloppy, matPrecon, matEig, param, profile), n_shadow(param.Nkrylov)
+  {
+    if (n_shadow < 1) errorQuda("Invalid shadow space dimension %d", n_shadow);
+    if (param.deflate) errorQuda("Deflation is not supported by the IDR solver");
+
+    M.resize(n_shadow * n_shadow);
+    f.resize(n_shadow);
+
+    std::stringstream ss;
+    ss << "IDR(" << n_shadow << ")";
+    solver_name = ss.str();
+  }
+
+  IDR::~IDR()
+  {
+    profile.TPSTART(QUDA_PROFILE_FREE);
+    destroyDeflationSpace();
+    profile.TPSTOP(QUDA_PROFILE_FREE);
+  }
+
+  void IDR::create(ColorSpinorField &x, const ColorSpinorField &b)
+  {
+    Solver::create(x, b);
+
+    if (!init) {
+      profile.TPSTART(QUDA_PROFILE_INIT);
+
+      ColorSpinorParam csParam(x);
+      csParam.create = QUDA_ZERO_FIELD_CREATE;
+      r_full = ColorSpinorField(csParam);
+      y = ColorSpinorField(csParam);
+
+      // now allocate sloppy fields
+      csParam.setPrecision(param.precision_sloppy);
+      r = mixed() ? ColorSpinorField(csParam) : r_full.create_alias();
+      x_sloppy = ColorSpinorField(csParam);
+      v = ColorSpinorField(csParam);
+      t = ColorSpinorField(csParam);
+
+      P.resize(n_shadow);
+      G.resize(n_shadow);
+      U.resize(n_shadow);
+      for (int i = 0; i < n_shadow; i++) {
+        P[i] = ColorSpinorField(csParam);
+        G[i] = ColorSpinorField(csParam);
+        U[i] = ColorSpinorField(csParam);
+      }
+
+      createShadowSpace();
+
+      profile.TPSTOP(QUDA_PROFILE_INIT);
+      init = true;
+    }
+  }
+
+  void IDR::createShadowSpace()
+  {
+    for (int i = 0; i < n_shadow; i++) {
+      // generate the noise in the solver precision, using r_full as scratch
+      spinorNoise(r_full, 1234 + i, QUDA_NOISE_GAUSS);
+      blas::copy(P[i], r_full);
+
+      // block classical Gram-Schmidt, applied twice for stability
+      if (i > 0) {
+        for (int pass = 0; pass < 2; pass++) {
+          std::vector<Complex> d(i);
+          blas::cDotProduct(d, {P.begin(), P.begin() + i}, P[i]);
+          for (auto &d_j : d) d_j = -d_j;
+          blas::caxpy(d, {P.begin(), P.begin() + i}, P[i]);
+        }
+      }
+      blas::ax(1.0 / sqrt(blas::norm2(P[i])), P[i]);
+    }
+  }
+
+  ColorSpinorField &IDR::get_residual()
+  {
+    if (!init) errorQuda("No residual vector present");
+    if (!param.return_residual) errorQuda("SolverParam::return_residual not enabled");
+    // the residual of the last reliable update, or the true residual if it was computed
+    return r_full;
+  }
+
+  /*
+    IDR(s) with biorthogonalization, following Algorithm 2 of van
+    Gijzen and Sonneveld.  Each cycle performs s steps that keep the
+    residual in the current subspace while making it orthogonal to
+    one more shadow vector, followed by a dimension reduction step
+    that enters the next subspace with a minimal residual update.
+    The biorthogonalization of each new direction G_k against
+    P_0..P_{k-1} is done with classical rather than modified
+    Gram-Schmidt: since M = P^H G is lower triangular, all s inner
+    products P^H G_k are computed with a single multi-reduction, and
+    the coefficients and the new column of M follow from a triangular
+    solve on the host.
+  */
+  void IDR::operator()(ColorSpinorField &x, ColorSpinorField &b)
+  {
+    create(x, b);
+
+    profile.TPSTART(QUDA_PROFILE_PREAMBLE);
+
+    double b2 = blas::norm2(b);
+    double r2;
+
+    // Compute initial residual depending on whether we have an initial guess or not.
+    if (param.use_init_guess == QUDA_USE_INIT_GUESS_YES) {
+      mat(r_full, x);
+      r2 = blas::xmyNorm(b, r_full);
+      blas::copy(y, x); // we accumulate into y
+    } else {
+      blas::copy(r_full, b);
+      r2 = b2;
+      blas::zero(y);
+    }
+
+    // Check to see that we're not trying to invert on a zero-field source
+    if (b2 == 0) {
+      if (param.compute_null_vector == QUDA_COMPUTE_NULL_VECTOR_NO) {
+        warningQuda("inverting on zero-field source");
+        x = b;
+        param.true_res = 0.0;
+        param.true_res_hq = 0.0;
+        profile.TPSTOP(QUDA_PROFILE_PREAMBLE);
+        return;
+      } else if (param.use_init_guess == QUDA_USE_INIT_GUESS_YES) {
+        b2 = r2;
+      } else {
+        errorQuda("Null vector computing requires non-zero guess!");
+      }
+    }
+
+    blas::copy(r, r_full); // no op if uni-precision
+    blas::zero(x_sloppy);
+    blas::zero(G);
+    blas::zero(U);
+
+    // M starts as the identity, since G = 0
+    for (int i = 0; i < n_shadow; i++)
+      for (int j = 0; j < n_shadow; j++) M[i * n_shadow + j] = i == j ? 1.0 : 0.0;
+
+    const double stop = stopping(param.tol, b2, param.residual_type); // stopping condition of solver
+
+    const bool use_heavy_quark_res = (param.residual_type & QUDA_HEAVY_QUARK_RESIDUAL) ? true : false;
+    double heavy_quark_res = use_heavy_quark_res ? sqrt(blas::HeavyQuarkResidualNorm(y, r_full).z) : 0.0;
+    const int heavy_quark_check = param.heavy_quark_check; // how often to check the heavy quark residual
+
+    blas::flops = 0;
+
+    profile.TPSTOP(QUDA_PROFILE_PREAMBLE);
+    profile.TPSTART(QUDA_PROFILE_COMPUTE);
+
+    // angle below which omega is enlarged, to maintain convergence (Sleijpen and van der Vorst)
+    constexpr double kappa = 0.7;
+    Complex omega = 1.0;
+
+    int total_iter = 0;
+    int rUpdate = 0;
+    double maxrr = sqrt(r2); // the maximum residual norm since the last reliable update
+
+    /**
+       Bookkeeping after each update of the residual: reliable
+       updates, the heavy quark residual and convergence.  Returns
+       whether the residual was recomputed.
+     */
+    auto post_update = [&]() {
+      total_iter++;
+
+      if (use_heavy_quark_res && total_iter % heavy_quark_check == 0) {
+        blas::copy(v, y);
+        heavy_quark_res = sqrt(blas::xpyHeavyQuarkResidualNorm(x_sloppy, v, r).z);
+      }
+
+      double rNorm = sqrt(r2);
+      if (rNorm > maxrr) maxrr = rNorm;
+      bool updateR = rNorm < param.delta * maxrr;
+      if (convergence(r2, heavy_quark_res, stop, param.tol_hq) || total_iter >= param.maxiter)
+        updateR = !param.sloppy_converge;
+
+      if (updateR) {
+        blas::xpy(x_sloppy, y);
+        blas::zero(x_sloppy);
+
+        // explicitly recompute the residual
+        mat(r_full, y);
+        r2 = blas::xmyNorm(b, r_full);
+        blas::copy(r, r_full); // no op if uni-precision
+        if (use_heavy_quark_res) heavy_quark_res = sqrt(blas::HeavyQuarkResidualNorm(y, r_full).z);
+
+        maxrr = sqrt(r2);
+        rUpdate++;
+      }
+
+      PrintStats(solver_name.c_str(), total_iter, r2, b2, heavy_quark_res);
+      return updateR;
+    };
+
+    PrintStats(solver_name.c_str(), total_iter, r2, b2, heavy_quark_res);
+    bool converged = convergence(r2, heavy_quark_res, stop, param.tol_hq);
+
+    while (!converged && total_iter < param.maxiter) {
+      // f = P^H r
+      blas::cDotProduct(f, P, r);
+
+      for (int k = 0; k < n_shadow && !converged && total_iter < param.maxiter; k++) {
+        // solve the lower triangular system M(k:s, k:s) c = f(k:s)
+        std::vector<Complex> c(n_shadow - k);
+        for (int i = k; i < n_shadow; i++) {
+          Complex sum = f[i];
+          for (int j = k; j < i; j++) sum -= M[i * n_shadow + j] * c[j - k];
+          c[i - k] = sum / M[i * n_shadow + i];
+        }
+
+        // v = r - G(k:s) c
+        std::vector<Complex> c_neg(c.size());
+        for (auto i = 0u; i < c.size(); i++) c_neg[i] = -c[i];
+        blas::copy(v, r);
+        blas::caxpy(c_neg, {G.begin() + k, G.end()}, v);
+
+        // U_k = omega v + U(k:s) c
+        blas::caxpby(omega, v, c[0], U[k]);
+        if (k + 1 < n_shadow)
+          blas::caxpy(std::vector<Complex>(c.begin() + 1, c.end()), {U.begin() + k + 1, U.end()}, U[k]);
+
+        matSloppy(G[k], U[k]);
+
+        // biorthogonalize G_k against P_0..P_{k-1}, and compute the new column of M
+        std::vector<Complex> d(n_shadow);
+        blas::cDotProduct(d, P, G[k]);
+        std::vector<Complex> alpha(k);
+        for (int i = 0; i < k; i++) {
+          Complex sum = d[i];
+          for (int j = 0; j < i; j++) sum -= M[i * n_shadow + j] * alpha[j];
+          alpha[i] = sum / M[i * n_shadow + i];
+        }
+        for (int i = k; i < n_shadow; i++) {
+          Complex m = d[i];
+          for (int j = 0; j < k; j++) m -= M[i * n_shadow + j] * alpha[j];
+          M[i * n_shadow + k] = m;
+        }
+        if (k > 0) {
+          for (auto &a : alpha) a = -a;
+          blas::caxpy(alpha, {G.begin(), G.begin() + k}, G[k]);
+          blas::caxpy(alpha, {U.begin(), U.begin() + k}, U[k]);
+        }
+
+        // make r orthogonal to P_k
+        Complex beta = f[k] / M[k * n_shadow + k];
+        r2 = blas::caxpyNorm(-beta, G[k], r);
+        blas::caxpy(beta, U[k], x_sloppy);
+        for (int i = k + 1; i < n_shadow; i++) f[i] -= beta * M[i * n_shadow + k];
+
+        if (post_update() && k + 1 < n_shadow) blas::cDotProduct(f, P, r); // f = P^H r for the new residual
+        converged = convergence(r2, heavy_quark_res, stop, param.tol_hq);
+      }
+
+      if (converged || total_iter >= param.maxiter) break;
+
+      // dimension reduction step
+      matSloppy(t, r);
+      double4 tr = blas::cDotProductNormAB(t, r); // (t, r), |t|^2, |r|^2
+      Complex tr_dot(tr.x, tr.y);
+      omega = tr_dot / tr.z;
+      double rho = std::abs(tr_dot) / sqrt(tr.z * tr.w);
+      if (rho < kappa) omega *= kappa / rho;
+
+      blas::caxpy(omega, r, x_sloppy);
+      r2 = blas::caxpyNorm(-omega, t, r);
+
+      post_update();
+      converged = convergence(r2, heavy_quark_res, stop, param.tol_hq);
+    }
+
+    blas::copy(x, x_sloppy);
+    blas::xpy(y, x);
+
+    // Done with compute, begin the epilogue.
+    profile.TPSTOP(QUDA_PROFILE_COMPUTE);
+    profile.TPSTART(QUDA_PROFILE_EPILOGUE);
+
+    param.secs += profile.Last(QUDA_PROFILE_COMPUTE);
+    double gflops = (blas::flops + mat.flops() + matSloppy.flops() + matPrecon.flops() + matEig.flops()) * 1e-9;
+    param.gflops = gflops;
+    param.iter += total_iter;
+
+    if (total_iter >= param.maxiter) warningQuda("Exceeded maximum iterations %d", param.maxiter);
+
+    // Print number of reliable updates.
+    logQuda(QUDA_VERBOSE, "%s: Reliable updates = %d\n", solver_name.c_str(), rUpdate);
+
+    // compute the true residual
+    if (!param.is_preconditioner && param.compute_true_res) {
+      mat(r_full, x);
+      param.true_res = sqrt(blas::xmyNorm(b, r_full) / b2);
+      param.true_res_hq = use_heavy_quark_res ? sqrt(blas::HeavyQuarkResidualNorm(x, r_full).z) : 0.0;
+    }
+
+    // Reset flops counters.
+    blas::flops = 0;
+    mat.flops();
+    matSloppy.flops();
+    matPrecon.flops();
+    matEig.flops();
+
+    profile.TPSTOP(QUDA_PROFILE_EPILOGUE);
+
+    PrintSummary(solver_name.c_str(), total_iter, r2, b2, stop, param.tol_hq);
+  }
+
+} // namespace quda
@@ -10,6 +10,72 @@ namespace quda
   {
   }
 
+  void MinResExt::orthonormalize(std::vector<ColorSpinorField> &p, std::vector<ColorSpinorField> &q)
+  {
+    typedef Matrix<Complex, Dynamic, Dynamic, RowMajor> matrix;
+
+    const int N = p.size();
+
+    // Orthonormalise the vector basis
+    if (orthogonal) {
+      // Cholesky QR: a single block reduction forms the Gram matrix
+      // G = P* P = L L*, and then P <- P L^{-*} (applied to Q as well)
+      std::vector<Complex> G_(N * N);
+      blas::hDotProduct(G_, p, p);
+
+      profile.TPSTOP(QUDA_PROFILE_CHRONO);
+      profile.TPSTART(QUDA_PROFILE_EIGEN);
+
+      LLT<matrix> cholesky(Map<matrix>(G_.data(), N, N));
+      bool success = cholesky.info() == Success;
+      matrix U;
+      if (success) U = cholesky.matrixU().solve(matrix::Identity(N, N));
+
+      profile.TPSTOP(QUDA_PROFILE_EIGEN);
+      profile.TPSTART(QUDA_PROFILE_CHRONO);
+
+      if (success) {
+        // U is upper triangular, so working down from the last
+        // vector, column j only reads the yet unmodified p_i, i < j
+        for (int j = N - 1; j >= 0; j--) {
+          std::vector<Complex> a(j);
+          for (int i = 0; i < j; i++) a[i] = U(i, j);
+          blas::ax(U(j, j).real(), p[j]);
+          if (j > 0) blas::caxpy(a, {p.begin(), p.begin() + j}, p[j]);
+          if (!apply_mat) {
+            blas::ax(U(j, j).real(), q[j]);
+            if (j > 0) blas::caxpy(a, {q.begin(), q.begin() + j}, q[j]);
+          }
+        }
+      } else {
+        // the basis is numerically rank deficient, so fall back to
+        // modified Gram-Schmidt which is more robust to this
+        logQuda(QUDA_VERBOSE, "MinResExt: Cholesky orthonormalization failed, falling back to Gram-Schmidt\n");
+        for (int i = 0; i < N; i++) {
+          double p2 = blas::norm2(p[i]);
+          blas::ax(1 / sqrt(p2), p[i]);
+          if (!apply_mat) blas::ax(1 / sqrt(p2), q[i]);
+
+          if (i + 1 < N) {
+            std::vector<Complex> alpha(N - (i + 1));
+            blas::cDotProduct(alpha, {p[i]}, {p.begin() + i + 1, p.end()});
+            for (auto &a : alpha) a = -a;
+            blas::caxpy(alpha, {p[i]}, {p.begin() + i + 1, p.end()});
+
+            if (!apply_mat) {
+              // if not applying the matrix below then orthogonalize q
+              blas::caxpy(alpha, {q[i]}, {q.begin() + i + 1, q.end()});
+            }
+          }
+        }
+      }
+    }
+
+    // if operator hasn't already been applied then apply
+    if (apply_mat)
+      for (int i = 0; i < N; i++) mat(q[i], p[i]);
+  }
+
   /* Solve the equation A p_k psi_k = b by minimizing the residual and
      using Eigen's SVD algorithm for numerical stability */
   void MinResExt::solve(std::vector<Complex> &psi_, std::vector<ColorSpinorField> &p, std::vector<ColorSpinorField> &q,
@@ -85,30 +151,7 @@ namespace quda
       return;
     }
 
-    // Orthonormalise the vector basis
-    if (orthogonal) {
-      for (int i = 0; i < N; i++) {
-        double p2 = blas::norm2(p[i]);
-        blas::ax(1 / sqrt(p2), p[i]);
-        if (!apply_mat) blas::ax(1 / sqrt(p2), q[i]);
-
-        if (i + 1 < N) {
-          std::vector<Complex> alpha(N - (i + 1));
-          blas::cDotProduct(alpha, {p[i]}, {p.begin() + i + 1, p.end()});
-          for (auto &a : alpha) a = -a;
-          blas::caxpy(alpha, {p[i]}, {p.begin() + i + 1, p.end()});
-
-          if (!apply_mat) {
-            // if not applying the matrix below then orthogonalize q
-            blas::caxpy(alpha, {q[i]}, {q.begin() + i + 1, q.end()});
-          }
-        }
-      }
-    }
-
-    // if operator hasn't already been applied then apply
-    if (apply_mat)
-      for (int i = 0; i < N; i++) mat(q[i], p[i]);
+    orthonormalize(p, q);
 
     // Solution coefficient vectors
     std::vector<Complex> alpha(N);
@@ -136,4 +179,114 @@ namespace quda
     if (!running) profile.TPSTOP(QUDA_PROFILE_CHRONO);
   }
 
+  /*
+    Forecast the solutions of the shifted systems (A + sigma_i) x_i = b
+    from the same basis, with A p_j = q_j.  Since (A + sigma_i) p_j =
+    q_j + sigma_i p_j, the projected systems of all the shifts are
+    assembled from the blocks P* P, P* Q and P* b (Hermitian) or from
+    [P, Q]* [P, Q] and [P, Q]* b (non-Hermitian), so a single
+    reduction is needed regardless of the number of shifts.
+
+    The guesses are intended to seed a multi-shift solve, which
+    requires the shifts to have a common source.  Thus x_0 is the
+    usual guess for the first shift, while x_i for i > 0 is the one
+    whose residual is closest to that of x_0, i.e., the guess for the
+    system (A + sigma_i) x_i = A x_0.  The solve then leaves only the
+    (minimized) difference r_i - r_0 for the refinement of each shift.
+  */
+  void MinResExt::operator()(std::vector<ColorSpinorField> &x, const ColorSpinorField &b,
+                             std::vector<ColorSpinorField> &p, std::vector<ColorSpinorField> &q,
+                             const std::vector<double> &shift)
+  {
+    typedef Matrix<Complex, Dynamic, Dynamic> matrix;
+    typedef Matrix<Complex, Dynamic, 1> vector;
+
+    bool running = profile.isRunning(QUDA_PROFILE_CHRONO);
+    if (!running) profile.TPSTART(QUDA_PROFILE_CHRONO);
+
+    const int N = p.size();
+    const int n_shift = shift.size();
+    if (x.size() != shift.size()) errorQuda("Number of solutions %lu does not match shifts %d", x.size(), n_shift);
+    if (shift[0] != 0.0) errorQuda("Shifts must be relative to the first system (shift[0] = %e)", shift[0]);
+    logQuda(QUDA_VERBOSE, "Constructing minimum residual extrapolation with basis size %d for %d shifts\n", N, n_shift);
+
+    if (N == 0) {
+      for (auto &xi : x) blas::zero(xi);
+      if (!running) profile.TPSTOP(QUDA_PROFILE_CHRONO);
+      return;
+    }
+
+    orthonormalize(p, q);
+
+    // need a copy of b in the basis precision
+    ColorSpinorParam param(b);
+    param.setPrecision(p[0].Precision(), p[0].Precision(), true);
+    param.create = QUDA_COPY_FIELD_CREATE;
+    ColorSpinorField b_(param);
+
+    // the blocks PP = P* P, PQ = P* Q and Pb = P* b, with QP, QQ and Qb if not Hermitian
+    const int M = hermitian ? N : 2 * N;
+    std::vector<Complex> G_(M * (2 * N + 1));
+    if (hermitian)
+      blas::cDotProduct(G_, p, {p, q, b_});
+    else
+      blas::cDotProduct(G_, {p, q}, {p, q, b_});
+
+    auto block = [&](int row, int col) {
+      matrix B(N, N);
+      for (int i = 0; i < N; i++)
+        for (int j = 0; j < N; j++) B(i, j) = G_[(row * N + i) * (2 * N + 1) + col * N + j];
+      return B;
+    };
+    auto rhs = [&](int row) {
+      vector v(N);
+      for (int i = 0; i < N; i++) v(i) = G_[(row * N + i) * (2 * N + 1) + 2 * N];
+      return v;
+    };
+
+    profile.TPSTOP(QUDA_PROFILE_CHRONO);
+    profile.TPSTART(QUDA_PROFILE_EIGEN);
+
+    matrix PP = block(0, 0);
+    matrix PQ = block(0, 1);
+    std::vector<vector> psi(n_shift);
+    if (hermitian) {
+      // Galerkin: P* (A + sigma_i) P psi_i = P* b for the first shift, P* A P psi_0 for the others
+      psi[0] = LDLT<matrix>(PQ).solve(rhs(0));
+      vector phi = PQ * psi[0];
+      for (int s = 1; s < n_shift; s++) psi[s] = LDLT<matrix>(PQ + shift[s] * PP).solve(phi);
+    } else {
+      // minimum residual: normal equations of (Q + sigma_i P) psi_i = b, or Q psi_0 for the others
+      matrix QP = block(1, 0);
+      matrix QQ = block(1, 1);
+      psi[0] = LDLT<matrix>(QQ).solve(rhs(1));
+      for (int s = 1; s < n_shift; s++) {
+        matrix A = QQ + shift[s] * (QP + PQ) + shift[s] * shift[s] * PP;
+        psi[s] = LDLT<matrix>(A).solve((QQ + shift[s] * PQ) * psi[0]);
+      }
+    }
+
+    profile.TPSTOP(QUDA_PROFILE_EIGEN);
+    profile.TPSTART(QUDA_PROFILE_CHRONO);
+
+    // x_s = sum_j psi_s(j) p_j for all shifts at once
+    std::vector<Complex> alpha(N * n_shift);
+    for (int j = 0; j < N; j++)
+      for (int s = 0; s < n_shift; s++) alpha[j * n_shift + s] = psi[s](j);
+    blas::zero(x);
+    blas::caxpy(alpha, p, x);
+
+    if (getVerbosity() >= QUDA_SUMMARIZE) {
+      // compute the residual of the first shift only if we're going to print it
+      ColorSpinorField r(b_);
+      std::vector<Complex> beta(N);
+      for (int j = 0; j < N; j++) beta[j] = -psi[0](j);
+      blas::caxpy(beta, q, r);
+      printfQuda("MinResExt: N = %d, shifts = %d, |res| / |src| = %e (first shift)\n", N, n_shift,
+                 sqrt(blas::norm2(r) / blas::norm2(b_)));
+    }
+
+    if (!running) profile.TPSTOP(QUDA_PROFILE_CHRONO);
+  }
+
 } // namespace quda
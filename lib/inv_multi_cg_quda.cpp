@@ -132,12 +132,22 @@ namespace quda {
         if (param.tol_offset[j] < param.delta) reliable = true;
 
       r = b;
+      if (param.use_init_guess == QUDA_USE_INIT_GUESS_YES) {
+        // the shifted systems must share a residual, so all shifts
+        // are corrected with the residual of the guess of the first
+        // shift, and the remainder of the others is left to the
+        // refinement
+        mat(r, x[0]);
+        if (b.Nspin() == 4) blas::axpy(param.offset[0], x[0], r);
+        blas::xpay(b, -1.0, r);
+      }
 
       ColorSpinorParam csParam(b);
       csParam.create = QUDA_NULL_FIELD_CREATE;
 
       mixed = param.precision_sloppy != param.precision;
-      group_update = false; // do we want to do group updates regardless of precision?
+      // with an initial guess the corrections are accumulated separately and added to the guesses
+      group_update = param.use_init_guess == QUDA_USE_INIT_GUESS_YES;
 
       x_sloppy.resize(num_offset);
       if ((mixed && param.use_sloppy_partial_accumulator) || group_update) {
@@ -234,7 +244,9 @@ namespace quda {
     profile.TPSTART(QUDA_PROFILE_PREAMBLE);
 
     // stopping condition of each shift
-    std::vector<double> r2(num_offset, b2);
+    std::vector<double> r2(num_offset, param.use_init_guess == QUDA_USE_INIT_GUESS_YES ? blas::norm2(r) : b2);
+    if (param.use_init_guess == QUDA_USE_INIT_GUESS_YES)
+      logQuda(QUDA_VERBOSE, "Guess residual |r0|/|b| = %e\n", sqrt(r2[0] / b2));
     std::vector<double> stop(num_offset);
     for (int i = 0; i < num_offset; i++) stop[i] = Solver::stopping(param.tol_offset[i], b2, param.residual_type);
 
@@ -270,8 +282,10 @@ namespace quda {
 
     profile.TPSTOP(QUDA_PROFILE_PREAMBLE);
     profile.TPSTART(QUDA_PROFILE_COMPUTE);
+    telemetry.begin("MultiShiftCG", param, b2);
 
     logQuda(QUDA_VERBOSE, "%d iterations, <r,r> = %e, |r|/|b| = %e\n", k, r2[0], sqrt(r2[0] / b2));
+    telemetry.iteration(k, r2[0], 0.0);
 
     while ( !convergence(r2, stop, num_offset_now) &&  !exit_early && k < param.maxiter) {
 
@@ -336,7 +350,7 @@ namespace quda {
 	for (int j=0; j<num_offset_now; j++) {
           blas::axpy(alpha[j], p[j], x_sloppy[j]);
           if (group_update) {
-            if (rUpdate == 0)
+            if (rUpdate == 0 && param.use_init_guess == QUDA_USE_INIT_GUESS_NO)
               x[j] = x_sloppy[j];
             else
               blas::xpy(x_sloppy[j], x[j]);
@@ -389,6 +403,7 @@ namespace quda {
 	maxrx[m] = rNorm[m];
         r0Norm[m] = rNorm[m];
         rUpdate++;
+        telemetry.reliable_update();
       }
 
       // now we can check if any of the shifts have converged and remove them
@@ -430,6 +445,7 @@ namespace quda {
       }
 
       logQuda(QUDA_VERBOSE, "%d iterations, <r,r> = %e, |r|/|b| = %e\n", k, r2[0], sqrt(r2[0] / b2));
+      telemetry.iteration(k, r2[0], 0.0);
     }
 
     for (int i=0; i<num_offset; i++) {
@@ -444,16 +460,20 @@ namespace quda {
     if (k==param.maxiter) warningQuda("Exceeded maximum iterations %d\n", param.maxiter);
 
     param.secs = profile.Last(QUDA_PROFILE_COMPUTE);
-    double gflops = (blas::flops + mat.flops() + matSloppy.flops())*1e-9;
+    double blas_gflops = blas::flops * 1e-9;
+    double gflops = blas_gflops + (mat.flops() + matSloppy.flops()) * 1e-9;
     param.gflops = gflops;
     param.iter += k;
+    telemetry.set_flops(gflops - blas_gflops, blas_gflops);
 
     if (param.compute_true_res) {
       for (int i = 0; i < num_offset; i++) {
         // only calculate true residual if we need to:
-        // 1.) For higher shifts if we did not use mixed precision
+        // 1.) For higher shifts if we did not use mixed precision, or
+        //     started from a guess whose remainder may need refinement
         // 2.) For shift 0 if we did not exit early  (we went to the full solution)
-        if ( (i > 0 and not mixed) or (i == 0 and not exit_early) ) {
+        const bool guess = param.use_init_guess == QUDA_USE_INIT_GUESS_YES;
+        if ((i > 0 and (not mixed or guess)) or (i == 0 and not exit_early)) {
           mat(r, x[i]);
           if (r.Nspin() == 4) {
             blas::axpy(offset[i], x[i], r); // Offset it.
@@ -490,6 +510,10 @@ namespace quda {
       }
     }
 
+    // the record holds the unshifted system, whose true residual is left to the refinement on early exit
+    telemetry.end(k, convergence(r2, stop, num_offset_now) || exit_early,
+                  param.compute_true_res ? param.true_res_offset[0] : NAN, NAN);
+
     // reset the flops counters
     blas::flops = 0;
     mat.flops();
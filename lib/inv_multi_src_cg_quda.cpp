@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <cmath>
+
+#include <quda_internal.h>
+#include <color_spinor_field.h>
+#include <blas_quda.h>
+#include <invert_quda.h>
+#include <util_quda.h>
+
+namespace quda
+{
+
+  MultiSrcCG::MultiSrcCG(const DiracMatrix &mat, const DiracMatrix &matSloppy, SolverParam &param,
+                         TimeProfile &profile) :
+    mat(mat), matSloppy(matSloppy), param(param), profile(profile)
+  {
+  }
+
+  void MultiSrcCG::create(const std::vector<ColorSpinorField> &x, const std::vector<ColorSpinorField> &b)
+  {
+    const auto n = b.size();
+    if (x.size() != n) errorQuda("Number of solutions %lu does not match sources %lu", x.size(), n);
+    if (checkLocation(x[0], b[0]) != QUDA_CUDA_FIELD_LOCATION) errorQuda("Not supported");
+    if (param.residual_type & QUDA_HEAVY_QUARK_RESIDUAL)
+      errorQuda("Heavy-quark residual is not supported by the multi-source solvers");
+    if (r.size() == n) return;
+
+    profile.TPSTART(QUDA_PROFILE_INIT);
+
+    ColorSpinorParam csParam(b[0]);
+    csParam.create = QUDA_NULL_FIELD_CREATE;
+    r.resize(n, csParam);
+
+    // now allocate sloppy fields
+    const bool mixed = param.precision != param.precision_sloppy;
+    csParam.setPrecision(param.precision_sloppy);
+    r_sloppy.clear();
+    for (auto &ri : r) r_sloppy.push_back(mixed ? ColorSpinorField(csParam) : ri.create_alias());
+    x_sloppy.resize(n, csParam);
+    p.resize(n, csParam);
+    s.resize(n, csParam);
+    q.resize(n, csParam);
+
+    profile.TPSTOP(QUDA_PROFILE_INIT);
+  }
+
+  std::vector<int> MultiSrcCG::initialize(std::vector<ColorSpinorField> &x, std::vector<ColorSpinorField> &b,
+                                          std::vector<double> &b2, std::vector<double> &r2, std::vector<double> &stop)
+  {
+    const int n = b.size();
+
+    profile.TPSTART(QUDA_PROFILE_PREAMBLE);
+
+    for (int i = 0; i < n; i++) b2[i] = blas::norm2(b[i]);
+
+    // compute initial residuals
+    if (param.use_init_guess == QUDA_USE_INIT_GUESS_YES) {
+      mat(r, x);
+      for (int i = 0; i < n; i++) r2[i] = blas::xmyNorm(b[i], r[i]);
+    } else {
+      for (int i = 0; i < n; i++) {
+        blas::zero(x[i]);
+        blas::copy(r[i], b[i]);
+        r2[i] = b2[i];
+      }
+    }
+
+    std::vector<int> active;
+    for (int i = 0; i < n; i++) {
+      blas::zero(x_sloppy[i]);
+      blas::copy(r_sloppy[i], r[i]);
+      stop[i] = Solver::stopping(param.tol, b2[i], param.residual_type);
+      if (b2[i] == 0.0) {
+        warningQuda("inverting on zero-field source %d", i);
+        blas::zero(x[i]);
+        r2[i] = 0.0;
+      } else {
+        active.push_back(i);
+      }
+    }
+
+    profile.TPSTOP(QUDA_PROFILE_PREAMBLE);
+    profile.TPSTART(QUDA_PROFILE_COMPUTE);
+    blas::flops = 0;
+
+    return active;
+  }
+
+  void MultiSrcCG::finalize(std::vector<ColorSpinorField> &x, std::vector<ColorSpinorField> &b,
+                            const std::vector<double> &b2, const std::vector<double> &r2, const std::vector<int> &iter,
+                            int k)
+  {
+    const int n = b.size();
+
+    for (int i = 0; i < n; i++) blas::xpy(x_sloppy[i], x[i]);
+
+    param.true_res = 0.0;
+    param.true_res_hq = 0.0;
+    std::vector<double> true_res(n, 0.0);
+    if (param.compute_true_res) {
+      // compute the true residuals
+      mat(r, x);
+      for (int i = 0; i < n; i++) {
+        if (b2[i] > 0.0) true_res[i] = sqrt(blas::xmyNorm(b[i], r[i]) / b2[i]);
+        param.true_res = std::max(param.true_res, true_res[i]);
+      }
+    }
+
+    qudaDeviceSynchronize(); // ensure solver is complete before ending timing
+    profile.TPSTOP(QUDA_PROFILE_COMPUTE);
+    profile.TPSTART(QUDA_PROFILE_EPILOGUE);
+    param.secs += profile.Last(QUDA_PROFILE_COMPUTE);
+
+    // store flops and reset counters
+    double gflops = (blas::flops + mat.flops() + matSloppy.flops()) * 1e-9;
+
+    param.gflops += gflops;
+    param.iter += k;
+
+    // reset the flops counters
+    blas::flops = 0;
+    mat.flops();
+    matSloppy.flops();
+
+    profile.TPSTOP(QUDA_PROFILE_EPILOGUE);
+
+    for (int i = 0; i < n; i++) {
+      logQuda(QUDA_SUMMARIZE,
+              "Source %d: Convergence at %d iterations, L2 relative residual: iterated = %e, true = %e (requested = "
+              "%e)\n",
+              i, iter[i], b2[i] > 0.0 ? sqrt(r2[i] / b2[i]) : 0.0, true_res[i], param.tol);
+    }
+  }
+
+  /*
+    The sources share every operator application and reduction, but
+    nothing else.  The operator is applied to all active sources in
+    one multi-RHS call, which for operators with a batched dslash
+    reads the gauge field once for the whole set.  Each source
+    follows the single-reduction CG of Chronopoulos and Gear, where
+    s = A r is computed explicitly and q = A p by recurrence, so that
+    (r, r) and (r, s) of all sources come from one multi-reduction of
+    [r] against [r, s].  Only the diagonal of each block is used, as
+    the coefficients are per source: the cross terms come from the
+    same tiles of the multi-reduce kernel, so they cost no extra
+    memory traffic.
+
+    A source leaves the batch once it has converged, so that later
+    iterations only apply the operator to the unconverged sources.
+    Reliable updates are done per source, with the true residuals of
+    all sources that require one computed as a batch.
+  */
+  void MultiSrcCG::operator()(std::vector<ColorSpinorField> &x, std::vector<ColorSpinorField> &b)
+  {
+    const int n = b.size();
+    if (n == 0) return;
+
+    pushOutputPrefix("MultiSrcCG: ");
+
+    create(x, b);
+
+    std::vector<double> b2(n), r2(n), stop(n);
+    std::vector<int> active = initialize(x, b, b2, r2, stop);
+
+    std::vector<double> r_max(n); // largest residual norm since the last reliable update
+    std::vector<double> alpha(n), beta(n);
+    std::vector<double> gamma_old(n);
+    std::vector<bool> restart(n, true); // whether the recurrences for p and q start afresh
+    std::vector<int> steps(n, 0); // steps since the last reliable update
+    std::vector<int> iter(n, 0);
+    for (int i = 0; i < n; i++) r_max[i] = sqrt(r2[i]);
+
+    int k = 0;
+    int rUpdate = 0;
+
+    while (!active.empty() && k < param.maxiter) {
+      const int m = active.size();
+      auto r_a = subset(r_sloppy, active);
+      auto s_a = subset(s, active);
+
+      matSloppy(s_a, r_a);
+
+      // a single reduction for (r_i, r_i) and (r_i, s_i) of all active sources
+      std::vector<double> G(m * 2 * m);
+      blas::reDotProduct(G, r_a, {r_a, s_a});
+
+      std::vector<int> step, update, next;
+      for (int a = 0; a < m; a++) {
+        const int i = active[a];
+        const double gamma = G[a * 2 * m + a];
+        const double delta = G[a * 2 * m + m + a];
+        r2[i] = gamma;
+        r_max[i] = std::max(r_max[i], sqrt(gamma));
+
+        const bool converged = gamma < stop[i];
+        // force a reliable update on convergence should this have been accumulated in sloppy precision
+        if (steps[i] > 0 && (sqrt(gamma) < param.delta * r_max[i] || (converged && param.delta >= param.tol))) {
+          update.push_back(i);
+          next.push_back(i);
+        } else if (converged) {
+          logQuda(QUDA_VERBOSE, "Source %d converged after %d iterations\n", i, iter[i]);
+        } else {
+          // the recurrence is restarted should rounding have made the step length denominator non-positive
+          beta[i] = restart[i] ? 0.0 : gamma / gamma_old[i];
+          double denom = restart[i] ? delta : delta - beta[i] * gamma / alpha[i];
+          if (denom <= 0.0) {
+            logQuda(QUDA_VERBOSE, "Restarting recurrence of source %d at iteration %d\n", i, iter[i]);
+            restart[i] = true;
+            beta[i] = 0.0;
+            denom = delta;
+          }
+          alpha[i] = gamma / denom;
+          gamma_old[i] = gamma;
+          step.push_back(i);
+          next.push_back(i);
+        }
+      }
+
+      for (auto i : step) {
+        if (restart[i]) {
+          blas::copy(p[i], r_sloppy[i]);
+          blas::copy(q[i], s[i]);
+          restart[i] = false;
+        } else {
+          blas::xpay(r_sloppy[i], beta[i], p[i]);
+          blas::xpay(s[i], beta[i], q[i]);
+        }
+        blas::axpy(alpha[i], p[i], x_sloppy[i]);
+        blas::axpy(-alpha[i], q[i], r_sloppy[i]);
+        steps[i]++;
+        iter[i]++;
+      }
+
+      if (!update.empty()) {
+        for (auto i : update) {
+          blas::xpy(x_sloppy[i], x[i]);
+          blas::zero(x_sloppy[i]);
+        }
+        auto x_u = subset(x, update);
+        mat(subset(r, update), x_u);
+        for (auto i : update) {
+          r2[i] = blas::xmyNorm(b[i], r[i]);
+          blas::copy(r_sloppy[i], r[i]);
+          r_max[i] = sqrt(r2[i]);
+          steps[i] = 0;
+        }
+
+        // q = A p is carried by recurrence, so recompute it for the continuing recurrences
+        std::vector<int> cont;
+        for (auto i : update)
+          if (!restart[i]) cont.push_back(i);
+        if (!cont.empty()) {
+          auto p_c = subset(p, cont);
+          matSloppy(subset(q, cont), p_c);
+        }
+
+        rUpdate += update.size();
+      }
+
+      active = next;
+      k++;
+
+      if (getVerbosity() >= QUDA_VERBOSE) {
+        double r_rel = 0.0;
+        for (auto i : active) r_rel = std::max(r_rel, sqrt(r2[i] / b2[i]));
+        printfQuda("%d iterations, %d active sources, max |r| / |b| = %e\n", k, (int)active.size(), r_rel);
+      }
+    }
+
+    if (k == param.maxiter) warningQuda("Exceeded maximum iterations %d with %lu active sources", k, active.size());
+
+    logQuda(QUDA_VERBOSE, "Reliable updates = %d\n", rUpdate);
+
+    finalize(x, b, b2, r2, iter, k);
+
+    popOutputPrefix();
+  }
+
+} // namespace quda
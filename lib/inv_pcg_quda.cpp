@@ -373,6 +373,12 @@ namespace quda
         double L2breakdown_eps = 0;
         if (ru.reliable_break(r2, stop, L2breakdown, L2breakdown_eps)) { break; }
 
+        // the caller may end the solve at a reliable update, where the solution is up to date
+        if (param.reliable_update_hook && param.reliable_update_hook(k + 1, r2)) {
+          ++k;
+          break;
+        }
+
         ru.update_norm(r2, y);
 
         ru.reset(r2);
@@ -0,0 +1,333 @@
+#include <array>
+#include <cmath>
+
+#include <quda_internal.h>
+#include <color_spinor_field.h>
+#include <blas_quda.h>
+#include <invert_quda.h>
+#include <util_quda.h>
+#include <reliable_updates.h>
+
+namespace quda
+{
+
+  PipelinedCG::PipelinedCG(const DiracMatrix &mat, const DiracMatrix &matSloppy, const DiracMatrix &matPrecon,
+                           const DiracMatrix &matEig, SolverParam &param, TimeProfile &profile) :
+    Solver(mat, matSloppy, matPrecon, matEig, param, profile)
+  {
+    if (param.deflate) errorQuda("Deflation is not supported by the pipelined CG solver");
+  }
+
+  PipelinedCG::~PipelinedCG()
+  {
+    if (!param.is_preconditioner) profile.TPSTART(QUDA_PROFILE_FREE);
+    destroyDeflationSpace();
+    if (!param.is_preconditioner) profile.TPSTOP(QUDA_PROFILE_FREE);
+  }
+
+  void PipelinedCG::create(ColorSpinorField &x, const ColorSpinorField &b)
+  {
+    Solver::create(x, b);
+    if (!init) {
+      if (!param.is_preconditioner) profile.TPSTART(QUDA_PROFILE_INIT);
+
+      ColorSpinorParam csParam(b);
+      csParam.create = QUDA_NULL_FIELD_CREATE;
+      r = ColorSpinorField(csParam);
+      y = ColorSpinorField(csParam);
+
+      // now allocate sloppy fields
+      csParam.setPrecision(param.precision_sloppy);
+      r_sloppy = mixed() ? ColorSpinorField(csParam) : r.create_alias();
+      x_sloppy = ColorSpinorField(csParam);
+      p = ColorSpinorField(csParam);
+      s = ColorSpinorField(csParam);
+      w = ColorSpinorField(csParam);
+      z = ColorSpinorField(csParam);
+      q = ColorSpinorField(csParam);
+
+      if (!param.is_preconditioner) profile.TPSTOP(QUDA_PROFILE_INIT);
+
+      init = true;
+    }
+  }
+
+  ColorSpinorField &PipelinedCG::get_residual()
+  {
+    if (!init) errorQuda("No residual vector present");
+    if (!param.return_residual) errorQuda("SolverParam::return_residual not enabled");
+    // the residual of the last replacement, or the true residual if it was computed
+    return r;
+  }
+
+  /*
+    Pipelined CG, following Algorithm 4 of Ghysels and Vanroose.
+    Alongside the residual r, the recurrences carry w = A r, s = A p
+    and z = A s, such that both inner products (r, r) and (w, r) of an
+    iteration are available before the operator is applied, and are
+    reduced together with a single global sum that runs concurrently
+    with q = A w.  The residual is checked for convergence one
+    iteration late, when its norm arrives with the reduction.
+    Rounding errors in the extra recurrences are removed by residual
+    replacement, where r, w, s and z are recomputed explicitly.
+  */
+  void PipelinedCG::operator()(ColorSpinorField &x, ColorSpinorField &b)
+  {
+    if (param.is_preconditioner) commGlobalReductionPush(param.global_reduction);
+
+    if (checkLocation(x, b) != QUDA_CUDA_FIELD_LOCATION) errorQuda("Not supported");
+
+    if (param.maxiter == 0 || param.Nsteps == 0) {
+      if (param.use_init_guess == QUDA_USE_INIT_GUESS_NO) blas::zero(x);
+      if (param.is_preconditioner) commGlobalReductionPop();
+      return;
+    }
+
+    create(x, b);
+
+    if (!param.is_preconditioner) profile.TPSTART(QUDA_PROFILE_PREAMBLE);
+
+    double b2 = blas::norm2(b);
+
+    // Check to see that we're not trying to invert on a zero-field source
+    if (b2 == 0 && param.compute_null_vector == QUDA_COMPUTE_NULL_VECTOR_NO) {
+      if (!param.is_preconditioner) profile.TPSTOP(QUDA_PROFILE_PREAMBLE);
+      warningQuda("inverting on zero-field source");
+      x = b;
+      param.true_res = 0.0;
+      param.true_res_hq = 0.0;
+      if (param.is_preconditioner) commGlobalReductionPop();
+      return;
+    }
+
+    const bool alternative_reliable = param.use_alternative_reliable;
+    const double u = precisionEpsilon(param.precision_sloppy);
+    const double uhigh = precisionEpsilon(); // solver precision
+
+    double Anorm = 0.0;
+    if (alternative_reliable) {
+      // estimate norm for reliable updates
+      mat(r, b);
+      Anorm = sqrt(blas::norm2(r) / b2);
+    }
+
+    // compute initial residual
+    double r2 = 0.0;
+    if (param.use_init_guess == QUDA_USE_INIT_GUESS_YES) {
+      mat(r, x);
+      r2 = blas::xmyNorm(b, r);
+      if (b2 == 0) b2 = r2;
+      // y contains the original guess
+      blas::copy(y, x);
+    } else {
+      blas::copy(r, b);
+      r2 = b2;
+      blas::zero(y);
+    }
+    blas::zero(x_sloppy);
+    blas::copy(r_sloppy, r);
+    matSloppy(w, r_sloppy);
+
+    const bool use_heavy_quark_res = (param.residual_type & QUDA_HEAVY_QUARK_RESIDUAL) ? true : false;
+    double heavy_quark_res = use_heavy_quark_res ? sqrt(blas::HeavyQuarkResidualNorm(y, r).z) : 0.0;
+    double heavy_quark_res_old = heavy_quark_res;
+
+    const double stop = stopping(param.tol, b2, param.residual_type); // stopping condition of solver
+
+    ReliableUpdatesParams ru_params;
+    ru_params.alternative_reliable = alternative_reliable;
+    ru_params.u = u;
+    ru_params.uhigh = uhigh;
+    ru_params.Anorm = Anorm;
+    ru_params.delta = param.delta;
+    ru_params.maxResIncrease = param.max_res_increase;
+    ru_params.maxResIncreaseTotal = param.max_res_increase_total;
+    ru_params.use_heavy_quark_res = use_heavy_quark_res;
+    ru_params.hqmaxresIncrease = param.max_hq_res_increase;
+    ru_params.hqmaxresRestartTotal = param.max_hq_res_restart_total;
+
+    ReliableUpdates ru(ru_params, r2);
+
+    bool L2breakdown = false;
+    const double L2breakdown_eps = 100. * uhigh;
+
+    if (!param.is_preconditioner) {
+      profile.TPSTOP(QUDA_PROFILE_PREAMBLE);
+      profile.TPSTART(QUDA_PROFILE_COMPUTE);
+      blas::flops = 0;
+    }
+
+    // as in CG, the heavy-quark residual is only trusted if it was computed at a residual replacement
+    auto converged_check = [&]() {
+      if (!use_heavy_quark_res) return convergence(r2, heavy_quark_res, stop, param.tol_hq);
+      bool L2done = L2breakdown || convergenceL2(r2, heavy_quark_res, stop, param.tol_hq);
+      bool HQdone = (ru.steps_since_reliable == 0 && param.delta > 0)
+        && convergenceHQ(r2, heavy_quark_res, stop, param.tol_hq);
+      return L2done && HQdone;
+    };
+
+    // the reduction is only deferred if it is a global one
+    const bool global_reduction = commGlobalReduction();
+
+    double alpha = 0.0;
+    double gamma_old = 0.0;
+    double r2_old = r2;
+    bool restart = true;     // whether the recurrences for p, s and z start afresh
+    bool accumulate = false; // whether an update of x is yet to be folded into the error estimate
+    int k = 0;
+
+    PrintStats("PipelinedCG", k, r2, b2, heavy_quark_res);
+    bool converged = converged_check();
+
+    while (!converged && k < param.maxiter) {
+      // rank-local fused reduction of (r, r), (w, r) and, for the alternative reliable updates, (p, p)
+      std::array<double, 3> sum = {};
+      commGlobalReductionPush(false);
+      double3 rw = blas::cDotProductNormA(r_sloppy, w);
+      sum[0] = rw.z;
+      sum[1] = rw.x;
+      if (alternative_reliable && accumulate) sum[2] = blas::norm2(p);
+      commGlobalReductionPop();
+
+      // overlap the global sum with the operator
+      if (global_reduction) comm_allreduce_sum_array_start(sum.data(), sum.size());
+      matSloppy(q, w);
+      if (global_reduction) comm_allreduce_wait();
+
+      const double gamma = sum[0];
+      const double delta = sum[1];
+      r2 = gamma;
+
+      ru.update_rNorm(sqrt(r2));
+      if (accumulate) {
+        ru.update_ppnorm(sum[2]);
+        ru.accumulate_norm(alpha);
+        PrintStats("PipelinedCG", k, r2, b2, heavy_quark_res);
+      }
+
+      ru.evaluate(r2_old);
+      // force a residual replacement if we are within target tolerance (only if doing reliable updates)
+      if (param.delta >= param.tol
+          && (convergence(r2, heavy_quark_res, stop, param.tol_hq)
+              || (use_heavy_quark_res && convergenceL2(r2, heavy_quark_res, stop, param.tol_hq))))
+        ru.set_updateX();
+
+      if (ru.trigger()) {
+        blas::xpy(x_sloppy, y);
+        blas::zero(x_sloppy);
+        mat(r, y);
+        r2 = blas::xmyNorm(b, r);
+        blas::copy(r_sloppy, r);
+
+        ru.update_norm(r2, y);
+        if (use_heavy_quark_res) heavy_quark_res = sqrt(blas::HeavyQuarkResidualNorm(y, r).z);
+
+        if (ru.reliable_break(r2, stop, L2breakdown, L2breakdown_eps)) break;
+
+        // the caller may end the solve at a reliable update, where the solution is up to date
+        if (param.reliable_update_hook && param.reliable_update_hook(k, r2)) break;
+
+        bool heavy_quark_restart = false;
+        if (use_heavy_quark_res
+            && ru.reliable_heavy_quark_break(L2breakdown, heavy_quark_res, heavy_quark_res_old, heavy_quark_restart))
+          break;
+        if (heavy_quark_restart) restart = true;
+
+        // recompute the auxiliary vectors; s and z are only needed if the recurrence continues
+        matSloppy(w, r_sloppy);
+        if (!restart) {
+          matSloppy(s, p);
+          matSloppy(z, s);
+        }
+
+        ru.reset(r2);
+        heavy_quark_res_old = heavy_quark_res;
+        r2_old = r2;
+        accumulate = false;
+
+        PrintStats("PipelinedCG", k, r2, b2, heavy_quark_res);
+        converged = converged_check();
+        continue;
+      }
+
+      converged = converged_check();
+      if (converged) break;
+
+      // the recurrence is restarted should rounding have made the step length denominator non-positive
+      double beta = restart ? 0.0 : gamma / gamma_old;
+      double denom = restart ? delta : delta - beta * gamma / alpha;
+      if (denom <= 0.0) {
+        logQuda(QUDA_VERBOSE, "PipelinedCG: restarting recurrence at iteration %d\n", k);
+        restart = true;
+        denom = delta;
+      }
+      alpha = gamma / denom;
+
+      if (restart) {
+        blas::copy(z, q);
+        blas::copy(s, w);
+        blas::copy(p, r_sloppy);
+        restart = false;
+      } else {
+        blas::xpay(q, beta, z);
+        blas::xpay(w, beta, s);
+        blas::xpay(r_sloppy, beta, p);
+      }
+      blas::axpy(alpha, p, x_sloppy);
+      blas::axpy(-alpha, s, r_sloppy);
+      blas::axpy(-alpha, z, w);
+
+      gamma_old = gamma;
+      r2_old = r2;
+      accumulate = true;
+      k++;
+
+      if (use_heavy_quark_res && k % param.heavy_quark_check == 0) {
+        // q is free until the next application of the operator
+        blas::copy(q, y);
+        heavy_quark_res = sqrt(blas::xpyHeavyQuarkResidualNorm(x_sloppy, q, r_sloppy).z);
+      }
+    }
+
+    blas::copy(x, x_sloppy);
+    blas::xpy(y, x);
+
+    if (k == param.maxiter) warningQuda("Exceeded maximum iterations %d", param.maxiter);
+
+    logQuda(QUDA_VERBOSE, "PipelinedCG: Residual replacements = %d\n", ru.rUpdate);
+
+    if (param.compute_true_res) {
+      // compute the true residuals
+      mat(r, x);
+      param.true_res = sqrt(blas::xmyNorm(b, r) / b2);
+      param.true_res_hq = use_heavy_quark_res ? sqrt(blas::HeavyQuarkResidualNorm(x, r).z) : 0.0;
+    }
+
+    if (!param.is_preconditioner) {
+      qudaDeviceSynchronize(); // ensure solver is complete before ending timing
+      profile.TPSTOP(QUDA_PROFILE_COMPUTE);
+      profile.TPSTART(QUDA_PROFILE_EPILOGUE);
+      param.secs += profile.Last(QUDA_PROFILE_COMPUTE);
+
+      // store flops and reset counters
+      double gflops = (blas::flops + mat.flops() + matSloppy.flops() + matPrecon.flops() + matEig.flops()) * 1e-9;
+
+      param.gflops += gflops;
+      param.iter += k;
+
+      // reset the flops counters
+      blas::flops = 0;
+      mat.flops();
+      matSloppy.flops();
+      matPrecon.flops();
+      matEig.flops();
+
+      profile.TPSTOP(QUDA_PROFILE_EPILOGUE);
+    }
+
+    PrintSummary("PipelinedCG", k, r2, b2, stop, param.tol_hq);
+
+    if (param.is_preconditioner) commGlobalReductionPop();
+  }
+
+} // namespace quda
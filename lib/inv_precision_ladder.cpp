@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cmath>
+
+#include <quda_internal.h>
+#include <color_spinor_field.h>
+#include <blas_quda.h>
+#include <invert_quda.h>
+#include <util_quda.h>
+
+namespace quda
+{
+
+  PrecisionLadder::PrecisionLadder(const DiracMatrix &mat, const DiracMatrix &matSloppy, const DiracMatrix &matPrecon,
+                                   const DiracMatrix &matEig, SolverParam &param, TimeProfile &profile) :
+    Solver(mat, matSloppy, matPrecon, matEig, param, profile), rung_param(param)
+  {
+    if (param.precision_ladder_check <= 0)
+      errorQuda("Invalid precision ladder check interval %d", param.precision_ladder_check);
+    if (param.deflate) errorQuda("Deflation is not supported with the precision ladder");
+    // promotion is decided at the reliable updates, so the solver must report them
+    switch (param.inv_type) {
+    case QUDA_CG_INVERTER:
+    case QUDA_CGNE_INVERTER:
+    case QUDA_CGNR_INVERTER:
+    case QUDA_PCG_INVERTER:
+    case QUDA_PIPELINED_CG_INVERTER:
+    case QUDA_GCR_INVERTER:
+    case QUDA_BICGSTAB_INVERTER: break;
+    default: errorQuda("Solver type %d is not supported with the precision ladder", param.inv_type);
+    }
+
+    rungs.push_back({param.precision, &mat});
+    if (param.precision_sloppy < rungs.front().first) rungs.insert(rungs.begin(), {param.precision_sloppy, &matSloppy});
+    // with a Schwarz preconditioner the preconditioner operator is local, so cannot be a rung
+    if (param.schwarz_type == QUDA_INVALID_SCHWARZ && param.precision_precondition < rungs.front().first)
+      rungs.insert(rungs.begin(), {param.precision_precondition, &matPrecon});
+
+    rung_param.precision_ladder = false;
+    createRung();
+  }
+
+  void PrecisionLadder::createRung()
+  {
+    rung_param.precision_sloppy = rungs[rung].first;
+    solver.reset(Solver::create(rung_param, mat, *rungs[rung].second, matPrecon, matEig, profile));
+  }
+
+  void PrecisionLadder::operator()(ColorSpinorField &x, ColorSpinorField &b)
+  {
+    if (param.maxiter == 0) {
+      if (param.use_init_guess == QUDA_USE_INIT_GUESS_NO) blas::zero(x);
+      return;
+    }
+
+    pushOutputPrefix("PrecisionLadder: ");
+
+    create(x, b);
+
+    // each solve climbs the ladder from the bottom
+    if (rung > 0) {
+      rung = 0;
+      createRung();
+    }
+
+    const double b2 = blas::norm2(b);
+
+    // relative residual at the start of the interval over which the convergence rate is measured
+    double res = 1.0;
+    if (param.use_init_guess == QUDA_USE_INIT_GUESS_YES && b2 > 0.0) {
+      ColorSpinorField r(x);
+      mat(r, x);
+      res = sqrt(blas::xmyNorm(b, r) / b2);
+    }
+
+    auto converged = [&]() {
+      bool done = true;
+      if (param.residual_type & QUDA_L2_RELATIVE_RESIDUAL) done = done && rung_param.true_res <= param.tol;
+      if (param.residual_type & QUDA_L2_ABSOLUTE_RESIDUAL) done = done && rung_param.true_res * sqrt(b2) <= param.tol;
+      if (param.residual_type & QUDA_HEAVY_QUARK_RESIDUAL) done = done && rung_param.true_res_hq <= param.tol_hq;
+      return done;
+    };
+
+    int k = 0;              // iterations over all rungs
+    int iter_start = 0;     // solver iteration at the start of the rate interval
+    double best_rate = 0.0; // largest reduction of the log residual per iteration on the current rung
+    bool stalled = false;   // whether the solver was ended at a reliable update since the rate stalled
+
+    // the inner solves are not recorded, so the record of the ladder holds the residuals at the reliable updates
+    telemetry.begin("PrecisionLadder", param, b2);
+
+    // promotion is decided at the reliable updates of the solver, where the true residual is known
+    rung_param.reliable_update_hook = [&](int iter, double r2) {
+      telemetry.reliable_update();
+      telemetry.iteration(k + iter, r2, 0.0);
+      if (rung + 1 == static_cast<int>(rungs.size()) || b2 == 0.0 || iter - iter_start < param.precision_ladder_check)
+        return false;
+      const double res_now = sqrt(r2 / b2);
+      const double rate = res_now > 0.0 ? log(res / res_now) / (iter - iter_start) : 0.0;
+      logQuda(QUDA_VERBOSE, "%d iterations, %d-bit sloppy precision, |r| / |b| = %e, rate = %e\n",
+              k + iter, 8 * rungs[rung].first, res_now, rate);
+      stalled = rate < 0.5 * best_rate || rate <= 0.0;
+      if (stalled) return true;
+      best_rate = std::max(best_rate, rate);
+      iter_start = iter;
+      res = res_now;
+      return false;
+    };
+
+    rung_param.use_init_guess = param.use_init_guess;
+    rung_param.compute_true_res = true;
+
+    while (true) {
+      rung_param.maxiter = param.maxiter - k;
+      rung_param.iter = 0;
+      rung_param.secs = 0.0;
+      rung_param.gflops = 0.0;
+      stalled = false;
+
+      (*solver)(x, b);
+
+      rung_param.use_init_guess = QUDA_USE_INIT_GUESS_YES;
+      k += rung_param.iter;
+      param.iter += rung_param.iter;
+      param.secs += rung_param.secs;
+      param.gflops += rung_param.gflops;
+
+      // the solver only ends early when stalled or at its noise floor
+      if (b2 == 0.0 || converged() || k >= param.maxiter || rung + 1 == static_cast<int>(rungs.size())) break;
+
+      logQuda(QUDA_SUMMARIZE,
+              "Promoting sloppy precision from %d to %d bits after %d iterations (%s), |r| / |b| = %e, best rate = "
+              "%e\n",
+              8 * rungs[rung].first, 8 * rungs[rung + 1].first, k, stalled ? "stalled" : "noise floor",
+              rung_param.true_res, best_rate);
+      rung++;
+      createRung();
+      iter_start = 0;
+      best_rate = 0.0;
+      res = rung_param.true_res;
+    }
+
+    rung_param.reliable_update_hook = nullptr;
+
+    param.true_res = rung_param.true_res;
+    param.true_res_hq = rung_param.true_res_hq;
+    param.precision_ladder_promotions = rung;
+    telemetry.end(k, converged(), param.true_res,
+                  param.residual_type & QUDA_HEAVY_QUARK_RESIDUAL ? param.true_res_hq : NAN);
+
+    logQuda(QUDA_SUMMARIZE, "Finished after %d iterations with %d-bit sloppy precision, L2 relative residual = %e\n",
+            k, 8 * rungs[rung].first, param.true_res);
+
+    popOutputPrefix();
+  }
+
+} // namespace quda
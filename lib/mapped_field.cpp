@@ -0,0 +1,114 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <mapped_field.h>
+
+namespace quda
+{
+
+  MappedRegion::MappedRegion(const std::string &filename, size_t offset, size_t bytes) :
+    base(nullptr), length(0), ptr(nullptr), bytes(bytes)
+  {
+    if (bytes == 0) errorQuda("Cannot map an empty region of %s", filename.c_str());
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) errorQuda("Failed to open %s (%s)", filename.c_str(), strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) != 0) errorQuda("Failed to stat %s (%s)", filename.c_str(), strerror(errno));
+    if (static_cast<size_t>(st.st_size) < offset + bytes)
+      errorQuda("Region [%lu, %lu) is beyond the end of %s (%lu bytes)", offset, offset + bytes, filename.c_str(),
+                static_cast<size_t>(st.st_size));
+
+    // the mapping must start on a page boundary
+    const size_t page = sysconf(_SC_PAGESIZE);
+    const size_t start = (offset / page) * page;
+    length = offset + bytes - start;
+    base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, start);
+    if (base == MAP_FAILED) errorQuda("Failed to map %s (%s)", filename.c_str(), strerror(errno));
+    close(fd);
+
+    // the field is read once, front to back, when copied to the device
+    madvise(base, length, MADV_SEQUENTIAL);
+    madvise(base, length, MADV_WILLNEED);
+    ptr = static_cast<char *>(base) + (offset - start);
+
+    if (getVerbosity() >= QUDA_DEBUG_VERBOSE)
+      printfQuda("Mapped %lu bytes of %s at offset %lu\n", bytes, filename.c_str(), offset);
+  }
+
+  MappedRegion::~MappedRegion()
+  {
+    if (base && munmap(base, length) != 0) warningQuda("Failed to unmap region (%s)", strerror(errno));
+  }
+
+  void **MappedRegion::chunks(int n)
+  {
+    if (n <= 0 || bytes % n != 0) errorQuda("Cannot split %lu bytes into %d chunks", bytes, n);
+    chunks_.resize(n);
+    for (int i = 0; i < n; i++) chunks_[i] = ptr + i * (bytes / n);
+    return chunks_.data();
+  }
+
+  /** @return The number of bytes of a host gauge field */
+  static size_t mapped_bytes(const GaugeFieldParam &param)
+  {
+    if (param.location != QUDA_CPU_FIELD_LOCATION) errorQuda("Mapped gauge fields must be host fields");
+    if (param.order != QUDA_QDP_GAUGE_ORDER && param.order != QUDA_MILC_GAUGE_ORDER)
+      errorQuda("Mapped gauge fields must be in QDP or MILC order, not %d", param.order);
+
+    int site_dim = 0;
+    switch (param.geometry) {
+    case QUDA_SCALAR_GEOMETRY: site_dim = 1; break;
+    case QUDA_VECTOR_GEOMETRY: site_dim = param.nDim; break;
+    default: errorQuda("Unsupported geometry %d for mapped gauge fields", param.geometry);
+    }
+    size_t volume = 1;
+    for (int d = 0; d < param.nDim; d++) volume *= param.x[d];
+    size_t n_internal = param.reconstruct != QUDA_RECONSTRUCT_NO ? param.reconstruct : 2 * param.nColor * param.nColor;
+    return site_dim * volume * n_internal * param.Precision();
+  }
+
+  /** @return Parameters of a reference field to the region */
+  static GaugeFieldParam reference_param(GaugeFieldParam param, MappedRegion &region)
+  {
+    param.create = QUDA_REFERENCE_FIELD_CREATE;
+    param.gauge = param.order == QUDA_QDP_GAUGE_ORDER ?
+      region.chunks(param.geometry == QUDA_SCALAR_GEOMETRY ? 1 : param.nDim) :
+      region.data();
+    return param;
+  }
+
+  MappedGaugeField::MappedGaugeField(const std::string &filename, size_t offset, const GaugeFieldParam &param) :
+    MappedRegion(filename, offset, mapped_bytes(param)), cpuGaugeField(reference_param(param, *this))
+  {
+  }
+
+  /** @return The number of bytes of a host vector field */
+  static size_t mapped_bytes(const ColorSpinorParam &param)
+  {
+    if (param.location != QUDA_CPU_FIELD_LOCATION) errorQuda("Mapped vector fields must be host fields");
+    if (param.fieldOrder != QUDA_SPACE_SPIN_COLOR_FIELD_ORDER && param.fieldOrder != QUDA_SPACE_COLOR_SPIN_FIELD_ORDER)
+      errorQuda("Unsupported field order %d for mapped vector fields", param.fieldOrder);
+
+    size_t volume = 1;
+    for (int d = 0; d < param.nDim; d++) volume *= param.x[d];
+    return volume * param.nSpin * param.nColor * 2 * param.Precision();
+  }
+
+  static ColorSpinorParam reference_param(ColorSpinorParam param, MappedRegion &region)
+  {
+    param.create = QUDA_REFERENCE_FIELD_CREATE;
+    param.v = region.data();
+    return param;
+  }
+
+  MappedColorSpinorField::MappedColorSpinorField(const std::string &filename, size_t offset,
+                                                 const ColorSpinorParam &param) :
+    MappedRegion(filename, offset, mapped_bytes(param)), ColorSpinorField(reference_param(param, *this))
+  {
+  }
+
+} // namespace quda
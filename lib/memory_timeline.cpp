@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <memory_timeline.h>
+#include <malloc_quda.h>
+#include <util_quda.h>
+
+namespace quda
+{
+
+  namespace memory_timeline
+  {
+
+    /** The memory types reported in the tunecache trace */
+    enum { DEVICE, PINNED, MAPPED, HOST, N_TRACE_TYPE };
+
+    struct Event {
+      double time;                   /** Seconds since the timeline was started */
+      const char *type;              /** Memory type of this event */
+      long delta;                    /** Signed number of bytes allocated */
+      int phase;                     /** Innermost active phase, or -1 if none */
+      size_t bytes[N_TRACE_TYPE];    /** Memory allocated following this event */
+    };
+
+    struct Phase {
+      std::string name;
+      size_t peak[N_TRACE_TYPE] = {}; /** Peak memory allocated while this phase was active */
+      size_t allocated = 0;           /** Bytes allocated while this phase was active */
+      size_t events = 0;              /** Number of events while this phase was active */
+    };
+
+    static std::mutex mutex;
+    static std::vector<Event> ring;   // ring buffer of events
+    static size_t n_event = 0;        // total number of events recorded
+    static std::vector<Phase> phases; // all phases seen so far
+    static std::unordered_map<std::string, int> phase_id;
+    static std::vector<int> stack; // active phases, innermost last
+    static std::chrono::steady_clock::time_point start;
+
+    bool enabled()
+    {
+      static bool enable = [] {
+        char *enable_str = getenv("QUDA_ENABLE_MEMORY_TIMELINE");
+        bool enable = enable_str && strcmp(enable_str, "1") == 0;
+        if (enable) {
+          size_t ring_size = 65536;
+          char *size_str = getenv("QUDA_MEMORY_TIMELINE_SIZE");
+          if (size_str) {
+            long n = atol(size_str);
+            if (n <= 0) errorQuda("Invalid QUDA_MEMORY_TIMELINE_SIZE=%s", size_str);
+            ring_size = n;
+          }
+          ring.resize(ring_size);
+          start = std::chrono::steady_clock::now();
+        }
+        return enable;
+      }();
+      return enable;
+    }
+
+    void push_phase(const std::string &name)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = phase_id.find(name);
+      int id;
+      if (it == phase_id.end()) {
+        id = phases.size();
+        phase_id[name] = id;
+        phases.push_back({name});
+      } else {
+        id = it->second;
+      }
+      stack.push_back(id);
+
+      // the current allocation is a lower bound for the phase peak
+      size_t bytes[N_TRACE_TYPE] = {device_allocated(), pinned_allocated(), mapped_allocated(), host_allocated()};
+      for (int t = 0; t < N_TRACE_TYPE; t++) phases[id].peak[t] = std::max(phases[id].peak[t], bytes[t]);
+    }
+
+    void pop_phase(const std::string &name)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = phase_id.find(name);
+      if (it == phase_id.end()) return;
+      for (auto s = stack.rbegin(); s != stack.rend(); s++) {
+        if (*s == it->second) {
+          stack.erase(std::next(s).base());
+          return;
+        }
+      }
+    }
+
+    void record(const char *type, long delta)
+    {
+      if (!enabled()) return;
+
+      Event event;
+      event.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      event.type = type;
+      event.delta = delta;
+      event.bytes[DEVICE] = device_allocated();
+      event.bytes[PINNED] = pinned_allocated();
+      event.bytes[MAPPED] = mapped_allocated();
+      event.bytes[HOST] = host_allocated();
+
+      std::lock_guard<std::mutex> lock(mutex);
+      event.phase = stack.empty() ? -1 : stack.back();
+      ring[n_event % ring.size()] = event;
+      n_event++;
+
+      for (auto id : stack) {
+        auto &p = phases[id];
+        for (int t = 0; t < N_TRACE_TYPE; t++) p.peak[t] = std::max(p.peak[t], event.bytes[t]);
+        p.events++;
+        if (delta > 0) p.allocated += delta;
+      }
+    }
+
+    void print_phase_peaks()
+    {
+      if (!enabled()) return;
+      std::lock_guard<std::mutex> lock(mutex);
+      printfQuda("Memory timeline: %zu events recorded, %zu retained\n", n_event, std::min(n_event, ring.size()));
+      if (phases.empty()) return;
+      printfQuda("%40s %8s %14s %12s %12s %12s %12s\n", "Phase", "Events", "Allocated MiB", "Device MiB",
+                 "Pinned MiB", "Mapped MiB", "Host MiB");
+      for (auto &p : phases) {
+        if (p.events == 0) continue;
+        printfQuda("%40s %8zu %14.1f %12.1f %12.1f %12.1f %12.1f\n", p.name.c_str(), p.events,
+                   p.allocated / (double)(1 << 20), p.peak[DEVICE] / (double)(1 << 20),
+                   p.peak[PINNED] / (double)(1 << 20), p.peak[MAPPED] / (double)(1 << 20),
+                   p.peak[HOST] / (double)(1 << 20));
+      }
+    }
+
+    void serialize(std::ostream &out)
+    {
+      if (!enabled()) return;
+      std::lock_guard<std::mutex> lock(mutex);
+      size_t n = std::min(n_event, ring.size());
+      for (size_t i = n_event - n; i < n_event; i++) {
+        auto &event = ring[i % ring.size()];
+        out << std::setw(12) << event.time << "\t";
+        for (int t = 0; t < N_TRACE_TYPE; t++) out << std::setw(12) << event.bytes[t] << "\t";
+        out << std::setw(16) << "memory"
+            << "\t";
+        out << (event.phase >= 0 ? phases[event.phase].name : "none") << "\t\t";
+        out << "type=" << event.type << ",delta=" << event.delta << std::endl;
+      }
+    }
+
+    size_t size()
+    {
+      if (!enabled()) return 0;
+      std::lock_guard<std::mutex> lock(mutex);
+      return std::min(n_event, ring.size());
+    }
+
+  } // namespace memory_timeline
+
+} // namespace quda
@@ -0,0 +1,410 @@
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstring>
+#include <stdexcept>
+#include <externals/json.hpp>
+#include <crc32.h>
+#include <mg_checkpoint.h>
+
+namespace quda
+{
+
+  namespace mg_checkpoint
+  {
+
+    using json = nlohmann::json;
+
+    namespace
+    {
+
+      constexpr int format_version = 2;
+      constexpr size_t max_manifest_bytes = 1 << 24;
+      constexpr size_t verify_buffer_bytes = 1 << 24;
+
+      std::string data_file(const std::string &filename) { return filename + ".data"; }
+
+      std::string key(int level, const std::string &name) { return std::to_string(level) + "/" + name; }
+
+      /**
+         @return The parameters that define the hierarchy, which must
+         match for a checkpoint to be restored.  The geometric block
+         sizes are those after any adjustment by the transfer
+         operator, as written back to the parameters, so requesting
+         block sizes that are adjusted means the checkpoint is not
+         restored and the hierarchy is set up afresh.
+       */
+      json hierarchy_param(const QudaMultigridParam &param)
+      {
+        const QudaInvertParam &inv = *param.invert_param;
+        json p;
+        p["dslash_type"] = inv.dslash_type;
+        p["matpc_type"] = inv.matpc_type;
+        p["kappa"] = inv.kappa;
+        p["mass"] = inv.mass;
+        p["mu"] = inv.mu;
+        p["epsilon"] = inv.epsilon;
+        p["m5"] = inv.m5;
+        p["Ls"] = inv.Ls;
+        p["clover_csw"] = inv.clover_csw;
+        p["clover_coeff"] = inv.clover_coeff;
+        p["twist_flavor"] = inv.twist_flavor;
+        p["n_level"] = param.n_level;
+        for (int l = 0; l < param.n_level; l++) {
+          json level;
+          level["n_vec"] = param.n_vec[l];
+          for (int d = 0; d < QUDA_MAX_DIM; d++) level["geo_block_size"].push_back(param.geo_block_size[l][d]);
+          level["spin_block_size"] = param.spin_block_size[l];
+          level["n_block_ortho"] = param.n_block_ortho[l];
+          level["block_ortho_two_pass"] = param.block_ortho_two_pass[l];
+          level["precision_null"] = param.precision_null[l];
+          level["transfer_type"] = param.transfer_type[l];
+          level["mu_factor"] = param.mu_factor[l];
+          level["setup_location"] = param.setup_location[l];
+          level["coarse_grid_solution_type"] = param.coarse_grid_solution_type[l];
+          level["smoother_solve_type"] = param.smoother_solve_type[l];
+          p["levels"].push_back(level);
+        }
+        return p;
+      }
+
+      /** @return The rank partitioning and local dimensions of the fine grid */
+      json partitioning(const GaugeField &gauge)
+      {
+        json p;
+        for (int d = 0; d < 4; d++) {
+          p["comm_dims"].push_back(comm_dim(d));
+          p["local_dims"].push_back(gauge.X()[d]);
+        }
+        return p;
+      }
+
+      std::string gauge_checksum(const GaugeField &gauge)
+      {
+        char str[17];
+        snprintf(str, sizeof(str), "%016" PRIx64, Checksum(gauge));
+        return str;
+      }
+
+      /** @return Parameters of a host field for file I/O of a given field */
+      ColorSpinorParam host_param(const ColorSpinorField &v)
+      {
+        ColorSpinorParam param(v);
+        param.location = QUDA_CPU_FIELD_LOCATION;
+        param.mem_type = QUDA_MEMORY_PINNED;
+        param.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
+        param.setPrecision(std::max(v.Precision(), QUDA_SINGLE_PRECISION));
+        param.create = QUDA_NULL_FIELD_CREATE;
+        return param;
+      }
+
+      /** @return The rank-local data of a host gauge field as contiguous chunks */
+      template <typename T, typename Field> std::vector<std::pair<T *, size_t>> chunks(Field &u)
+      {
+        if (u.Location() != QUDA_CPU_FIELD_LOCATION) errorQuda("Checkpoint gauge fields must be host fields");
+        std::vector<std::pair<T *, size_t>> c;
+        if (u.Order() == QUDA_QDP_GAUGE_ORDER) {
+          auto gauge = static_cast<T *const *>(u.Gauge_p());
+          for (int d = 0; d < u.Geometry(); d++) c.push_back({gauge[d], u.Bytes() / u.Geometry()});
+        } else {
+          c.push_back({u.Gauge_p(), u.Bytes()});
+        }
+        return c;
+      }
+
+      /**
+         @brief The SciDAC-style checksum of the rank-local data,
+         reduced over all ranks
+       */
+      template <typename T> crc::ScidacChecksum checksum(const std::vector<std::pair<T *, size_t>> &chunks)
+      {
+        crc::ScidacChecksum sum;
+        for (auto i = 0u; i < chunks.size(); i++)
+          sum.add(static_cast<uint64_t>(comm_rank()) * chunks.size() + i, chunks[i].first, chunks[i].second);
+        uint64_t packed = sum.pack();
+        comm_allreduce_xor(packed);
+        sum.unpack(packed);
+        return sum;
+      }
+
+    } // namespace
+
+    Writer::Writer(const std::string &filename, const QudaMultigridParam &param, const GaugeField &gauge) :
+      filename(filename), fd(-1), offset(0)
+    {
+      json m;
+      m["format"] = "quda-mg-checkpoint";
+      m["version"] = format_version;
+      m["partitioning"] = partitioning(gauge);
+      m["gauge_checksum"] = gauge_checksum(gauge);
+      m["param"] = hierarchy_param(param);
+      manifest = m.dump();
+
+      const auto data = data_file(filename);
+      if (comm_rank() == 0) {
+        int fd0 = open(data.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd0 < 0) errorQuda("Failed to open %s (%s)", data.c_str(), strerror(errno));
+        ::close(fd0);
+      }
+      comm_barrier();
+      fd = open(data.c_str(), O_WRONLY);
+      if (fd < 0) errorQuda("Failed to open %s (%s)", data.c_str(), strerror(errno));
+    }
+
+    Writer::~Writer()
+    {
+      if (fd >= 0) ::close(fd);
+    }
+
+    void Writer::write(int level, const std::string &name, const std::vector<std::pair<const void *, size_t>> &chunks)
+    {
+      size_t bytes = 0;
+      for (auto &c : chunks) bytes += c.second;
+
+      // each rank writes its block, with the blocks ordered by rank
+      off_t pos = offset + comm_rank() * bytes;
+      for (auto &c : chunks) {
+        auto p = static_cast<const char *>(c.first);
+        for (size_t left = c.second; left > 0;) {
+          ssize_t n = pwrite(fd, p, left, pos);
+          if (n < 0 && errno == EINTR) continue;
+          if (n <= 0) errorQuda("Failed to write %s (%s)", data_file(filename).c_str(), strerror(errno));
+          p += n;
+          pos += n;
+          left -= n;
+        }
+      }
+
+      auto sum = checksum(chunks);
+      char suma[9], sumb[9];
+      snprintf(suma, sizeof(suma), "%08x", sum.suma);
+      snprintf(sumb, sizeof(sumb), "%08x", sum.sumb);
+      json e = {{"name", key(level, name)}, {"offset", offset}, {"bytes", bytes},
+                {"chunks", chunks.size()},  {"suma", suma},     {"sumb", sumb}};
+      entries.push_back(e.dump());
+      offset += comm_size() * bytes;
+    }
+
+    void Writer::write(int level, const std::string &name, const std::vector<const ColorSpinorField *> &v)
+    {
+      for (auto i = 0u; i < v.size(); i++) {
+        ColorSpinorField h(host_param(*v[i]));
+        h = *v[i];
+        write(level, name + "[" + std::to_string(i) + "]", {{h.V(), h.Bytes()}});
+      }
+    }
+
+    void Writer::write(int level, const std::string &name, const GaugeField &u)
+    {
+      write(level, name, chunks<const void>(u));
+    }
+
+    void Writer::close()
+    {
+      if (fd < 0) return;
+      if (fsync(fd) != 0) errorQuda("Failed to sync %s (%s)", data_file(filename).c_str(), strerror(errno));
+      ::close(fd);
+      fd = -1;
+      comm_barrier();
+
+      if (comm_rank() == 0) {
+        auto m = json::parse(manifest);
+        m["fields"] = json::array();
+        for (auto &e : entries) m["fields"].push_back(json::parse(e));
+        const std::string str = m.dump(2);
+        int fd0 = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd0 < 0) errorQuda("Failed to open %s (%s)", filename.c_str(), strerror(errno));
+        if (::write(fd0, str.data(), str.size()) != static_cast<ssize_t>(str.size()))
+          errorQuda("Failed to write %s (%s)", filename.c_str(), strerror(errno));
+        ::close(fd0);
+      }
+      comm_barrier();
+
+      if (getVerbosity() >= QUDA_SUMMARIZE)
+        printfQuda("Wrote multigrid checkpoint %s (%lu fields, %.1f MiB)\n", filename.c_str(), entries.size(),
+                   offset / (double)(1 << 20));
+    }
+
+    Reader::Reader(const std::string &filename, const QudaMultigridParam &param, const GaugeField &gauge) :
+      filename(filename), fd(-1)
+    {
+      // all ranks take the same decision since the manifest and the checks are global
+      auto invalid = [&](const std::string &reason) {
+        warningQuda("Not restoring multigrid checkpoint %s since %s", filename.c_str(), reason.c_str());
+        entries.clear();
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+      };
+
+      std::string manifest;
+      uint64_t length = 0;
+      if (comm_rank() == 0) {
+        int fd0 = open(filename.c_str(), O_RDONLY);
+        if (fd0 >= 0) {
+          off_t size = lseek(fd0, 0, SEEK_END);
+          if (size > 0 && static_cast<size_t>(size) <= max_manifest_bytes) {
+            manifest.resize(size);
+            if (pread(fd0, &manifest[0], size, 0) == size) length = size;
+          }
+          ::close(fd0);
+        }
+      }
+      comm_broadcast(&length, sizeof(length));
+      if (length == 0) {
+        invalid("it cannot be read");
+        return;
+      }
+      manifest.resize(length);
+      comm_broadcast(&manifest[0], length);
+
+      auto m = json::parse(manifest, nullptr, false);
+      if (m.is_discarded() || !m.is_object() || m.value("format", "") != "quda-mg-checkpoint") {
+        invalid("it is not a multigrid checkpoint");
+        return;
+      }
+      if (m.value("version", 0) != format_version) {
+        invalid("its version " + std::to_string(m.value("version", 0)) + " is not supported");
+        return;
+      }
+
+      if (m["partitioning"] != partitioning(gauge)) {
+        invalid("the rank partitioning differs");
+        return;
+      }
+      if (m["param"] != hierarchy_param(param)) {
+        invalid("the multigrid parameters differ");
+        return;
+      }
+      if (m["gauge_checksum"] != gauge_checksum(gauge)) {
+        invalid("the gauge field differs");
+        return;
+      }
+
+      uint64_t data_bytes = 0;
+      try {
+        for (auto &e : m.at("fields")) {
+          Entry entry = {e.at("offset").get<uint64_t>(), e.at("bytes").get<uint64_t>(),
+                         e.at("chunks").get<uint64_t>(),
+                         static_cast<uint32_t>(std::stoul(e.at("suma").get<std::string>(), nullptr, 16)),
+                         static_cast<uint32_t>(std::stoul(e.at("sumb").get<std::string>(), nullptr, 16))};
+          if (entry.chunks == 0 || entry.bytes % entry.chunks != 0) throw std::invalid_argument("chunks");
+          entries[e.at("name").get<std::string>()] = entry;
+          data_bytes = std::max(data_bytes, entry.offset + comm_size() * entry.bytes);
+        }
+      } catch (const std::exception &) {
+        invalid("its field entries are malformed");
+        return;
+      }
+
+      // every field the restore reads must be present: the null space, the transfer basis and the
+      // coarse links of every level with a coarser level
+      for (int l = 0; l < param.n_level - 1; l++) {
+        std::vector<std::string> names = {key(l, "V[0]")};
+        for (auto &link : coarse_link_names) names.push_back(key(l, link));
+        for (int i = 0; i < param.n_vec[l]; i++) names.push_back(key(l, "B[" + std::to_string(i) + "]"));
+        for (auto &name : names)
+          if (entries.count(name) == 0) {
+            invalid(name + " is missing");
+            return;
+          }
+      }
+
+      const auto data = data_file(filename);
+      fd = open(data.c_str(), O_RDONLY);
+      struct stat st;
+      int fail = (fd < 0 || fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < data_bytes) ? 1 : 0;
+      comm_allreduce_int(fail);
+      if (fail) {
+        invalid(data + " is missing or truncated");
+        return;
+      }
+
+      // verify the checksums of all fields up front, so that a corrupted checkpoint is set up afresh
+      // rather than failing part way through the restore
+      std::vector<char> buf(verify_buffer_bytes);
+      for (auto &[name, e] : entries) {
+        crc::ScidacChecksum sum;
+        const uint64_t chunk_bytes = e.bytes / e.chunks;
+        off_t pos = e.offset + comm_rank() * e.bytes;
+        for (uint64_t i = 0; i < e.chunks && !fail; i++) {
+          uint32_t crc = 0;
+          for (uint64_t left = chunk_bytes; left > 0;) {
+            ssize_t n = pread(fd, buf.data(), std::min<uint64_t>(left, buf.size()), pos);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+              fail = 1;
+              break;
+            }
+            crc = crc::crc32(crc, buf.data(), n);
+            pos += n;
+            left -= n;
+          }
+          sum.add(static_cast<uint64_t>(comm_rank()) * e.chunks + i, crc);
+        }
+
+        uint64_t packed = sum.pack();
+        comm_allreduce_xor(packed);
+        sum.unpack(packed);
+        comm_allreduce_int(fail);
+        if (fail) {
+          invalid("reading " + data + " failed");
+          return;
+        }
+        if (sum.suma != e.suma || sum.sumb != e.sumb) {
+          invalid("the checksum of " + name + " does not match");
+          return;
+        }
+      }
+
+      if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Restoring multigrid checkpoint %s\n", filename.c_str());
+    }
+
+    Reader::~Reader()
+    {
+      if (fd >= 0) ::close(fd);
+    }
+
+    void Reader::read(int level, const std::string &name, const std::vector<std::pair<void *, size_t>> &chunks)
+    {
+      if (!valid()) errorQuda("Reading from invalid multigrid checkpoint %s", filename.c_str());
+      auto it = entries.find(key(level, name));
+      if (it == entries.end()) errorQuda("%s missing from multigrid checkpoint %s", key(level, name).c_str(), filename.c_str());
+      const Entry &e = it->second;
+
+      size_t bytes = 0;
+      for (auto &c : chunks) bytes += c.second;
+      if (bytes != e.bytes || chunks.size() != e.chunks)
+        errorQuda("Size of %s in multigrid checkpoint %s is %" PRIu64 " bytes in %" PRIu64 " chunks, expected %lu in %lu",
+                  key(level, name).c_str(), filename.c_str(), e.bytes, e.chunks, bytes, chunks.size());
+
+      off_t pos = e.offset + comm_rank() * bytes;
+      for (auto &c : chunks) {
+        auto p = static_cast<char *>(c.first);
+        for (size_t left = c.second; left > 0;) {
+          ssize_t n = pread(fd, p, left, pos);
+          if (n < 0 && errno == EINTR) continue;
+          if (n <= 0) errorQuda("Failed to read %s (%s)", data_file(filename).c_str(), strerror(errno));
+          p += n;
+          pos += n;
+          left -= n;
+        }
+      }
+    }
+
+    void Reader::read(int level, const std::string &name, const std::vector<ColorSpinorField *> &v)
+    {
+      for (auto i = 0u; i < v.size(); i++) {
+        ColorSpinorField h(host_param(*v[i]));
+        read(level, name + "[" + std::to_string(i) + "]", {{h.V(), h.Bytes()}});
+        *v[i] = h;
+      }
+    }
+
+    void Reader::read(int level, const std::string &name, GaugeField &u) { read(level, name, chunks<void>(u)); }
+
+  } // namespace mg_checkpoint
+
+} // namespace quda
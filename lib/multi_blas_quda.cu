@@ -1,4 +1,5 @@
 #include <blas_quda.h>
+#include <solver_telemetry.h>
 #include <color_spinor_field.h>
 #include <kernels/multi_blas_core.cuh>
 #include <tunable_nd.h>
@@ -80,7 +81,10 @@ namespace quda {
         strcat(aux, ",fast_compile");
 #endif
 
-        apply(device::get_default_stream());
+        {
+          SolverTelemetry::Region region(SolverTelemetry::BLAS);
+          apply(device::get_default_stream());
+        }
 
         blas::bytes += bytes();
         blas::flops += flops();
@@ -1,4 +1,5 @@
 #include <blas_quda.h>
+#include <solver_telemetry.h>
 #include <uint_to_char.h>
 #include <kernels/multi_reduce_core.cuh>
 #include <tunable_reduction.h>
@@ -96,7 +97,10 @@ namespace quda {
         }
         if (is_norm) strcat(aux, ",norm");
 
-        apply(device::get_default_stream());
+        {
+          SolverTelemetry::Region region(SolverTelemetry::REDUCTION);
+          apply(device::get_default_stream());
+        }
 
         blas::bytes += bytes();
         blas::flops += flops();
@@ -4,6 +4,7 @@
 #include <tune_quda.h>
 #include <random_quda.h>
 #include <vector_io.h>
+#include <mg_checkpoint.h>
 
 // for building the KD inverse op
 #include <staggered_kd_build_xinv.h>
@@ -84,7 +85,9 @@ namespace quda
 
     if (param.transfer_type == QUDA_TRANSFER_AGGREGATE) {
       if (param.level < param.Nlevel - 1) {
-        if (param.mg_global.compute_null_vector == QUDA_COMPUTE_NULL_VECTOR_YES) {
+        if (param.checkpoint) {
+          param.checkpoint->read(param.level, "B", param.B);
+        } else if (param.mg_global.compute_null_vector == QUDA_COMPUTE_NULL_VECTOR_YES) {
           if (param.mg_global.generate_all_levels == QUDA_BOOLEAN_TRUE || param.level == 0) {
 
             // Initializing to random vectors
@@ -155,10 +158,13 @@ namespace quda
         }
       } else {
         // create transfer operator
+        MemoryPhase memory_phase("MG level " + std::to_string(param.level) + ":transfer");
         if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Creating transfer operator\n");
+        std::function<void(ColorSpinorField &)> restore_V;
+        if (param.checkpoint) restore_V = [&](ColorSpinorField &V) { param.checkpoint->read(param.level, "V", {&V}); };
         transfer = new Transfer(param.B, param.Nvec, param.NblockOrtho, param.blockOrthoTwoPass, param.geoBlockSize,
                                 param.spinBlockSize, param.mg_global.precision_null[param.level],
-                                param.mg_global.transfer_type[param.level], profile);
+                                param.mg_global.transfer_type[param.level], profile, restore_V);
         for (int i=0; i<QUDA_MAX_MG_LEVEL; i++) param.mg_global.geo_block_size[param.level][i] = param.geoBlockSize[i];
 
         // create coarse temporary vector if not already created in verify()
@@ -185,8 +191,10 @@ namespace quda
         for (int i=0; i<nVec_coarse; i++)
           (*B_coarse)[i] = param.B[0]->CreateCoarse(param.geoBlockSize, param.spinBlockSize, param.Nvec, B_coarse_precision, param.mg_global.setup_location[param.level+1]);
 
-        // if we're not generating on all levels then we need to propagate the vectors down
-        if ((param.level != 0 || param.Nlevel - 1) && param.mg_global.generate_all_levels == QUDA_BOOLEAN_FALSE) {
+        // if we're not generating on all levels then we need to propagate the vectors down (unless
+        // they are restored from a checkpoint)
+        if ((param.level != 0 || param.Nlevel - 1) && param.mg_global.generate_all_levels == QUDA_BOOLEAN_FALSE
+            && !param.checkpoint) {
           if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Restricting null space vectors\n");
           for (int i=0; i<param.Nvec; i++) {
             zero(*(*B_coarse)[i]);
@@ -240,6 +248,9 @@ namespace quda
     diracSmoother->prefetch(QUDA_CUDA_FIELD_LOCATION);
     diracSmootherSloppy->prefetch(QUDA_CUDA_FIELD_LOCATION);
 
+    // a checkpoint is only used for the initial build, and subsequent resets recompute the hierarchy
+    param.checkpoint.reset();
+
     if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Setup of level %d done\n", param.level);
 
     popLevel();
@@ -390,6 +401,7 @@ namespace quda
 
   void MG::createCoarseDirac() {
     pushLevel(param.level);
+    MemoryPhase memory_phase("MG level " + std::to_string(param.level) + ":coarse_op");
 
     if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Creating coarse Dirac operator\n");
 
@@ -443,8 +455,18 @@ namespace quda
       diracParam.use_mma = param.use_mma;
       diracParam.allow_truncation = (param.mg_global.allow_truncation == QUDA_BOOLEAN_TRUE) ? true : false;
 
-      diracCoarseResidual = new DiracCoarse(diracParam, param.setup_location == QUDA_CUDA_FIELD_LOCATION ? true : false,
-                                            param.mg_global.setup_minimize_memory == QUDA_BOOLEAN_TRUE ? true : false);
+      if (param.checkpoint) {
+        auto restore = [&](const std::vector<GaugeField *> &links) {
+          for (auto i = 0u; i < links.size(); i++)
+            param.checkpoint->read(param.level, mg_checkpoint::coarse_link_names[i], *links[i]);
+        };
+        diracCoarseResidual = new DiracCoarse(diracParam, param.setup_location == QUDA_CUDA_FIELD_LOCATION ? true : false,
+                                              param.mg_global.setup_minimize_memory == QUDA_BOOLEAN_TRUE ? true : false,
+                                              restore);
+      } else {
+        diracCoarseResidual = new DiracCoarse(diracParam, param.setup_location == QUDA_CUDA_FIELD_LOCATION ? true : false,
+                                              param.mg_global.setup_minimize_memory == QUDA_BOOLEAN_TRUE ? true : false);
+      }
 
       // create smoothing operators
       diracParam.dirac = const_cast<Dirac *>(param.matSmooth->Expose());
@@ -1384,7 +1406,7 @@ namespace quda
       VectorIO io(vec_outfile);
       vector_ref<const ColorSpinorField> B_ref;
       for (auto i = 0u; i < B.size(); i++) B_ref.push_back(*B[i]);
-      io.save(std::move(B_ref));
+      io.save_async(std::move(B_ref));
       popLevel();
       profile_global.TPSTOP(QUDA_PROFILE_IO);
       if (is_running) profile_global.TPSTART(QUDA_PROFILE_INIT);
@@ -1401,9 +1423,27 @@ namespace quda
     if (param.level < param.Nlevel - 2) coarse->dumpNullVectors();
   }
 
+  void MG::saveCheckpoint(mg_checkpoint::Writer &writer) const
+  {
+    if (param.level == param.Nlevel - 1) return;
+    if (param.transfer_type != QUDA_TRANSFER_AGGREGATE)
+      errorQuda("Checkpointing not supported for transfer type %d", param.transfer_type);
+
+    pushLevel(param.level);
+    writer.write(param.level, "B", std::vector<const ColorSpinorField *>(param.B.begin(), param.B.end()));
+    writer.write(param.level, "V", {&transfer->Vectors()});
+    auto links = static_cast<const DiracCoarse *>(diracCoarseResidual)->CoarseLinks(QUDA_CPU_FIELD_LOCATION);
+    for (auto i = 0u; i < links.size(); i++)
+      writer.write(param.level, mg_checkpoint::coarse_link_names[i], *links[i]);
+    popLevel();
+
+    coarse->saveCheckpoint(writer);
+  }
+
   void MG::generateNullVectors(std::vector<ColorSpinorField *> &B, bool refresh)
   {
     pushLevel(param.level);
+    MemoryPhase memory_phase("MG level " + std::to_string(param.level) + ":null_space");
 
     SolverParam solverParam(param); // Set solver field parameters:
     // set null-space generation options - need to expose these
@@ -1419,7 +1459,8 @@ namespace quda
       solverParam.ca_lambda_min = param.mg_global.setup_ca_lambda_min[param.level];
       solverParam.ca_lambda_max = param.mg_global.setup_ca_lambda_max[param.level];
       solverParam.Nkrylov = param.mg_global.setup_ca_basis_size[param.level];
-    } else if (solverParam.inv_type == QUDA_GCR_INVERTER || solverParam.inv_type == QUDA_BICGSTABL_INVERTER) {
+    } else if (solverParam.inv_type == QUDA_GCR_INVERTER || solverParam.inv_type == QUDA_BICGSTABL_INVERTER
+               || solverParam.inv_type == QUDA_IDR_INVERTER) {
       solverParam.Nkrylov = param.mg_global.setup_ca_basis_size[param.level];
     } else {
       solverParam.Nkrylov = 4;
@@ -1767,6 +1808,7 @@ namespace quda
   void MG::generateEigenVectors()
   {
     pushLevel(param.level);
+    MemoryPhase memory_phase("MG level " + std::to_string(param.level) + ":eigensolver");
 
     // Extract eigensolver params
     int n_conv = param.mg_global.eig_param[param.level]->n_conv;
@@ -6,6 +6,16 @@
 
 #include <numa_affinity.h>
 #include <quda_internal.h>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
 
 #ifdef NUMA_NVML
 #include <nvml.h>
@@ -51,3 +61,144 @@ int setNumaAffinityNVML(int devid)
   return -1;
 #endif
 }
+
+namespace
+{
+
+  // memory policies from linux/mempolicy.h, so that we depend on neither libnuma nor its headers
+  constexpr int mpol_preferred = 1;
+  constexpr int mpol_interleave = 3;
+
+  constexpr int max_numa_node = 1024;               // size of the node masks passed to the kernel
+  constexpr size_t numa_policy_min_bytes = 1 << 20; // smaller allocations are left to the default policy
+
+  constexpr int bits_per_long = 8 * sizeof(unsigned long);
+  using node_mask_t = unsigned long[max_numa_node / bits_per_long];
+
+  int numa_policy = 0;       // memory policy set by setNumaAffinity (0 = none)
+  node_mask_t numa_mask = {}; // nodes the memory policy applies to
+
+  /**
+   * Parse a sysfs cpu or node list, e.g., "0-23,48-71"
+   * @param list the list to parse
+   * @return the listed entries
+   */
+  std::vector<int> parseList(const std::string &list)
+  {
+    std::vector<int> entries;
+    size_t pos = 0;
+    while (pos < list.size() && isdigit(list[pos])) {
+      size_t end;
+      int first = std::stoi(list.substr(pos), &end);
+      pos += end;
+      int last = first;
+      if (pos < list.size() && list[pos] == '-') {
+        last = std::stoi(list.substr(pos + 1), &end);
+        pos += end + 1;
+      }
+      for (int i = first; i <= last; i++) entries.push_back(i);
+      if (pos < list.size() && list[pos] == ',') pos++;
+    }
+    return entries;
+  }
+
+  /**
+   * Read the first line of a sysfs file
+   * @param path the file to read
+   * @return the first line, or an empty string if the file could not be read
+   */
+  std::string readSysfs(const std::string &path)
+  {
+    std::ifstream file(path);
+    std::string line;
+    if (file) std::getline(file, line);
+    return line;
+  }
+
+  /**
+   * @return the NUMA node a PCI device is attached to, or -1 if unknown
+   * @param pci_bus_id PCI bus id of the device
+   */
+  int pciNumaNode(const char *pci_bus_id)
+  {
+    // sysfs uses lower case and a four digit domain
+    std::string id(pci_bus_id);
+    for (auto &c : id) c = tolower(c);
+    auto colon = id.find(':');
+    if (colon > 4 && colon != std::string::npos) id = id.substr(colon - 4);
+
+    std::string node = readSysfs("/sys/bus/pci/devices/" + id + "/numa_node");
+    return node.empty() ? -1 : std::stoi(node);
+  }
+
+} // namespace
+
+int setNumaAffinity(int devid, const char *pci_bus_id)
+{
+  char *enable_numa = getenv("QUDA_ENABLE_NUMA_AFFINITY");
+  if (!enable_numa || strcmp(enable_numa, "1") != 0) return -1;
+
+  int node = pciNumaNode(pci_bus_id);
+  if (node < 0 || node >= max_numa_node) {
+    warningQuda("Failed to determine NUMA node for device %d (%s)", devid, pci_bus_id);
+#ifdef NUMA_NVML
+    return setNumaAffinityNVML(devid);
+#else
+    return -1;
+#endif
+  }
+
+  // bind the calling thread, and so the host threads it spawns, to the cpus of the node
+  std::string cpu_list = readSysfs("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+  auto cpus = parseList(cpu_list);
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (auto cpu : cpus)
+    if (cpu < CPU_SETSIZE) CPU_SET(cpu, &cpu_set);
+  if (cpus.empty() || sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+    warningQuda("Failed to set cpu affinity to NUMA node %d cpus %s for device %d", node, cpu_list.c_str(), devid);
+#ifdef NUMA_NVML
+    if (setNumaAffinityNVML(devid) != 0) return -1;
+#else
+    return -1;
+#endif
+  }
+
+  // choose the memory policy for large host allocations
+  char *host_memory = getenv("QUDA_NUMA_HOST_MEMORY");
+  std::string policy = host_memory ? host_memory : "local";
+  memset(numa_mask, 0, sizeof(numa_mask));
+  if (policy == "local") {
+    numa_policy = mpol_preferred;
+    numa_mask[node / bits_per_long] |= 1ul << (node % bits_per_long);
+  } else if (policy == "interleave") {
+    numa_policy = mpol_interleave;
+    for (auto n : parseList(readSysfs("/sys/devices/system/node/online")))
+      if (n < max_numa_node) numa_mask[n / bits_per_long] |= 1ul << (n % bits_per_long);
+  } else if (policy == "none") {
+    numa_policy = 0;
+  } else {
+    errorQuda("Unknown QUDA_NUMA_HOST_MEMORY policy %s", policy.c_str());
+  }
+
+  if (getVerbosity() >= QUDA_SUMMARIZE)
+    printfQuda("Set NUMA affinity for device %d (%s): node %d, cpus %s, host memory policy %s\n", devid, pci_bus_id,
+               node, cpu_list.c_str(), policy.c_str());
+  return 0;
+}
+
+void setNumaMemoryPolicy(void *ptr, size_t bytes)
+{
+  if (numa_policy == 0 || bytes < numa_policy_min_bytes) return;
+
+  // mbind needs a page-aligned range, so bind the whole pages of the allocation
+  static const uintptr_t page_size = getpagesize();
+  uintptr_t begin = (reinterpret_cast<uintptr_t>(ptr) + page_size - 1) & ~(page_size - 1);
+  uintptr_t end = (reinterpret_cast<uintptr_t>(ptr) + bytes) & ~(page_size - 1);
+  if (end <= begin) return;
+
+  // the kernel ignores the last bit of maxnode
+  if (syscall(SYS_mbind, begin, end - begin, numa_policy, numa_mask, max_numa_node + 1, 0) != 0
+      && getVerbosity() >= QUDA_DEBUG_VERBOSE)
+    warningQuda("Failed to set NUMA memory policy for %zu bytes at %p (%s)", bytes, ptr, strerror(errno));
+}
@@ -1,4 +1,5 @@
 #include <blas_quda.h>
+#include <solver_telemetry.h>
 #include <color_spinor_field_order.h>
 #include <tunable_reduction.h>
 #include <kernels/reduce_core.cuh>
@@ -61,7 +62,10 @@ namespace quda {
           strcat(aux, y.AuxString().c_str());
         }
 
-        apply(device::get_default_stream());
+        {
+          SolverTelemetry::Region region(SolverTelemetry::REDUCTION);
+          apply(device::get_default_stream());
+        }
 
         blas::bytes += bytes();
         blas::flops += flops();
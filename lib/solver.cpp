@@ -50,6 +50,11 @@ namespace quda {
   {
     Solver *solver = nullptr;
 
+    if (param.precision_ladder && !param.is_preconditioner) {
+      report("precision ladder");
+      return new PrecisionLadder(mat, matSloppy, matPrecon, matEig, param, profile);
+    }
+
     if (param.preconditioner && param.inv_type != QUDA_GCR_INVERTER)
       errorQuda("Explicit preconditoner not supported for %d solver", param.inv_type);
 
@@ -92,6 +97,23 @@ namespace quda {
       report("CA-GCR");
       solver = new CAGCR(mat, matSloppy, matPrecon, matEig, param, profile);
       break;
+    case QUDA_PIPELINED_CG_INVERTER:
+      report("PIPELINED-CG");
+      solver = new PipelinedCG(mat, matSloppy, matPrecon, matEig, param, profile);
+      break;
+    case QUDA_IDR_INVERTER:
+      report("IDR");
+      solver = new IDR(mat, matSloppy, matPrecon, matEig, param, profile);
+      break;
+    case QUDA_CA_BICGSTAB_INVERTER:
+      report("CA-BiCGstab");
+      solver = new CABiCGstab(mat, matSloppy, matPrecon, matEig, param, profile);
+      break;
+    case QUDA_GCRODR_INVERTER:
+      report("GCRO-DR");
+      solver = new GCRODR(mat, matSloppy, matPrecon, matEig, param, profile);
+      break;
+    case QUDA_BLOCK_CG_INVERTER: errorQuda("Block CG is only available for batched multi-source solves"); break;
     case QUDA_MR_INVERTER:
       report("MR");
       solver = new MR(mat, matSloppy, param, profile);
@@ -414,7 +436,8 @@ namespace quda {
     case QUDA_CA_GCR_INVERTER:
     case QUDA_CA_CG_INVERTER:
     case QUDA_CA_CGNR_INVERTER:
-    case QUDA_CA_CGNE_INVERTER: return true;
+    case QUDA_CA_CGNE_INVERTER:
+    case QUDA_CA_BICGSTAB_INVERTER: return true;
     default: return false;
     }
   }
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <solver_telemetry.h>
+#include <invert_quda.h>
+#include <comm_quda.h>
+#include <util_quda.h>
+#include <quda_api.h>
+#include <device.h>
+
+namespace quda
+{
+
+  static std::mutex mutex;
+  static std::string telemetry_path; // file the records are appended to
+  static size_t ring_size = 256;     // number of iterations held in the ring buffer
+
+  static SolverTelemetry *recording = nullptr; // the record whose regions are timed, if any
+  static int region_depth = 0;                 // nesting depth of the regions
+
+  /**
+     Event pairs of the outermost regions that have not been added to
+     the record yet, held in a ring.  The events are created on the
+     first recorded solve and kept for the lifetime of the process.
+     The solvers reduce at every iteration, which completes the
+     earlier regions, so the ring is only waited on if a solver issues
+     more regions than it holds without reducing.
+   */
+  struct TimedRegion {
+    qudaEvent_t start;
+    qudaEvent_t stop;
+    SolverTelemetry::Category category;
+  };
+  static std::vector<TimedRegion> regions;
+  static size_t region_head = 0;  // oldest region not yet added to the record
+  static size_t region_count = 0; // number of regions not yet added to the record
+  static constexpr size_t max_regions = 64;
+
+  bool SolverTelemetry::enabled()
+  {
+    static bool enable = [] {
+      char *path_str = getenv("QUDA_SOLVER_TELEMETRY");
+      bool enable = path_str && strlen(path_str) > 0;
+      if (enable) {
+        telemetry_path = path_str;
+        char *size_str = getenv("QUDA_SOLVER_TELEMETRY_SIZE");
+        if (size_str) {
+          long n = atol(size_str);
+          if (n <= 0) errorQuda("Invalid QUDA_SOLVER_TELEMETRY_SIZE=%s", size_str);
+          ring_size = n;
+        }
+      }
+      return enable;
+    }();
+    return enable;
+  }
+
+  void SolverTelemetry::begin(const char *name, const SolverParam &param, double b2)
+  {
+    active = enabled() && param.record_telemetry && comm_rank() == 0;
+    if (!active) return;
+
+    this->name = name;
+    precision = 8 * param.precision;
+    precision_sloppy = 8 * param.precision_sloppy;
+    tol = param.tol;
+    this->b2 = b2;
+    operator_gflops = 0.0;
+    blas_gflops = 0.0;
+    reliable_updates = 0;
+    reliable = false;
+    ring.resize(ring_size);
+    n_iter = 0;
+    for (auto &s : secs) s = 0.0;
+
+    if (regions.empty()) {
+      regions.resize(max_regions);
+      for (auto &r : regions) {
+        r.start = qudaChronoEventCreate();
+        r.stop = qudaChronoEventCreate();
+      }
+    }
+    // regions left by a solve that was not ended are dropped
+    region_head = (region_head + region_count) % regions.size();
+    region_count = 0;
+    recording = this;
+
+    start = std::chrono::steady_clock::now();
+  }
+
+  SolverTelemetry::~SolverTelemetry()
+  {
+    if (recording != this) return;
+    // the solve was abandoned, so its pending regions are dropped
+    recording = nullptr;
+    region_head = (region_head + region_count) % regions.size();
+    region_count = 0;
+  }
+
+  void SolverTelemetry::harvest(bool wait)
+  {
+    while (region_count > 0) {
+      auto &r = regions[region_head];
+      if (wait)
+        qudaEventSynchronize(r.stop);
+      else if (!qudaEventQuery(r.stop))
+        break;
+      secs[r.category] += qudaEventElapsedTime(r.start, r.stop);
+      region_head = (region_head + 1) % regions.size();
+      region_count--;
+    }
+  }
+
+  SolverTelemetry::Region::Region(Category category)
+  {
+    if (!recording) return;
+    entered = true;
+    if (region_depth++ > 0) return;
+
+    if (region_count == regions.size()) recording->harvest(false);
+    if (region_count == regions.size()) recording->harvest(true);
+    slot = (region_head + region_count) % regions.size();
+    regions[slot].category = category;
+    qudaEventRecord(regions[slot].start, device::get_default_stream());
+  }
+
+  SolverTelemetry::Region::~Region()
+  {
+    if (!entered) return;
+    region_depth--;
+    if (slot < 0 || !recording) return;
+    qudaEventRecord(regions[slot].stop, device::get_default_stream());
+    region_count++;
+  }
+
+  void SolverTelemetry::iteration(int k, double r2, double hq)
+  {
+    if (!active) return;
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ring[n_iter % ring.size()] = {k, r2, hq, time, reliable};
+    n_iter++;
+    reliable = false;
+  }
+
+  void SolverTelemetry::reliable_update()
+  {
+    if (!active) return;
+    reliable_updates++;
+    reliable = true;
+  }
+
+  void SolverTelemetry::set_flops(double operator_gflops, double blas_gflops)
+  {
+    if (!active) return;
+    this->operator_gflops = operator_gflops;
+    this->blas_gflops = blas_gflops;
+  }
+
+  /**
+     @brief Write a floating point value as JSON, where non-finite
+     values are written as null
+   */
+  static void json(std::ostream &out, double value)
+  {
+    if (std::isfinite(value))
+      out << value;
+    else
+      out << "null";
+  }
+
+  void SolverTelemetry::end(int iter, bool converged, double true_res, double true_res_hq)
+  {
+    if (!active) return;
+    active = false;
+
+    // the solve has ended with a reduction, so this waits for little if any work
+    harvest(true);
+    recording = nullptr;
+
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ostringstream out;
+    out.precision(6);
+    out << std::scientific;
+    out << "{\"solver\":\"" << name << "\",\"precision\":" << precision << ",\"precision_sloppy\":" << precision_sloppy;
+    out << ",\"tol\":";
+    json(out, tol);
+    out << ",\"b2\":";
+    json(out, b2);
+    out << ",\"iter\":" << iter << ",\"converged\":" << (converged ? "true" : "false");
+    out << ",\"reliable_updates\":" << reliable_updates;
+    out << ",\"true_res\":";
+    json(out, true_res);
+    out << ",\"true_res_hq\":";
+    json(out, true_res_hq);
+    out << ",\"secs\":";
+    json(out, wall);
+    out << ",\"gflops\":";
+    json(out, wall > 0.0 ? (operator_gflops + blas_gflops) / wall : 0.0);
+    out << ",\"secs_operator\":";
+    json(out, secs[OPERATOR]);
+    out << ",\"secs_blas\":";
+    json(out, secs[BLAS]);
+    out << ",\"secs_reduction\":";
+    json(out, secs[REDUCTION]);
+    out << ",\"gflop_operator\":";
+    json(out, operator_gflops);
+    out << ",\"gflop_blas\":";
+    json(out, blas_gflops);
+
+    // the history is written oldest first, in columns
+    size_t n = std::min(n_iter, ring.size());
+    auto column = [&](const char *key, auto value) {
+      out << ",\"" << key << "\":[";
+      for (size_t i = n_iter - n; i < n_iter; i++) {
+        if (i > n_iter - n) out << ",";
+        value(ring[i % ring.size()]);
+      }
+      out << "]";
+    };
+    out << ",\"history_size\":" << n_iter;
+    column("history_iter", [&](const Iteration &it) { out << it.k; });
+    column("history_res", [&](const Iteration &it) { json(out, b2 > 0.0 ? sqrt(it.r2 / b2) : sqrt(it.r2)); });
+    column("history_hq", [&](const Iteration &it) { json(out, it.hq); });
+    column("history_time", [&](const Iteration &it) { json(out, it.time); });
+    column("history_reliable", [&](const Iteration &it) { out << (it.reliable ? 1 : 0); });
+    out << "}\n";
+
+    // the file is kept open for the lifetime of the process, and flushed after each record
+    std::lock_guard<std::mutex> lock(mutex);
+    static std::ofstream file(telemetry_path, std::ios::app);
+    if (!file) {
+      static bool warned = false;
+      if (!warned) warningQuda("Cannot write solver telemetry file %s", telemetry_path.c_str());
+      warned = true;
+      return;
+    }
+    file << out.str() << std::flush;
+  }
+
+} // namespace quda
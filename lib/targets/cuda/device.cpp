@@ -3,6 +3,7 @@
 #include <util_quda.h>
 #include <quda_internal.h>
 #include <quda_cuda_api.h>
+#include <numa_affinity.h>
 #include <nvml.h>
 
 
@@ -101,6 +102,10 @@ namespace quda
       CHECK_CUDA_ERROR(cudaSetDevice(dev));
 #endif
 
+      char pci_bus_id[32];
+      CHECK_CUDA_ERROR(cudaDeviceGetPCIBusId(pci_bus_id, sizeof(pci_bus_id), dev));
+      setNumaAffinity(dev, pci_bus_id);
+
       CHECK_CUDA_ERROR(cudaDeviceSetCacheConfig(cudaFuncCachePreferL1));
       //cudaDeviceSetSharedMemConfig(cudaSharedMemBankSizeEightByte);
       // cudaGetDeviceProperties(&deviceProp, dev);
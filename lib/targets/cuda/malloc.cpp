@@ -2,9 +2,15 @@
 #include <cstdio>
 #include <string>
 #include <map>
-#include <unistd.h>   // for getpagesize()
+#include <atomic>
+#include <unistd.h>   // for getpagesize() and sysconf()
+#include <sys/mman.h> // for madvise()
 #include <execinfo.h> // for backtrace
 #include <quda_internal.h>
+#include <memory_pool.h>
+#include <malloc_tracking.h>
+#include <memory_timeline.h>
+#include <numa_affinity.h>
 #include <device.h>
 #include <shmem_helper.cuh>
 
@@ -20,23 +26,32 @@ namespace quda
 {
 
   enum AllocType { DEVICE, DEVICE_PINNED, HOST, PINNED, MAPPED, MANAGED, SHMEM, N_ALLOC_TYPE };
+  static const char *alloc_type_name[N_ALLOC_TYPE] = {"device", "device-pinned", "host", "pinned", "mapped", "managed", "shmem"};
+
+  /**
+     @return The registry of the call sites of all tracked allocations
+   */
+  static CallSiteRegistry &call_sites()
+  {
+    static CallSiteRegistry registry;
+    return registry;
+  }
 
   class MemAlloc
   {
 
   public:
-    std::string func;
-    std::string file;
-    int line;
+    int site; // interned call site, see call_sites()
     size_t size;
     size_t base_size;
 #ifdef QUDA_BACKWARDSCPP
     backward::StackTrace st;
 #endif
 
-    MemAlloc() : line(-1), size(0), base_size(0) {}
+    MemAlloc() : site(-1), size(0), base_size(0) {}
 
-    MemAlloc(std::string func, std::string file, int line) : func(func), file(file), line(line), size(0), base_size(0)
+    MemAlloc(const char *func, const char *file, int line) :
+      site(call_sites().id(func, file, line)), size(0), base_size(0)
     {
 #ifdef QUDA_BACKWARDSCPP
       st.load_here(32);
@@ -51,11 +66,11 @@ namespace quda
     MemAlloc &operator=(MemAlloc &&) = default;
   };
 
-  static std::map<void *, MemAlloc> alloc[N_ALLOC_TYPE];
-  static size_t total_bytes[N_ALLOC_TYPE] = {0};
-  static size_t max_total_bytes[N_ALLOC_TYPE] = {0};
-  static size_t total_host_bytes, max_total_host_bytes;
-  static size_t total_pinned_bytes, max_total_pinned_bytes;
+  static AllocTable<MemAlloc> alloc[N_ALLOC_TYPE];
+  static std::atomic<size_t> total_bytes[N_ALLOC_TYPE];
+  static std::atomic<size_t> max_total_bytes[N_ALLOC_TYPE];
+  static std::atomic<size_t> total_host_bytes, max_total_host_bytes;
+  static std::atomic<size_t> total_pinned_bytes, max_total_pinned_bytes;
 
   size_t device_allocated() { return total_bytes[DEVICE]; }
 
@@ -99,42 +114,41 @@ namespace quda
   {
     const char *type_str[] = {"Device", "Device Pinned", "Host  ", "Pinned", "Mapped", "Managed", "Shmem "};
 
-    for (auto entry : alloc[type]) {
-      void *ptr = entry.first;
-      MemAlloc a = entry.second;
-      printfQuda("%s  %15p  %15lu  %s(), %s:%d\n", type_str[type], ptr, (unsigned long)a.base_size, a.func.c_str(),
-                 a.file.c_str(), a.line);
+    alloc[type].for_each([&](void *ptr, const MemAlloc &a) {
+      auto site = call_sites().get(a.site);
+      printfQuda("%s  %15p  %15lu  %s(), %s:%d\n", type_str[type], ptr, (unsigned long)a.base_size, site.func.c_str(),
+                 site.file.c_str(), site.line);
 #ifdef QUDA_BACKWARDSCPP
       if (getRankVerbosity()) {
         backward::Printer p;
         p.print(a.st);
       }
 #endif
-    }
+    });
   }
 
   static void track_malloc(const AllocType &type, const MemAlloc &a, void *ptr)
   {
-    total_bytes[type] += a.base_size;
-    if (total_bytes[type] > max_total_bytes[type]) { max_total_bytes[type] = total_bytes[type]; }
+    atomic_fetch_max(max_total_bytes[type], total_bytes[type] += a.base_size);
     if (type != DEVICE && type != DEVICE_PINNED && type != SHMEM) {
-      total_host_bytes += a.base_size;
-      if (total_host_bytes > max_total_host_bytes) { max_total_host_bytes = total_host_bytes; }
+      atomic_fetch_max(max_total_host_bytes, total_host_bytes += a.base_size);
     }
     if (type == PINNED || type == MAPPED) {
-      total_pinned_bytes += a.base_size;
-      if (total_pinned_bytes > max_total_pinned_bytes) { max_total_pinned_bytes = total_pinned_bytes; }
+      atomic_fetch_max(max_total_pinned_bytes, total_pinned_bytes += a.base_size);
     }
-    alloc[type][ptr] = a;
+    alloc[type].insert(ptr, a);
+    memory_timeline::record(alloc_type_name[type], a.base_size);
   }
 
   static void track_free(const AllocType &type, void *ptr)
   {
-    size_t size = alloc[type][ptr].base_size;
+    MemAlloc a;
+    alloc[type].erase(ptr, a);
+    size_t size = a.base_size;
     total_bytes[type] -= size;
     if (type != DEVICE && type != DEVICE_PINNED && type != SHMEM) { total_host_bytes -= size; }
     if (type == PINNED || type == MAPPED) { total_pinned_bytes -= size; }
-    alloc[type].erase(ptr);
+    memory_timeline::record(alloc_type_name[type], -static_cast<long>(size));
   }
 
   /**
@@ -160,9 +174,11 @@ namespace quda
     int align = posix_memalign(&ptr, page_size, a.base_size);
     if (!ptr || align != 0) {
 #endif
-      errorQuda("Failed to allocate aligned host memory of size %zu (%s:%d in %s())\n", size, a.file.c_str(), a.line,
-                a.func.c_str());
+      auto site = call_sites().get(a.site);
+      errorQuda("Failed to allocate aligned host memory of size %zu (%s:%d in %s())\n", size, site.file.c_str(),
+                site.line, site.func.c_str());
     }
+    setNumaMemoryPolicy(ptr, a.base_size); // before the pages are first touched
     return ptr;
   }
 
@@ -216,11 +232,11 @@ namespace quda
   }
 
   /**
-   * Perform a standard cudaMalloc() with error-checking.  This
-   * function should only be called via the device_malloc() macro,
-   * defined in malloc_quda.h
+   * Perform a cudaMalloc(), returning nullptr if the device is out of
+   * memory.  This is used by the device memory pool, which flushes
+   * its cache and retries with device_malloc_() should this fail.
    */
-  void *device_malloc_(const char *func, const char *file, int line, size_t size)
+  static void *device_try_malloc_(const char *func, const char *file, int line, size_t size)
   {
     if (use_managed_memory()) return managed_malloc_(func, file, line, size);
 
@@ -231,7 +247,10 @@ namespace quda
 
 #ifndef USE_QDPJIT
     cudaError_t err = cudaMalloc(&ptr, size);
-    if (err != cudaSuccess) {
+    if (err == cudaErrorMemoryAllocation) {
+      cudaGetLastError(); // clear the error so that it is not picked up by a later check
+      return nullptr;
+    } else if (err != cudaSuccess) {
       errorQuda("Failed to allocate device memory of size %zu (%s:%d in %s())\n", size, file, line, func);
     }
 #else
@@ -247,6 +266,18 @@ namespace quda
     return ptr;
   }
 
+  /**
+   * Perform a standard cudaMalloc() with error-checking.  This
+   * function should only be called via the device_malloc() macro,
+   * defined in malloc_quda.h
+   */
+  void *device_malloc_(const char *func, const char *file, int line, size_t size)
+  {
+    void *ptr = device_try_malloc_(func, file, line, size);
+    if (!ptr) errorQuda("Failed to allocate device memory of size %zu (%s:%d in %s())\n", size, file, line, func);
+    return ptr;
+  }
+
   /**
    * Perform a cuMemAlloc with error-checking.  This function is to
    * guarantee a unique memory allocation on the device, since
@@ -274,6 +305,92 @@ namespace quda
     return ptr;
   }
 
+  /**
+   * Size of a (transparent) huge page, which is used as the alignment
+   * and granularity of the host memory pool allocations.
+   */
+  static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+  /**
+   * Smallest host allocation that is served by the host memory pool,
+   * smaller allocations go straight to malloc().  At this size all
+   * size classes are multiples of the huge page size.
+   */
+  static constexpr size_t host_pool_min_bytes = 8 * huge_page_size;
+
+  /**
+   * Allocate host memory aligned to, and advised to be backed by, huge
+   * pages where the OS supports it.  Every page is first touched here
+   * by the calling thread, so the page faults are paid once when the
+   * pool grows rather than whenever the memory is reused, and the pages
+   * are placed on the NUMA node local to the calling thread.  This is
+   * the backing allocator of the host memory pool, and returns
+   * nullptr if the allocation fails, so that the pool can flush its
+   * cache and retry with huge_page_malloc_().
+   */
+  static void *huge_page_try_malloc_(const char *func, const char *file, int line, size_t size)
+  {
+    MemAlloc a(func, file, line);
+    void *ptr = nullptr;
+
+    a.size = size;
+    a.base_size = ((size + huge_page_size - 1) / huge_page_size) * huge_page_size;
+    int align = posix_memalign(&ptr, huge_page_size, a.base_size);
+    if (!ptr || align != 0) return nullptr;
+#ifdef MADV_HUGEPAGE
+    madvise(ptr, a.base_size, MADV_HUGEPAGE); // purely advisory, so failure is benign
+#endif
+    setNumaMemoryPolicy(ptr, a.base_size);
+
+    static const size_t page_size = getpagesize();
+    for (size_t i = 0; i < a.base_size; i += page_size) static_cast<volatile char *>(ptr)[i] = 0;
+
+    track_malloc(HOST, a, ptr);
+    return ptr;
+  }
+
+  /**
+   * Huge-page host allocation with error-checking, used by the host
+   * memory pool should huge_page_try_malloc_() fail after flushing.
+   */
+  static void *huge_page_malloc_(const char *func, const char *file, int line, size_t size)
+  {
+    void *ptr = huge_page_try_malloc_(func, file, line, size);
+    if (!ptr)
+      errorQuda("Failed to allocate huge-page aligned host memory of size %zu (%s:%d in %s())\n", size, file, line,
+                func);
+    return ptr;
+  }
+
+  /** Cache of inactive large host allocations made by safe_malloc() */
+  static pool::SizeClassPool host_pool("Host", huge_page_malloc_, host_free_, huge_page_try_malloc_);
+
+  /**
+   * @return whether large host allocations are served by the host
+   * memory pool, which is opt-in (enable with
+   * QUDA_ENABLE_HOST_MEMORY_POOL=1).  The bytes held in the pool are
+   * capped (in MiB, 0 = unlimited) with QUDA_HOST_MEMORY_POOL_CAP,
+   * which defaults to an eighth of the physical memory.
+   */
+  static bool use_host_memory_pool()
+  {
+    // initialized exactly once, even when first called concurrently from several host threads
+    static const bool host_memory_pool = []() {
+      char *enable_host_pool = getenv("QUDA_ENABLE_HOST_MEMORY_POOL");
+      if (!enable_host_pool || strcmp(enable_host_pool, "0") == 0) return false;
+
+      char *host_pool_cap = getenv("QUDA_HOST_MEMORY_POOL_CAP");
+      if (host_pool_cap) {
+        host_pool.set_cap(static_cast<size_t>(atol(host_pool_cap)) << 20);
+      } else {
+        host_pool.set_cap(static_cast<size_t>(sysconf(_SC_PHYS_PAGES)) * getpagesize() / 8);
+      }
+      return true;
+    }();
+
+    return host_memory_pool;
+  }
+
   /**
    * Perform a standard malloc() with error-checking.  This function
    * should only be called via the safe_malloc() macro, defined in
@@ -281,11 +398,20 @@ namespace quda
    */
   void *safe_malloc_(const char *func, const char *file, int line, size_t size)
   {
+    if (size >= host_pool_min_bytes && use_host_memory_pool()) {
+      void *ptr = host_pool.allocate(func, file, line, size);
+#ifdef HOST_DEBUG
+      memset(ptr, 0xff, size);
+#endif
+      return ptr;
+    }
+
     MemAlloc a(func, file, line);
     a.size = a.base_size = size;
 
     void *ptr = malloc(size);
     if (!ptr) { errorQuda("Failed to allocate host memory of size %zu (%s:%d in %s())\n", size, file, line, func); }
+    setNumaMemoryPolicy(ptr, size); // before the pages are first touched
     track_malloc(HOST, a, ptr);
 #ifdef HOST_DEBUG
     memset(ptr, 0xff, size);
@@ -482,7 +608,9 @@ namespace quda
   void host_free_(const char *func, const char *file, int line, void *ptr)
   {
     if (!ptr) { errorQuda("Attempt to free NULL host pointer (%s:%d in %s())\n", file, line, func); }
-    if (alloc[HOST].count(ptr)) {
+    if (host_pool.owns(ptr)) {
+      host_pool.release(ptr);
+    } else if (alloc[HOST].count(ptr)) {
       track_free(HOST, ptr);
       free(ptr);
     } else if (alloc[PINNED].count(ptr)) {
@@ -625,22 +753,12 @@ namespace quda
     /** Cache of inactive pinned-memory allocations.  We cache pinned
         memory allocations so that fields can reuse these with minimal
         overhead.*/
-    static std::multimap<size_t, void *> pinnedCache;
+    static SizeClassPool pinned_pool("Pinned", quda::pinned_malloc_, quda::host_free_);
 
-    /** Sizes of active pinned-memory allocations.  For convenience,
-        we keep track of the sizes of active allocations (i.e., those not
-        in the cache). */
-    static std::map<void *, size_t> pinnedSize;
-
-    /** Cache of inactive device-memory allocations.  We cache pinned
+    /** Cache of inactive device-memory allocations.  We cache device
         memory allocations so that fields can reuse these with minimal
         overhead.*/
-    static std::multimap<size_t, void *> deviceCache;
-
-    /** Sizes of active device-memory allocations.  For convenience,
-        we keep track of the sizes of active allocations (i.e., those not
-        in the cache). */
-    static std::map<void *, size_t> deviceSize;
+    static SizeClassPool device_pool("Device", quda::device_malloc_, quda::device_free_, quda::device_try_malloc_);
 
     static bool pool_init = false;
 
@@ -672,6 +790,21 @@ namespace quda
           warningQuda("Not using pinned memory pool allocator");
           pinned_memory_pool = false;
         }
+
+        // caps (in MiB, 0 = unlimited) on the inactive memory held by the pools; by default the device pool
+        // may cache at most half of the device memory that is free at initialization
+        char *device_pool_cap = getenv("QUDA_DEVICE_MEMORY_POOL_CAP");
+        if (device_pool_cap) {
+          device_pool.set_cap(static_cast<size_t>(atol(device_pool_cap)) << 20);
+        } else {
+          size_t free_bytes, total_bytes;
+          auto error = cudaMemGetInfo(&free_bytes, &total_bytes);
+          if (error != cudaSuccess) errorQuda("cudaMemGetInfo failed with error %s", cudaGetErrorString(error));
+          device_pool.set_cap(free_bytes / 2);
+        }
+        char *pinned_pool_cap = getenv("QUDA_PINNED_MEMORY_POOL_CAP");
+        if (pinned_pool_cap) pinned_pool.set_cap(static_cast<size_t>(atol(pinned_pool_cap)) << 20);
+
         pool_init = true;
       }
 #if defined(NVSHMEM_COMMS)
@@ -685,37 +818,14 @@ namespace quda
 
     void *pinned_malloc_(const char *func, const char *file, int line, size_t nbytes)
     {
-      void *ptr = nullptr;
-      if (pinned_memory_pool) {
-        if (pinnedCache.empty()) {
-          ptr = quda::pinned_malloc_(func, file, line, nbytes);
-        } else {
-          auto it = pinnedCache.lower_bound(nbytes);
-          if (it != pinnedCache.end()) { // sufficiently large allocation found
-            nbytes = it->first;
-            ptr = it->second;
-            pinnedCache.erase(it);
-          } else { // sacrifice the smallest cached allocation
-            it = pinnedCache.begin();
-            ptr = it->second;
-            pinnedCache.erase(it);
-            host_free(ptr);
-            ptr = quda::pinned_malloc_(func, file, line, nbytes);
-          }
-        }
-        pinnedSize[ptr] = nbytes;
-      } else {
-        ptr = quda::pinned_malloc_(func, file, line, nbytes);
-      }
-      return ptr;
+      if (pinned_memory_pool) return pinned_pool.allocate(func, file, line, nbytes);
+      return quda::pinned_malloc_(func, file, line, nbytes);
     }
 
     void pinned_free_(const char *func, const char *file, int line, void *ptr)
     {
       if (pinned_memory_pool) {
-        if (!pinnedSize.count(ptr)) { errorQuda("Attempt to free invalid pointer"); }
-        pinnedCache.insert(std::make_pair(pinnedSize[ptr], ptr));
-        pinnedSize.erase(ptr);
+        pinned_pool.release(ptr);
       } else {
         quda::host_free_(func, file, line, ptr);
       }
@@ -723,37 +833,14 @@ namespace quda
 
     void *device_malloc_(const char *func, const char *file, int line, size_t nbytes)
     {
-      void *ptr = nullptr;
-      if (device_memory_pool) {
-        if (deviceCache.empty()) {
-          ptr = quda::device_malloc_(func, file, line, nbytes);
-        } else {
-          auto it = deviceCache.lower_bound(nbytes);
-          if (it != deviceCache.end()) { // sufficiently large allocation found
-            nbytes = it->first;
-            ptr = it->second;
-            deviceCache.erase(it);
-          } else { // sacrifice the smallest cached allocation
-            it = deviceCache.begin();
-            ptr = it->second;
-            deviceCache.erase(it);
-            quda::device_free_(func, file, line, ptr);
-            ptr = quda::device_malloc_(func, file, line, nbytes);
-          }
-        }
-        deviceSize[ptr] = nbytes;
-      } else {
-        ptr = quda::device_malloc_(func, file, line, nbytes);
-      }
-      return ptr;
+      if (device_memory_pool) return device_pool.allocate(func, file, line, nbytes);
+      return quda::device_malloc_(func, file, line, nbytes);
     }
 
     void device_free_(const char *func, const char *file, int line, void *ptr)
     {
       if (device_memory_pool) {
-        if (!deviceSize.count(ptr)) { errorQuda("Attempt to free invalid pointer"); }
-        deviceCache.insert(std::make_pair(deviceSize[ptr], ptr));
-        deviceSize.erase(ptr);
+        device_pool.release(ptr);
       } else {
         quda::device_free_(func, file, line, ptr);
       }
@@ -773,20 +860,41 @@ namespace quda
 
     void flush_pinned()
     {
-      if (pinned_memory_pool) {
-        for (auto it : pinnedCache) { host_free(it.second); }
-        pinnedCache.clear();
-      }
+      if (pinned_memory_pool) pinned_pool.flush();
     }
 
     void flush_device()
     {
-      if (device_memory_pool) {
-        for (auto it : deviceCache) { device_free(it.second); }
-        deviceCache.clear();
-      }
+      if (device_memory_pool) device_pool.flush();
+    }
+
+    void flush_host() { host_pool.flush(); }
+
+    void trim_host(size_t bytes) { host_pool.trim(bytes); }
+
+    void trim_pinned(size_t bytes)
+    {
+      if (pinned_memory_pool) pinned_pool.trim(bytes);
+    }
+
+    void trim_device(size_t bytes)
+    {
+      if (device_memory_pool) device_pool.trim(bytes);
+    }
+
+    void print_stats()
+    {
+      if (device_memory_pool) device_pool.print_stats();
+      if (pinned_memory_pool) pinned_pool.print_stats();
+      if (use_host_memory_pool()) host_pool.print_stats();
     }
 
   } // namespace pool
 
+  PoolStats device_pool_stats() { return pool::device_pool.get_stats(); }
+
+  PoolStats pinned_pool_stats() { return pool::pinned_pool.get_stats(); }
+
+  PoolStats host_pool_stats() { return host_pool.get_stats(); }
+
 } // namespace quda
@@ -2,6 +2,7 @@
 #include <util_quda.h>
 #include <quda_internal.h>
 #include <quda_hip_api.h>
+#include <numa_affinity.h>
 #include <target_device.h>
 
 static hipDeviceProp_t deviceProp;
@@ -43,6 +44,10 @@ namespace quda
 
       CHECK_HIP_ERROR(hipSetDevice(dev));
 
+      char pci_bus_id[32];
+      CHECK_HIP_ERROR(hipDeviceGetPCIBusId(pci_bus_id, sizeof(pci_bus_id), dev));
+      setNumaAffinity(dev, pci_bus_id);
+
       // FIXME: Commenting this out now until it is fixed in a newer ROCm as it seems
       // Broken in recent ROCms. I am not sure it does anything anyway on RedTeam
       // CHECK_HIP_ERROR(hipDeviceSetCacheConfig(hipFuncCachePreferL1));
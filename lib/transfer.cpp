@@ -21,7 +21,7 @@ namespace quda {
   */
   Transfer::Transfer(const std::vector<ColorSpinorField *> &B, int Nvec, int n_block_ortho, bool block_ortho_two_pass,
                      int *geo_bs, int spin_bs, QudaPrecision null_precision, const QudaTransferType transfer_type,
-                     TimeProfile &profile) :
+                     TimeProfile &profile, const std::function<void(ColorSpinorField &)> &restore) :
     B(B),
     Nvec(Nvec),
     NblockOrtho(n_block_ortho),
@@ -130,7 +130,10 @@ namespace quda {
     for (int s = 0; s < B[0]->Nspin(); s++) spin_map[s] = static_cast<int*>(safe_malloc(2*sizeof(int)));
     createSpinMap(spin_bs);
 
-    reset();
+    if (restore && transfer_type == QUDA_TRANSFER_AGGREGATE)
+      restore(B[0]->Location() == QUDA_CUDA_FIELD_LOCATION ? *V_d : *V_h);
+    else
+      reset();
     postTrace();
   }
 
@@ -2,6 +2,7 @@
 #include <comm_quda.h>
 #include <quda.h>     // for QUDA_VERSION_STRING
 #include <timer.h>
+#include <memory_timeline.h>
 #include <sys/stat.h> // for stat()
 #include <fcntl.h>
 #include <cfloat> // for FLT_MAX
@@ -512,8 +513,8 @@ namespace quda
   {
     time_t now;
     int lock_handle;
-    std::string lock_path, profile_path, async_profile_path, trace_path;
-    std::ofstream profile_file, async_profile_file, trace_file;
+    std::string lock_path, profile_path, async_profile_path, trace_path, memory_path;
+    std::ofstream profile_file, async_profile_file, trace_file, memory_file;
 
     if (resource_path.empty()) return;
 
@@ -546,11 +547,14 @@ namespace quda
         profile_path = resource_path + "/profile_" + std::to_string(count) + ".tsv";
         async_profile_path = resource_path + "/profile_async_" + std::to_string(count) + ".tsv";
         if (traceEnabled()) trace_path = resource_path + "/trace_" + std::to_string(count) + ".tsv";
+        if (memory_timeline::enabled()) memory_path = resource_path + "/memory_trace_" + std::to_string(count) + ".tsv";
       } else {
         profile_path = resource_path + "/" + profile_fname + "_" + std::to_string(count) + ".tsv";
         async_profile_path = resource_path + "/" + profile_fname + "_" + std::to_string(count) + "_async.tsv";
         if (traceEnabled())
           trace_path = resource_path + "/" + profile_fname + "_trace_" + std::to_string(count) + ".tsv";
+        if (memory_timeline::enabled())
+          memory_path = resource_path + "/" + profile_fname + "_memory_trace_" + std::to_string(count) + ".tsv";
       }
 
       count++;
@@ -558,6 +562,7 @@ namespace quda
       profile_file.open(profile_path.c_str());
       async_profile_file.open(async_profile_path.c_str());
       if (traceEnabled()) trace_file.open(trace_path.c_str());
+      if (memory_timeline::enabled()) memory_file.open(memory_path.c_str());
 
       if (getVerbosity() >= QUDA_SUMMARIZE) {
         // compute number of non-zero entries that will be output in the profile
@@ -577,6 +582,8 @@ namespace quda
         printfQuda("Saving %d sets of cached profiles to %s\n", n_policy, async_profile_path.c_str());
         if (traceEnabled())
           printfQuda("Saving trace list with %lu entries to %s\n", trace_list.size(), trace_path.c_str());
+        if (memory_timeline::enabled())
+          printfQuda("Saving memory timeline with %lu entries to %s\n", memory_timeline::size(), memory_path.c_str());
       }
 
       time(&now);
@@ -638,6 +645,26 @@ namespace quda
         trace_file.close();
       }
 
+      if (memory_timeline::enabled()) {
+        memory_file << "memory_trace"
+                    << "\t" << quda_version;
+#ifdef GITVERSION
+        memory_file << "\t" << gitversion;
+#else
+        memory_file << "\t" << quda_version;
+#endif
+        memory_file << "\t" << quda_hash << "\t# Last updated " << ctime(&now) << std::endl;
+
+        memory_file << std::setw(12) << "time\t" << std::setw(12) << "device-mem\t" << std::setw(12) << "pinned-mem\t";
+        memory_file << std::setw(12) << "mapped-mem\t" << std::setw(12) << "host-mem\t";
+        memory_file << std::setw(16) << "volume"
+                    << "\tname\taux" << std::endl;
+
+        memory_timeline::serialize(memory_file);
+
+        memory_file.close();
+      }
+
       // Release lock.
       close(lock_handle);
       remove(lock_path.c_str());
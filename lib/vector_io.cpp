@@ -1,11 +1,89 @@
+#include <algorithm>
+#include <future>
 #include <color_spinor_field.h>
 #include <qio_field.h>
 #include <vector_io.h>
+#include <vector_io_native.h>
+#include <async_io.h>
+#include <eigen_compress.h>
 #include <blas_quda.h>
 
 namespace quda
 {
 
+  /**
+     @return Whether to save vectors in the native format rather than
+     with QIO.  This is selected with QUDA_VECTOR_IO_FORMAT=native or
+     QUDA_VECTOR_IO_FORMAT=qio, defaulting to QIO if QUDA was built
+     with it.  The format is detected automatically when loading.
+   */
+  static bool native_format()
+  {
+    static const bool native = [] {
+      char *format = getenv("QUDA_VECTOR_IO_FORMAT");
+#ifdef HAVE_QIO
+      bool native = false;
+#else
+      bool native = true;
+#endif
+      if (format) {
+        if (strcmp(format, "native") == 0) {
+          native = true;
+        } else if (strcmp(format, "qio") == 0) {
+          native = false;
+        } else {
+          errorQuda("Unknown QUDA_VECTOR_IO_FORMAT=%s", format);
+        }
+      }
+      return native;
+    }();
+    return native;
+  }
+
+  /**
+     @return The number of vectors in each host staging batch when
+     streaming vectors to or from a native file.  This is set with
+     QUDA_VECTOR_IO_BATCH_SIZE (default 16), where 0 stages all
+     vectors at once.  Two batches are allocated to overlap the file
+     I/O with the conversion, so the peak host memory is independent
+     of the number of vectors.
+   */
+  static size_t batch_size()
+  {
+    static const size_t size = [] {
+      char *size_str = getenv("QUDA_VECTOR_IO_BATCH_SIZE");
+      long size = 16;
+      if (size_str) {
+        size = atol(size_str);
+        if (size < 0) errorQuda("Invalid QUDA_VECTOR_IO_BATCH_SIZE=%s", size_str);
+      }
+      return static_cast<size_t>(size);
+    }();
+    return size;
+  }
+
+  /**
+     @return The parameters of the host staging fields used for
+     converting a set of vectors to or from file
+     @param[in] v The vector to be converted
+     @param[in] prec The precision of the file data
+     @param[in] parity_inflate Whether single-parity fields are stored as full fields
+   */
+  static ColorSpinorParam staging_param(const ColorSpinorField &v, QudaPrecision prec, bool parity_inflate)
+  {
+    ColorSpinorParam csParam(v);
+    csParam.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
+    csParam.setPrecision(prec);
+    csParam.location = QUDA_CPU_FIELD_LOCATION;
+    csParam.create = QUDA_NULL_FIELD_CREATE;
+    if (csParam.siteSubset == QUDA_PARITY_SITE_SUBSET && parity_inflate) {
+      csParam.x[0] *= 2;                          // corrects for the factor of two in the X direction
+      csParam.siteSubset = QUDA_FULL_SITE_SUBSET; // create a full-parity field.
+      csParam.create = QUDA_ZERO_FIELD_CREATE;    // to explicitly zero the other parity.
+    }
+    return csParam;
+  }
+
   VectorIO::VectorIO(const std::string &filename, bool parity_inflate) :
     filename(filename),
     parity_inflate(parity_inflate)
@@ -26,20 +104,29 @@ namespace quda
       errorQuda("When loading single parity vectors, the suggested parity must be set.");
     if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Start loading %04d vectors from %s\n", Nvec, filename.c_str());
 
+    // complete any pending asynchronous save to this file
+    async_io::flush(filename);
+
+    if (eigen_compress::is_compressed_file(filename)) {
+      eigen_compress::load(filename, vecs);
+      if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Done loading vectors\n");
+      return;
+    }
+
+    if (native_io::is_native_file(filename)) {
+      load_native(vecs, load_prec);
+      if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Done loading vectors\n");
+      return;
+    }
+
+    // QIO reads all vectors in a single call, so they are all staged at once
     std::vector<ColorSpinorField> tmp(Nvec);
     bool create_tmp = load_prec != v0.Precision() || (v0.SiteSubset() == QUDA_PARITY_SITE_SUBSET && parity_inflate) ||
       v0.Location() == QUDA_CUDA_FIELD_LOCATION;
 
     if (create_tmp) {
-      ColorSpinorParam csParam(vecs[0]);
-      csParam.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
-      csParam.setPrecision(load_prec);
-      csParam.location = QUDA_CPU_FIELD_LOCATION;
+      ColorSpinorParam csParam = staging_param(v0, load_prec, parity_inflate);
       csParam.create = QUDA_NULL_FIELD_CREATE;
-      if (csParam.siteSubset == QUDA_PARITY_SITE_SUBSET && parity_inflate) {
-        csParam.x[0] *= 2;
-        csParam.siteSubset = QUDA_FULL_SITE_SUBSET;
-      }
       for (int i = 0; i < Nvec; i++) tmp[i] = ColorSpinorField(csParam);
     }
 
@@ -80,42 +167,40 @@ namespace quda
     const QudaPrecision save_prec = prec != QUDA_INVALID_PRECISION ? prec :
       v0.Precision() < QUDA_SINGLE_PRECISION ? QUDA_SINGLE_PRECISION : v0.Precision();
 
-    bool create_tmp = save_prec != v0.Precision() || (v0.SiteSubset() == QUDA_PARITY_SITE_SUBSET && parity_inflate) ||
-      v0.Location() == QUDA_CUDA_FIELD_LOCATION;
     auto spinor_parity = v0.SuggestedParity();
     if (v0.SiteSubset() == QUDA_PARITY_SITE_SUBSET && parity_inflate &&
         spinor_parity != QUDA_EVEN_PARITY && spinor_parity != QUDA_ODD_PARITY)
       errorQuda("When loading single parity vectors, the suggested parity must be set.");
+
+    if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Start saving %d vectors to %s\n", Nvec, filename.c_str());
+
+    // complete any pending asynchronous save to this file before overwriting it
+    async_io::flush(filename);
+
+    if (native_format()) {
+      save_native({vecs.begin(), vecs.begin() + Nvec}, save_prec);
+      if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Done saving vectors\n");
+      return;
+    }
+
+    // QIO writes all vectors in a single call, so they are all staged at once
+    bool create_tmp = save_prec != v0.Precision() || (v0.SiteSubset() == QUDA_PARITY_SITE_SUBSET && parity_inflate) ||
+      v0.Location() == QUDA_CUDA_FIELD_LOCATION;
     std::vector<ColorSpinorField> tmp(Nvec);
 
     if (create_tmp) {
-      ColorSpinorParam csParam(vecs[0]);
-      csParam.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
-      csParam.setPrecision(save_prec);
-      csParam.location = QUDA_CPU_FIELD_LOCATION;
-
-      if (csParam.siteSubset == QUDA_FULL_SITE_SUBSET || !parity_inflate) {
-        // We're good, copy as is.
-        csParam.create = QUDA_NULL_FIELD_CREATE;
-        for (int i = 0; i < Nvec; i++) {
-          tmp[i] = ColorSpinorField(csParam);
+      ColorSpinorParam csParam = staging_param(v0, save_prec, parity_inflate);
+      for (int i = 0; i < Nvec; i++) {
+        tmp[i] = ColorSpinorField(csParam);
+        if (v0.SiteSubset() == QUDA_FULL_SITE_SUBSET || !parity_inflate) {
           tmp[i] = vecs[i];
-        }
-      } else { // QUDA_PARITY_SITE_SUBSET
-        csParam.x[0] *= 2;                          // corrects for the factor of two in the X direction
-        csParam.siteSubset = QUDA_FULL_SITE_SUBSET; // create a full-parity field.
-        csParam.create = QUDA_ZERO_FIELD_CREATE;    // to explicitly zero the odd sites.
-        for (int i = 0; i < Nvec; i++) {
-          tmp[i] = ColorSpinorField(csParam);
-
-          // copy the single parity only eigen/singular vector into the even components of the full parity vector
+        } else {
+          // copy the single parity only eigen/singular vector into the corresponding parity of the full vector
           blas::copy(spinor_parity == QUDA_EVEN_PARITY ? tmp[i].Even() : tmp[i].Odd(), vecs[i]);
         }
       }
     }
 
-    if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Start saving %d vectors to %s\n", Nvec, filename.c_str());
-
     if (v0.Ndim() == 4 || v0.Ndim() == 5) {
       // since QIO routines presently assume we have 4-d fields, we need to convert to array of 4-d fields
       auto Ls = v0.Ndim() == 5 ? v0.X(4) : 1;
@@ -137,4 +222,155 @@ namespace quda
     if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Done saving vectors\n");
   }
 
+  void VectorIO::load_native(cvector_ref<ColorSpinorField> &vecs, QudaPrecision load_prec)
+  {
+    const ColorSpinorField &v0 = vecs[0];
+    const size_t Nvec = vecs.size();
+    const auto spinor_parity = v0.SuggestedParity();
+    const bool inflate = v0.SiteSubset() == QUDA_PARITY_SITE_SUBSET && parity_inflate;
+    const bool create_tmp = load_prec != v0.Precision() || inflate || v0.Location() == QUDA_CUDA_FIELD_LOCATION;
+
+    if (!create_tmp) {
+      native_io::Reader reader(filename, v0, spinor_parity);
+      reader.read(vecs, 0);
+      reader.close();
+      return;
+    }
+
+    const size_t batch = batch_size() > 0 ? std::min(batch_size(), Nvec) : Nvec;
+    const size_t n_batch = (Nvec + batch - 1) / batch;
+    ColorSpinorParam csParam = staging_param(v0, load_prec, parity_inflate);
+    csParam.create = QUDA_NULL_FIELD_CREATE; // every site is read from file
+    std::vector<ColorSpinorField> staging[2];
+    for (auto &s : staging) s.resize(std::min(batch, Nvec));
+    for (auto &v : staging[0]) v = ColorSpinorField(csParam);
+    if (n_batch > 1)
+      for (auto &v : staging[1]) v = ColorSpinorField(csParam);
+    if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Loading in %lu batches of %lu vectors\n", n_batch, batch);
+
+    native_io::Reader reader(filename, staging[0][0], spinor_parity);
+    auto read_batch = [&](size_t b) {
+      auto &s = staging[b % 2];
+      size_t n = std::min(batch, Nvec - b * batch);
+      reader.read({s.begin(), s.begin() + n}, b * batch);
+    };
+
+    // read the next batch on a helper thread while this one is copied to its destination
+    std::future<void> pending = std::async(std::launch::async, read_batch, 0);
+    for (size_t b = 0; b < n_batch; b++) {
+      pending.get();
+      if (b + 1 < n_batch) pending = std::async(std::launch::async, read_batch, b + 1);
+
+      auto &s = staging[b % 2];
+      for (size_t i = 0; i < std::min(batch, Nvec - b * batch); i++) {
+        auto &v = vecs[b * batch + i];
+        if (inflate) {
+          v = spinor_parity == QUDA_EVEN_PARITY ? s[i].Even() : s[i].Odd();
+        } else {
+          v = s[i];
+        }
+      }
+    }
+    reader.close();
+  }
+
+  void VectorIO::save_native(cvector_ref<const ColorSpinorField> &vecs, QudaPrecision save_prec)
+  {
+    const ColorSpinorField &v0 = vecs[0];
+    const size_t Nvec = vecs.size();
+    const auto spinor_parity = v0.SuggestedParity();
+    const bool inflate = v0.SiteSubset() == QUDA_PARITY_SITE_SUBSET && parity_inflate;
+    const bool create_tmp = save_prec != v0.Precision() || inflate || v0.Location() == QUDA_CUDA_FIELD_LOCATION;
+
+    if (!create_tmp) {
+      native_io::Writer writer(filename, v0, spinor_parity, Nvec);
+      writer.write(vecs, 0);
+      writer.close();
+      return;
+    }
+
+    const size_t batch = batch_size() > 0 ? std::min(batch_size(), Nvec) : Nvec;
+    const size_t n_batch = (Nvec + batch - 1) / batch;
+    // when inflating, the other parity is zeroed on creation and never written to
+    ColorSpinorParam csParam = staging_param(v0, save_prec, parity_inflate);
+    std::vector<ColorSpinorField> staging[2];
+    for (auto &s : staging) s.resize(std::min(batch, Nvec));
+    for (auto &v : staging[0]) v = ColorSpinorField(csParam);
+    if (n_batch > 1)
+      for (auto &v : staging[1]) v = ColorSpinorField(csParam);
+    if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Saving in %lu batches of %lu vectors\n", n_batch, batch);
+
+    native_io::Writer writer(filename, staging[0][0], spinor_parity, Nvec);
+
+    // write each batch on a helper thread while the next one is copied from the source
+    std::future<void> pending;
+    for (size_t b = 0; b < n_batch; b++) {
+      auto &s = staging[b % 2];
+      size_t n = std::min(batch, Nvec - b * batch);
+      for (size_t i = 0; i < n; i++) {
+        const ColorSpinorField &v = vecs[b * batch + i];
+        if (inflate) {
+          blas::copy(spinor_parity == QUDA_EVEN_PARITY ? s[i].Even() : s[i].Odd(), v);
+        } else {
+          s[i] = v;
+        }
+      }
+
+      if (pending.valid()) pending.get();
+      pending = std::async(std::launch::async, [&, b, n] {
+        auto &staged = staging[b % 2];
+        writer.write({staged.begin(), staged.begin() + n}, b * batch);
+      });
+    }
+    pending.get();
+    writer.close();
+  }
+
+  void VectorIO::save_async(cvector_ref<const ColorSpinorField> &vecs, QudaPrecision prec, uint32_t size)
+  {
+    const ColorSpinorField &v0 = vecs[0];
+    const size_t Nvec = (size != 0 && size < vecs.size()) ? size : vecs.size();
+    if (prec < QUDA_SINGLE_PRECISION && prec != QUDA_INVALID_PRECISION) errorQuda("Unsupported precision %d", prec);
+    const QudaPrecision save_prec = prec != QUDA_INVALID_PRECISION ? prec :
+      v0.Precision() < QUDA_SINGLE_PRECISION ? QUDA_SINGLE_PRECISION : v0.Precision();
+    const bool inflate = v0.SiteSubset() == QUDA_PARITY_SITE_SUBSET && parity_inflate;
+
+    // the staging fields are always full-volume host fields when inflating
+    const size_t bytes = Nvec * (inflate ? 2 : 1) * v0.Volume() * v0.Nspin() * v0.Ncolor() * 2 * save_prec;
+    if (!async_io::enabled() || !native_format() || bytes > async_io::budget()) {
+      if (async_io::enabled() && native_format())
+        logQuda(QUDA_VERBOSE, "Saving %s synchronously since it exceeds the asynchronous staging budget\n",
+                filename.c_str());
+      save(vecs, prec, size);
+      return;
+    }
+
+    auto spinor_parity = v0.SuggestedParity();
+    if (inflate && spinor_parity != QUDA_EVEN_PARITY && spinor_parity != QUDA_ODD_PARITY)
+      errorQuda("When loading single parity vectors, the suggested parity must be set.");
+
+    if (getVerbosity() >= QUDA_SUMMARIZE)
+      printfQuda("Start asynchronous saving of %lu vectors to %s\n", Nvec, filename.c_str());
+
+    // complete any pending save to this file, then make room for the snapshot
+    async_io::flush(filename);
+    async_io::reserve(bytes);
+
+    ColorSpinorParam csParam = staging_param(v0, save_prec, parity_inflate);
+    std::vector<ColorSpinorField> staging(Nvec);
+    for (auto i = 0u; i < Nvec; i++) {
+      staging[i] = ColorSpinorField(csParam);
+      if (inflate) {
+        blas::copy(spinor_parity == QUDA_EVEN_PARITY ? staging[i].Even() : staging[i].Odd(), vecs[i]);
+      } else {
+        staging[i] = vecs[i];
+      }
+    }
+
+    auto writer = std::make_unique<native_io::Writer>(filename, staging[0], spinor_parity, Nvec);
+    async_io::submit(std::move(writer), std::move(staging));
+  }
+
+  void VectorIO::flush() { async_io::flush(); }
+
 } // namespace quda
@@ -0,0 +1,524 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <externals/json.hpp>
+#include <crc32.h>
+#include <timer.h>
+#include <vector_io_native.h>
+
+namespace quda
+{
+
+  namespace native_io
+  {
+
+    using json = nlohmann::json;
+
+    namespace
+    {
+
+      constexpr char magic[] = "QUDAFLD1";
+      constexpr size_t magic_bytes = 8;
+      constexpr size_t preamble_bytes = magic_bytes + sizeof(uint64_t); // magic and header length
+      constexpr size_t payload_alignment = 4096;
+      constexpr int format_version = 1;
+
+      /**
+         @brief Write a buffer at a given file offset, retrying on
+         partial writes
+       */
+      void pwrite_all(int fd, const void *buf, size_t bytes, off_t offset, const std::string &filename)
+      {
+        auto p = static_cast<const char *>(buf);
+        while (bytes > 0) {
+          ssize_t n = pwrite(fd, p, bytes, offset);
+          if (n < 0 && errno == EINTR) continue;
+          if (n <= 0)
+            errorQuda("Failed to write %s at offset %lld (%s)", filename.c_str(), (long long)offset, strerror(errno));
+          p += n;
+          bytes -= n;
+          offset += n;
+        }
+      }
+
+      /**
+         @brief Read a buffer from a given file offset, retrying on
+         partial reads
+       */
+      void pread_all(int fd, void *buf, size_t bytes, off_t offset, const std::string &filename)
+      {
+        auto p = static_cast<char *>(buf);
+        while (bytes > 0) {
+          ssize_t n = pread(fd, p, bytes, offset);
+          if (n < 0 && errno == EINTR) continue;
+          if (n <= 0)
+            errorQuda("Failed to read %s at offset %lld (%s)", filename.c_str(), (long long)offset, strerror(errno));
+          p += n;
+          bytes -= n;
+          offset += n;
+        }
+      }
+
+      /**
+         Coalesces consecutive reads that are contiguous both in the
+         file and in memory, so that reading with the same partitioning
+         as the writer results in a single read per parity.
+       */
+      class CoalescedRead
+      {
+        int fd;
+        const std::string &filename;
+        char *buf;
+        off_t file_offset = 0;
+        size_t mem_offset = 0;
+        size_t bytes = 0;
+
+      public:
+        CoalescedRead(int fd, const std::string &filename, char *buf) : fd(fd), filename(filename), buf(buf) { }
+
+        void add(off_t file_offset_, size_t mem_offset_, size_t bytes_)
+        {
+          if (bytes > 0 && file_offset_ == file_offset + static_cast<off_t>(bytes) && mem_offset_ == mem_offset + bytes) {
+            bytes += bytes_;
+            return;
+          }
+          flush();
+          file_offset = file_offset_;
+          mem_offset = mem_offset_;
+          bytes = bytes_;
+        }
+
+        void flush()
+        {
+          if (bytes > 0) pread_all(fd, buf + mem_offset, bytes, file_offset, filename);
+          bytes = 0;
+        }
+      };
+
+      void check_field(const ColorSpinorField &v)
+      {
+        if (v.Location() != QUDA_CPU_FIELD_LOCATION) errorQuda("Native I/O requires host fields");
+        if (v.FieldOrder() != QUDA_SPACE_SPIN_COLOR_FIELD_ORDER)
+          errorQuda("Native I/O requires space-spin-color order, not %d", v.FieldOrder());
+        if (v.Precision() != QUDA_DOUBLE_PRECISION && v.Precision() != QUDA_SINGLE_PRECISION)
+          errorQuda("Unsupported precision %d", v.Precision());
+      }
+
+      size_t payload_offset(size_t header_length)
+      {
+        return ((preamble_bytes + header_length + payload_alignment - 1) / payload_alignment) * payload_alignment;
+      }
+
+      bool little_endian()
+      {
+        const uint16_t one = 1;
+        return *reinterpret_cast<const char *>(&one) == 1;
+      }
+
+      /**
+         @brief Read the header of a native file on rank 0 and broadcast it
+         @param[in] filename The file to read
+         @param[out] length The length of the serialized header
+         @return The header
+       */
+      json read_header(const std::string &filename, uint64_t &length)
+      {
+        length = 0;
+        std::string header;
+        if (comm_rank() == 0) {
+          int fd = open(filename.c_str(), O_RDONLY);
+          if (fd < 0) errorQuda("Failed to open %s (%s)", filename.c_str(), strerror(errno));
+          char preamble[preamble_bytes];
+          pread_all(fd, preamble, preamble_bytes, 0, filename);
+          if (memcmp(preamble, magic, magic_bytes) != 0) errorQuda("%s is not a native QUDA field file", filename.c_str());
+          memcpy(&length, preamble + magic_bytes, sizeof(length));
+          header.resize(length);
+          pread_all(fd, &header[0], length, preamble_bytes, filename);
+          close(fd);
+        }
+        comm_broadcast(&length, sizeof(length));
+        header.resize(length);
+        comm_broadcast(&header[0], length);
+        return json::parse(header);
+      }
+
+      /**
+         @brief Convert between host precisions
+       */
+      template <typename dst_t, typename src_t> void convert(void *dst, const void *src, size_t n)
+      {
+        auto d = static_cast<dst_t *>(dst);
+        auto s = static_cast<const src_t *>(src);
+        for (size_t i = 0; i < n; i++) d[i] = s[i];
+      }
+
+      /** @return A packed checksum in the serialized form, with each word as 8 hex digits */
+      json checksum_json(uint64_t packed)
+      {
+        crc::ScidacChecksum sum;
+        sum.unpack(packed);
+        char suma[9], sumb[9];
+        snprintf(suma, sizeof(suma), "%08x", sum.suma);
+        snprintf(sumb, sizeof(sumb), "%08x", sum.sumb);
+        return {{"suma", suma}, {"sumb", sumb}};
+      }
+
+      /** @return The block index of this rank, lexicographic in the rank grid */
+      size_t block_index()
+      {
+        size_t block = 0;
+        for (int d = 3; d >= 0; d--) block = block * comm_dim(d) + comm_coord(d);
+        return block;
+      }
+
+    } // namespace
+
+    Geometry::Geometry(const ColorSpinorField &v, QudaParity parity) :
+      nDim(v.Ndim()), full(v.SiteSubset() == QUDA_FULL_SITE_SUBSET), parity(parity), pc_5d(v.PCType() == QUDA_5D_PC)
+    {
+      for (int d = 0; d < nDim; d++) {
+        L[d] = v.full_dim(d);
+        int n = d < 4 ? comm_dim(d) : 1;
+        int c = d < 4 ? comm_coord(d) : 0;
+        offset[d] = c * L[d];
+        G[d] = n * L[d];
+      }
+      if (!full && parity != QUDA_EVEN_PARITY && parity != QUDA_ODD_PARITY)
+        errorQuda("Parity must be set for single parity fields");
+    }
+
+    size_t Geometry::volume() const
+    {
+      size_t v = 1;
+      for (int d = 0; d < nDim; d++) v *= L[d];
+      return v;
+    }
+
+    std::vector<int> Geometry::parities() const
+    {
+      if (full) return {0, 1};
+      return {parity == QUDA_EVEN_PARITY ? 0 : 1};
+    }
+
+    crc::ScidacChecksum Geometry::checksum(const char *buf, size_t site_bytes) const
+    {
+      crc::ScidacChecksum sum;
+      for (auto p : parities()) {
+        for_each_half_line(p, [&](const lat_dim_t &x, size_t cb, size_t n) {
+          uint64_t global = 0;
+          for (int d = nDim - 1; d >= 0; d--) global = global * G[d] + offset[d] + x[d];
+          const char *site = buf + (parity_offset(p) + cb) * site_bytes;
+          for (size_t k = 0; k < n; k++) sum.add(global + 2 * k, site + k * site_bytes, site_bytes);
+        });
+      }
+      return sum;
+    }
+
+    bool is_native_file(const std::string &filename)
+    {
+      int native = 0;
+      if (comm_rank() == 0) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd >= 0) {
+          char preamble[magic_bytes];
+          native = pread(fd, preamble, magic_bytes, 0) == static_cast<ssize_t>(magic_bytes)
+            && memcmp(preamble, magic, magic_bytes) == 0;
+          close(fd);
+        }
+      }
+      comm_broadcast(&native, sizeof(native));
+      return native;
+    }
+
+    Writer::Writer(const std::string &filename, const ColorSpinorField &meta, QudaParity parity, size_t nvec) :
+      filename(filename),
+      g(meta, parity),
+      nColor(meta.Ncolor()),
+      nSpin(meta.Nspin()),
+      precision(meta.Precision()),
+      nvec(nvec),
+      site_bytes(nSpin * nColor * 2 * precision),
+      block_bytes(g.sites() * site_bytes),
+      vec_bytes(comm_size() * block_bytes),
+      block(block_index()),
+      checksums(nvec, 0)
+    {
+      check_field(meta);
+
+      // the header is written with placeholder checksums of the same
+      // length as the final ones, so the payload offset is fixed here
+      const std::string header_str = header(false);
+      const uint64_t header_length = header_str.size();
+      payload = payload_offset(header_length);
+
+      if (comm_rank() == 0) {
+        int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) errorQuda("Failed to open %s (%s)", filename.c_str(), strerror(errno));
+        char preamble[preamble_bytes];
+        memcpy(preamble, magic, magic_bytes);
+        memcpy(preamble + magic_bytes, &header_length, sizeof(header_length));
+        pwrite_all(fd, preamble, preamble_bytes, 0, filename);
+        pwrite_all(fd, header_str.data(), header_length, preamble_bytes, filename);
+        if (ftruncate(fd, payload + nvec * vec_bytes) != 0)
+          errorQuda("Failed to size %s (%s)", filename.c_str(), strerror(errno));
+        ::close(fd);
+      }
+      comm_barrier();
+
+      fd = open(filename.c_str(), O_WRONLY);
+      if (fd < 0) errorQuda("Failed to open %s (%s)", filename.c_str(), strerror(errno));
+    }
+
+    Writer::~Writer()
+    {
+      if (fd >= 0) ::close(fd);
+    }
+
+    std::string Writer::header(bool final) const
+    {
+      std::vector<json> sums;
+      for (auto c : checksums) sums.push_back(checksum_json(final ? c : 0));
+
+      json header;
+      header["format"] = "quda-native-field";
+      header["version"] = format_version;
+      header["field"] = "ColorSpinorField";
+      header["byte_order"] = little_endian() ? "little" : "big";
+      header["ndim"] = g.nDim;
+      header["global_dims"] = std::vector<int>(g.G.data, g.G.data + g.nDim);
+      header["partition"] = {comm_dim(0), comm_dim(1), comm_dim(2), comm_dim(3)};
+      header["ncolor"] = nColor;
+      header["nspin"] = nSpin;
+      header["precision"] = static_cast<int>(precision);
+      header["order"] = "space_spin_color";
+      header["subset"] = g.full ? "full" : "parity";
+      header["parity"] = g.full ? "none" : (g.parity == QUDA_EVEN_PARITY ? "even" : "odd");
+      header["pc_type"] = g.pc_5d ? "5d" : "4d";
+      header["nvec"] = nvec;
+      header["block_bytes"] = block_bytes;
+      header["checksums"] = sums;
+      return header.dump();
+    }
+
+    void Writer::write(cvector_ref<const ColorSpinorField> &vecs, size_t first)
+    {
+      if (fd < 0) errorQuda("%s is closed", filename.c_str());
+      if (first + vecs.size() > nvec)
+        errorQuda("Writing vectors %lu-%lu beyond the %lu in %s", first, first + vecs.size() - 1, nvec, filename.c_str());
+
+      host_timer_t timer;
+      timer.start();
+      for (auto i = 0u; i < vecs.size(); i++) {
+        const ColorSpinorField &v = vecs[i];
+        check_field(v);
+        if (v.Precision() != precision || v.Ncolor() != nColor || v.Nspin() != nSpin
+            || (v.SiteSubset() == QUDA_FULL_SITE_SUBSET) != g.full)
+          errorQuda("Vector %lu does not match the file %s", first + i, filename.c_str());
+
+        // the checksums are independent of the partitioning, so are reduced at close
+        checksums[first + i] = g.checksum(static_cast<const char *>(v.V()), site_bytes).pack();
+        pwrite_all(fd, v.V(), block_bytes, payload + (first + i) * vec_bytes + block * block_bytes, filename);
+      }
+      timer.stop();
+
+      written += vecs.size();
+      bytes += vecs.size() * vec_bytes;
+      time += timer.last();
+    }
+
+    void Writer::close()
+    {
+      if (fd < 0) errorQuda("%s is already closed", filename.c_str());
+      if (written != nvec) errorQuda("Only %lu of %lu vectors written to %s", written, nvec, filename.c_str());
+      if (::close(fd) != 0) errorQuda("Failed to close %s (%s)", filename.c_str(), strerror(errno));
+      fd = -1;
+
+      for (auto &c : checksums) comm_allreduce_xor(c);
+      if (comm_rank() == 0) {
+        const std::string header_str = header(true);
+        if (payload_offset(header_str.size()) != payload) errorQuda("Header of %s changed length", filename.c_str());
+        int fd = open(filename.c_str(), O_WRONLY);
+        if (fd < 0) errorQuda("Failed to open %s (%s)", filename.c_str(), strerror(errno));
+        pwrite_all(fd, header_str.data(), header_str.size(), preamble_bytes, filename);
+        if (::close(fd) != 0) errorQuda("Failed to close %s (%s)", filename.c_str(), strerror(errno));
+      }
+      comm_barrier();
+
+      if (getVerbosity() >= QUDA_VERBOSE)
+        printfQuda("Wrote %lu vectors (%.1f MiB) to %s in %.3f s of I/O (%.2f GB/s)\n", nvec,
+                   bytes / (double)(1 << 20), filename.c_str(), time, bytes / (1e9 * time));
+    }
+
+    Reader::Reader(const std::string &filename, const ColorSpinorField &meta, QudaParity parity) :
+      filename(filename), g(meta, parity), nColor(meta.Ncolor()), nSpin(meta.Nspin())
+    {
+      check_field(meta);
+
+      uint64_t header_length;
+      auto header = read_header(filename, header_length);
+      if (header.at("format") != "quda-native-field" || header.at("version") > format_version)
+        errorQuda("Unsupported file format in %s", filename.c_str());
+      if (header.at("byte_order") != (little_endian() ? "little" : "big"))
+        errorQuda("Byte order of %s does not match the host", filename.c_str());
+      if (header.at("ndim") != g.nDim) errorQuda("Dimension mismatch %d != %d", header.at("ndim").get<int>(), g.nDim);
+      if (header.at("global_dims") != std::vector<int>(g.G.data, g.G.data + g.nDim))
+        errorQuda("Global dimensions of %s do not match", filename.c_str());
+      if (header.at("ncolor") != nColor || header.at("nspin") != nSpin)
+        errorQuda("Color/spin mismatch: file has nColor = %d, nSpin = %d", header.at("ncolor").get<int>(),
+                  header.at("nspin").get<int>());
+      if (g.nDim == 5 && header.at("pc_type") != (g.pc_5d ? "5d" : "4d"))
+        errorQuda("Preconditioning type of %s does not match", filename.c_str());
+      nvec_ = header.at("nvec").get<size_t>();
+
+      file_full = header.at("subset") == "full";
+      if (!file_full) {
+        auto file_parity = header.at("parity") == "even" ? QUDA_EVEN_PARITY : QUDA_ODD_PARITY;
+        if (g.full || file_parity != parity) errorQuda("%s does not contain the requested parity", filename.c_str());
+      }
+
+      file_prec = static_cast<QudaPrecision>(header.at("precision").get<int>());
+      const size_t file_site_bytes = nSpin * nColor * 2 * file_prec;
+
+      // the partitioning of the writer
+      auto partition = header.at("partition").get<std::vector<int>>();
+      W = {};
+      Lw = {};
+      Vw = 1;
+      for (int d = 0; d < g.nDim; d++) {
+        W[d] = d < 4 ? partition[d] : 1;
+        if (g.G[d] % W[d] != 0) errorQuda("Invalid partitioning %d of dimension %d in %s", W[d], d, filename.c_str());
+        Lw[d] = g.G[d] / W[d];
+        Vw *= Lw[d];
+      }
+      block_bytes = (file_full ? Vw : Vw / 2) * file_site_bytes;
+      if (block_bytes != header.at("block_bytes").get<size_t>()) errorQuda("Inconsistent header in %s", filename.c_str());
+      vec_bytes = W[0] * W[1] * W[2] * W[3] * block_bytes;
+      payload = payload_offset(header_length);
+
+      for (auto &c : header.at("checksums")) {
+        crc::ScidacChecksum sum;
+        sum.suma = std::stoul(c.at("suma").get<std::string>(), nullptr, 16);
+        sum.sumb = std::stoul(c.at("sumb").get<std::string>(), nullptr, 16);
+        expected.push_back(sum.pack());
+      }
+      if (expected.size() != nvec_) errorQuda("Inconsistent header in %s", filename.c_str());
+
+      fd = open(filename.c_str(), O_RDONLY);
+      if (fd < 0) errorQuda("Failed to open %s (%s)", filename.c_str(), strerror(errno));
+    }
+
+    Reader::~Reader()
+    {
+      if (fd >= 0) ::close(fd);
+    }
+
+    void Reader::read(cvector_ref<ColorSpinorField> &vecs, size_t first)
+    {
+      if (fd < 0) errorQuda("%s is closed", filename.c_str());
+      if (first + vecs.size() > nvec_)
+        errorQuda("%s contains %lu vectors, but vectors %lu-%lu requested", filename.c_str(), nvec_, first,
+                  first + vecs.size() - 1);
+
+      host_timer_t timer;
+      timer.start();
+
+      const size_t n_real = nSpin * nColor * 2;
+      const size_t file_site_bytes = n_real * file_prec;
+      staging.resize(g.sites() * file_site_bytes);
+
+      for (auto i = 0u; i < vecs.size(); i++) {
+        auto &v = vecs[i];
+        check_field(v);
+        if (v.Ncolor() != nColor || v.Nspin() != nSpin || (v.SiteSubset() == QUDA_FULL_SITE_SUBSET) != g.full)
+          errorQuda("Vector %lu does not match the file %s", first + i, filename.c_str());
+
+        const size_t offset = payload + (first + i) * vec_bytes;
+        CoalescedRead reader(fd, filename, staging.data());
+        for (auto p : g.parities()) {
+          g.for_each_half_line(p, [&](const lat_dim_t &x, size_t cb, size_t n) {
+            // writer block and local coordinates of the other dimensions
+            size_t block_line = 0, line = 0;
+            for (int d = g.nDim - 1; d >= 1; d--) {
+              int global = g.offset[d] + x[d];
+              if (d < 4) block_line = block_line * W[d] + global / Lw[d];
+              line = line * Lw[d] + global % Lw[d];
+            }
+            // split the half line over the writer blocks along x
+            for (size_t k = 0; k < n;) {
+              int global = g.offset[0] + x[0] + 2 * k;
+              int xw = global % Lw[0];
+              size_t m = std::min(n - k, static_cast<size_t>((Lw[0] - xw + 1) / 2));
+              size_t block = block_line * W[0] + global / Lw[0];
+              size_t cb_w = (line * Lw[0] + xw) / 2 + (file_full ? p * (Vw / 2) : 0);
+              reader.add(offset + block * block_bytes + cb_w * file_site_bytes,
+                         (g.parity_offset(p) + cb + k) * file_site_bytes, m * file_site_bytes);
+              k += m;
+            }
+          });
+        }
+        reader.flush();
+
+        // the checksum can only be verified when the whole field is read
+        if (g.full == file_full) checksums.push_back({first + i, g.checksum(staging.data(), file_site_bytes).pack()});
+
+        size_t n = g.sites() * n_real;
+        if (file_prec == v.Precision()) {
+          memcpy(v.V(), staging.data(), n * file_prec);
+        } else if (v.Precision() == QUDA_DOUBLE_PRECISION) {
+          convert<double, float>(v.V(), staging.data(), n);
+        } else {
+          convert<float, double>(v.V(), staging.data(), n);
+        }
+      }
+      timer.stop();
+
+      bytes += vecs.size() * g.sites() * file_site_bytes;
+      time += timer.last();
+    }
+
+    void Reader::close()
+    {
+      if (fd < 0) errorQuda("%s is already closed", filename.c_str());
+      ::close(fd);
+      fd = -1;
+
+      // every rank reads the same vectors, so the reductions match
+      for (auto &c : checksums) {
+        uint64_t packed = c.second;
+        comm_allreduce_xor(packed);
+        if (packed != expected[c.first]) {
+          auto computed = checksum_json(packed);
+          auto file = checksum_json(expected[c.first]);
+          errorQuda("Checksum mismatch for vector %lu in %s: computed %s %s, expected %s %s", c.first, filename.c_str(),
+                    computed.at("suma").get<std::string>().c_str(), computed.at("sumb").get<std::string>().c_str(),
+                    file.at("suma").get<std::string>().c_str(), file.at("sumb").get<std::string>().c_str());
+        }
+      }
+
+      if (getVerbosity() >= QUDA_VERBOSE)
+        printfQuda("Read %.1f MiB from %s in %.3f s of I/O (%.2f GB/s)%s\n", bytes / (double)(1 << 20),
+                   filename.c_str(), time, bytes / (1e9 * time), checksums.empty() ? "" : ", checksums verified");
+      checksums.clear();
+    }
+
+    void write(const std::string &filename, cvector_ref<const ColorSpinorField> &vecs, QudaParity parity)
+    {
+      Writer writer(filename, vecs[0], parity, vecs.size());
+      writer.write(vecs, 0);
+      writer.close();
+    }
+
+    void read(const std::string &filename, cvector_ref<ColorSpinorField> &vecs, QudaParity parity)
+    {
+      Reader reader(filename, vecs[0], parity);
+      reader.read(vecs, 0);
+      reader.close();
+    }
+
+  } // namespace native_io
+
+} // namespace quda
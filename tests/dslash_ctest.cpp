@@ -121,6 +121,31 @@ TEST_P(DslashTest, verify)
 
 TEST_P(DslashTest, benchmark) { dslash_test_wrapper.run_test(niter, /**show_metrics =*/true); }
 
+// a set of fields applied in one multi-RHS call gives the same result as applying them one at a time
+TEST_P(DslashTest, batched)
+{
+  auto &dirac = dslash_test_wrapper.dirac;
+  auto test_type = dslash_test_wrapper.dtest_type;
+  if (!dirac || (test_type != dslash_test_type::MatPC && test_type != dslash_test_type::MatPCDagMatPC)) GTEST_SKIP();
+
+  constexpr int n_src = 4;
+  ColorSpinorParam param(dslash_test_wrapper.cudaSpinor);
+  param.create = QUDA_NULL_FIELD_CREATE;
+  std::vector<ColorSpinorField> in(n_src, param), out(n_src, param), ref(n_src, param);
+  RNG rng(in[0], 1234);
+  for (auto &v : in) spinorNoise(v, rng, QUDA_NOISE_GAUSS);
+
+  if (test_type == dslash_test_type::MatPC) {
+    for (int i = 0; i < n_src; i++) dirac->M(ref[i], in[i]);
+    dirac->M(out, in);
+  } else {
+    for (int i = 0; i < n_src; i++) dirac->MdagM(ref[i], in[i]);
+    dirac->MdagM(out, in);
+  }
+
+  for (int i = 0; i < n_src; i++) EXPECT_EQ(blas::max_deviation(out[i], ref[i])[0], 0.0) << "Source " << i;
+}
+
 int main(int argc, char **argv)
 {
   // initalize google test, includes command line options
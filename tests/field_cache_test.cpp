@@ -0,0 +1,139 @@
+#include <color_spinor_field.h>
+#include <gauge_field.h>
+#include <clover_field.h>
+#include <field_cache.h>
+#include <test.h>
+
+/*
+   This test checks that the field temporary cache reuses released
+   temporaries of each cached field type, and that it evicts the least
+   recently released ones once over budget.
+ */
+
+using namespace quda;
+
+/**
+   @brief Create the parameters of a device field of each cached type
+ */
+template <typename T> typename T::param_type field_param();
+
+template <> ColorSpinorParam field_param<ColorSpinorField>()
+{
+  QudaGaugeParam gauge_param = newQudaGaugeParam();
+  QudaInvertParam inv_param = newQudaInvertParam();
+  setWilsonGaugeParam(gauge_param);
+  setInvertParam(inv_param);
+
+  ColorSpinorParam param;
+  constructWilsonTestSpinorParam(&param, &inv_param, &gauge_param);
+  param.setPrecision(inv_param.cuda_prec, inv_param.cuda_prec, true);
+  param.location = QUDA_CUDA_FIELD_LOCATION;
+  param.create = QUDA_NULL_FIELD_CREATE;
+  return param;
+}
+
+template <> GaugeFieldParam field_param<GaugeField>()
+{
+  QudaGaugeParam gauge_param = newQudaGaugeParam();
+  setWilsonGaugeParam(gauge_param);
+
+  GaugeFieldParam param(gauge_param, nullptr, QUDA_GENERAL_LINKS);
+  param.location = QUDA_CUDA_FIELD_LOCATION;
+  param.reconstruct = QUDA_RECONSTRUCT_NO;
+  param.setPrecision(gauge_param.cuda_prec, true);
+  param.create = QUDA_NULL_FIELD_CREATE;
+  return param;
+}
+
+template <> CloverFieldParam field_param<CloverField>()
+{
+  QudaGaugeParam gauge_param = newQudaGaugeParam();
+  QudaInvertParam inv_param = newQudaInvertParam();
+  setWilsonGaugeParam(gauge_param);
+  setInvertParam(inv_param);
+
+  CloverFieldParam param(inv_param, GaugeFieldParam(gauge_param).x);
+  param.location = QUDA_CUDA_FIELD_LOCATION;
+  param.setPrecision(inv_param.cuda_prec, true);
+  param.create = QUDA_NULL_FIELD_CREATE;
+  return param;
+}
+
+template <typename T> class FieldCacheTest : public ::testing::Test
+{
+protected:
+  std::unique_ptr<T> field;
+
+  void SetUp() override
+  {
+    FieldTmp<T>::destroy();
+    field.reset(T::Create(field_param<T>()));
+  }
+
+  void TearDown() override
+  {
+    FieldTmp<T>::set_budget(default_field_cache_budget * 1024 * 1024);
+    FieldTmp<T>::destroy();
+  }
+};
+
+using cached_types = ::testing::Types<ColorSpinorField, GaugeField, CloverField>;
+TYPED_TEST_SUITE(FieldCacheTest, cached_types);
+
+// a released temporary is reused by the next matching request
+TYPED_TEST(FieldCacheTest, reuse)
+{
+  auto stats = FieldTmp<TypeParam>::get_stats();
+
+  const TypeParam *first = nullptr;
+  {
+    auto tmp = getFieldTmp(*this->field);
+    first = &static_cast<TypeParam &>(tmp);
+  }
+
+  auto cached = FieldTmp<TypeParam>::get_stats();
+  EXPECT_EQ(cached.misses, stats.misses + 1);
+  EXPECT_EQ(cached.cached_fields, 1u);
+  EXPECT_EQ(cached.cached_bytes, this->field->TotalBytes());
+
+  {
+    auto tmp = getFieldTmp(*this->field);
+    EXPECT_EQ(&static_cast<TypeParam &>(tmp), first);
+  }
+
+  auto reused = FieldTmp<TypeParam>::get_stats();
+  EXPECT_EQ(reused.hits, cached.hits + 1);
+  EXPECT_EQ(reused.misses, cached.misses);
+}
+
+// released temporaries beyond the budget are evicted oldest first
+TYPED_TEST(FieldCacheTest, evict)
+{
+  FieldTmp<TypeParam>::set_budget(this->field->TotalBytes());
+  auto stats = FieldTmp<TypeParam>::get_stats();
+
+  const TypeParam *first = nullptr;
+  {
+    auto tmp1 = getFieldTmp(*this->field);
+    auto tmp2 = getFieldTmp(*this->field);
+    first = &static_cast<TypeParam &>(tmp1);
+  } // tmp2 is released before tmp1, so it is the one evicted
+
+  auto evicted = FieldTmp<TypeParam>::get_stats();
+  EXPECT_EQ(evicted.evictions, stats.evictions + 1);
+  EXPECT_EQ(evicted.cached_fields, 1u);
+  EXPECT_LE(evicted.cached_bytes, evicted.budget);
+
+  {
+    auto tmp = getFieldTmp(*this->field);
+    EXPECT_EQ(&static_cast<TypeParam &>(tmp), first);
+  }
+  EXPECT_EQ(FieldTmp<TypeParam>::get_stats().hits, evicted.hits + 1);
+}
+
+int main(int argc, char **argv)
+{
+  quda_test test("Field Cache Test", argc, argv);
+  test.init();
+  return test.execute();
+}
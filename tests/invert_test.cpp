@@ -21,6 +21,10 @@ QudaInvertParam mg_inv_param;
 QudaEigParam mg_eig_param[QUDA_MAX_MG_LEVEL];
 QudaEigParam eig_param;
 
+// multigrid checkpoint written after the setup, and checkpoint the setup is restored from (if not empty)
+std::string mg_checkpoint_write;
+std::string mg_checkpoint_restore;
+
 // if --enable-testing true is passed, we run the tests defined in here
 #include <invert_test_gtest.hpp>
 
@@ -187,6 +191,12 @@ std::vector<double> solve(test_t param)
   multishift = ::testing::get<4>(param);
   inv_param.solution_accumulator_pipeline = ::testing::get<5>(param);
 
+  // a batched solve sets its own number of sources, otherwise that of the command line is used
+  static const int Nsrc_default = Nsrc;
+  batched_multi_src = ::testing::get<7>(param) > 0;
+  Nsrc = batched_multi_src ? ::testing::get<7>(param) : Nsrc_default;
+  inv_param.batched_multi_src = batched_multi_src ? QUDA_BOOLEAN_TRUE : QUDA_BOOLEAN_FALSE;
+
   // schwarz parameters
   auto schwarz_param = ::testing::get<6>(param);
   inv_param.schwarz_type           = ::testing::get<0>(schwarz_param);
@@ -210,7 +220,10 @@ std::vector<double> solve(test_t param)
   void *mg_preconditioner = nullptr;
   if (inv_multigrid) {
     if (use_split_grid) { errorQuda("Split grid does not work with MG yet."); }
-    mg_preconditioner = newMultigridQuda(&mg_param);
+    mg_preconditioner = mg_checkpoint_restore.empty() ? newMultigridQuda(&mg_param) :
+                                                        restoreMultigridQuda(&mg_param, mg_checkpoint_restore.c_str());
+    if (!mg_checkpoint_write.empty())
+      checkpointMultigridQuda(mg_preconditioner, &mg_param, mg_checkpoint_write.c_str());
     inv_param.preconditioner = mg_preconditioner;
   }
 
@@ -236,6 +249,7 @@ std::vector<double> solve(test_t param)
   //----------------------------------------------------------------------------
   if (multishift > 1) {
     if (use_split_grid) { errorQuda("Split grid does not work with multishift yet."); }
+    if (batched_multi_src) { errorQuda("Batched multi-source solves do not work with multishift."); }
     inv_param.num_offset = multishift;
     for (int i = 0; i < multishift; i++) {
       // Set masses and offsets
@@ -266,11 +280,14 @@ std::vector<double> solve(test_t param)
     out[i] = quda::ColorSpinorField(cs_param);
   }
 
-  if (!use_split_grid) {
+  if (!use_split_grid && !batched_multi_src) {
 
     for (int i = 0; i < Nsrc; i++) {
       // If deflating, preserve the deflation space between solves
       if (inv_deflate) eig_param.preserve_deflation = i < Nsrc - 1 ? QUDA_BOOLEAN_TRUE : QUDA_BOOLEAN_FALSE;
+      // If recycling, preserve the recycled subspace between solves
+      if (inv_type == QUDA_GCRODR_INVERTER)
+        inv_param.preserve_recycle = i < Nsrc - 1 ? QUDA_BOOLEAN_TRUE : QUDA_BOOLEAN_FALSE;
       // Perform QUDA inversions
       if (multishift > 1) {
         invertMultiShiftQuda(_hp_multi_x[i].data(), in[i].V(), &inv_param);
@@ -320,7 +337,7 @@ std::vector<double> solve(test_t param)
   if (inv_multigrid) destroyMultigridQuda(mg_preconditioner);
 
   // Compute performance statistics
-  if (Nsrc > 1 && !use_split_grid) performanceStats(time, gflops, iter);
+  if (Nsrc > 1 && !use_split_grid && !batched_multi_src) performanceStats(time, gflops, iter);
 
   std::vector<double> res(Nsrc);
   // Perform host side verification of inversion if requested
@@ -409,7 +426,8 @@ int main(int argc, char **argv)
     result = RUN_ALL_TESTS();
   } else {
     solve(test_t {inv_type, solution_type, solve_type, prec_sloppy, multishift, solution_accumulator_pipeline,
-                  schwarz_t {precon_schwarz_type, inv_multigrid ? QUDA_MG_INVERTER : precon_type, prec_precondition} } );
+                  schwarz_t {precon_schwarz_type, inv_multigrid ? QUDA_MG_INVERTER : precon_type, prec_precondition},
+                  batched_multi_src ? Nsrc : 0});
   }
 
   // finalize the QUDA library
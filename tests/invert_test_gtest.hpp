@@ -1,10 +1,15 @@
+#include <cstdio>
+#include <string>
+#include <tuple>
 #include <gtest/gtest.h>
 #include <quda_arch.h>
 
 // tuple containing parameters for Schwarz solver
 using schwarz_t = ::testing::tuple<QudaSchwarzType, QudaInverterType, QudaPrecision>;
 
-using test_t = ::testing::tuple<QudaInverterType, QudaSolutionType, QudaSolveType, QudaPrecision, int, int, schwarz_t>;
+// the last element is the number of sources of a batched multi-source solve, or 0 for separate solves
+using test_t
+  = ::testing::tuple<QudaInverterType, QudaSolutionType, QudaSolveType, QudaPrecision, int, int, schwarz_t, int>;
 
 class InvertTest : public ::testing::TestWithParam<test_t>
 {
@@ -93,6 +98,7 @@ bool skip_test(test_t param)
   auto solution_accumulator_pipeline = ::testing::get<5>(param);
   auto schwarz_param = ::testing::get<6>(param);
   auto prec_precondition = ::testing::get<2>(schwarz_param);
+  auto batch = ::testing::get<7>(param);
 
   if (prec < prec_sloppy) return true;              // outer precision >= sloppy precision
   if (!(QUDA_PRECISION & prec_sloppy)) return true; // precision not enabled so skip it
@@ -106,6 +112,11 @@ bool skip_test(test_t param)
   if (is_chiral(dslash_type) && multishift > 1) return true;
   // FIXME this needs to be added to dslash_reference.cpp
   if (is_chiral(dslash_type) && solution_type == QUDA_MATDAG_MAT_SOLUTION) return true;
+  // block CG only solves batches, and batched solves only support CG and block CG without multishift or split grid
+  if (inverter_type == QUDA_BLOCK_CG_INVERTER && batch == 0) return true;
+  if (batch > 0 && inverter_type != QUDA_CG_INVERTER && inverter_type != QUDA_BLOCK_CG_INVERTER) return true;
+  if (batch > 0 && (multishift > 1 || grid_partition[0] * grid_partition[1] * grid_partition[2] * grid_partition[3] > 1))
+    return true;
   // Skip if the inverter does not support batched update and batched update is greater than one
   if (!support_solution_accumulator_pipeline(inverter_type) && solution_accumulator_pipeline > 1) return true;
   // MdagMLocal only support for Mobius at present
@@ -135,6 +146,111 @@ TEST_P(InvertTest, verify)
   for (auto rsd : solve(GetParam())) EXPECT_LE(rsd, tol);
 }
 
+// the same solves with the sloppy precision promoted adaptively on the precision ladder
+class InvertPrecisionLadderTest : public InvertTest
+{
+};
+
+TEST_P(InvertPrecisionLadderTest, verify)
+{
+  if (skip_test(GetParam())) GTEST_SKIP();
+  auto tol = inv_param.tol;
+  // Slight loss of precision possible when reconstructing full solution
+  if (is_full_solution(::testing::get<1>(GetParam())) && is_preconditioned_solve(::testing::get<2>(GetParam())))
+    tol *= 10;
+
+  auto precision_ladder = inv_param.precision_ladder;
+  inv_param.precision_ladder = QUDA_BOOLEAN_TRUE;
+  for (auto rsd : solve(GetParam())) EXPECT_LE(rsd, tol);
+  inv_param.precision_ladder = precision_ladder;
+}
+
+// with reliable updates disabled, the solve on the half-precision rung ends once its iterated residual has converged,
+// while its true residual is still at the noise floor of half precision, so the ladder must be climbed to converge
+TEST_P(InvertPrecisionLadderTest, promote)
+{
+  if (skip_test(GetParam())) GTEST_SKIP();
+  // only the CG solvers are guaranteed to converge their iterated residual in half precision without reliable updates
+  if (!is_normal_solve(GetParam())) GTEST_SKIP();
+  if (::testing::get<3>(GetParam()) != QUDA_HALF_PRECISION || inv_param.cuda_prec == QUDA_HALF_PRECISION) GTEST_SKIP();
+  // the tolerance must be below the noise floor of half precision
+  if (inv_param.tol > 1e-6) GTEST_SKIP();
+  auto tol = inv_param.tol;
+  if (is_full_solution(::testing::get<1>(GetParam())) && is_preconditioned_solve(::testing::get<2>(GetParam())))
+    tol *= 10;
+
+  auto precision_ladder = inv_param.precision_ladder;
+  auto reliable_delta = inv_param.reliable_delta;
+  inv_param.precision_ladder = QUDA_BOOLEAN_TRUE;
+  inv_param.reliable_delta = 1e-3 * inv_param.tol;
+  for (auto rsd : solve(GetParam())) EXPECT_LE(rsd, tol);
+  EXPECT_GE(inv_param.precision_ladder_promotions, 1);
+  inv_param.precision_ladder = precision_ladder;
+  inv_param.reliable_delta = reliable_delta;
+}
+
+extern std::string mg_checkpoint_write;
+extern std::string mg_checkpoint_restore;
+
+// a multigrid setup restored from a checkpoint gives the same solve, while a checkpoint written with different
+// parameters or with corrupted data is not restored and the setup is done afresh (only run with --inv-multigrid)
+TEST(MultigridCheckpoint, verify)
+{
+  if (!inv_multigrid) GTEST_SKIP();
+  test_t param {inv_type,
+                solution_type,
+                solve_type,
+                prec_sloppy,
+                1,
+                1,
+                schwarz_t {precon_schwarz_type, QUDA_MG_INVERTER, prec_precondition},
+                0};
+  auto tol = inv_param.tol;
+  if (is_full_solution(solution_type) && is_preconditioned_solve(solve_type)) tol *= 10;
+
+  const std::string file = "dummy.mg";
+  auto mg_solve = [&](const std::string &write, const std::string &restore) {
+    mg_checkpoint_write = write;
+    mg_checkpoint_restore = restore;
+    auto res = solve(param);
+    mg_checkpoint_write.clear();
+    mg_checkpoint_restore.clear();
+    for (auto rsd : res) EXPECT_LE(rsd, tol);
+    return std::make_pair(inv_param.iter, mg_param.checkpoint_restored);
+  };
+
+  auto [iter, restored] = mg_solve(file, "");
+  EXPECT_EQ(restored, QUDA_BOOLEAN_FALSE);
+
+  // null-space vectors and coarse links stored in reduced precision are stored in single precision, so the
+  // restored solve may differ by rounding
+  auto [iter_restored, restored_checkpoint] = mg_solve("", file);
+  EXPECT_EQ(restored_checkpoint, QUDA_BOOLEAN_TRUE);
+  EXPECT_LE(std::abs(iter_restored - iter), 1);
+
+  auto n_block_ortho = mg_param.n_block_ortho[0];
+  mg_param.n_block_ortho[0] = n_block_ortho + 1;
+  EXPECT_EQ(mg_solve("", file).second, QUDA_BOOLEAN_FALSE);
+  mg_param.n_block_ortho[0] = n_block_ortho;
+
+  // flip a byte in the middle of the data file
+  if (quda::comm_rank() == 0) {
+    FILE *fp = fopen((file + ".data").c_str(), "r+b");
+    if (!fp || fseek(fp, 0, SEEK_END) != 0) errorQuda("Failed to open %s.data", file.c_str());
+    long offset = ftell(fp) / 2;
+    fseek(fp, offset, SEEK_SET);
+    int c = fgetc(fp);
+    fseek(fp, offset, SEEK_SET);
+    fputc(c ^ 0xff, fp);
+    fclose(fp);
+  }
+  quda::comm_barrier();
+  EXPECT_EQ(mg_solve("", file).second, QUDA_BOOLEAN_FALSE);
+
+  if (quda::comm_rank() == 0 && (remove(file.c_str()) != 0 || remove((file + ".data").c_str()) != 0))
+    errorQuda("Error deleting file");
+}
+
 std::string gettestname(::testing::TestParamInfo<test_t> param)
 {
   std::string name;
@@ -146,6 +262,7 @@ std::string gettestname(::testing::TestParamInfo<test_t> param)
     name += std::string("_shift") + std::to_string(::testing::get<4>(param.param));
   if (::testing::get<5>(param.param) > 1)
     name += std::string("_solution_accumulator_pipeline") + std::to_string(::testing::get<5>(param.param));
+  if (::testing::get<7>(param.param) > 0) name += std::string("_batch") + std::to_string(::testing::get<7>(param.param));
   auto &schwarz_param = ::testing::get<6>(param.param);
   if (::testing::get<0>(schwarz_param) != QUDA_INVALID_SCHWARZ) {
     name += std::string("_") + get_schwarz_str(::testing::get<0>(schwarz_param));
@@ -157,11 +274,12 @@ std::string gettestname(::testing::TestParamInfo<test_t> param)
 
 using ::testing::Combine;
 using ::testing::Values;
-auto normal_solvers = Values(QUDA_CG_INVERTER, QUDA_CA_CG_INVERTER, QUDA_PCG_INVERTER);
+auto normal_solvers = Values(QUDA_CG_INVERTER, QUDA_CA_CG_INVERTER, QUDA_PCG_INVERTER, QUDA_PIPELINED_CG_INVERTER);
 
 auto direct_solvers
   = Values(QUDA_CGNE_INVERTER, QUDA_CGNR_INVERTER, QUDA_CA_CGNE_INVERTER, QUDA_CA_CGNR_INVERTER, QUDA_GCR_INVERTER,
-           QUDA_CA_GCR_INVERTER, QUDA_BICGSTAB_INVERTER, QUDA_BICGSTABL_INVERTER, QUDA_MR_INVERTER);
+           QUDA_CA_GCR_INVERTER, QUDA_BICGSTAB_INVERTER, QUDA_BICGSTABL_INVERTER, QUDA_MR_INVERTER, QUDA_IDR_INVERTER,
+           QUDA_CA_BICGSTAB_INVERTER, QUDA_GCRODR_INVERTER);
 
 auto sloppy_precisions
   = Values(QUDA_DOUBLE_PRECISION, QUDA_SINGLE_PRECISION, QUDA_HALF_PRECISION, QUDA_QUARTER_PRECISION);
@@ -176,7 +294,7 @@ INSTANTIATE_TEST_SUITE_P(NormalEvenOdd, InvertTest,
                                  Values(QUDA_MATPCDAG_MATPC_SOLUTION, QUDA_MAT_SOLUTION),
                                  Values(QUDA_NORMOP_PC_SOLVE), sloppy_precisions, Values(1),
                                  solution_accumulator_pipelines,
-                                 no_schwarz),
+                                 no_schwarz, Values(0)),
                          gettestname);
 
 // full system normal solve
@@ -185,7 +303,7 @@ INSTANTIATE_TEST_SUITE_P(NormalFull, InvertTest,
                                  Values(QUDA_NORMOP_SOLVE),
                                  sloppy_precisions, Values(1),
                                  solution_accumulator_pipelines,
-                                 no_schwarz),
+                                 no_schwarz, Values(0)),
                          gettestname);
 
 // preconditioned direct solves
@@ -193,7 +311,7 @@ INSTANTIATE_TEST_SUITE_P(EvenOdd, InvertTest,
                          Combine(direct_solvers, Values(QUDA_MATPC_SOLUTION, QUDA_MAT_SOLUTION),
                                  Values(QUDA_DIRECT_PC_SOLVE), sloppy_precisions, Values(1),
                                  solution_accumulator_pipelines,
-                                 no_schwarz),
+                                 no_schwarz, Values(0)),
                          gettestname);
 
 // full system direct solve
@@ -201,7 +319,7 @@ INSTANTIATE_TEST_SUITE_P(Full, InvertTest,
                          Combine(direct_solvers, Values(QUDA_MAT_SOLUTION),
                                  Values(QUDA_DIRECT_SOLVE),
                                  sloppy_precisions, Values(1), solution_accumulator_pipelines,
-                                 no_schwarz),
+                                 no_schwarz, Values(0)),
                          gettestname);
 
 // preconditioned multi-shift solves
@@ -209,7 +327,29 @@ INSTANTIATE_TEST_SUITE_P(MultiShiftEvenOdd, InvertTest,
                          Combine(Values(QUDA_CG_INVERTER), Values(QUDA_MATPCDAG_MATPC_SOLUTION),
                                  Values(QUDA_NORMOP_PC_SOLVE), sloppy_precisions, Values(10),
                                  solution_accumulator_pipelines,
-                                 no_schwarz),
+                                 no_schwarz, Values(0)),
+                         gettestname);
+
+// batched multi-source preconditioned normal solves
+INSTANTIATE_TEST_SUITE_P(BatchedNormalEvenOdd, InvertTest,
+                         Combine(Values(QUDA_CG_INVERTER, QUDA_BLOCK_CG_INVERTER),
+                                 Values(QUDA_MATPCDAG_MATPC_SOLUTION),
+                                 Values(QUDA_NORMOP_PC_SOLVE), sloppy_precisions, Values(1),
+                                 Values(1), no_schwarz, Values(4)),
+                         gettestname);
+
+// preconditioned normal and direct solves on the precision ladder
+INSTANTIATE_TEST_SUITE_P(PrecisionLadderNormalEvenOdd, InvertPrecisionLadderTest,
+                         Combine(Values(QUDA_CG_INVERTER, QUDA_PCG_INVERTER, QUDA_PIPELINED_CG_INVERTER),
+                                 Values(QUDA_MATPCDAG_MATPC_SOLUTION), Values(QUDA_NORMOP_PC_SOLVE),
+                                 Values(QUDA_SINGLE_PRECISION, QUDA_HALF_PRECISION), Values(1), Values(1),
+                                 no_schwarz, Values(0)),
+                         gettestname);
+
+INSTANTIATE_TEST_SUITE_P(PrecisionLadderEvenOdd, InvertPrecisionLadderTest,
+                         Combine(Values(QUDA_GCR_INVERTER, QUDA_BICGSTAB_INVERTER), Values(QUDA_MATPC_SOLUTION),
+                                 Values(QUDA_DIRECT_PC_SOLVE), Values(QUDA_SINGLE_PRECISION, QUDA_HALF_PRECISION),
+                                 Values(1), Values(1), no_schwarz, Values(0)),
                          gettestname);
 
 // Schwarz-preconditioned normal solves
@@ -221,7 +361,8 @@ INSTANTIATE_TEST_SUITE_P(SchwarzNormal, InvertTest,
                                  solution_accumulator_pipelines,
                                  Combine(Values(QUDA_ADDITIVE_SCHWARZ),
                                          Values(QUDA_CG_INVERTER, QUDA_CA_CG_INVERTER),
-                                         Values(QUDA_HALF_PRECISION, QUDA_QUARTER_PRECISION))),
+                                         Values(QUDA_HALF_PRECISION, QUDA_QUARTER_PRECISION)),
+                                 Values(0)),
                          gettestname);
 
 // Schwarz-preconditioned direct solves
@@ -233,5 +374,6 @@ INSTANTIATE_TEST_SUITE_P(SchwarzEvenOdd, InvertTest,
                                  solution_accumulator_pipelines,
                                  Combine(Values(QUDA_ADDITIVE_SCHWARZ),
                                          Values(QUDA_MR_INVERTER, QUDA_CA_GCR_INVERTER),
-                                         Values(QUDA_HALF_PRECISION, QUDA_QUARTER_PRECISION))),
+                                         Values(QUDA_HALF_PRECISION, QUDA_QUARTER_PRECISION)),
+                                 Values(0)),
                          gettestname);
@@ -1,12 +1,22 @@
+#include <fcntl.h>
+#include <unistd.h>
 #include <cstdio>
+#include <cstring>
 #include <limits>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include <instantiate.h>
 #include <color_spinor_field.h>
+#include <gauge_field.h>
+#include <mapped_field.h>
 #include <misc.h>
 #include <qio_field.h> // for QIO routines
 #include <vector_io.h>
 #include <blas_quda.h>
+#include <comm_quda.h>
+#include <crc32.h>
 #include <quda.h>
 #include <test.h>
 
@@ -71,6 +81,297 @@ TEST_P(GaugeIOTest, verify)
   for (int dir = 0; dir < 4; dir++) { host_free(gauge[dir]); }
 }
 
+// tuple types: precision, whether the file is ILDG (or NERSC)
+using gauge_file_test_t = ::testing::tuple<QudaPrecision, bool>;
+
+class GaugeFileTest : public ::testing::TestWithParam<gauge_file_test_t>
+{
+protected:
+  gauge_file_test_t param;
+
+public:
+  GaugeFileTest() : param(GetParam()) { }
+};
+
+/**
+   @brief Store a value in big-endian byte order
+ */
+template <typename T> void store_big_endian(char *buf, T value, int bytes = sizeof(T))
+{
+  for (int b = 0; b < bytes; b++) buf[b] = (static_cast<uint64_t>(value) >> (8 * (bytes - 1 - b))) & 0xff;
+}
+
+/**
+   @brief Write the host gauge field as a big-endian NERSC (3x3) or
+   ILDG configuration in the precision of the field, with the
+   checksums the readers verify.  Each rank writes its own sub-volume.
+   @return The SciDAC checksum of the links
+ */
+template <typename Float> quda::crc::ScidacChecksum write_gauge_file(const char *file, void **gauge, bool ildg)
+{
+  using namespace quda;
+  int G[4], offset[4];
+  for (int d = 0; d < 4; d++) {
+    G[d] = comm_dim(d) * Z[d];
+    offset[d] = comm_coord(d) * Z[d];
+  }
+  const size_t site_bytes = 4 * gauge_site_size * sizeof(Float);
+  const uint64_t global_volume = static_cast<uint64_t>(G[0]) * G[1] * G[2] * G[3];
+
+  // serialize the local sites as in the file, accumulating the checksums
+  std::vector<char> data(V * site_bytes);
+  std::vector<uint64_t> global(V);
+  uint32_t nersc_sum = 0;
+  crc::ScidacChecksum scidac;
+  for (int i = 0; i < V; i++) {
+    int x[4] = {i % Z[0], (i / Z[0]) % Z[1], (i / (Z[0] * Z[1])) % Z[2], i / (Z[0] * Z[1] * Z[2])};
+    int parity = (x[0] + x[1] + x[2] + x[3]) & 1;
+    char *site = data.data() + i * site_bytes;
+    for (int d = 0; d < 4; d++) {
+      for (size_t k = 0; k < gauge_site_size; k++) {
+        Float v = static_cast<Float *>(gauge[d])[(parity * Vh + i / 2) * gauge_site_size + k];
+        uint32_t w[sizeof(Float) / 4];
+        memcpy(w, &v, sizeof(Float));
+        for (auto wi : w) nersc_sum += wi;
+
+        uint64_t bits = 0;
+        memcpy(&bits, &v, sizeof(Float));
+        store_big_endian(site + (d * gauge_site_size + k) * sizeof(Float), bits, sizeof(Float));
+      }
+    }
+    global[i] = (((static_cast<uint64_t>(offset[3] + x[3]) * G[2] + offset[2] + x[2]) * G[1] + offset[1] + x[1]) * G[0])
+      + offset[0] + x[0];
+    scidac.add(global[i], site, site_bytes);
+  }
+
+  double sum = nersc_sum;
+  comm_allreduce_sum(sum);
+  nersc_sum = static_cast<uint64_t>(sum) & 0xffffffffu;
+  uint64_t packed = scidac.pack();
+  comm_allreduce_xor(packed);
+  scidac.unpack(packed);
+
+  // the records before and after the link data, which are identical on every rank
+  auto lime_record = [](const std::string &type, const std::string &payload, uint64_t length) {
+    std::string record(144, '\0');
+    store_big_endian(&record[0], 0x456789abu);
+    store_big_endian(&record[4], 1, 2);
+    store_big_endian(&record[8], length);
+    record.replace(16, type.size(), type);
+    record += payload;
+    record.resize(((record.size() + 7) / 8) * 8, '\0');
+    return record;
+  };
+  const std::string fp = sizeof(Float) == 8 ? "64" : "32";
+  std::string prefix, suffix;
+  if (ildg) {
+    std::string format = "<?xml version=\"1.0\"?><ildgFormat><version>1.0</version><field>su3gauge</field><precision>"
+      + fp + "</precision><lx>" + std::to_string(G[0]) + "</lx><ly>" + std::to_string(G[1]) + "</ly><lz>"
+      + std::to_string(G[2]) + "</lz><lt>" + std::to_string(G[3]) + "</lt></ildgFormat>";
+    prefix = lime_record("ildg-format", format, format.size());
+    prefix += lime_record("ildg-binary-data", "", global_volume * site_bytes);
+    char sums[64];
+    snprintf(sums, sizeof(sums), "<suma>%x</suma><sumb>%x</sumb>", scidac.suma, scidac.sumb);
+    std::string checksum = "<?xml version=\"1.0\"?><scidacChecksum><version>1.0</version>" + std::string(sums)
+      + "</scidacChecksum>";
+    suffix = lime_record("scidac-checksum", checksum, checksum.size());
+  } else {
+    char checksum[16];
+    snprintf(checksum, sizeof(checksum), "%08x", nersc_sum);
+    prefix = "BEGIN_HEADER\nHDR_VERSION = 1.0\nDATATYPE = 4D_SU3_GAUGE_3x3\n";
+    for (int d = 0; d < 4; d++) prefix += "DIMENSION_" + std::to_string(d + 1) + " = " + std::to_string(G[d]) + "\n";
+    prefix += "CHECKSUM = " + std::string(checksum) + "\nFLOATING_POINT = IEEE" + fp + "BIG\nEND_HEADER\n";
+  }
+
+  if (comm_rank() == 0) {
+    FILE *f = fopen(file, "wb");
+    if (!f) errorQuda("Failed to create %s", file);
+    fwrite(prefix.data(), 1, prefix.size(), f);
+    fclose(f);
+  }
+  comm_barrier();
+
+  int fd = open(file, O_WRONLY);
+  if (fd < 0) errorQuda("Failed to open %s", file);
+  for (int i = 0; i < V; i += Z[0]) {
+    if (pwrite(fd, data.data() + i * site_bytes, Z[0] * site_bytes, prefix.size() + global[i] * site_bytes)
+        != static_cast<ssize_t>(Z[0] * site_bytes))
+      errorQuda("Failed to write %s", file);
+  }
+  if (comm_rank() == 0 && !suffix.empty()
+      && pwrite(fd, suffix.data(), suffix.size(), prefix.size() + global_volume * site_bytes)
+        != static_cast<ssize_t>(suffix.size()))
+    errorQuda("Failed to write %s", file);
+  close(fd);
+  comm_barrier();
+
+  return scidac;
+}
+
+// test that a NERSC or ILDG configuration reads back identically, and loads directly to the device
+TEST_P(GaugeFileTest, verify)
+{
+  QudaGaugeParam gauge_param = newQudaGaugeParam();
+  setWilsonGaugeParam(gauge_param);
+
+  gauge_param.cpu_prec = ::testing::get<0>(param);
+  if (!quda::is_enabled(gauge_param.cpu_prec)) GTEST_SKIP();
+  gauge_param.cuda_prec = gauge_param.cpu_prec;
+  gauge_param.t_boundary = QUDA_PERIODIC_T;
+  const bool ildg = ::testing::get<1>(param);
+
+  const size_t bytes = V * gauge_site_size * gauge_param.cpu_prec;
+  void *gauge[4], *gauge_read[4];
+  for (int dir = 0; dir < 4; dir++) {
+    gauge[dir] = safe_malloc(bytes);
+    gauge_read[dir] = safe_malloc(bytes);
+  }
+  constructHostGaugeField(gauge, gauge_param, 0, nullptr);
+
+  auto file = ildg ? "dummy.ildg" : "dummy.nersc";
+  auto checksum = gauge_param.cpu_prec == QUDA_DOUBLE_PRECISION ? write_gauge_file<double>(file, gauge, ildg) :
+                                                                  write_gauge_file<float>(file, gauge, ildg);
+
+  // the links read back into a host array are identical
+  readGaugeFileQuda((void *)gauge_read, file, &gauge_param);
+  for (int dir = 0; dir < 4; dir++) EXPECT_EQ(memcmp(gauge[dir], gauge_read[dir], bytes), 0);
+
+  // loading the original field, validated against the SciDAC checksum, and loading from the file agree
+  gauge_param.checksum_precision = gauge_param.cpu_prec;
+  gauge_param.checksum_a = checksum.suma;
+  gauge_param.checksum_b = checksum.sumb;
+  loadGaugeQuda((void *)gauge, &gauge_param);
+  std::array<double, 3> plaq_old;
+  plaqQuda(plaq_old.data());
+  freeGaugeQuda();
+
+  gauge_param.checksum_precision = QUDA_INVALID_PRECISION;
+  loadGaugeFileQuda(file, &gauge_param);
+  std::array<double, 3> plaq_new;
+  plaqQuda(plaq_new.data());
+  freeGaugeQuda();
+
+  for (int i = 0; i < 3; i++) EXPECT_EQ(plaq_old[i], plaq_new[i]);
+
+  // the checksum of a native-ordered device copy of the field matches the file
+  {
+    quda::GaugeFieldParam host_param(gauge_param, gauge);
+    host_param.location = QUDA_CPU_FIELD_LOCATION;
+    host_param.ghostExchange = QUDA_GHOST_EXCHANGE_NO;
+    std::unique_ptr<quda::GaugeField> host(quda::GaugeField::Create(host_param));
+
+    quda::GaugeFieldParam device_param(*host);
+    device_param.location = QUDA_CUDA_FIELD_LOCATION;
+    device_param.reconstruct = QUDA_RECONSTRUCT_NO;
+    device_param.setPrecision(gauge_param.cpu_prec, true);
+    device_param.create = QUDA_NULL_FIELD_CREATE;
+    std::unique_ptr<quda::GaugeField> device(quda::GaugeField::Create(device_param));
+    device->copy(*host);
+
+    auto device_checksum = quda::Checksums(*device, gauge_param.cpu_prec);
+    EXPECT_EQ(device_checksum.suma, checksum.suma);
+    EXPECT_EQ(device_checksum.sumb, checksum.sumb);
+  }
+
+  if (::quda::comm_rank() == 0 && remove(file) != 0) errorQuda("Error deleting file");
+
+  for (int dir = 0; dir < 4; dir++) {
+    host_free(gauge[dir]);
+    host_free(gauge_read[dir]);
+  }
+}
+
+class MappedFieldTest : public ::testing::TestWithParam<gauge_test_t>
+{
+protected:
+  gauge_test_t param;
+
+public:
+  MappedFieldTest() : param(GetParam()) { }
+};
+
+// test that a gauge field and a source memory mapped from a file load identically to the regular loads
+TEST_P(MappedFieldTest, verify)
+{
+  QudaGaugeParam gauge_param = newQudaGaugeParam();
+  QudaInvertParam inv_param = newQudaInvertParam();
+  setWilsonGaugeParam(gauge_param);
+  setInvertParam(inv_param);
+
+  gauge_param.cpu_prec = ::testing::get<0>(param);
+  if (!quda::is_enabled(gauge_param.cpu_prec)) GTEST_SKIP();
+  gauge_param.cuda_prec = gauge_param.cpu_prec;
+  gauge_param.t_boundary = QUDA_PERIODIC_T;
+  inv_param.cpu_prec = gauge_param.cpu_prec;
+
+  const size_t gauge_bytes = V * gauge_site_size * gauge_param.cpu_prec;
+  void *gauge[4];
+  for (int dir = 0; dir < 4; dir++) gauge[dir] = safe_malloc(gauge_bytes);
+  constructHostGaugeField(gauge, gauge_param, 0, nullptr);
+
+  quda::ColorSpinorParam cs_param;
+  constructWilsonTestSpinorParam(&cs_param, &inv_param, &gauge_param);
+  quda::ColorSpinorField in(cs_param);
+  quda::RNG rng(in, 1234);
+  spinorNoise(in, rng, QUDA_NOISE_GAUSS);
+
+  // a rank-local file holding a header, the gauge field in QDP order and then the source
+  const size_t header = 100;
+  const size_t gauge_offset = header;
+  const size_t source_offset = gauge_offset + 4 * gauge_bytes;
+  auto file = std::string("dummy_mapped.") + std::to_string(::quda::comm_rank());
+  {
+    FILE *fp = fopen(file.c_str(), "wb");
+    if (!fp) errorQuda("Failed to open %s", file.c_str());
+    std::vector<char> zero(header, 0);
+    bool ok = fwrite(zero.data(), 1, header, fp) == header;
+    for (int dir = 0; dir < 4; dir++) ok = ok && fwrite(gauge[dir], 1, gauge_bytes, fp) == gauge_bytes;
+    ok = ok && fwrite(in.V(), 1, in.Bytes(), fp) == in.Bytes();
+    if (fclose(fp) != 0 || !ok) errorQuda("Failed to write %s", file.c_str());
+  }
+
+  // the mapped source is identical to the original once copied to the device
+  {
+    quda::ColorSpinorParam mapped_param(cs_param);
+    quda::MappedColorSpinorField mapped(file, source_offset, mapped_param);
+    quda::ColorSpinorParam device_param(cs_param, inv_param, QUDA_CUDA_FIELD_LOCATION);
+    device_param.create = QUDA_NULL_FIELD_CREATE;
+    quda::ColorSpinorField in_device(device_param);
+    quda::ColorSpinorField mapped_device(device_param);
+    in_device = in;
+    mapped_device = mapped;
+    EXPECT_EQ(quda::blas::max_deviation(mapped_device, in_device)[0], 0.0);
+  }
+
+  auto get_plaq = []() {
+    std::array<double, 3> plaq;
+    plaqQuda(plaq.data());
+    return plaq;
+  };
+
+  quda::ColorSpinorField out(cs_param);
+  quda::ColorSpinorField out_mapped(cs_param);
+
+  loadGaugeQuda((void *)gauge, &gauge_param);
+  auto plaq = get_plaq();
+  invertQuda(out.V(), in.V(), &inv_param);
+  auto iter = inv_param.iter;
+  freeGaugeQuda();
+
+  loadGaugeMappedQuda(file.c_str(), gauge_offset, &gauge_param);
+  auto plaq_mapped = get_plaq();
+  invertMappedQuda(out_mapped.V(), file.c_str(), source_offset, &inv_param);
+  auto iter_mapped = inv_param.iter;
+  freeGaugeQuda();
+
+  for (int i = 0; i < 3; i++) EXPECT_EQ(plaq_mapped[i], plaq[i]);
+  EXPECT_EQ(iter_mapped, iter);
+  EXPECT_EQ(quda::blas::max_deviation(out_mapped, out)[0], 0.0);
+
+  if (remove(file.c_str()) != 0) errorQuda("Error deleting file");
+  for (int dir = 0; dir < 4; dir++) host_free(gauge[dir]);
+}
+
 using cs_test_t = ::testing::tuple<QudaSiteSubset, bool, QudaPrecision, QudaPrecision, int, QudaFieldLocation>;
 
 class ColorSpinorIOTest : public ::testing::TestWithParam<cs_test_t>
@@ -172,6 +473,20 @@ INSTANTIATE_TEST_SUITE_P(Gauge, GaugeIOTest, Combine(Values(QUDA_DOUBLE_PRECISIO
                            return get_prec_str(::testing::get<0>(param.param));
                          });
 
+// memory mapped gauge field and source test
+INSTANTIATE_TEST_SUITE_P(Mapped, MappedFieldTest, Combine(Values(QUDA_DOUBLE_PRECISION, QUDA_SINGLE_PRECISION)),
+                         [](testing::TestParamInfo<gauge_test_t> param) {
+                           return get_prec_str(::testing::get<0>(param.param));
+                         });
+
+// NERSC and ILDG gauge file test
+INSTANTIATE_TEST_SUITE_P(GaugeFile, GaugeFileTest,
+                         Combine(Values(QUDA_DOUBLE_PRECISION, QUDA_SINGLE_PRECISION), Values(false, true)),
+                         [](testing::TestParamInfo<gauge_file_test_t> param) {
+                           return get_prec_str(::testing::get<0>(param.param))
+                             + std::string(::testing::get<1>(param.param) ? "_ildg" : "_nersc");
+                         });
+
 // colorspinor full field IO test
 INSTANTIATE_TEST_SUITE_P(Full, ColorSpinorIOTest,
                          Combine(Values(QUDA_FULL_SITE_SUBSET), Values(false),
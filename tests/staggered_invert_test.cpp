@@ -332,7 +332,7 @@ int main(int argc, char **argv)
 
     for (int k = 0; k < Nsrc; k++) { quda::spinorNoise(*in[k], *rng, QUDA_NOISE_UNIFORM); }
 
-    if (!use_split_grid) {
+    if (!use_split_grid && !batched_multi_src) {
       for (int k = 0; k < Nsrc; k++) {
         if (inv_deflate) eig_param.preserve_deflation = k < Nsrc - 1 ? QUDA_BOOLEAN_TRUE : QUDA_BOOLEAN_FALSE;
         invertQuda(out[k]->V(), in[k]->V(), &inv_param);
@@ -418,7 +418,7 @@ int main(int argc, char **argv)
   } // switch
 
   // Compute timings
-  if (Nsrc > 1 && !use_split_grid) performanceStats(time, gflops, iter);
+  if (Nsrc > 1 && !use_split_grid && !batched_multi_src) performanceStats(time, gflops, iter);
 
   // Free RNG
   delete rng;
@@ -49,6 +49,9 @@ bool unit_gauge = false;
 double gaussian_sigma = 0.2;
 std::string gauge_outfile;
 int Nsrc = 1;
+bool batched_multi_src = false;
+bool precision_ladder = false;
+int precision_ladder_check = 100;
 int Msrc = 1;
 int niter = 100;
 int maxiter_precondition = 10;
@@ -345,7 +348,12 @@ namespace
                                                            {"ca-cg", QUDA_CA_CG_INVERTER},
                                                            {"ca-cgne", QUDA_CA_CGNE_INVERTER},
                                                            {"ca-cgnr", QUDA_CA_CGNR_INVERTER},
-                                                           {"ca-gcr", QUDA_CA_GCR_INVERTER}};
+                                                           {"ca-gcr", QUDA_CA_GCR_INVERTER},
+                                                           {"pipelined-cg", QUDA_PIPELINED_CG_INVERTER},
+                                                           {"idr", QUDA_IDR_INVERTER},
+                                                           {"ca-bicgstab", QUDA_CA_BICGSTAB_INVERTER},
+                                                           {"gcrodr", QUDA_GCRODR_INVERTER},
+                                                           {"block-cg", QUDA_BLOCK_CG_INVERTER}};
 
   CLI::TransformPairs<QudaPrecision> precision_map {{"double", QUDA_DOUBLE_PRECISION},
                                                     {"single", QUDA_SINGLE_PRECISION},
@@ -510,7 +518,7 @@ std::shared_ptr<QUDAApp> make_app(std::string app_description, std::string app_n
     "Whether to do a multi-shift solver test or not. Default is 1 (single mass)"
     "If a value N > 1 is passed, heavier masses will be constructed and the multi-shift solver will be called");
   quda_app->add_option("--ngcrkrylov", gcrNkrylov,
-                       "The number of inner iterations to use for GCR, BiCGstab-l, CA-CG, CA-GCR (default 8)");
+                       "The number of inner iterations to use for GCR, BiCGstab-l, CA-CG, CA-GCR, the number of steps of CA-BiCGstab, and the shadow space dimension of IDR (default 8)");
   quda_app->add_option("--niter", niter, "The number of iterations to perform (default 100)");
   quda_app->add_option("--max-res-increase", max_res_increase,
                        "The number of consecutive true residual incrases allowed (default 1)");
@@ -526,6 +534,12 @@ std::shared_ptr<QUDAApp> make_app(std::string app_description, std::string app_n
     ->transform(CLI::QUDACheckedTransformer(verbosity_map));
   quda_app->add_option("--nsrc", Nsrc,
                        "How many spinors to apply the dslash to simultaneusly (experimental for staggered only)");
+  quda_app->add_option("--batched-multi-src", batched_multi_src,
+                       "Solve all sources together with the batched multi-source CG (default false)");
+  quda_app->add_option("--precision-ladder", precision_ladder,
+                       "Promote the sloppy precision from the preconditioner precision as the solve stalls (default false)");
+  quda_app->add_option("--precision-ladder-check", precision_ladder_check,
+                       "Minimum iterations over which the rate is measured on the precision ladder (default 100)");
 
   quda_app->add_option("--pipeline", pipeline,
                        "The pipeline length for fused operations in GCR, BiCGstab-l (default 0, no pipelining)");
@@ -762,10 +776,13 @@ void add_deflation_option_group(std::shared_ptr<QUDAApp> quda_app)
                       "Set memory location for the ritz vectors  (default cuda memory location)");
   opgroup->add_option("--df-max-restart-num", max_restart_num,
                       "Set maximum number of the initCG restarts in the deflation stage (default 3)");
-  opgroup->add_option("--df-max-search-dim", max_search_dim, "Set the size of eigenvector search space (default 64)");
+  opgroup->add_option("--df-max-search-dim", max_search_dim,
+                      "Set the size of eigenvector search space, or the cycle length of GCRO-DR (default 64)");
   opgroup->add_option("--df-mem-type-ritz", mem_type_ritz,
                       "Set memory type for the ritz vectors  (default device memory type)");
-  opgroup->add_option("--df-n-ev", n_ev, "Set number of eigenvectors computed within a single solve cycle (default 8)");
+  opgroup->add_option("--df-n-ev", n_ev,
+                      "Set number of eigenvectors computed within a single solve cycle, or the recycled subspace "
+                      "dimension of GCRO-DR (default 8)");
   opgroup->add_option("--df-tol-eigenval", eigenval_tol, "Set maximum eigenvalue residual norm (default 1e-1)");
   opgroup->add_option("--df-tol-inc", inc_tol,
                       "Set tolerance for the subsequent restarts in the initCG solver  (default 1e-2)");
@@ -185,6 +185,9 @@ extern bool unit_gauge;
 extern double gaussian_sigma;
 extern std::string gauge_outfile;
 extern int Nsrc;
+extern bool batched_multi_src;
+extern bool precision_ladder;
+extern int precision_ladder_check;
 extern int Msrc;
 extern int niter;
 extern int maxiter_precondition;
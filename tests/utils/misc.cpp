@@ -314,6 +314,11 @@ const char *get_solver_str(QudaInverterType type)
   case QUDA_CA_CGNE_INVERTER: ret = "ca_cgne"; break;
   case QUDA_CA_CGNR_INVERTER: ret = "ca_cgnr"; break;
   case QUDA_CA_GCR_INVERTER: ret = "ca_gcr"; break;
+  case QUDA_PIPELINED_CG_INVERTER: ret = "pipelined_cg"; break;
+  case QUDA_IDR_INVERTER: ret = "idr"; break;
+  case QUDA_CA_BICGSTAB_INVERTER: ret = "ca_bicgstab"; break;
+  case QUDA_GCRODR_INVERTER: ret = "gcrodr"; break;
+  case QUDA_BLOCK_CG_INVERTER: ret = "block_cg"; break;
   default:
     ret = "unknown";
     errorQuda("Error: invalid solver type %d\n", type);
@@ -277,6 +277,13 @@ void setInvertParam(QudaInvertParam &inv_param)
   // Whether or not use fused kernels for Mobius
   inv_param.use_mobius_fused_kernel = use_mobius_fused_kernel ? QUDA_BOOLEAN_TRUE : QUDA_BOOLEAN_FALSE;
 
+  // Whether or not to solve multiple sources together
+  inv_param.batched_multi_src = batched_multi_src ? QUDA_BOOLEAN_TRUE : QUDA_BOOLEAN_FALSE;
+
+  // Whether or not to adapt the sloppy precision during the solve
+  inv_param.precision_ladder = precision_ladder ? QUDA_BOOLEAN_TRUE : QUDA_BOOLEAN_FALSE;
+  inv_param.precision_ladder_check = precision_ladder_check;
+
   inv_param.struct_size = sizeof(inv_param);
 }
 
@@ -973,6 +980,13 @@ void setStaggeredInvertParam(QudaInvertParam &inv_param)
   // Whether or not to use native BLAS LAPACK
   inv_param.native_blas_lapack = (native_blas_lapack ? QUDA_BOOLEAN_TRUE : QUDA_BOOLEAN_FALSE);
 
+  // Whether or not to solve multiple sources together
+  inv_param.batched_multi_src = batched_multi_src ? QUDA_BOOLEAN_TRUE : QUDA_BOOLEAN_FALSE;
+
+  // Whether or not to adapt the sloppy precision during the solve
+  inv_param.precision_ladder = precision_ladder ? QUDA_BOOLEAN_TRUE : QUDA_BOOLEAN_FALSE;
+  inv_param.precision_ladder_check = precision_ladder_check;
+
   inv_param.struct_size = sizeof(inv_param);
 }
 